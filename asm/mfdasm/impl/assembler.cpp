@@ -119,6 +119,10 @@ Result<mri::SectionTable, AsmError> Assembler::astToBytes() const {
 		}
 
 		std::vector<u8> bytes = to_bytes_result.unwrap();
+		if(statement.kind() == Statement::INSTRUCTION) {
+			section_table.addLine(resolval_context.currentAddress, statement.lineno());
+		}
+
 		current_section->data.insert(current_section->data.end(), bytes.begin(), bytes.end());
 		resolval_context.currentAddress += bytes.size();
 	}
@@ -412,8 +412,9 @@ Result<std::vector<u8>, AsmError> Instruction::toBytes(ResolvalContext &resolval
 				return Err(err);
 			}
 
+			/* the operand starts after the opcode, the mode and the previous operand */
 			resolval_context.unresolvedIdentifiers.insert(
-				{resolval_context.currentAddress + 2 + ix,
+				{resolval_context.currentAddress + 2 + operands.size(),
 				 {.name = err.maybeMessage().value_or(""),
 				  .width = static_cast<usize>(reg ? 1 : 2),
 				  .lineno = m_expressions[ix]->lineno()}});
@@ -78,4 +78,12 @@ std::shared_ptr<Section> SectionTable::findSectionByAddress(usize address) {
 	return nullptr;
 }
 
+void SectionTable::addLine(u16 address, u32 lineno) {
+	m_lines.push_back({.address = address, .lineno = lineno});
+}
+
+const std::vector<shared::LineTableEntry> &SectionTable::lines() const {
+	return m_lines;
+}
+
 }  // namespace mfdasm::impl::mri
@@ -22,6 +22,7 @@
 #include <memory>
 #include <string>
 
+#include <shared/line_table.hpp>
 #include <shared/typedefs.hpp>
 
 #include <mfdasm/impl/asmerror.hpp>
@@ -46,8 +47,18 @@ class SectionTable {
 
 	std::shared_ptr<Section> findSectionByAddress(usize address);
 
+	/**
+	 * @brief Record that the instruction at the given address was assembled from
+	 * the given source line.
+	 */
+	void addLine(u16 address, u32 lineno);
+
+	const std::vector<shared::LineTableEntry> &lines() const;
+
    private:
 	SectionMap m_sectionMap;
+
+	std::vector<shared::LineTableEntry> m_lines;
 };
 
 }  // namespace mfdasm::impl::mri
@@ -23,6 +23,7 @@
 #include <string>
 
 #include <shared/cli/args.hpp>
+#include <shared/line_table.hpp>
 #include <shared/log.hpp>
 
 #include <mfdasm/impl/assembler.hpp>
@@ -55,6 +56,7 @@ int main(int argc, char **argv) {
 	shared::cli::Argument<std::string> arg_outfile("-o");
 	shared::cli::Argument<std::string> arg_infile("-i");
 	shared::cli::Argument<bool> arg_padded("-p", "--padded", true);
+	shared::cli::Argument<std::string> arg_line_table("-g", "--line-table");
 
 	shared::cli::ArgumentParser parser;
 	parser.addArgument(&arg_verbosity);
@@ -63,6 +65,7 @@ int main(int argc, char **argv) {
 	parser.addArgument(&arg_outfile);
 	parser.addArgument(&arg_infile);
 	parser.addArgument(&arg_padded);
+	parser.addArgument(&arg_line_table);
 	parser.parse(argc - 1, argv + 1);  // NOLINT
 
 	if(arg_licenses.get().value_or(false)) {
@@ -122,5 +125,17 @@ int main(int argc, char **argv) {
 		impl::mri::writeCompactMRI(outfile, bytes.unwrap(), false);
 	}
 
+	const std::optional<std::string> line_table_file = arg_line_table.get();
+	if(line_table_file.has_value()) {
+		const shared::LineTable line_table = {
+			.source = infile.value(),
+			.entries = bytes.unwrap().lines(),
+		};
+
+		if(!line_table.write(line_table_file.value())) {
+			std::exit(1);
+		}
+	}
+
 	return 0;
 }
@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <mfdemu/impl/instructions.hpp>
+#include <mfdemu/machine.hpp>
+#include <mfdemu/mfdemu.h>
+
+using mfdemu::Machine;
+
+struct mfdemu_machine {
+	std::unique_ptr<Machine> machine;
+};
+
+struct mfdemu_snapshot {
+	Machine::Snapshot snapshot;
+};
+
+static_assert(MFDEMU_REG_IID == mfdemu::impl::REGISTER_IID);
+static_assert(MFDEMU_EVENT_CYCLE_LIMIT == static_cast<int>(Machine::Event::CYCLE_LIMIT));
+
+static bool validRegister(mfdemu_register reg) {
+	return reg >= MFDEMU_REG_AL && reg <= MFDEMU_REG_IID;
+}
+
+extern "C" {
+
+unsigned mfdemu_api_version(void) {
+	return MFDEMU_API_VERSION;
+}
+
+mfdemu_machine *mfdemu_create(const uint8_t *mri, size_t size) {
+	std::unique_ptr<Machine> machine = Machine::fromMRI(std::vector<u8>(mri, mri + size));
+	if(machine == nullptr) {
+		return nullptr;
+	}
+
+	return new mfdemu_machine{std::move(machine)};
+}
+
+void mfdemu_destroy(mfdemu_machine *machine) {
+	delete machine;
+}
+
+void mfdemu_reset(mfdemu_machine *machine) {
+	machine->machine->reset();
+}
+
+bool mfdemu_map_gio(
+	mfdemu_machine *machine, uint16_t first, uint16_t last, mfdemu_gio_read_fn read,
+	mfdemu_gio_write_fn write, void *user) {
+	Machine::GioRead read_callback;
+	if(read != nullptr) {
+		read_callback = [read, user](u16 port, bool low) { return read(user, port, low); };
+	}
+
+	Machine::GioWrite write_callback;
+	if(write != nullptr) {
+		write_callback = [write, user](u16 port, u8 value, bool low) {
+			write(user, port, value, low);
+		};
+	}
+
+	return machine->machine->mapIoDevice(first, last, read_callback, write_callback);
+}
+
+bool mfdemu_map_aio(
+	mfdemu_machine *machine, uint16_t first, uint16_t last, mfdemu_aio_read_fn read,
+	mfdemu_aio_write_fn write, void *user) {
+	Machine::AioRead read_callback;
+	if(read != nullptr) {
+		read_callback = [read, user](u16 address) { return read(user, address); };
+	}
+
+	Machine::AioWrite write_callback;
+	if(write != nullptr) {
+		write_callback = [write, user](u16 address, u16 value) { write(user, address, value); };
+	}
+
+	return machine->machine->mapMemoryDevice(first, last, read_callback, write_callback);
+}
+
+bool mfdemu_set_halt_port(mfdemu_machine *machine, uint16_t port) {
+	return machine->machine->setHaltPort(port);
+}
+
+mfdemu_event mfdemu_step(mfdemu_machine *machine) {
+	return static_cast<mfdemu_event>(machine->machine->step());
+}
+
+mfdemu_event mfdemu_run_cycles(mfdemu_machine *machine, uint64_t cycles) {
+	return static_cast<mfdemu_event>(machine->machine->run(cycles));
+}
+
+mfdemu_event mfdemu_run(mfdemu_machine *machine) {
+	return static_cast<mfdemu_event>(machine->machine->run());
+}
+
+void mfdemu_request_stop(mfdemu_machine *machine) {
+	machine->machine->requestStop();
+}
+
+void mfdemu_set_breakpoint(mfdemu_machine *machine, uint16_t ip) {
+	machine->machine->setBreakpoint(ip);
+}
+
+void mfdemu_remove_breakpoint(mfdemu_machine *machine, uint16_t ip) {
+	machine->machine->removeBreakpoint(ip);
+}
+
+uint16_t mfdemu_read_register(const mfdemu_machine *machine, mfdemu_register reg) {
+	return validRegister(reg) ? machine->machine->readRegister(reg) : 0;
+}
+
+void mfdemu_write_register(mfdemu_machine *machine, mfdemu_register reg, uint16_t value) {
+	if(validRegister(reg)) {
+		machine->machine->writeRegister(reg, value);
+	}
+}
+
+void mfdemu_read_memory(
+	const mfdemu_machine *machine, uint16_t address, uint8_t *data, size_t size) {
+	const std::vector<u8> contents = machine->machine->readMemory(address, size);
+	std::copy(contents.begin(), contents.end(), data);
+}
+
+void mfdemu_write_memory(
+	mfdemu_machine *machine, uint16_t address, const uint8_t *data, size_t size) {
+	machine->machine->writeMemory(address, std::vector<u8>(data, data + size));
+}
+
+uint64_t mfdemu_cycles(const mfdemu_machine *machine) {
+	return machine->machine->cycles();
+}
+
+uint64_t mfdemu_retired(const mfdemu_machine *machine) {
+	return machine->machine->retired();
+}
+
+bool mfdemu_halted(const mfdemu_machine *machine) {
+	return machine->machine->halted();
+}
+
+uint16_t mfdemu_guest_status(const mfdemu_machine *machine) {
+	return machine->machine->guestStatus();
+}
+
+mfdemu_snapshot *mfdemu_snapshot_take(mfdemu_machine *machine) {
+	std::optional<Machine::Snapshot> snapshot = machine->machine->snapshot();
+	if(!snapshot.has_value()) {
+		return nullptr;
+	}
+
+	return new mfdemu_snapshot{std::move(snapshot.value())};
+}
+
+void mfdemu_snapshot_restore(mfdemu_machine *machine, const mfdemu_snapshot *snapshot) {
+	machine->machine->restore(snapshot->snapshot);
+}
+
+void mfdemu_snapshot_free(mfdemu_snapshot *snapshot) {
+	delete snapshot;
+}
+}
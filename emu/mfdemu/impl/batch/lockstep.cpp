@@ -0,0 +1,654 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include <mfdemu/impl/batch/lockstep.hpp>
+#include <mfdemu/impl/devices/halt.hpp>
+#include <mfdemu/impl/instructions.hpp>
+
+namespace mfdemu::impl {
+
+static constexpr u16 FLAG_OF = 1 << 15;
+static constexpr u16 FLAG_CF = 1 << 14;
+static constexpr u16 FLAG_ZF = 1 << 13;
+static constexpr u16 FLAG_NF = 1 << 12;
+static constexpr u16 FLAG_IE = 1 << 11;
+
+/** operand modes without a memory access */
+static constexpr u8 MODE_IMMEDIATE = 0b0000;
+static constexpr u8 MODE_REGISTER = 0b1000;
+
+/** slots in LockstepBatch::m_registers */
+static constexpr usize SLOT_ACL = 0;
+static constexpr usize SLOT_IP = 5;
+static constexpr usize SLOT_AR = 6;
+static constexpr usize SLOT_FL = 7;
+
+/** groups smaller than this fraction of all lanes run on the scalar Cpu */
+static constexpr usize MIN_GROUP_FRACTION = 8;
+
+static usize registerSlot(u8 id) {
+	return id < REGISTER_SP ? id / 3 : id - REGISTER_SP + 4;
+}
+
+/** bits of the slot which make up the register, see Cpu::getRegister() */
+static u16 registerBits(u8 id) {
+	if(id >= REGISTER_SP) {
+		return 0xFFFF;
+	}
+
+	constexpr std::array<u16, 3> BITS = {0x00FF, 0xFF00, 0xFFFF};
+	return BITS[id % 3];
+}
+
+/** registers lane kernels may write, ip, fl and iid are left to the Cpu */
+static bool writableRegister(u8 id) {
+	return id <= REGISTER_SP || id == REGISTER_AR;
+}
+
+static bool jumpTaken(u8 opcode, u16 fl) {
+	const bool of = (fl & FLAG_OF) != 0;
+	const bool cf = (fl & FLAG_CF) != 0;
+	const bool zf = (fl & FLAG_ZF) != 0;
+	const bool nf = (fl & FLAG_NF) != 0;
+
+	switch(opcode) {
+	case OPCODE_JMP:
+		return true;
+	case OPCODE_JZ:
+		return zf;
+	case OPCODE_JG:
+		return !zf && nf == of;
+	case OPCODE_JGE:
+		return nf == of;
+	case OPCODE_JL:
+		return nf != of;
+	case OPCODE_JLE:
+		return zf || nf != of;
+	case OPCODE_JC:
+		return cf;
+	case OPCODE_JS:
+		return nf;
+	case OPCODE_JNZ:
+		return !zf;
+	case OPCODE_JNC:
+		return !cf;
+	case OPCODE_JNS:
+		return !nf;
+	default:
+		return false;
+	}
+}
+
+LockstepBatch::LockstepBatch(const std::vector<u8> &image, usize lanes)
+	: m_lanes(lanes),
+	  m_cycles(lanes),
+	  m_retired(lanes),
+	  m_state(lanes, LaneState::RUNNING),
+	  m_guestStatus(lanes),
+	  m_mask(lanes),
+	  m_operand1(lanes),
+	  m_operand2(lanes),
+	  m_result(lanes),
+	  m_costs(0x10000),
+	  m_ioBus(std::make_shared<GioBus>()) {
+	for(std::vector<u16> &reg: m_registers) {
+		reg.resize(lanes);
+	}
+
+	const MemoryImage shared_image(image);
+	m_memory.reserve(lanes);
+	for(usize lane = 0; lane < lanes; lane++) {
+		m_memory.push_back(std::make_shared<AioDevice>(false, image.size()));
+		m_memory.back()->loadImage(shared_image);
+	}
+
+	m_cpu.connectIoDevice(m_ioBus);
+}
+
+void LockstepBatch::writeMemory(usize lane, u16 address, const std::vector<u8> &data) {
+	m_memory[lane]->writeData(address, data);
+}
+
+void LockstepBatch::setHaltPort(u16 port) {
+	m_ioBus->mapDevice(port, port, std::make_shared<HaltDevice>(port, [this](u16 status) {
+						   m_haltStatus = status;
+					   }));
+}
+
+u16 LockstepBatch::readRegister(usize lane, u8 id) const {
+	if(id > REGISTER_IID) {
+		return 0;
+	}
+
+	return m_registers[registerSlot(id)][lane] & registerBits(id);
+}
+
+void LockstepBatch::start() {
+	for(usize lane = 0; lane < m_lanes; lane++) {
+		m_cpu.clear();
+		m_cpu.connectAddressDevice(m_memory[lane]);
+
+		m_cpu.reset = true;
+		m_cpu.iclck();
+		m_cpu.reset = false;
+		while(!m_cpu.atInstructionBoundary()) {
+			m_cpu.iclck();
+		}
+
+		for(usize slot = 0; slot < Cpu::REGISTER_FILE_IDS.size(); slot++) {
+			m_registers[slot][lane] = m_cpu.readRegister(Cpu::REGISTER_FILE_IDS[slot]);
+		}
+		m_cycles[lane] = m_cpu.cycles();
+		m_retired[lane] = m_cpu.perfCounters().retired;
+	}
+
+	m_started = true;
+}
+
+LockstepBatch::Instruction LockstepBatch::decode(usize lane, u16 ip) const {
+	const AioDevice &memory = *m_memory[lane];
+
+	Instruction instruction{};
+	const u16 head = memory.readWord(ip);
+	instruction.ip = ip;
+	instruction.opcode = head >> 8;
+	instruction.mode1 = (head >> 4) & 0xF;
+	instruction.mode2 = head & 0xF;
+
+	const u8 operand_count = instruction.opcode < INSTRUCTION_OPERAND_COUNT.size()
+								 ? INSTRUCTION_OPERAND_COUNT[instruction.opcode]
+								 : 0;
+	const u16 length1 = (instruction.mode1 & MODE_REGISTER) != 0 ? 1 : 2;
+	const u16 length2 = (instruction.mode2 & MODE_REGISTER) != 0 ? 1 : 2;
+
+	instruction.value1 = memory.readWord(static_cast<u16>(ip + 2));
+	instruction.value2 = memory.readWord(static_cast<u16>(ip + 2 + length1));
+	instruction.next_ip =
+		ip + 2 + (operand_count >= 1 ? length1 : 0) + (operand_count == 2 ? length2 : 0);
+	return instruction;
+}
+
+bool LockstepBatch::sameCode(usize lane, usize reference, const Instruction &instruction) const {
+	const AioDevice &memory = *m_memory[lane];
+	const AioDevice &reference_memory = *m_memory[reference];
+
+	for(u16 address = instruction.ip; address != instruction.next_ip; address++) {
+		if(memory.readByte(address) != reference_memory.readByte(address)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+u32 LockstepBatch::learnedCycles(const Instruction &instruction, bool taken) const {
+	const Cost &cost = m_costs[instruction.ip];
+	return cost.encoding == instruction.encoding() ? cost.cycles[taken ? 1 : 0] : 0;
+}
+
+void LockstepBatch::scalarStep(usize lane) {
+	const Instruction instruction = decode(lane, m_registers[SLOT_IP][lane]);
+	const bool taken = jumpTaken(instruction.opcode, m_registers[SLOT_FL][lane]);
+
+	m_cpu.connectAddressDevice(m_memory[lane]);
+	for(usize slot = 0; slot < Cpu::REGISTER_FILE_IDS.size(); slot++) {
+		m_cpu.writeRegister(Cpu::REGISTER_FILE_IDS[slot], m_registers[slot][lane]);
+	}
+
+	const u64 cycles = m_cpu.cycles();
+	const u64 retired = m_cpu.perfCounters().retired;
+	m_haltStatus.reset();
+
+	do {
+		m_cpu.iclck();
+	} while(!m_cpu.atInstructionBoundary());
+
+	for(usize slot = 0; slot < Cpu::REGISTER_FILE_IDS.size(); slot++) {
+		m_registers[slot][lane] = m_cpu.readRegister(Cpu::REGISTER_FILE_IDS[slot]);
+	}
+
+	const u64 spent = m_cpu.cycles() - cycles;
+	m_cycles[lane] += spent;
+	m_retired[lane] += m_cpu.perfCounters().retired - retired;
+	m_stats.scalar_instructions += m_cpu.perfCounters().retired - retired;
+
+	Cost &cost = m_costs[instruction.ip];
+	if(cost.encoding != instruction.encoding()) {
+		cost = {.encoding = instruction.encoding(), .cycles = {0, 0}};
+	}
+	cost.cycles[taken ? 1 : 0] = spent;
+
+	if(m_haltStatus.has_value()) {
+		m_state[lane] = LaneState::HALTED;
+		m_guestStatus[lane] = m_haltStatus.value();
+	}
+}
+
+void LockstepBatch::run(u64 max_instructions) {
+	if(!m_started) {
+		start();
+	}
+
+	const std::vector<u16> &ip = m_registers[SLOT_IP];
+
+	while(true) {
+		/* the lowest ip goes first, lanes which skipped ahead wait there */
+		u32 group_ip = UINT32_MAX;
+		for(usize lane = 0; lane < m_lanes; lane++) {
+			if(m_state[lane] != LaneState::RUNNING) {
+				continue;
+			}
+
+			if(m_retired[lane] >= max_instructions) {
+				m_state[lane] = LaneState::LIMIT;
+			} else if(m_exitIp.has_value() && ip[lane] == m_exitIp.value()) {
+				m_state[lane] = LaneState::EXIT_IP;
+			} else {
+				group_ip = std::min<u32>(group_ip, ip[lane]);
+			}
+		}
+
+		if(group_ip == UINT32_MAX) {
+			break;
+		}
+
+		usize first = m_lanes;
+		usize count = 0;
+		for(usize lane = 0; lane < m_lanes; lane++) {
+			const bool member = m_state[lane] == LaneState::RUNNING && ip[lane] == group_ip;
+			m_mask[lane] = member ? 0xFFFF : 0;
+			count += member ? 1 : 0;
+			first = member && first == m_lanes ? lane : first;
+		}
+
+		/* lanes which modified the code at ip take their own way */
+		const Instruction instruction = decode(first, group_ip);
+		for(usize lane = first + 1; lane < m_lanes; lane++) {
+			if(m_mask[lane] != 0 && !sameCode(lane, first, instruction)) {
+				m_mask[lane] = 0;
+				count--;
+				scalarStep(lane);
+			}
+		}
+
+		if(count > 1 && count * MIN_GROUP_FRACTION >= m_lanes && vectorStep(instruction)) {
+			m_stats.vector_steps++;
+			m_stats.vector_instructions += count;
+			continue;
+		}
+
+		for(usize lane = first; lane < m_lanes; lane++) {
+			if(m_mask[lane] != 0) {
+				scalarStep(lane);
+			}
+		}
+	}
+}
+
+void LockstepBatch::loadRegister(u8 id, std::vector<u16> &out) const {
+	const std::vector<u16> &reg = m_registers[registerSlot(id)];
+	const u16 bits = registerBits(id);
+
+	for(usize lane = 0; lane < m_lanes; lane++) {
+		out[lane] = reg[lane] & bits;
+	}
+}
+
+void LockstepBatch::storeRegister(u8 id, const std::vector<u16> &values) {
+	std::vector<u16> &reg = m_registers[registerSlot(id)];
+	const u16 bits = registerBits(id);
+
+	for(usize lane = 0; lane < m_lanes; lane++) {
+		const u16 merged = (reg[lane] & ~bits) | (values[lane] & bits);
+		reg[lane] = (merged & m_mask[lane]) | (reg[lane] & ~m_mask[lane]);
+	}
+}
+
+bool LockstepBatch::loadOperand(u8 mode, u16 value, std::vector<u16> &out) const {
+	if(mode == MODE_IMMEDIATE) {
+		std::fill(out.begin(), out.end(), value);
+		return true;
+	}
+
+	const u8 id = value >> 8;
+	if(mode != MODE_REGISTER || id > REGISTER_IID) {
+		return false;
+	}
+
+	loadRegister(id, out);
+	return true;
+}
+
+bool LockstepBatch::loadMemoryOperand(u8 mode, u16 value, std::vector<u16> &out) const {
+	const bool is_register = (mode & MODE_REGISTER) != 0;
+	const u8 id = value >> 8;
+	if(is_register && id > REGISTER_IID) {
+		return false;
+	}
+
+	if(is_register) {
+		loadRegister(id, out);
+	} else {
+		std::fill(out.begin(), out.end(), value);
+	}
+
+	const bool indirect = (mode & 0b10) != 0;
+	for(usize lane = 0; lane < m_lanes; lane++) {
+		if(m_mask[lane] == 0) {
+			continue;
+		}
+
+		const AioDevice &memory = *m_memory[lane];
+		const u16 address = indirect ? memory.readWord(out[lane]) : out[lane];
+		out[lane] = memory.readWord(address);
+	}
+
+	return true;
+}
+
+void LockstepBatch::updateFlags(u16 clear, const std::vector<u16> &set) {
+	std::vector<u16> &fl = m_registers[SLOT_FL];
+
+	for(usize lane = 0; lane < m_lanes; lane++) {
+		const u16 updated = (fl[lane] & ~clear) | set[lane];
+		fl[lane] = (updated & m_mask[lane]) | (fl[lane] & ~m_mask[lane]);
+	}
+}
+
+void LockstepBatch::retire(const Instruction &instruction, u32 cycles) {
+	std::vector<u16> &ip = m_registers[SLOT_IP];
+
+	for(usize lane = 0; lane < m_lanes; lane++) {
+		const bool member = m_mask[lane] != 0;
+		ip[lane] = member ? instruction.next_ip : ip[lane];
+		m_cycles[lane] += member ? cycles : 0;
+		m_retired[lane] += member ? 1 : 0;
+	}
+}
+
+bool LockstepBatch::jump(const Instruction &instruction) {
+	if(!loadOperand(instruction.mode1, instruction.value1, m_operand1)) {
+		return false;
+	}
+
+	const std::vector<u16> &fl = m_registers[SLOT_FL];
+	u16 any_taken = 0;
+	u16 any_not_taken = 0;
+	for(usize lane = 0; lane < m_lanes; lane++) {
+		m_result[lane] = jumpTaken(instruction.opcode, fl[lane]) ? 0xFFFF : 0;
+		any_taken |= m_mask[lane] & m_result[lane];
+		any_not_taken |= m_mask[lane] & ~m_result[lane];
+	}
+
+	const u32 taken_cycles = learnedCycles(instruction, true);
+	const u32 not_taken_cycles = learnedCycles(instruction, false);
+	if((any_taken != 0 && taken_cycles == 0) || (any_not_taken != 0 && not_taken_cycles == 0)) {
+		return false;
+	}
+
+	std::vector<u16> &ip = m_registers[SLOT_IP];
+	for(usize lane = 0; lane < m_lanes; lane++) {
+		const bool member = m_mask[lane] != 0;
+		const bool taken = m_result[lane] != 0;
+		const u16 target = taken ? m_operand1[lane] : instruction.next_ip;
+		ip[lane] = member ? target : ip[lane];
+		m_cycles[lane] += member ? (taken ? taken_cycles : not_taken_cycles) : 0;
+		m_retired[lane] += member ? 1 : 0;
+	}
+
+	return true;
+}
+
+bool LockstepBatch::vectorStep(const Instruction &instruction) {
+	if(instruction.opcode >= OPCODE_JMP && instruction.opcode <= OPCODE_JNS) {
+		return jump(instruction);
+	}
+
+	const u32 cycles = learnedCycles(instruction, false);
+	if(cycles == 0) {
+		return false;
+	}
+
+	std::vector<u16> &ar = m_registers[SLOT_AR];
+	const std::vector<u16> &fl = m_registers[SLOT_FL];
+	const u8 target1 = instruction.value1 >> 8;
+	const u8 target2 = instruction.value2 >> 8;
+
+	switch(instruction.opcode) {
+	case OPCODE_ADD:
+	case OPCODE_ADC: {
+		if(!loadOperand(instruction.mode1, instruction.value1, m_operand1)) {
+			return false;
+		}
+
+		const bool with_carry = instruction.opcode == OPCODE_ADC;
+		for(usize lane = 0; lane < m_lanes; lane++) {
+			const u32 carry = with_carry && (fl[lane] & FLAG_CF) != 0 ? 1 : 0;
+			const u32 sum = m_operand1[lane] + ar[lane] + carry;
+			m_result[lane] = (sum > UINT16_MAX ? FLAG_CF : 0) | (sum == 0 ? FLAG_ZF : 0);
+			m_operand2[lane] = sum;
+		}
+
+		updateFlags(FLAG_OF | FLAG_CF | FLAG_ZF | FLAG_NF, m_result);
+		storeRegister(REGISTER_AR, m_operand2);
+		break;
+	}
+	case OPCODE_AND:
+	case OPCODE_OR:
+	case OPCODE_TEST: {
+		if(!loadOperand(instruction.mode1, instruction.value1, m_operand1)) {
+			return false;
+		}
+
+		const bool is_or = instruction.opcode == OPCODE_OR;
+		for(usize lane = 0; lane < m_lanes; lane++) {
+			const u16 value = is_or ? ar[lane] | m_operand1[lane] : ar[lane] & m_operand1[lane];
+			m_result[lane] = value == 0 ? FLAG_ZF : 0;
+			m_operand2[lane] = value;
+		}
+
+		updateFlags(FLAG_OF | FLAG_CF | FLAG_ZF, m_result);
+		if(instruction.opcode != OPCODE_TEST) {
+			storeRegister(REGISTER_AR, m_operand2);
+		}
+		break;
+	}
+	case OPCODE_XOR: {
+		if(!loadOperand(instruction.mode1, instruction.value1, m_operand1)) {
+			return false;
+		}
+
+		for(usize lane = 0; lane < m_lanes; lane++) {
+			m_operand2[lane] = ar[lane] ^ m_operand1[lane];
+			m_result[lane] = m_operand2[lane] == 0 ? FLAG_ZF : 0;
+		}
+
+		updateFlags(FLAG_ZF, m_result);
+		storeRegister(REGISTER_AR, m_operand2);
+		break;
+	}
+	case OPCODE_MUL: {
+		if(!loadOperand(instruction.mode1, instruction.value1, m_operand1)) {
+			return false;
+		}
+
+		for(usize lane = 0; lane < m_lanes; lane++) {
+			const u32 product = static_cast<u32>(ar[lane]) * m_operand1[lane];
+			m_operand1[lane] = product >> 16;
+			m_operand2[lane] = product;
+			m_result[lane] = m_operand1[lane] != 0 ? FLAG_OF | FLAG_CF : 0;
+		}
+
+		updateFlags(FLAG_OF | FLAG_CF, m_result);
+		storeRegister(REGISTER_AR, m_operand2);
+		storeRegister(REGISTER_ACL, m_operand1);
+		break;
+	}
+	case OPCODE_CMP: {
+		if(!loadOperand(instruction.mode1, instruction.value1, m_operand1) ||
+		   !loadOperand(instruction.mode2, instruction.value2, m_operand2)) {
+			return false;
+		}
+
+		for(usize lane = 0; lane < m_lanes; lane++) {
+			const bool below = m_operand1[lane] < m_operand2[lane];
+			const bool equal = m_operand1[lane] == m_operand2[lane];
+			m_result[lane] = (below ? FLAG_CF : 0) | (equal ? FLAG_ZF : 0);
+		}
+
+		updateFlags(FLAG_OF | FLAG_CF | FLAG_ZF | FLAG_NF, m_result);
+		break;
+	}
+	case OPCODE_INC:
+	case OPCODE_DEC: {
+		if(!writableRegister(target1)) {
+			return false;
+		}
+
+		loadRegister(target1, m_operand1);
+		const u16 delta = instruction.opcode == OPCODE_INC ? 1 : UINT16_MAX;
+		for(usize lane = 0; lane < m_lanes; lane++) {
+			m_result[lane] = m_operand1[lane] + delta;
+		}
+
+		storeRegister(target1, m_result);
+		break;
+	}
+	case OPCODE_LD: {
+		if(!writableRegister(target1)) {
+			return false;
+		}
+
+		const bool memory = instruction.mode2 != MODE_IMMEDIATE &&
+							instruction.mode2 != MODE_REGISTER;
+		if(memory ? !loadMemoryOperand(instruction.mode2, instruction.value2, m_operand2)
+				  : !loadOperand(instruction.mode2, instruction.value2, m_operand2)) {
+			return false;
+		}
+
+		storeRegister(target1, m_operand2);
+		break;
+	}
+	case OPCODE_MOV: {
+		if(!writableRegister(target2)) {
+			return false;
+		}
+
+		/* MOV takes operand 1 as is unless it names a register */
+		if((instruction.mode1 & MODE_REGISTER) == 0) {
+			std::fill(m_operand1.begin(), m_operand1.end(), instruction.value1);
+		} else if(target1 <= REGISTER_IID) {
+			loadRegister(target1, m_operand1);
+		} else {
+			return false;
+		}
+
+		storeRegister(target2, m_operand1);
+		break;
+	}
+	case OPCODE_NOT:
+	case OPCODE_NEG: {
+		if(instruction.mode1 != MODE_REGISTER || !writableRegister(target1)) {
+			return false;
+		}
+
+		loadRegister(target1, m_operand1);
+		const bool negate = instruction.opcode == OPCODE_NEG;
+		for(usize lane = 0; lane < m_lanes; lane++) {
+			m_result[lane] = negate ? 0 - m_operand1[lane] : ~m_operand1[lane];
+		}
+
+		storeRegister(target1, m_result);
+		break;
+	}
+	case OPCODE_SL:
+	case OPCODE_SR:
+	case OPCODE_ROL:
+	case OPCODE_ROR: {
+		if(instruction.mode1 != MODE_REGISTER || !writableRegister(target1) ||
+		   !loadOperand(instruction.mode2, instruction.value2, m_operand2)) {
+			return false;
+		}
+
+		/* the Cpu shifts by the full count, which is only defined below 16 */
+		u16 count_bits = 0;
+		for(usize lane = 0; lane < m_lanes; lane++) {
+			count_bits |= m_mask[lane] & m_operand2[lane];
+		}
+		if(count_bits >= 16) {
+			return false;
+		}
+
+		loadRegister(target1, m_operand1);
+		const u8 opcode = instruction.opcode;
+		for(usize lane = 0; lane < m_lanes; lane++) {
+			const u32 value = m_operand1[lane];
+			const u32 count = m_operand2[lane] & 0xF;
+			const u32 left = value << count;
+			const u32 right = (value << 8) >> count;
+
+			switch(opcode) {
+			case OPCODE_SL:
+				m_result[lane] = left;
+				break;
+			case OPCODE_SR:
+				m_result[lane] = value >> count;
+				break;
+			case OPCODE_ROL:
+				m_result[lane] = left | ((left >> 16) & 0xFF);
+				break;
+			default:
+				m_result[lane] = (value >> count) | ((right & 0xFF) << 8);
+				break;
+			}
+		}
+
+		storeRegister(target1, m_result);
+		break;
+	}
+	case OPCODE_NOP:
+		break;
+	case OPCODE_CLO:
+	case OPCODE_CLC:
+	case OPCODE_CLZ:
+	case OPCODE_CLN:
+	case OPCODE_CLI:
+	case OPCODE_STO:
+	case OPCODE_STC:
+	case OPCODE_STZ:
+	case OPCODE_STN:
+	case OPCODE_STI: {
+		constexpr std::array<u16, 5> FLAGS = {FLAG_OF, FLAG_CF, FLAG_ZF, FLAG_NF, FLAG_IE};
+		const bool set = instruction.opcode >= OPCODE_STO;
+		const u16 flag =
+			FLAGS[instruction.opcode - (set ? OPCODE_STO : OPCODE_CLO)];
+
+		std::fill(m_result.begin(), m_result.end(), set ? flag : 0);
+		updateFlags(flag, m_result);
+		break;
+	}
+	default:
+		return false;
+	}
+
+	retire(instruction, cycles);
+	return true;
+}
+
+}  // namespace mfdemu::impl
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MFDEMU_IMPL_BATCH_LOCKSTEP_HPP
+#define MFDEMU_IMPL_BATCH_LOCKSTEP_HPP
+
+#include <array>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include <shared/typedefs.hpp>
+
+#include <mfdemu/impl/bus/aio_device.hpp>
+#include <mfdemu/impl/bus/gio_bus.hpp>
+#include <mfdemu/impl/cpu.hpp>
+
+namespace mfdemu::impl {
+
+/**
+ * @brief Runs one image on many instances (lanes) at once. The registers of all
+ * lanes are kept in one array per register, lanes which are at the same ip
+ * execute the instruction together in branch-free loops over these arrays, so
+ * the compiler can use the vector units. Lanes at another ip are masked out
+ * until they meet again.
+ *
+ * Instructions without a lane kernel, such as bus I/O and memory writes, and
+ * groups too small to be worth a pass over all lanes run on a scalar Cpu. The
+ * cycles an instruction takes are learned from these scalar runs, so cycle and
+ * retired counts match those of a System running the same lane.
+ *
+ * Each lane has its own memory, pages are shared between lanes until they are
+ * written to. The only GIO device is an optional HaltDevice,
+ * reads from any other port return 0 and interrupts are never raised.
+ */
+class LockstepBatch {
+   public:
+	enum class LaneState : u8 {
+		RUNNING,
+		HALTED,
+		EXIT_IP,
+		LIMIT,
+	};
+
+	struct Stats {
+		/** passes over all lanes */
+		u64 vector_steps;
+		/** instructions retired by lanes in these passes */
+		u64 vector_instructions;
+		/** instructions retired on the scalar Cpu */
+		u64 scalar_instructions;
+	};
+
+	LockstepBatch(const std::vector<u8> &image, usize lanes);
+
+	usize lanes() const { return m_lanes; }
+
+	/**
+	 * @brief Overwrite memory of a lane, e.g. with its input. Only valid
+	 * before run().
+	 */
+	void writeMemory(usize lane, u16 address, const std::vector<u8> &data);
+	const AioDevice &memory(usize lane) const { return *m_memory[lane]; }
+
+	/**
+	 * @brief Halt a lane once it writes its exit status to port, see
+	 * HaltDevice.
+	 */
+	void setHaltPort(u16 port);
+
+	/**
+	 * @brief Stop a lane once the instruction at ip is about to be executed.
+	 */
+	void setExitIp(u16 ip) { m_exitIp = ip; }
+
+	/**
+	 * @brief Run until every lane halted, reached the exit ip or retired
+	 * max_instructions instructions.
+	 */
+	void run(u64 max_instructions);
+
+	LaneState state(usize lane) const { return m_state[lane]; }
+	u16 guestStatus(usize lane) const { return m_guestStatus[lane]; }
+	u64 cycles(usize lane) const { return m_cycles[lane]; }
+	u64 retired(usize lane) const { return m_retired[lane]; }
+	u16 readRegister(usize lane, u8 id) const;
+
+	const Stats &stats() const { return m_stats; }
+
+   private:
+	/** decoded instruction at the ip of the current group */
+	struct Instruction {
+		u16 ip;
+		u8 opcode;
+		u8 mode1;
+		u8 mode2;
+		u16 value1;
+		u16 value2;
+		u16 next_ip;
+
+		u16 encoding() const { return (opcode << 8) | (mode1 << 4) | mode2; }
+	};
+
+	/** learned cycle counts of the instruction encoding at an address, 0 if
+	 * unknown. Index 1 holds the count of jumps which are taken. */
+	struct Cost {
+		u16 encoding;
+		std::array<u32, 2> cycles;
+	};
+
+	void start();
+	Instruction decode(usize lane, u16 ip) const;
+	bool sameCode(usize lane, usize reference, const Instruction &instruction) const;
+	u32 learnedCycles(const Instruction &instruction, bool taken) const;
+
+	void scalarStep(usize lane);
+
+	bool vectorStep(const Instruction &instruction);
+	bool loadOperand(u8 mode, u16 value, std::vector<u16> &out) const;
+	bool loadMemoryOperand(u8 mode, u16 value, std::vector<u16> &out) const;
+	void loadRegister(u8 id, std::vector<u16> &out) const;
+	void storeRegister(u8 id, const std::vector<u16> &values);
+	void updateFlags(u16 clear, const std::vector<u16> &set);
+	void retire(const Instruction &instruction, u32 cycles);
+	bool jump(const Instruction &instruction);
+
+	usize m_lanes;
+	bool m_started{false};
+	std::optional<u16> m_exitIp;
+
+	/** lane registers in Cpu::REGISTER_FILE_IDS order, FL is kept in the
+	 * format returned by Cpu::readRegister() */
+	std::array<std::vector<u16>, Cpu::REGISTER_FILE_IDS.size()> m_registers;
+	std::vector<u64> m_cycles;
+	std::vector<u64> m_retired;
+	std::vector<LaneState> m_state;
+	std::vector<u16> m_guestStatus;
+	std::vector<std::shared_ptr<AioDevice>> m_memory;
+
+	/** 0xffff for lanes in the current group, 0 otherwise */
+	std::vector<u16> m_mask;
+	std::vector<u16> m_operand1;
+	std::vector<u16> m_operand2;
+	std::vector<u16> m_result;
+
+	std::vector<Cost> m_costs;
+
+	/** scalar Cpu, lanes are swapped in by their registers and memory */
+	Cpu m_cpu;
+	std::shared_ptr<GioBus> m_ioBus;
+	usize m_scalarLane{0};
+	std::optional<u16> m_haltStatus;
+
+	Stats m_stats{};
+};
+
+}  // namespace mfdemu::impl
+
+#endif
@@ -15,7 +15,8 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
-#include <bitset>
+#include <algorithm>
+#include <cstddef>
 #include <utility>
 
 #include <shared/log.hpp>
@@ -26,8 +27,9 @@
 namespace mfdemu::impl {
 
 AioDevice::AioDevice(bool read_only, usize size)
-	: m_address(0), m_write(false), m_readOnly(read_only) {
-	m_data.reserve(size);
+	: m_address(0), m_write(false) {
+	m_access.fill(read_only ? Access::READ_ONLY : Access::READ_WRITE);
+	m_pages.reserve((size + PAGE_SIZE - 1) / PAGE_SIZE);
 }
 
 void AioDevice::clck() {
@@ -51,28 +53,24 @@ void AioDevice::clck() {
 		m_step = 3;
 		break;
 	case 3:
-		if(m_write) {
-			if(m_readOnly) {
-				m_step = 0;
-				break;
-			}
+		if(m_mappedPages.test(m_address / PAGE_SIZE)) {
+			AioMappedDevice *device = findDevice(m_address);
+			if(device != nullptr) {
+				if(m_write) {
+					device->write(m_address, io);
+				} else {
+					io = device->read(m_address);
+				}
 
-			if(m_address >= m_data.size() || m_address + 1 >= m_data.size()) { /* discard */
 				m_step = 0;
 				break;
 			}
+		}
 
-			if(m_address == 0x5000) { /* debug thingy */
-				logInfo() << "write to 0x5000 , value = 0b" << std::bitset<16>(io).to_string()
-						  << "\n";
-			}
-
-			m_data[m_address] = (io >> 8) & 0xFF;
-			m_data[m_address + 1] = io & 0xFF;
+		if(m_write) {
+			storeWord(m_address, io);
 		} else {
-			io = m_address >= m_data.size() || m_address + 1 >= m_data.size()
-					 ? 0
-					 : (m_data[m_address] << 8) | m_data[m_address + 1];
+			io = loadWord(m_address);
 		}
 
 		m_step = 0;
@@ -82,8 +80,236 @@ void AioDevice::clck() {
 	}
 }
 
+u16 AioDevice::loadWord(u16 address) const {
+	const u16 value = m_access[address / PAGE_SIZE] != Access::NONE ? readWord(address) : 0;
+
+	if(m_watchpoints != nullptr && m_watchpoints->watched(address)) {
+		m_watchpoints->access(address, false, value, value);
+	}
+
+	return value;
+}
+
+void AioDevice::storeWord(u16 address, u16 value) {
+	if(m_access[address / PAGE_SIZE] != Access::READ_WRITE) {
+		return;
+	}
+
+	if(static_cast<usize>(address) + 1 >= m_size) { /* discard */
+		return;
+	}
+
+	if(m_watchpoints != nullptr && m_watchpoints->watched(address)) {
+		m_watchpoints->access(address, true, readWord(address), value);
+	}
+
+	writeByte(address, (value >> 8) & 0xFF);
+	writeByte(address + 1, value & 0xFF);
+}
+
+bool AioDevice::blockAccess(u16 address, usize count) const {
+	/* the pages of mapped devices are rare, any word in one takes the slow path */
+	for(usize ix = 0; ix < count; ix++) {
+		if(m_mappedPages.test(static_cast<u16>(address + (ix * 2)) / PAGE_SIZE)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void AioDevice::readBlock(u16 address, u16 *out, usize count) {
+	for(usize ix = 0; ix < count; ix++) {
+		out[ix] = loadWord(address);
+		address += 2;
+	}
+}
+
+void AioDevice::writeBlock(u16 address, const u16 *data, usize count) {
+	for(usize ix = 0; ix < count; ix++) {
+		storeWord(address, data[ix]);
+		address += 2;
+	}
+}
+
+std::vector<std::shared_ptr<AioDevice::Page>> AioDevice::makePages(const std::vector<u8> &data) {
+	static const std::shared_ptr<Page> zero_page = std::make_shared<Page>();
+
+	std::vector<std::shared_ptr<Page>> pages((data.size() + PAGE_SIZE - 1) / PAGE_SIZE);
+	for(usize index = 0; index < pages.size(); index++) {
+		const auto first = data.begin() + static_cast<std::ptrdiff_t>(index * PAGE_SIZE);
+		const auto last = first + static_cast<std::ptrdiff_t>(
+									  std::min(PAGE_SIZE, data.size() - (index * PAGE_SIZE)));
+
+		if(std::all_of(first, last, [](u8 value) { return value == 0; })) {
+			pages[index] = zero_page;
+			continue;
+		}
+
+		pages[index] = std::make_shared<Page>();
+		std::copy(first, last, pages[index]->begin());
+	}
+
+	return pages;
+}
+
+AioDevice::Page &AioDevice::writablePage(usize index) {
+	std::shared_ptr<Page> &page = m_pages[index];
+	if(!m_ownedPages.test(index)) {
+		page = std::make_shared<Page>(*page);
+		m_ownedPages.set(index);
+	}
+
+	return *page;
+}
+
 void AioDevice::setData(std::vector<u8> data) {
-	m_data = std::move(data);
+	m_size = data.size();
+	m_pages = makePages(data);
+	m_ownedPages.reset();
+}
+
+void AioDevice::loadData(const std::vector<u8> &data) {
+	m_size = data.size();
+	m_pages = makePages(data);
+	m_ownedPages.reset();
+	m_step = 0;
+	mode = false;
+	m_dirtyPages.reset();
 }
 
+void AioDevice::loadImage(const MemoryImage &image) {
+	m_size = image.m_size;
+	m_pages = image.m_pages;
+	m_ownedPages.reset();
+	m_step = 0;
+	mode = false;
+	m_dirtyPages.reset();
+}
+
+void AioDevice::writeData(usize address, const std::vector<u8> &data) {
+	for(usize ix = 0; ix < data.size() && address + ix < m_size; ix++) {
+		writeByte(address + ix, data[ix]);
+	}
+}
+
+bool AioDevice::mapDevice(u16 first, u16 last, std::shared_ptr<AioMappedDevice> device) {
+	if(first > last) {
+		logError() << "invalid AIO address range 0x" << std::hex << first << " to 0x" << last
+				   << std::dec << "\n";
+		return false;
+	}
+
+	for(u32 page = first / PAGE_SIZE; page <= last / PAGE_SIZE; page++) {
+		std::vector<Mapping> &mappings = m_pageMappings[page];
+
+		/* a page covered entirely hides all earlier mappings of it */
+		if(first <= page * PAGE_SIZE && last >= ((page + 1) * PAGE_SIZE) - 1) {
+			mappings.clear();
+		}
+
+		mappings.insert(mappings.begin(), {first, last, device});
+		m_mappedPages.set(page);
+	}
+
+	return true;
+}
+
+void AioDevice::setAccess(usize first_page, usize last_page, Access access) {
+	std::fill(m_access.begin() + first_page, m_access.begin() + last_page + 1, access);
+}
+
+AioMappedDevice *AioDevice::findDevice(u16 address) const {
+	for(const Mapping &mapping: m_pageMappings[address / PAGE_SIZE]) {
+		if(address >= mapping.first && address <= mapping.last) {
+			return mapping.device.get();
+		}
+	}
+
+	return nullptr;
+}
+
+void AioDevice::dmaRead(usize address, u8 *out, usize length) const {
+	while(length > 0) {
+		const usize offset = address % PAGE_SIZE;
+		const usize chunk = std::min(length, PAGE_SIZE - offset);
+		const usize valid = address < m_size ? std::min(chunk, m_size - address) : 0;
+
+		if(valid > 0 && m_access[address / PAGE_SIZE] != Access::NONE) {
+			std::copy_n(m_pages[address / PAGE_SIZE]->begin() + offset, valid, out);
+			std::fill_n(out + valid, chunk - valid, 0);
+
+			if(m_watchpoints != nullptr && m_watchpoints->watched(address)) {
+				for(usize ix = 0; ix + 1 < valid; ix += 2) {
+					m_watchpoints->access(
+						address + ix, false, readWord(address + ix), readWord(address + ix));
+				}
+			}
+		} else {
+			std::fill_n(out, chunk, 0);
+		}
+
+		address += chunk;
+		out += chunk;
+		length -= chunk;
+	}
+}
+
+void AioDevice::dmaWrite(usize address, const u8 *data, usize length) {
+	while(length > 0 && address < m_size) {
+		const usize offset = address % PAGE_SIZE;
+		const usize chunk = std::min({length, PAGE_SIZE - offset, m_size - address});
+
+		if(m_access[address / PAGE_SIZE] == Access::READ_WRITE) {
+			if(m_watchpoints != nullptr && m_watchpoints->watched(address)) {
+				for(usize ix = 0; ix + 1 < chunk; ix += 2) {
+					m_watchpoints->access(
+						address + ix, true, readWord(address + ix), (data[ix] << 8) | data[ix + 1]);
+				}
+			}
+
+			std::copy_n(data, chunk, writablePage(address / PAGE_SIZE).begin() + offset);
+			m_dirtyPages.set(address / PAGE_SIZE);
+		}
+
+		address += chunk;
+		data += chunk;
+		length -= chunk;
+	}
+}
+
+std::vector<u8> AioDevice::data() const {
+	std::vector<u8> data(m_size);
+	for(usize offset = 0; offset < m_size; offset += PAGE_SIZE) {
+		const Page &page = *m_pages[offset / PAGE_SIZE];
+		std::copy_n(
+			page.begin(), std::min(PAGE_SIZE, m_size - offset),
+			data.begin() + static_cast<std::ptrdiff_t>(offset));
+	}
+
+	return data;
+}
+
+MemoryImage AioDevice::snapshot() {
+	m_ownedPages.reset();
+	return {m_size, m_pages};
+}
+
+AioDevice::PageSet AioDevice::takeDirtyPages() {
+	const PageSet pages = m_dirtyPages;
+	m_dirtyPages.reset();
+	return pages;
+}
+
+usize AioDevice::privatePages() const {
+	return m_ownedPages.count();
+}
+
+void AioDevice::setWatchpoints(Watchpoints *watchpoints) {
+	m_watchpoints = watchpoints;
+}
+
+MemoryImage::MemoryImage(const std::vector<u8> &data)
+	: m_size(data.size()), m_pages(AioDevice::makePages(data)) {}
+
 }  // namespace mfdemu::impl
@@ -18,30 +18,217 @@
 #ifndef MFDEMU_IMPL_AIO_DEVICE_HPP
 #define MFDEMU_IMPL_AIO_DEVICE_HPP
 
+#include <array>
+#include <bitset>
+#include <memory>
+#include <utility>
 #include <vector>
 
 #include <shared/typedefs.hpp>
 
 #include <mfdemu/impl/bus/bus_device.hpp>
+#include <mfdemu/impl/debug/watchpoints.hpp>
 
 namespace mfdemu::impl {
 
+class MemoryImage;
+
+/**
+ * @brief Device mapped into the address space of an AioDevice in place of its
+ * memory. It is accessed a word at a time, at the address of the first byte.
+ */
+class AioMappedDevice {
+   public:
+	virtual ~AioMappedDevice() = default;
+
+	virtual u16 read(u16 address) = 0;
+	virtual void write(u16 address, u16 value) = 0;
+};
+
+/**
+ * @brief Main memory. The contents are kept in refcounted pages which are
+ * shared with the MemoryImage they were loaded from, and with every other
+ * device that loaded it, until the device writes to them.
+ */
 class AioDevice : public BaseBusDevice<u16> {
    public:
+	static constexpr usize PAGE_SIZE = 0x100;
+	static constexpr usize PAGE_COUNT = 0x10000 / PAGE_SIZE;
+	using PageSet = std::bitset<PAGE_COUNT>;
+	using Page = std::array<u8, PAGE_SIZE>;
+
+	/** @brief How the Cpu may access a page. */
+	enum class Access : u8 {
+		READ_WRITE,
+		/** writes are discarded */
+		READ_ONLY,
+		/** reads return 0 and writes are discarded */
+		NONE,
+	};
+
 	AioDevice(bool read_only, usize size);
 	void clck() override;
 
 	void setData(std::vector<u8> data);
 
+	/**
+	 * @brief Copy data into the existing buffer and abort any transaction in
+	 * progress.
+	 */
+	void loadData(const std::vector<u8> &data);
+
+	/**
+	 * @brief Share the pages of image and abort any transaction in progress.
+	 */
+	void loadImage(const MemoryImage &image);
+
+	/**
+	 * @brief Overwrite the buffer starting at address, bytes past its end are
+	 * dropped.
+	 */
+	void writeData(usize address, const std::vector<u8> &data);
+
+	/**
+	 * @brief Route accesses to the addresses first..last (inclusive) to the
+	 * given device. Later mappings take precedence over earlier ones if they
+	 * overlap. Returns false if first is above last.
+	 */
+	bool mapDevice(u16 first, u16 last, std::shared_ptr<AioMappedDevice> device);
+
+	/**
+	 * @brief Set the access of the pages first_page..last_page (inclusive), a
+	 * word is accessed with the rights of the page of its first byte. Loading
+	 * data is not restricted.
+	 */
+	void setAccess(usize first_page, usize last_page, Access access);
+
+	usize size() const { return m_size; }
+
+	/** @brief 0 past the end of memory. */
+	u8 readByte(usize address) const {
+		return address < m_size ? (*m_pages[address / PAGE_SIZE])[address % PAGE_SIZE] : 0;
+	}
+
+	/** @brief Big endian word as read by the Cpu, 0 past the end of memory. */
+	u16 readWord(usize address) const {
+		return address + 1 >= m_size ? 0 : (readByte(address) << 8) | readByte(address + 1);
+	}
+
+	/**
+	 * @brief Copy length bytes starting at address into out, as a bus master
+	 * other than the Cpu would. Page access rights and watchpoints apply,
+	 * memory mapped devices are bypassed. Bytes past the end of memory read as
+	 * 0.
+	 */
+	void dmaRead(usize address, u8 *out, usize length) const;
+
+	/**
+	 * @brief Copy length bytes from data to memory starting at address, see
+	 * dmaRead(). Bytes past the end of memory are dropped.
+	 */
+	void dmaWrite(usize address, const u8 *data, usize length);
+
+	/* words in pages with mapped devices are not supported */
+	bool blockAccess(u16 address, usize count) const override;
+	void readBlock(u16 address, u16 *out, usize count) override;
+	void writeBlock(u16 address, const u16 *data, usize count) override;
+
+	/** @brief Copy of the whole memory. */
+	std::vector<u8> data() const;
+	const Page &page(usize index) const { return *m_pages[index]; }
+
+	/**
+	 * @brief The current contents as an image sharing all pages, later writes
+	 * to either copy the page. The device gives up ownership of all its pages,
+	 * even once the image is released its next write to each page copies it.
+	 */
+	MemoryImage snapshot();
+
+	/**
+	 * @brief Pages written since the last call.
+	 */
+	PageSet takeDirtyPages();
+
+	/**
+	 * @brief Number of pages this device copied for itself and writes in
+	 * place.
+	 */
+	usize privatePages() const;
+
+	/**
+	 * @brief Report accesses to watched pages, nullptr disables watchpoints.
+	 */
+	void setWatchpoints(Watchpoints *watchpoints);
+
    private:
+	friend class MemoryImage;
+
+	/** split data into pages, pages which are all zero share one page */
+	static std::vector<std::shared_ptr<Page>> makePages(const std::vector<u8> &data);
+
+	/** a Cpu word access to memory, mapped devices are not considered */
+	u16 loadWord(u16 address) const;
+	void storeWord(u16 address, u16 value);
+
+	/** the page at index, copied first unless the device owns it */
+	Page &writablePage(usize index);
+
+	void writeByte(usize address, u8 value) {
+		writablePage(address / PAGE_SIZE)[address % PAGE_SIZE] = value;
+		m_dirtyPages.set(address / PAGE_SIZE);
+	}
+
 	/** internal state */
 	u8 m_step{0};
 	u32 m_address;
 	bool m_write;
 
 	/** data */
-	bool m_readOnly;
-	std::vector<u8> m_data;
+	std::array<Access, PAGE_COUNT> m_access;
+	usize m_size{0};
+	std::vector<std::shared_ptr<Page>> m_pages;
+	/** pages this device copied and never handed out, only these are written
+	 * in place. use_count() can not tell, other threads may release their
+	 * references to a page concurrently. */
+	PageSet m_ownedPages;
+
+	struct Mapping {
+		u16 first;
+		u16 last;
+		std::shared_ptr<AioMappedDevice> device;
+	};
+
+	/** mapped device at address, nullptr for memory */
+	AioMappedDevice *findDevice(u16 address) const;
+
+	Watchpoints *m_watchpoints{nullptr};
+	PageSet m_dirtyPages;
+
+	/** mappings touching each page, the latest first */
+	std::array<std::vector<Mapping>, PAGE_COUNT> m_pageMappings;
+	/** pages with at least one mapped address */
+	PageSet m_mappedPages;
+};
+
+/**
+ * @brief Read-only memory contents to load into any number of AioDevices, e.g.
+ * a parsed MRI used by many instances. Only pages a device writes to are
+ * copied for it.
+ */
+class MemoryImage {
+   public:
+	explicit MemoryImage(const std::vector<u8> &data);
+
+	usize size() const { return m_size; }
+
+   private:
+	friend class AioDevice;
+
+	MemoryImage(usize size, std::vector<std::shared_ptr<AioDevice::Page>> pages)
+		: m_size(size), m_pages(std::move(pages)) {}
+
+	usize m_size;
+	std::vector<std::shared_ptr<AioDevice::Page>> m_pages;
 };
 
 }  // namespace mfdemu::impl
@@ -18,6 +18,8 @@
 #ifndef MFDEMU_IMPL_IO_DEVICE_HPP
 #define MFDEMU_IMPL_IO_DEVICE_HPP
 
+#include <shared/typedefs.hpp>
+
 namespace mfdemu::impl {
 
 template <typename BusWidthType>
@@ -27,6 +29,32 @@ class BaseBusDevice {
 
 	virtual void clck() = 0;
 
+	/**
+	 * @brief Interrupt acknowledge, the device puts the id of the interrupt
+	 * being acknowledged on io.
+	 */
+	virtual void acknowledge() {}
+
+	/**
+	 * @brief True if address is a stream port, such as a FIFO. Block
+	 * transfers to and from it stay at the port instead of advancing.
+	 */
+	virtual bool streamPort(u16 address) const { return false; }
+
+	/**
+	 * @brief True if count word transactions starting at address can be done
+	 * at once by readBlock() and writeBlock(), with the same effect as one bus
+	 * transaction per word. The address advances by 2 per word unless it is a
+	 * stream port.
+	 */
+	virtual bool blockAccess(u16 address, usize count) const { return false; }
+
+	/** @brief Read count words, only valid if blockAccess() is true. */
+	virtual void readBlock(u16 address, u16 *out, usize count) {}
+
+	/** @brief Write count words, only valid if blockAccess() is true. */
+	virtual void writeBlock(u16 address, const u16 *data, usize count) {}
+
 	bool mode{false};
 	BusWidthType io;
 };
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include <shared/log.hpp>
+
+#include <mfdemu/impl/bus/gio_bus.hpp>
+#include <mfdemu/impl/debug/history.hpp>
+
+namespace mfdemu::impl {
+
+GioBus::GioBus() : m_devices(1), m_ports(0x10000, 0) {}
+
+bool GioBus::mapDevice(u16 first, u16 last, std::shared_ptr<GioDevice> device) {
+	if(first > last) {
+		logError() << "invalid GIO port range 0x" << std::hex << first << " to 0x" << last
+				   << std::dec << "\n";
+		return false;
+	}
+
+	if(m_devices.size() > MAX_DEVICES) {
+		logError() << "too many devices mapped to the GIO bus\n";
+		return false;
+	}
+
+	std::fill(m_ports.begin() + first, m_ports.begin() + last + 1, m_devices.size());
+	m_devices.push_back(std::move(device));
+	return true;
+}
+
+void GioBus::write(u16 address, u8 value, bool low) {
+	if(m_history != nullptr && m_history->reexecuting()) {
+		return;
+	}
+
+	GioDevice *device = findDevice(address);
+	if(device != nullptr) {
+		device->write(address, value, low);
+	}
+}
+
+void GioBus::setRecorder(InputRecorder *recorder) {
+	m_recorder = recorder;
+}
+
+void GioBus::setReplayer(InputReplayer *replayer) {
+	m_replayer = replayer;
+}
+
+void GioBus::setHistory(History *history) {
+	m_history = history;
+}
+
+void GioBus::setInterruptController(InterruptController *controller) {
+	m_controller = controller;
+}
+
+void GioBus::acknowledge() {
+	if(m_history != nullptr && m_history->reexecuting()) {
+		io = m_history->gioRead();
+		return;
+	}
+
+	/* the interrupt id is guest input like any other read */
+	if(m_replayer != nullptr) {
+		io = m_replayer->gioRead();
+	} else if(m_controller != nullptr) {
+		io = m_controller->acknowledgeInterrupt();
+	} else {
+		io = m_interrupts.acknowledge();
+	}
+
+	if(m_recorder != nullptr) {
+		m_recorder->gioRead(io);
+	}
+
+	if(m_history != nullptr) {
+		m_history->logGioRead(io);
+	}
+}
+
+bool GioBus::blockAccess(u16 address, usize count) const {
+	if(m_recorder != nullptr || m_replayer != nullptr || m_history != nullptr) {
+		return false;
+	}
+
+	const GioDevice *device = findDevice(address);
+	if(!streamPort(address)) {
+		for(usize ix = 1; ix < count; ix++) {
+			const u16 port = address + (ix * 2);
+			if(findDevice(port) != device || streamPort(port)) {
+				return false;
+			}
+		}
+	}
+
+	return device == nullptr || device->blockAccess(address, count);
+}
+
+void GioBus::readBlock(u16 address, u16 *out, usize count) {
+	GioDevice *device = findDevice(address);
+	if(device == nullptr) {
+		std::fill_n(out, count, 0);
+		return;
+	}
+
+	/* each word is two reads, see read() */
+	const bool stream = device->streamPort(address);
+	for(usize ix = 0; ix < count; ix++) {
+		if(!device->stableRead(stream ? address : address + (ix * 2))) {
+			m_volatileReads += 2;
+		}
+	}
+
+	device->readBlock(address, out, count);
+}
+
+void GioBus::writeBlock(u16 address, const u16 *data, usize count) {
+	GioDevice *device = findDevice(address);
+	if(device != nullptr) {
+		device->writeBlock(address, data, count);
+	}
+}
+
+u8 GioBus::read(u16 address, bool low) {
+	if(m_history != nullptr && m_history->reexecuting()) {
+		return m_history->gioRead();
+	}
+
+	GioDevice *device = findDevice(address);
+	if(device != nullptr && !device->stableRead(address)) {
+		m_volatileReads++;
+	}
+
+	u8 value = 0;
+	if(m_replayer != nullptr) {
+		value = m_replayer->gioRead();
+	} else {
+		value = device != nullptr ? device->read(address, low) : 0;
+	}
+
+	if(m_recorder != nullptr) {
+		m_recorder->gioRead(value);
+	}
+
+	if(m_history != nullptr) {
+		m_history->logGioRead(value);
+	}
+
+	return value;
+}
+
+}  // namespace mfdemu::impl
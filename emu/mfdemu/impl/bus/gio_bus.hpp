@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MFDEMU_IMPL_GIO_BUS_HPP
+#define MFDEMU_IMPL_GIO_BUS_HPP
+
+#include <memory>
+#include <vector>
+
+#include <shared/typedefs.hpp>
+
+#include <mfdemu/impl/bus/gio_device.hpp>
+#include <mfdemu/impl/bus/interrupts.hpp>
+#include <mfdemu/impl/replay.hpp>
+
+namespace mfdemu::impl {
+
+class History;
+
+/**
+ * @brief GIO device which decodes the bus protocol once and forwards each
+ * transaction to the device mapped to the addressed port. Mappings are
+ * resolved into a flat table with one entry per port when they are made, so
+ * dispatching is a single lookup. Reads from unmapped ports return 0, writes
+ * to them are discarded.
+ */
+class GioBus : public GioDevice {
+   public:
+	static constexpr usize MAX_DEVICES = 0xff;
+
+	GioBus();
+
+	/**
+	 * @brief Map the ports first..last (inclusive) to the given device. Later
+	 * mappings take precedence over earlier ones if they overlap. At most
+	 * MAX_DEVICES devices can be mapped. Returns false if first is above last
+	 * or no more devices can be mapped.
+	 */
+	bool mapDevice(u16 first, u16 last, std::shared_ptr<GioDevice> device);
+
+	/** @brief True if a device is mapped to port. */
+	bool mapped(u16 port) const { return m_ports[port] != 0; }
+
+	/** @brief Interrupt lines of the devices on this bus. */
+	InterruptSink &interrupts() { return m_interrupts; }
+
+	/**
+	 * @brief Let controller decide IRQ and the acknowledged interrupt id,
+	 * nullptr goes back to the lowest raised line.
+	 */
+	void setInterruptController(InterruptController *controller);
+
+	/** @brief True while IRQ is high. */
+	bool interruptPending() const {
+		return m_controller != nullptr ? m_controller->pending() : m_interrupts.pending();
+	}
+
+	/**
+	 * @brief Put the interrupt id chosen by the controller on the bus, the
+	 * lowest raised one without a controller.
+	 */
+	void acknowledge() override;
+
+	bool streamPort(u16 address) const override {
+		const GioDevice *device = findDevice(address);
+		return device != nullptr && device->streamPort(address);
+	}
+
+	/**
+	 * @brief Block transfers are supported if all words go to the same device
+	 * and it supports them, or to unmapped ports. They are not while reads are
+	 * recorded, replayed or logged to history.
+	 */
+	bool blockAccess(u16 address, usize count) const override;
+	void readBlock(u16 address, u16 *out, usize count) override;
+	void writeBlock(u16 address, const u16 *data, usize count) override;
+
+	/**
+	 * @brief Log every byte read from a device to recorder.
+	 */
+	void setRecorder(InputRecorder *recorder);
+
+	/**
+	 * @brief Take all read values from replayer, devices are not read anymore.
+	 * Writes still reach them.
+	 */
+	void setReplayer(InputReplayer *replayer);
+
+	/**
+	 * @brief Log reads to history and take them from it while re-executing,
+	 * writes are dropped then.
+	 */
+	void setHistory(History *history);
+
+	/**
+	 * @brief Number of reads from ports which are not stable, see
+	 * GioDevice::stableRead().
+	 */
+	u64 volatileReads() const { return m_volatileReads; }
+
+   protected:
+	void write(u16 address, u8 value, bool low) override;
+	u8 read(u16 address, bool low) override;
+
+   private:
+	GioDevice *findDevice(u16 address) const { return m_devices[m_ports[address]].get(); }
+
+	/** mapped devices, index 0 is the null device of unmapped ports */
+	std::vector<std::shared_ptr<GioDevice>> m_devices;
+	/** index into m_devices per port */
+	std::vector<u8> m_ports;
+	InterruptSink m_interrupts;
+	InterruptController *m_controller{nullptr};
+	InputRecorder *m_recorder{nullptr};
+	InputReplayer *m_replayer{nullptr};
+	History *m_history{nullptr};
+	u64 m_volatileReads{0};
+};
+
+}  // namespace mfdemu::impl
+
+#endif
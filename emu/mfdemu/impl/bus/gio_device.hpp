@@ -30,9 +30,17 @@ class GioDevice : public BaseBusDevice<u8> {
 	void clck() override;
 
    protected:
+	friend class GioBus;
+
 	virtual void write(u16 address, u8 value, bool low) = 0;
 	virtual u8 read(u16 address, bool low) = 0;
 
+	/**
+	 * @brief True if reads of address only change through scheduled events or
+	 * IRQs, so that loops polling it may be skipped.
+	 */
+	virtual bool stableRead(u16 address) const { return false; }
+
 	/** internal state */
 	u8 m_step{0};
 	u16 m_address{0};
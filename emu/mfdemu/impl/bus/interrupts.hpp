@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MFDEMU_IMPL_BUS_INTERRUPTS_HPP
+#define MFDEMU_IMPL_BUS_INTERRUPTS_HPP
+
+#include <array>
+#include <atomic>
+#include <bit>
+
+#include <shared/typedefs.hpp>
+
+namespace mfdemu::impl {
+
+/**
+ * @brief Interrupt request lines of the GIO bus, one per interrupt id. IRQ is
+ * high while any line is raised, the acknowledge sequence puts the lowest
+ * raised id on the bus, unless an InterruptController decides. Lines are
+ * level triggered, a device keeps its line raised until the request was
+ * served. Lines may be raised and lowered from any thread.
+ */
+class InterruptSink {
+   public:
+	static constexpr usize LINE_COUNT = 0x100;
+
+	void raise(u8 id) { m_lines[id / 64].fetch_or(bit(id), std::memory_order_acq_rel); }
+	void lower(u8 id) { m_lines[id / 64].fetch_and(~bit(id), std::memory_order_acq_rel); }
+
+	bool pending() const {
+		for(const std::atomic<u64> &word: m_lines) {
+			if(word.load(std::memory_order_relaxed) != 0) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	/** @brief Lowest raised id, 0 if no line is raised. */
+	u8 acknowledge() const {
+		for(usize ix = 0; ix < m_lines.size(); ix++) {
+			const u64 word = m_lines[ix].load(std::memory_order_acquire);
+			if(word != 0) {
+				return (ix * 64) + std::countr_zero(word);
+			}
+		}
+
+		return 0;
+	}
+
+	/** @brief Bit n is set if line first + n is raised, for up to 64 lines. */
+	u64 raised(u8 first, usize count) const {
+		const usize word = first / 64;
+		const usize shift = first % 64;
+		u64 bits = m_lines[word].load(std::memory_order_acquire) >> shift;
+		if(shift != 0 && word + 1 < m_lines.size()) {
+			bits |= m_lines[word + 1].load(std::memory_order_acquire) << (64 - shift);
+		}
+
+		return count >= 64 ? bits : bits & ((static_cast<u64>(1) << count) - 1);
+	}
+
+   private:
+	static constexpr u64 bit(u8 id) { return static_cast<u64>(1) << (id % 64); }
+
+	std::array<std::atomic<u64>, LINE_COUNT / 64> m_lines{};
+};
+
+/**
+ * @brief Decides whether the raised lines interrupt the Cpu and which id is
+ * put on the bus when it acknowledges, instead of the lowest raised line.
+ * See GioBus::setInterruptController().
+ */
+class InterruptController {
+   public:
+	virtual ~InterruptController() = default;
+
+	/** @brief True while IRQ is high. */
+	virtual bool pending() const = 0;
+
+	/** @brief Interrupt id of the request the Cpu takes. */
+	virtual u8 acknowledgeInterrupt() = 0;
+};
+
+}  // namespace mfdemu::impl
+
+#endif
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <mfdemu/impl/bus/register_device.hpp>
+
+namespace mfdemu::impl {
+
+void RegisterDevice::setInterrupt(InterruptSink *sink, u8 first) {
+	m_interrupts = sink;
+	m_firstInterrupt = first;
+}
+
+void RegisterDevice::raiseInterrupt(u8 index) {
+	if(m_interrupts != nullptr) {
+		m_interrupts->raise(m_firstInterrupt + index);
+	}
+}
+
+void RegisterDevice::lowerInterrupt(u8 index) {
+	if(m_interrupts != nullptr) {
+		m_interrupts->lower(m_firstInterrupt + index);
+	}
+}
+
+void RegisterDevice::write(u16 address, u8 value, bool low) {
+	if(!low) {
+		m_writeHigh = value;
+		return;
+	}
+
+	writeRegister(address - m_base, (static_cast<u16>(m_writeHigh) << 8) | value);
+}
+
+u8 RegisterDevice::read(u16 address, bool low) {
+	if(!low) {
+		m_readLatch = readRegister(address - m_base);
+		return m_readLatch >> 8;
+	}
+
+	return m_readLatch & 0xFF;
+}
+
+}  // namespace mfdemu::impl
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef MFDEMU_IMPL_BUS_REGISTER_DEVICE_HPP
+#define MFDEMU_IMPL_BUS_REGISTER_DEVICE_HPP
+
+#include <shared/typedefs.hpp>
+
+#include <mfdemu/impl/bus/gio_device.hpp>
+#include <mfdemu/impl/bus/interrupts.hpp>
+
+namespace mfdemu::impl {
+
+/**
+ * @brief GIO device with word-sized registers at base + offset. The high byte
+ * of a write is held until the low byte arrives and the whole word is passed
+ * to writeRegister(). Reading the high byte latches the value of
+ * readRegister() so that the low byte belongs to the same word, even if the
+ * register changes in between.
+ */
+class RegisterDevice : public GioDevice {
+   public:
+	explicit RegisterDevice(u16 base) : m_base(base) {}
+
+	/**
+	 * @brief Raise line first + n of sink for interrupt n of the device, see
+	 * raiseInterrupt().
+	 */
+	void setInterrupt(InterruptSink *sink, u8 first);
+
+   protected:
+	virtual void writeRegister(u16 offset, u16 value) = 0;
+	virtual u16 readRegister(u16 offset) = 0;
+
+	/** @brief Same as GioDevice::stableRead() for the register at offset. */
+	virtual bool stableRegister(u16 offset) const { return false; }
+
+	/** @brief Raise and lower line first + index, nothing without a sink. */
+	void raiseInterrupt(u8 index = 0);
+	void lowerInterrupt(u8 index = 0);
+
+	void write(u16 address, u8 value, bool low) final;
+	u8 read(u16 address, bool low) final;
+
+	bool stableRead(u16 address) const final {
+		return stableRegister(static_cast<u16>(address - m_base));
+	}
+
+   private:
+	u16 m_base;
+
+	InterruptSink *m_interrupts{nullptr};
+	u8 m_firstInterrupt{0};
+
+	u8 m_writeHigh{0};
+	u16 m_readLatch{0};
+};
+
+}  // namespace mfdemu::impl
+
+#endif
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <fstream>
+#include <map>
+#include <string>
+
+#include <shared/log.hpp>
+
+#include <mfdemu/impl/coverage.hpp>
+#include <mfdemu/impl/instructions.hpp>
+
+namespace mfdemu::impl {
+
+struct LineCoverage {
+	bool executed{false};
+	bool is_branch{false};
+	bool taken{false};
+	bool not_taken{false};
+};
+
+bool Coverage::writeLcov(
+	const std::string &path,
+	const shared::LineTable &lines,
+	const std::vector<u8> &image) const {
+	std::ofstream stream(path, std::ios::out | std::ios::trunc);
+	if(!stream.is_open()) {
+		logError() << "could not open \"" << path << "\" for writing coverage\n";
+		return false;
+	}
+
+	/* more than one instruction may be on the same line (e.g. `times`) */
+	std::map<u32, LineCoverage> line_coverage;
+	for(const shared::LineTableEntry &entry: lines.entries) {
+		LineCoverage &line = line_coverage[entry.lineno];
+		line.executed |= executed(entry.address);
+
+		const u8 opcode = entry.address < image.size() ? image[entry.address] : OPCODE_NOP;
+		if(opcode >= OPCODE_JZ && opcode <= OPCODE_JNS) {
+			line.is_branch = true;
+			line.taken |= taken(entry.address);
+			line.not_taken |= notTaken(entry.address);
+		}
+	}
+
+	usize lines_hit = 0;
+	usize branches_found = 0;
+	usize branches_hit = 0;
+
+	stream << "TN:\nSF:" << lines.source << "\n";
+
+	for(const auto &[lineno, line]: line_coverage) {
+		if(!line.is_branch) {
+			continue;
+		}
+
+		/* block 0, branch 0 is the jump being taken, branch 1 falling through */
+		const char *taken_count = line.executed ? (line.taken ? "1" : "0") : "-";
+		const char *not_taken_count = line.executed ? (line.not_taken ? "1" : "0") : "-";
+		stream << "BRDA:" << lineno << ",0,0," << taken_count << "\n"
+			   << "BRDA:" << lineno << ",0,1," << not_taken_count << "\n";
+
+		branches_found += 2;
+		branches_hit += static_cast<usize>(line.taken) + static_cast<usize>(line.not_taken);
+	}
+
+	stream << "BRF:" << branches_found << "\nBRH:" << branches_hit << "\n";
+
+	for(const auto &[lineno, line]: line_coverage) {
+		stream << "DA:" << lineno << "," << (line.executed ? 1 : 0) << "\n";
+		lines_hit += static_cast<usize>(line.executed);
+	}
+
+	stream << "LF:" << line_coverage.size() << "\nLH:" << lines_hit << "\nend_of_record\n";
+
+	return stream.good();
+}
+
+}  // namespace mfdemu::impl
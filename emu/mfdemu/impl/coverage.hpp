@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MFDEMU_IMPL_COVERAGE_HPP
+#define MFDEMU_IMPL_COVERAGE_HPP
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include <shared/line_table.hpp>
+#include <shared/typedefs.hpp>
+
+namespace mfdemu::impl {
+
+/**
+ * @brief Guest code coverage. Keeps one bit per address for executed
+ * instructions and two bits per address for the taken/not-taken outcome of
+ * conditional jumps. Updates are branch-free so coverage can always be
+ * collected.
+ */
+class Coverage {
+   public:
+	static constexpr usize BITMAP_WORDS = 0x10000 / 64;
+
+	void markExecuted(u16 address) { m_executed[address >> 6] |= bit(address); }
+
+	void markBranch(u16 address, bool taken) {
+		m_taken[address >> 6] |= static_cast<u64>(taken) << (address & 63);
+		m_notTaken[address >> 6] |= static_cast<u64>(!taken) << (address & 63);
+	}
+
+	bool executed(u16 address) const { return (m_executed[address >> 6] & bit(address)) != 0; }
+	bool taken(u16 address) const { return (m_taken[address >> 6] & bit(address)) != 0; }
+	bool notTaken(u16 address) const { return (m_notTaken[address >> 6] & bit(address)) != 0; }
+
+	/**
+	 * @brief Write an lcov tracefile for the source described by the line table.
+	 * @param path The file to write to.
+	 * @param lines Line table of the source file as generated by mfdasm.
+	 * @param image The memory image which was loaded, used to identify
+	 * conditional jumps which were never executed.
+	 */
+	bool writeLcov(
+		const std::string &path,
+		const shared::LineTable &lines,
+		const std::vector<u8> &image) const;
+
+   private:
+	static u64 bit(u16 address) { return 1ULL << (address & 63); }
+
+	std::array<u64, BITMAP_WORDS> m_executed{};
+	std::array<u64, BITMAP_WORDS> m_taken{};
+	std::array<u64, BITMAP_WORDS> m_notTaken{};
+};
+
+}  // namespace mfdemu::impl
+
+#endif
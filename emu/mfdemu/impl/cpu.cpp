@@ -15,6 +15,7 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <memory>
@@ -39,6 +40,128 @@ void Cpu::connectIoDevice(std::shared_ptr<BaseBusDevice<u8>> device) {
 	m_ioDevice = std::move(device);
 }
 
+void Cpu::clear() {
+	std::shared_ptr<BaseBusDevice<u16>> address_device = std::move(m_addressDevice);
+	std::shared_ptr<BaseBusDevice<u8>> io_device = std::move(m_ioDevice);
+
+	*this = Cpu();
+	m_addressDevice = std::move(address_device);
+	m_ioDevice = std::move(io_device);
+}
+
+void Cpu::enableHeatmap() {
+	if(m_heatmap == nullptr) {
+		m_heatmap = std::make_unique<MemoryHeatmap>();
+	}
+}
+
+void Cpu::enableTrace() {
+	if(m_trace == nullptr) {
+		m_trace = std::make_unique<ExecutionTrace>();
+	}
+}
+
+void Cpu::resume() {
+	m_breakpointResume = m_stopped;
+	m_stopped = false;
+}
+
+void Cpu::step() {
+	resume();
+	m_stepping = true;
+}
+
+Cpu::RegisterFile Cpu::registerFile() const {
+	RegisterFile registers{};
+	for(usize ix = 0; ix < REGISTER_FILE_IDS.size(); ix++) {
+		registers[ix] = getRegister(REGISTER_FILE_IDS[ix]);
+	}
+
+	return registers;
+}
+
+Cpu::Context Cpu::saveContext() const {
+	return {
+		.state = m_state,
+		.step_stash = m_stepStash,
+		.state_step = m_stateStep,
+		.instruction = m_instruction,
+		.operand1 = m_operand1,
+		.operand2 = m_operand2,
+		.address_bus_input = m_addressBusInput,
+		.address_bus_output = m_addressBusOutput,
+		.address_bus_address = m_addressBusAddress,
+		.io_bus_input = m_ioBusInput,
+		.io_bus_output = m_ioBusOutput,
+		.io_bus_address = m_ioBusAddress,
+		.stash = {m_stash1, m_stash2, m_stash3, m_stash4},
+		.pin_ams = m_pinAMS,
+		.pin_gms = m_pinGMS,
+		.pin_clk = m_pinCLK,
+		.pin_ira = m_pinIRA,
+		.reg_acl = m_regACL,
+		.reg_bcl = m_regBCL,
+		.reg_ccl = m_regCCL,
+		.reg_dcl = m_regDCL,
+		.reg_sp = m_regSP,
+		.reg_ip = m_regIP,
+		.reg_ar = m_regAR,
+		.reg_fl = m_regFL,
+		.reg_iid = m_regIID,
+		.perf_opcode = m_perfOpcode,
+		.cycles = m_perf.cycles,
+		.retired = m_perf.retired,
+		.abus_reads = m_perf.abus_reads,
+		.abus_writes = m_perf.abus_writes,
+		.gio_reads = m_perf.gio_reads,
+		.gio_writes = m_perf.gio_writes,
+		.state_cycles = m_perf.state_cycles,
+	};
+}
+
+void Cpu::restoreContext(const Context &context) {
+	m_state = context.state;
+	m_stepStash = context.step_stash;
+	m_stateStep = context.state_step;
+	m_fetchBoundary = m_stateStep == 0 && !m_state.empty() &&
+					  m_state.top() == CpuState::INST_FETCH;
+	m_instruction = context.instruction;
+	m_operand1 = context.operand1;
+	m_operand2 = context.operand2;
+	m_addressBusInput = context.address_bus_input;
+	m_addressBusOutput = context.address_bus_output;
+	m_addressBusAddress = context.address_bus_address;
+	m_ioBusInput = context.io_bus_input;
+	m_ioBusOutput = context.io_bus_output;
+	m_ioBusAddress = context.io_bus_address;
+	m_stash1 = context.stash[0];
+	m_stash2 = context.stash[1];
+	m_stash3 = context.stash[2];
+	m_stash4 = context.stash[3];
+	m_pinAMS = context.pin_ams;
+	m_pinGMS = context.pin_gms;
+	m_pinCLK = context.pin_clk;
+	m_pinIRA = context.pin_ira;
+	m_regACL = context.reg_acl;
+	m_regBCL = context.reg_bcl;
+	m_regCCL = context.reg_ccl;
+	m_regDCL = context.reg_dcl;
+	m_regSP = context.reg_sp;
+	m_regIP = context.reg_ip;
+	m_regAR = context.reg_ar;
+	m_regFL = context.reg_fl;
+	m_regIID = context.reg_iid;
+	m_perfOpcode = context.perf_opcode;
+	m_perf.cycles = context.cycles;
+	m_perf.retired = context.retired;
+	m_perf.abus_reads = context.abus_reads;
+	m_perf.abus_writes = context.abus_writes;
+	m_perf.gio_reads = context.gio_reads;
+	m_perf.gio_writes = context.gio_writes;
+	m_perf.state_cycles = context.state_cycles;
+	m_blockArmed = false;
+}
+
 void Cpu::iclck() {
 	logDebug() << "IP = 0x" << std::hex << m_regIP << std::dec << "\n";
 
@@ -50,9 +173,34 @@ void Cpu::iclck() {
 		m_state.push(CpuState::INST_FETCH);
 		m_state.push(CpuState::RESET);
 		m_stateStep = 0;
+		m_fetchBoundary = false;
+		m_perfOpcode = PerfCounters::OPCODE_NONE;
+		m_blockArmed = false;
+	}
+
+	/* instruction boundary, checked before the cycle is accounted for so that
+	 * stopping does not skew the counters */
+	if(m_fetchBoundary && !m_breakpointResume) {
+		if(m_stepping ||
+		   (m_breakpoints.test(m_regIP) && m_breakpoints.shouldBreak(m_regIP, *this))) {
+			m_stepping = false;
+			m_stopped = true;
+			return;
+		}
 	}
 
-	switch(m_state.top()) {
+	const CpuState state = m_state.top();
+
+	/* the bus clock only pulses while a bus transaction is in progress */
+	m_pinCLK = state == CpuState::ABUS_READ || state == CpuState::ABUS_READ_INDIRECT ||
+			   state == CpuState::ABUS_WRITE || state == CpuState::GIO_READ ||
+			   state == CpuState::GIO_WRITE;
+
+	m_perf.cycles++;
+	m_perf.state_cycles[static_cast<u8>(state)]++;
+	m_perf.opcodes[m_perfOpcode].cycles++;
+
+	switch(state) {
 	case CpuState::ABUS_READ_INDIRECT:
 	case CpuState::ABUS_READ:
 		this->abusRead();
@@ -86,7 +234,10 @@ void Cpu::iclck() {
 		break;
 	}
 
-	if(irq && m_regFL.ie) {
+	/* requests are taken between instructions so that no instruction is torn
+	 * apart, IE is cleared on entry so a held line is not taken again before
+	 * IRET */
+	if(irq && m_regFL.ie && m_stateStep == 0 && m_state.top() == CpuState::INST_FETCH) {
 		newState(CpuState::HARD_INTERRUPT);
 	}
 }
@@ -98,25 +249,37 @@ void Cpu::abusRead() {
 
 	switch(m_stateStep) {
 	case 0: /* T0: priming pulse, AMS high */
-		m_addressDevice->mode = true;
+		m_pinAMS = true;
+		m_addressDevice->mode = m_pinAMS;
 		m_addressDevice->clck();
 		m_stateStep = 1;
 		break;
 	case 1: /* T1: address out, AMS high */
-		m_addressDevice->mode = true;
+		m_pinAMS = true;
+		m_addressDevice->mode = m_pinAMS;
 		m_addressDevice->io = m_addressBusAddress;
 		m_addressDevice->clck();
+		if(m_heatmap != nullptr) {
+			m_heatmap->record(
+				m_addressBusAddress,
+				m_heatmapFetch ? MemoryHeatmap::EXECUTE : MemoryHeatmap::READ);
+		}
+		m_heatmapFetch = false;
 		m_stateStep = 2;
 		break;
 	case 2: /* T2: mode pulse, AMS low */
-		m_addressDevice->mode = false;
+		m_pinAMS = false;
+		m_addressDevice->mode = m_pinAMS;
 		m_addressDevice->clck();
 		m_stateStep = 3;
 		break;
 	case 3: { /* T3: read pulse, AMS Low */
-		m_addressDevice->mode = false;
+		m_pinAMS = false;
+		m_addressDevice->mode = m_pinAMS;
 		m_addressDevice->clck();
 		m_addressBusInput = m_addressDevice->io;
+		m_perf.abus_reads++;
+		m_perf.opcodes[m_perfOpcode].bus_reads++;
 
 		const CpuState old_state = m_state.top();
 		finishState();
@@ -138,25 +301,34 @@ void Cpu::abusWrite() {
 
 	switch(m_stateStep) {
 	case 0: /* T0: priming pulse, AMS high */
-		m_addressDevice->mode = true;
+		m_pinAMS = true;
+		m_addressDevice->mode = m_pinAMS;
 		m_addressDevice->clck();
 		m_stateStep = 1;
 		break;
 	case 1: /* T1: address out, AMS high */
-		m_addressDevice->mode = true;
+		m_pinAMS = true;
+		m_addressDevice->mode = m_pinAMS;
 		m_addressDevice->io = m_addressBusAddress;
 		m_addressDevice->clck();
+		if(m_heatmap != nullptr) {
+			m_heatmap->record(m_addressBusAddress, MemoryHeatmap::WRITE);
+		}
 		m_stateStep = 2;
 		break;
 	case 2: /* T2: mode pulse, AMS high */
-		m_addressDevice->mode = true;
+		m_pinAMS = true;
+		m_addressDevice->mode = m_pinAMS;
 		m_addressDevice->clck();
 		m_stateStep = 3;
 		break;
 	case 3: /* T3: write pulse, AMS Low */
-		m_addressDevice->mode = false;
+		m_pinAMS = false;
+		m_addressDevice->mode = m_pinAMS;
 		m_addressDevice->io = m_addressBusOutput;
 		m_addressDevice->clck();
+		m_perf.abus_writes++;
+		m_perf.opcodes[m_perfOpcode].bus_writes++;
 
 		finishState();
 		break;
@@ -192,20 +364,23 @@ void Cpu::gioRead() {
 
 	switch(m_stateStep) {
 	case 0: /* T0: Priming pulse, GMS high */
-		m_ioDevice->mode = true;
+		m_pinGMS = true;
+		m_ioDevice->mode = m_pinGMS;
 		m_ioDevice->clck();
 
 		m_stateStep = 1;
 		break;
 	case 1: /* T1: Address High-Byte pulse, GMS high */
-		m_ioDevice->mode = true;
+		m_pinGMS = true;
+		m_ioDevice->mode = m_pinGMS;
 		m_ioDevice->io = (m_ioBusAddress >> 8) & 0xFF;
 		m_ioDevice->clck();
 
 		m_stateStep = 2;
 		break;
 	case 2: /* T2: Address Low-Byte pulse, GMS low */
-		m_ioDevice->mode = false;
+		m_pinGMS = false;
+		m_ioDevice->mode = m_pinGMS;
 		m_ioDevice->io = m_ioBusAddress & 0xFF;
 		m_ioDevice->clck();
 
@@ -220,6 +395,8 @@ void Cpu::gioRead() {
 	case 4: /* T4: Data Low-Byte read pulse */
 		m_ioDevice->clck();
 		m_ioBusInput |= m_ioDevice->io;
+		m_perf.gio_reads++;
+		m_perf.opcodes[m_perfOpcode].bus_reads++;
 
 		finishState();
 		break;
@@ -235,20 +412,23 @@ void Cpu::gioWrite() {
 
 	switch(m_stateStep) {
 	case 0: /* T0: Priming pulse, GMS high */
-		m_ioDevice->mode = true;
+		m_pinGMS = true;
+		m_ioDevice->mode = m_pinGMS;
 		m_ioDevice->clck();
 
 		m_stateStep = 1;
 		break;
 	case 1: /* T1: Address High-Byte pulse, GMS high */
-		m_ioDevice->mode = true;
+		m_pinGMS = true;
+		m_ioDevice->mode = m_pinGMS;
 		m_ioDevice->io = (m_ioBusAddress >> 8) & 0xFF;
 		m_ioDevice->clck();
 
 		m_stateStep = 2;
 		break;
 	case 2: /* T2: Address Low-Byte pulse, GMS high */
-		m_ioDevice->mode = true;
+		m_pinGMS = true;
+		m_ioDevice->mode = m_pinGMS;
 		m_ioDevice->io = m_ioBusAddress & 0xFF;
 		m_ioDevice->clck();
 
@@ -263,6 +443,8 @@ void Cpu::gioWrite() {
 	case 4: /* T4: Data Low-Byte write pulse */
 		m_ioDevice->io = m_ioBusOutput & 0xFF;
 		m_ioDevice->clck();
+		m_perf.gio_writes++;
+		m_perf.opcodes[m_perfOpcode].bus_writes++;
 
 		finishState();
 		break;
@@ -271,96 +453,21 @@ void Cpu::gioWrite() {
 	}
 }
 
-static std::array<u8, 0x4e> INSTRUCTION_OPERAND_COUNT = {
-	/* 0x00: ADC .........*/ 1,
-	/* 0x01: ADD .........*/ 1,
-	/* 0x02: AND .........*/ 1,
-	/* 0x03: BIN .........*/ 2,
-	/* 0x04: BOT .........*/ 2,
-	/* 0x05: CALL ........*/ 1,
-	/* 0x06: _RESERVED_00 */ 0,
-	/* 0x07: CMP .........*/ 2,
-	/* 0x08: DEC .........*/ 1,
-	/* 0x09: DIV .........*/ 1,
-	/* 0x0a: IDIV ........*/ 1,
-	/* 0x0b: IMUL ........*/ 1,
-	/* 0x0c: IN ..........*/ 2,
-	/* 0x0d: INC .........*/ 1,
-	/* 0x0e: INT .........*/ 1,
-	/* 0x0f: IRET ........*/ 0,
-	/* 0x10: JMP .........*/ 1,
-	/* 0x11: JZ ..........*/ 1,
-	/* 0x12: JG ..........*/ 1,
-	/* 0x13: JGE .........*/ 1,
-	/* 0x14: JL ..........*/ 1,
-	/* 0x15: JLE .........*/ 1,
-	/* 0x16: JC ..........*/ 1,
-	/* 0x17: JS ..........*/ 1,
-	/* 0x18: JNZ .........*/ 1,
-	/* 0x19: JNC .........*/ 1,
-	/* 0x1a: JNS .........*/ 1,
-	/* 0x1b: LD ..........*/ 2,
-	/* 0x1c: MOV .........*/ 2,
-	/* 0x1d: MUL .........*/ 1,
-	/* 0x1e: NEG .........*/ 1,
-	/* 0x1f: NOP .........*/ 0,
-	/* 0x20: NOT .........*/ 1,
-	/* 0x21: OR ..........*/ 1,
-	/* 0x22: OUT .........*/ 2,
-	/* 0x23: POP .........*/ 1,
-	/* 0x24: PUSH ........*/ 1,
-	/* 0x25: RET .........*/ 0,
-	/* 0x26: ROL .........*/ 2,
-	/* 0x27: ROR .........*/ 2,
-	/* 0x28: SL ..........*/ 2,
-	/* 0x29: SR ..........*/ 2,
-	/* 0x2a: ST ..........*/ 2,
-	/* 0x2b: CLO .........*/ 0,
-	/* 0x2c: CLC .........*/ 0,
-	/* 0x2d: CLZ .........*/ 0,
-	/* 0x2e: CLN .........*/ 0,
-	/* 0x2f: CLI .........*/ 0,
-	/* 0x30: _RESERVED_01 */ 0,
-	/* 0x31: _RESERVED_02 */ 0,
-	/* 0x32: _RESERVED_03 */ 0,
-	/* 0x33: _RESERVED_04 */ 0,
-	/* 0x34: _RESERVED_05 */ 0,
-	/* 0x35: _RESERVED_06 */ 0,
-	/* 0x36: _RESERVED_07 */ 0,
-	/* 0x37: _RESERVED_08 */ 0,
-	/* 0x38: _RESERVED_09 */ 0,
-	/* 0x39: _RESERVED_10 */ 0,
-	/* 0x3a: _RESERVED_11 */ 0,
-	/* 0x3b: STO .........*/ 0,
-	/* 0x3c: STC .........*/ 0,
-	/* 0x3d: STZ .........*/ 0,
-	/* 0x3e: STN .........*/ 0,
-	/* 0x3f: STI .........*/ 0,
-	/* 0x40: _RESERVED_12 */ 0,
-	/* 0x41: _RESERVED_13 */ 0,
-	/* 0x42: _RESERVED_14 */ 0,
-	/* 0x43: _RESERVED_15 */ 0,
-	/* 0x44: _RESERVED_16 */ 0,
-	/* 0x45: _RESERVED_17 */ 0,
-	/* 0x46: _RESERVED_18 */ 0,
-	/* 0x47: _RESERVED_19 */ 0,
-	/* 0x48: _RESERVED_20 */ 0,
-	/* 0x49: _RESERVED_21 */ 0,
-	/* 0x4a: _RESERVED_22 */ 0,
-	/* 0x4b: SUB .........*/ 1,
-	/* 0x4c: TEST ........*/ 1,
-	/* 0x4d: XOR .........*/ 1,
-};
-
 void Cpu::fetchInst() {
 	switch(m_stateStep) {
 	case 0:
+		m_breakpointResume = false;
+		m_coverage.markExecuted(m_regIP);
 		m_addressBusAddress = m_regIP;
+		m_heatmapFetch = true;
 		m_stateStep = 1;
 		newState(CpuState::ABUS_READ);
 		break;
 	case 1: { /* Determine instruction length, decode operands. */
 		m_instruction = (m_addressBusInput >> 8) & 0xFF;
+		if(m_trace != nullptr) {
+			m_trace->fetched(m_perf.cycles, m_regIP, m_instruction);
+		}
 
 		auto transform_operand_bits = [](u8 bits) -> AddressingMode {
 			return {
@@ -378,6 +485,7 @@ void Cpu::fetchInst() {
 			printFetchedInstruction();
 #endif
 			m_stateStep = 0;
+			m_perfOpcode = m_instruction;
 			newState(CpuState::INST_EXEC);
 			break;
 		}
@@ -391,6 +499,7 @@ void Cpu::fetchInst() {
 	}
 	case 2: /* Fetch operand 1 */
 		m_addressBusAddress = m_regIP + 2;
+		m_heatmapFetch = true;
 
 		m_stateStep = 3;
 		newState(CpuState::ABUS_READ);
@@ -403,11 +512,13 @@ void Cpu::fetchInst() {
 			printFetchedInstruction();
 #endif
 			m_stateStep = 0;
+			m_perfOpcode = m_instruction;
 			newState(CpuState::INST_EXEC);
 			break;
 		}
 
 		m_addressBusAddress = m_regIP + 2 + (m_operand1.mode.is_register ? 1 : 2);
+		m_heatmapFetch = true;
 
 		m_stateStep = 4;
 		newState(CpuState::ABUS_READ);
@@ -419,6 +530,7 @@ void Cpu::fetchInst() {
 		printFetchedInstruction();
 #endif
 		m_stateStep = 0;
+		m_perfOpcode = m_instruction;
 		newState(CpuState::INST_EXEC);
 		break;
 	default:
@@ -551,7 +663,12 @@ void Cpu::execHardInterrupt() {
 		break;
 	case 1:
 		logDebug() << "setting IID\n";
-		m_regIID = m_ioBusInput & 0xFF;
+		if(m_ioDevice == nullptr) {
+			shared::panic("m_ioDevice == nullptr");
+		}
+
+		m_ioDevice->acknowledge();
+		m_regIID = m_ioDevice->io;
 		m_stateStep = 2;
 		break;
 	case 2:
@@ -585,8 +702,9 @@ void Cpu::execInterrupt() {
 		logDebug() << "entering interrupt vector\n";
 		m_regIP = m_addressBusInput;
 		m_regFL.ie = false;
+
+		/* back to the instruction fetch the interrupt was taken at */
 		finishState();
-		newState(CpuState::INST_FETCH);
 		break;
 	default:
 		shared::panic("invalid state: execInterrupt reached an invalid state step");
@@ -801,7 +919,7 @@ void Cpu::execInstAND() {
 void Cpu::execInstBIN() {
 	constexpr u8 STASH_OPERAND1 = 16;
 	constexpr u8 STASH_OPERAND2 = 20;
-	constexpr u8 READ_LOOP = 24;
+	constexpr u8 READ_LOOP = BLOCK_LOOP_STEP;
 	constexpr u8 STORE = 32;
 
 	switch(m_stateStep) {
@@ -827,7 +945,9 @@ void Cpu::execInstBIN() {
 		newState(CpuState::GIO_READ);
 		break;
 	case STORE:
-		m_stash1 += 2;
+		if(!m_ioDevice->streamPort(m_stash1)) {
+			m_stash1 += 2;
+		}
 		setRegister(REGISTER_AL, GET_LOW(m_regACL) - 1);
 		m_stateStep = (GET_LOW(m_regACL) == 0) ? EXEC_INST_STEP_INC_IP : READ_LOOP;
 
@@ -855,57 +975,138 @@ void Cpu::execInstBIN() {
 void Cpu::execInstBOT() {
 	constexpr u8 STASH_OPERAND1 = 16;
 	constexpr u8 STASH_OPERAND2 = 20;
-	constexpr u8 READ_LOOP = 24;
-	constexpr u8 STORE = 32;
+	constexpr u8 READ_LOOP = BLOCK_LOOP_STEP;
+	constexpr u8 WRITE = 32;
 
+	/* operand 1 is the first port, operand 2 the address of the first word
+	 * or a value written as it is */
 	switch(m_stateStep) {
-		GET_OPERAND_MOVE_TO_STASH(m_operand2, m_stash2, GET_OPERAND2, 0, STASH_OPERAND1)
+		GET_OPERAND_MOVE_TO_STASH(m_operand1, m_stash1, GET_OPERAND2, 0, STASH_OPERAND1)
 	GET_OPERAND2:
-		if(m_operand1.mode.indirect) {
-			m_addressBusAddress = m_operand1.mode.is_register
-									  ? getRegister((m_operand1.value & 0xFF00) >> 8)
-									  : m_operand1.value;
+		if(m_operand2.mode.indirect) {
+			m_addressBusAddress = m_operand2.mode.is_register
+									  ? getRegister((m_operand2.value & 0xFF00) >> 8)
+									  : m_operand2.value;
 			m_stateStep = STASH_OPERAND2;
 			newState(CpuState::ABUS_READ);
 			break;
 		}
-		m_stash2 = m_operand1.mode.is_register ? getRegister((m_operand1.value & 0xFF00) >> 8)
-											   : m_operand1.value;
+		m_stash2 = m_operand2.mode.is_register ? getRegister((m_operand2.value & 0xFF00) >> 8)
+											   : m_operand2.value;
 		goto READ_LOOP;
 	case STASH_OPERAND2:
 		m_stash2 = m_addressBusInput;
 	case READ_LOOP:
 	READ_LOOP:
-		m_addressBusAddress = m_stash1;
-		m_stateStep = STORE;
+		if(m_operand2.mode.immediate) {
+			m_addressBusInput = m_stash2;
+			goto WRITE;
+		}
+
+		m_addressBusAddress = m_stash2;
+		m_stash2 += 2;
+		m_stateStep = WRITE;
 		newState(CpuState::ABUS_READ);
 		break;
-	case STORE:
-		m_stash1 += 2;
+	case WRITE:
+	WRITE:
 		setRegister(REGISTER_AL, GET_LOW(m_regACL) - 1);
 		m_stateStep = (GET_LOW(m_regACL) == 0) ? EXEC_INST_STEP_INC_IP : READ_LOOP;
 
-		if(m_operand1.mode.immediate) {
-			if(!m_operand1.mode.is_register) {
-				shared::panic("invalid instruction");
-			}
-
-			logDebug() << "store value to register\n";
-			const u8 target = (m_operand1.value & 0xFF00) >> 8;
-			setRegister(target, m_addressBusInput);
-			break;
-		}
-
-		m_ioBusAddress = m_stash2;
-		m_stash2 += 2;
+		m_ioBusAddress = m_stash1;
 		m_ioBusOutput = m_addressBusInput;
-		newState(CpuState::ABUS_WRITE);
+		if(!m_ioDevice->streamPort(m_stash1)) {
+			m_stash1 += 2;
+		}
+		newState(CpuState::GIO_WRITE);
 		break;
 	default:
 		shared::panic("invalid state: execInstBOT reached an invalid state step");
 	}
 }
 
+u64 Cpu::blockTransfer(u64 limit) {
+	/* the cycles since the previous boundary show what one word costs, if
+	 * it was taken in the same instruction and exactly one word ago */
+	const u8 words_left = GET_LOW(m_regACL);
+	const bool measured = m_blockArmed && m_blockRetired == m_perf.retired &&
+						  m_blockWordsLeft == static_cast<u8>(words_left + 1);
+	const PerfCounters::OpcodeSpan start = m_blockStart;
+	const u64 period = m_perf.cycles - start.cycles;
+	m_blockArmed = true;
+	m_blockRetired = m_perf.retired;
+	m_blockWordsLeft = words_left;
+	m_blockStart = m_perf.opcodeSpan(m_perfOpcode);
+
+	if(!measured || period == 0 || limit <= m_perf.cycles) {
+		return 0;
+	}
+
+	/* operand 1 is the port and operand 2 the memory side for both */
+	const bool bin = m_instruction == OPCODE_BIN;
+	const Operand &memory_operand = m_operand2;
+	const u16 port = m_stash1;
+	const u16 address = m_stash2;
+
+	/* an immediate BIN target is a register, anything else panics, and the
+	 * words are counted in AL */
+	const u8 target = (memory_operand.value & 0xFF00) >> 8;
+	if(bin && memory_operand.mode.immediate &&
+	   (!memory_operand.mode.is_register || target == REGISTER_AL || target == REGISTER_ACL)) {
+		return 0;
+	}
+
+	const usize count = std::min<u64>(words_left, (limit - m_perf.cycles) / period);
+	if(count == 0 || !m_ioDevice->blockAccess(port, count) ||
+	   (!memory_operand.mode.immediate && !m_addressDevice->blockAccess(address, count))) {
+		return 0;
+	}
+
+	const bool stream = m_ioDevice->streamPort(port);
+	const u16 last_port = stream ? port : port + ((count - 1) * 2);
+	const u16 last_address = address + ((count - 1) * 2);
+	m_blockWords.resize(count);
+
+	if(bin) {
+		m_ioDevice->readBlock(port, m_blockWords.data(), count);
+		m_ioBusAddress = last_port;
+		m_ioBusInput = m_blockWords.back();
+
+		if(memory_operand.mode.immediate) {
+			setRegister(target, m_blockWords.back());
+		} else {
+			m_addressDevice->writeBlock(address, m_blockWords.data(), count);
+			m_addressBusAddress = last_address;
+			m_addressBusOutput = m_blockWords.back();
+			m_stash2 = last_address + 2;
+		}
+
+		m_stash1 = stream ? port : last_port + 2;
+	} else {
+		if(memory_operand.mode.immediate) {
+			std::fill(m_blockWords.begin(), m_blockWords.end(), m_stash2);
+		} else {
+			m_addressDevice->readBlock(address, m_blockWords.data(), count);
+			m_addressBusAddress = last_address;
+			m_stash2 = last_address + 2;
+		}
+
+		m_ioDevice->writeBlock(port, m_blockWords.data(), count);
+		m_addressBusInput = m_blockWords.back();
+		m_ioBusAddress = last_port;
+		m_ioBusOutput = m_blockWords.back();
+		m_stash1 = stream ? port : last_port + 2;
+	}
+
+	setRegister(REGISTER_AL, words_left - count);
+	m_stateStep = words_left == count ? EXEC_INST_STEP_INC_IP : BLOCK_LOOP_STEP;
+
+	m_perf.repeat(start, count);
+	m_blockWordsLeft = words_left - count;
+	m_blockStart = m_perf.opcodeSpan(m_perfOpcode);
+	return count * period;
+}
+
 void Cpu::execInstCALL() {
 	constexpr u8 MOVE_TO_STASH = 16;
 	constexpr u8 SET_NEW_IP = 32;
@@ -921,8 +1122,13 @@ void Cpu::execInstCALL() {
 		newState(CpuState::ABUS_WRITE);
 		break;
 	case SET_NEW_IP:
+		if(m_trace != nullptr) {
+			m_trace->call(m_regIP, m_stash1);
+		}
+
 		m_regIP = m_stash1;
 		finishState();
+		break;
 	default:
 		shared::panic("invalid state: execInstCALL reached an invalid state step");
 		break;
@@ -1066,8 +1272,24 @@ void Cpu::execInstINC() {
 /** @todo: implement */
 void Cpu::execInstINT() {}
 
-/** @todo: implement */
-void Cpu::execInstIRET() {}
+void Cpu::execInstIRET() {
+	switch(m_stateStep) {
+	case 0:
+		m_addressBusAddress = m_regSP;
+		m_stateStep = 1;
+		newState(CpuState::ABUS_READ);
+		break;
+	case 1:
+		m_regSP += 2;
+		m_regIP = m_addressBusInput;
+		m_regFL.ie = true;
+		m_regIID = 0;
+		finishState();
+		break;
+	default:
+		shared::panic("invalid state: execInstIRET reached an invalid state step");
+	}
+}
 
 void Cpu::execInstJMP() {
 	constexpr u8 MOVE_TO_STASH = 16;
@@ -1084,8 +1306,10 @@ void Cpu::execInstJMP() {
 	}
 }
 
-void Cpu::execInstJZ() {
-	if(!m_regFL.zf) {
+void Cpu::execConditionalJump(bool condition) {
+	m_coverage.markBranch(m_regIP, condition);
+
+	if(!condition) {
 		m_stateStep = EXEC_INST_STEP_INC_IP;
 		return;
 	}
@@ -1093,85 +1317,44 @@ void Cpu::execInstJZ() {
 	this->execInstJMP();
 }
 
-void Cpu::execInstJG() {
-	if(m_regFL.zf || (m_regFL.nf != m_regFL.of)) {
-		m_stateStep = EXEC_INST_STEP_INC_IP;
-		return;
-	}
+void Cpu::execInstJZ() {
+	execConditionalJump(m_regFL.zf);
+}
 
-	this->execInstJMP();
+void Cpu::execInstJG() {
+	execConditionalJump(!m_regFL.zf && m_regFL.nf == m_regFL.of);
 }
 
 void Cpu::execInstJGE() {
-	if(!(m_regFL.nf == m_regFL.of)) {
-		m_stateStep = EXEC_INST_STEP_INC_IP;
-		return;
-	}
-
-	this->execInstJMP();
+	execConditionalJump(m_regFL.nf == m_regFL.of);
 }
 
 void Cpu::execInstJL() {
-	if(m_regFL.nf == m_regFL.of) {
-		m_stateStep = EXEC_INST_STEP_INC_IP;
-		return;
-	}
-
-	this->execInstJMP();
+	execConditionalJump(m_regFL.nf != m_regFL.of);
 }
 
 void Cpu::execInstJLE() {
-	if(!m_regFL.zf && m_regFL.nf == m_regFL.of) {
-		m_stateStep = EXEC_INST_STEP_INC_IP;
-		return;
-	}
-
-	this->execInstJMP();
+	execConditionalJump(m_regFL.zf || m_regFL.nf != m_regFL.of);
 }
 
 void Cpu::execInstJC() {
-	if(!m_regFL.cf) {
-		m_stateStep = EXEC_INST_STEP_INC_IP;
-		return;
-	}
-
-	this->execInstJMP();
+	execConditionalJump(m_regFL.cf);
 }
 
 void Cpu::execInstJS() {
-	if(!m_regFL.nf) {
-		m_stateStep = EXEC_INST_STEP_INC_IP;
-		return;
-	}
-
-	this->execInstJMP();
+	execConditionalJump(m_regFL.nf);
 }
 
 void Cpu::execInstJNZ() {
-	if(m_regFL.zf) {
-		m_stateStep = EXEC_INST_STEP_INC_IP;
-		return;
-	}
-
-	this->execInstJMP();
+	execConditionalJump(!m_regFL.zf);
 }
 
 void Cpu::execInstJNC() {
-	if(m_regFL.cf) {
-		m_stateStep = EXEC_INST_STEP_INC_IP;
-		return;
-	}
-
-	this->execInstJMP();
+	execConditionalJump(!m_regFL.cf);
 }
 
 void Cpu::execInstJNS() {
-	if(m_regFL.nf) {
-		m_stateStep = EXEC_INST_STEP_INC_IP;
-		return;
-	}
-
-	this->execInstJMP();
+	execConditionalJump(!m_regFL.nf);
 }
 
 void Cpu::execInstLD() {
@@ -1385,6 +1568,10 @@ void Cpu::execInstRET() {
 		newState(CpuState::ABUS_READ);
 		break;
 	case 1:
+		if(m_trace != nullptr) {
+			m_trace->ret();
+		}
+
 		m_regSP += 2;
 		m_regIP = m_addressBusInput;
 		finishState();
@@ -1666,6 +1853,7 @@ void Cpu::newState(CpuState state) {
 	m_state.push(state);
 	m_stepStash.push(m_stateStep);
 	m_stateStep = 0;
+	m_fetchBoundary = state == CpuState::INST_FETCH;
 }
 
 void Cpu::finishState() {
@@ -1677,12 +1865,20 @@ void Cpu::finishState() {
 		}
 
 		m_state.push(CpuState::INST_FETCH);
+		m_fetchBoundary = true;
 		return;
 	}
 
+	if(m_state.top() == CpuState::INST_EXEC) {
+		m_perf.retired++;
+		m_perf.opcodes[m_instruction].retired++;
+		m_perfOpcode = PerfCounters::OPCODE_NONE;
+	}
+
 	m_stateStep = m_stepStash.top();
 	m_stepStash.pop();
 	m_state.pop();
+	m_fetchBoundary = m_stateStep == 0 && m_state.top() == CpuState::INST_FETCH;
 }
 
 void Cpu::printFetchedInstruction() const {
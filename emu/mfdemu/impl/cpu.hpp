@@ -18,6 +18,7 @@
 #ifndef MFDEMU_IMPL_CPU_HPP
 #define MFDEMU_IMPL_CPU_HPP
 
+#include <array>
 #include <memory>
 #include <stack>
 #include <vector>
@@ -25,6 +26,12 @@
 #include <shared/typedefs.hpp>
 
 #include <mfdemu/impl/bus/bus_device.hpp>
+#include <mfdemu/impl/coverage.hpp>
+#include <mfdemu/impl/debug/breakpoints.hpp>
+#include <mfdemu/impl/heatmap.hpp>
+#include <mfdemu/impl/instructions.hpp>
+#include <mfdemu/impl/perf_counters.hpp>
+#include <mfdemu/impl/trace.hpp>
 
 namespace mfdemu::impl {
 
@@ -77,11 +84,171 @@ class Cpu {
 	bool gms() const { return m_pinGMS; }
 	bool clk() const { return m_pinCLK; }
 	bool ira() const { return m_pinIRA; }
+	u16 ip() const { return m_regIP; }
 
 	void connectAddressDevice(std::shared_ptr<BaseBusDevice<u16>> device);
 
 	void connectIoDevice(std::shared_ptr<BaseBusDevice<u8>> device);
 
+	/**
+	 * @brief Return to the state after construction. Connected devices are
+	 * kept, the heatmap and trace are disabled again.
+	 */
+	void clear();
+
+	const PerfCounters &perfCounters() const { return m_perf; }
+	u64 cycles() const { return m_perf.cycles; }
+
+	const Coverage &coverage() const { return m_coverage; }
+
+	/**
+	 * @brief Start recording per-address memory accesses. The heatmap is not
+	 * allocated unless this is called.
+	 */
+	void enableHeatmap();
+	const MemoryHeatmap *heatmap() const { return m_heatmap.get(); }
+
+	/**
+	 * @brief Keep the last fetched instructions and a shadow call stack for
+	 * state dumps.
+	 */
+	void enableTrace();
+	const ExecutionTrace *trace() const { return m_trace.get(); }
+
+	/** debugging */
+
+	Breakpoints &breakpoints() { return m_breakpoints; }
+
+	/**
+	 * @brief True once a breakpoint or single step stopped the Cpu at an
+	 * instruction boundary. The Cpu must not be clocked again before resume()
+	 * or step() was called.
+	 */
+	bool stopped() const { return m_stopped; }
+	void resume();
+
+	/**
+	 * @brief Resume and stop again at the next instruction boundary.
+	 */
+	void step();
+
+	/**
+	 * @brief Enter the stopped state right away, the Cpu must be at an
+	 * instruction boundary.
+	 */
+	void stopAtBoundary() {
+		m_stepping = false;
+		m_stopped = true;
+	}
+
+	/**
+	 * @brief Leave the stopped state, unlike resume() a breakpoint at the
+	 * current instruction boundary is still checked.
+	 */
+	void cancelStop() {
+		m_stopped = false;
+		m_stepping = false;
+		m_breakpointResume = false;
+	}
+
+	/**
+	 * @brief Stop at the next instruction boundary.
+	 */
+	void requestStop() {
+		if(!m_stopped) {
+			m_stepping = true;
+		}
+	}
+
+	/** @brief Registers in a RegisterFile, the 8-bit halves are omitted. */
+	static constexpr std::array<u8, 9> REGISTER_FILE_IDS = {
+		REGISTER_ACL, REGISTER_BCL, REGISTER_CCL, REGISTER_DCL, REGISTER_SP,
+		REGISTER_IP,  REGISTER_AR,	REGISTER_FL,  REGISTER_IID,
+	};
+	using RegisterFile = std::array<u16, REGISTER_FILE_IDS.size()>;
+	RegisterFile registerFile() const;
+
+	/**
+	 * @brief Account the cycles since start as if they ran the given number of
+	 * times more. Used to skip idle loop iterations, the Cpu state must be the
+	 * same as at start.
+	 */
+	void fastForward(const PerfCounters &start, u64 iterations) {
+		m_perf.repeat(start, iterations);
+	}
+
+	/** @brief True between two words of a BIN or BOT, see blockTransfer(). */
+	bool inBlockLoop() const {
+		return m_stateStep == BLOCK_LOOP_STEP && m_state.top() == CpuState::INST_EXEC &&
+			   (m_instruction == OPCODE_BIN || m_instruction == OPCODE_BOT);
+	}
+
+	/**
+	 * @brief Called between cycles while inBlockLoop(). Once a word went over
+	 * the buses cycle by cycle, the remaining words of the instruction are
+	 * moved by one block transfer on each bus if both support it and the
+	 * cycles of those words do not pass limit. Counters, registers and stash
+	 * advance as if every word had been clocked through.
+	 * @return The number of cycles skipped.
+	 */
+	u64 blockTransfer(u64 limit);
+
+	u16 readRegister(u8 id) const { return getRegister(id); }
+	void writeRegister(u8 id, u16 value) { setRegister(id, value); }
+
+	bool atInstructionBoundary() const {
+		return m_stateStep == 0 && m_state.top() == CpuState::INST_FETCH;
+	}
+
+	/**
+	 * @brief Everything needed to resume execution from a given cycle. The
+	 * per-opcode counters, coverage, heatmap and breakpoints are not included.
+	 */
+	struct Context {
+		std::stack<CpuState, std::vector<CpuState>> state;
+		std::stack<u8> step_stash;
+		u8 state_step;
+
+		u16 instruction;
+		Operand operand1;
+		Operand operand2;
+
+		u16 address_bus_input;
+		u16 address_bus_output;
+		u16 address_bus_address;
+		u16 io_bus_input;
+		u16 io_bus_output;
+		u16 io_bus_address;
+		std::array<u16, 4> stash;
+
+		bool pin_ams;
+		bool pin_gms;
+		bool pin_clk;
+		bool pin_ira;
+
+		u16 reg_acl;
+		u16 reg_bcl;
+		u16 reg_ccl;
+		u16 reg_dcl;
+		u16 reg_sp;
+		u16 reg_ip;
+		u16 reg_ar;
+		CpuFlags reg_fl;
+		u16 reg_iid;
+
+		u8 perf_opcode;
+		u64 cycles;
+		u64 retired;
+		u64 abus_reads;
+		u64 abus_writes;
+		u64 gio_reads;
+		u64 gio_writes;
+		std::array<u64, PerfCounters::STATE_COUNT> state_cycles;
+	};
+
+	Context saveContext() const;
+	void restoreContext(const Context &context);
+
    protected:
 	/** general operations */
 
@@ -114,6 +281,12 @@ class Cpu {
 	void execInstINT();
 	void execInstIRET();
 	void execInstJMP();
+
+	/**
+	 * @brief Shared implementation of all conditional jumps, records the outcome
+	 * for coverage and jumps if the condition is met.
+	 */
+	void execConditionalJump(bool condition);
 	void execInstJZ();
 	void execInstJG();
 	void execInstJGE();
@@ -193,6 +366,12 @@ class Cpu {
 	std::stack<CpuState, std::vector<CpuState>> m_state;
 	std::stack<u8> m_stepStash;
 	u8 m_stateStep{0};
+	/** set while the next cycle starts an instruction fetch, the only place
+	 * breakpoints and single steps are checked */
+	bool m_fetchBoundary{false};
+
+	/** step of BIN and BOT at which the next word starts */
+	static constexpr u8 BLOCK_LOOP_STEP = 24;
 
 	u16 m_instruction{0};
 	Operand m_operand1;
@@ -239,6 +418,42 @@ class Cpu {
 	void setRegister(u8 target, u16 value);
 	u16 getRegister(u8 source) const;
 
+	/** performance counters
+	 *
+	 * m_perfOpcode is the opcode slot cycles and bus accesses are currently
+	 * accounted to. It is set when an instruction starts executing and reset
+	 * to PerfCounters::OPCODE_NONE once it retires.
+	 */
+	PerfCounters m_perf;
+	u8 m_perfOpcode{PerfCounters::OPCODE_NONE};
+
+	/** counters at the last word boundary of a BIN or BOT if m_blockArmed,
+	 * identified by the retired count and AL, and the words of a block
+	 * transfer */
+	bool m_blockArmed{false};
+	u64 m_blockRetired{0};
+	u8 m_blockWordsLeft{0};
+	PerfCounters::OpcodeSpan m_blockStart{};
+	std::vector<u16> m_blockWords;
+
+	/** executed addresses and conditional jump outcomes */
+	Coverage m_coverage;
+
+	/** per-address access counts, nullptr if disabled. m_heatmapFetch marks the
+	 * next AIO read as an instruction fetch. */
+	std::unique_ptr<MemoryHeatmap> m_heatmap;
+	bool m_heatmapFetch{false};
+
+	/** instruction trace and shadow call stack, nullptr if disabled */
+	std::unique_ptr<ExecutionTrace> m_trace;
+
+	/** breakpoints, m_breakpointResume skips the check at the instruction
+	 * boundary the Cpu was stopped at. */
+	Breakpoints m_breakpoints;
+	bool m_stopped{false};
+	bool m_stepping{false};
+	bool m_breakpointResume{false};
+
 	/** connected devices (for impl.) */
 	std::shared_ptr<BaseBusDevice<u16>> m_addressDevice;
 	std::shared_ptr<BaseBusDevice<u8>> m_ioDevice;
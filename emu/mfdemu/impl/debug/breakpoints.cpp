@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <utility>
+
+#include <mfdemu/impl/debug/breakpoints.hpp>
+
+namespace mfdemu::impl {
+
+void Breakpoints::set(u16 address, std::optional<Condition> condition) {
+	m_breakpoints[address] = {.condition = std::move(condition), .hits = 0};
+	m_bitmap[address >> 6] |= 1ULL << (address & 63);
+}
+
+bool Breakpoints::remove(u16 address) {
+	m_bitmap[address >> 6] &= ~(1ULL << (address & 63));
+	return m_breakpoints.erase(address) > 0;
+}
+
+void Breakpoints::clear() {
+	m_bitmap.fill(0);
+	m_breakpoints.clear();
+}
+
+bool Breakpoints::matches(u16 address, const Cpu &cpu) const {
+	const auto it = m_breakpoints.find(address);
+	if(it == m_breakpoints.end()) {
+		return false;
+	}
+
+	const Breakpoint &breakpoint = it->second;
+	return !breakpoint.condition.has_value() || breakpoint.condition->evaluate(cpu);
+}
+
+bool Breakpoints::shouldBreak(u16 address, const Cpu &cpu) {
+	if(!matches(address, cpu)) {
+		return false;
+	}
+
+	m_breakpoints[address].hits++;
+	return true;
+}
+
+}  // namespace mfdemu::impl
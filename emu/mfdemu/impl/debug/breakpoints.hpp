@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MFDEMU_IMPL_DEBUG_BREAKPOINTS_HPP
+#define MFDEMU_IMPL_DEBUG_BREAKPOINTS_HPP
+
+#include <array>
+#include <map>
+#include <optional>
+
+#include <shared/typedefs.hpp>
+
+#include <mfdemu/impl/debug/condition.hpp>
+
+namespace mfdemu::impl {
+
+class Cpu;
+
+struct Breakpoint {
+	std::optional<Condition> condition;
+	u64 hits{0};
+};
+
+/**
+ * @brief Execution breakpoints. The Cpu only tests one bit of the address
+ * bitmap per instruction, conditions are evaluated once that bit is set.
+ */
+class Breakpoints {
+   public:
+	bool test(u16 address) const { return ((m_bitmap[address >> 6] >> (address & 63)) & 1) != 0; }
+
+	/**
+	 * @brief Set a breakpoint, replacing any existing one at the same address.
+	 */
+	void set(u16 address, std::optional<Condition> condition);
+	bool remove(u16 address);
+	void clear();
+
+	/**
+	 * @brief Check if there is a breakpoint at address whose condition holds.
+	 */
+	bool matches(u16 address, const Cpu &cpu) const;
+
+	/**
+	 * @brief Check if the breakpoint at address should stop the Cpu and count
+	 * the hit if so.
+	 */
+	bool shouldBreak(u16 address, const Cpu &cpu);
+
+	const std::map<u16, Breakpoint> &list() const { return m_breakpoints; }
+
+   private:
+	std::array<u64, 0x10000 / 64> m_bitmap{};
+	std::map<u16, Breakpoint> m_breakpoints;
+};
+
+}  // namespace mfdemu::impl
+
+#endif
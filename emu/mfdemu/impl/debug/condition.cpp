@@ -0,0 +1,342 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <array>
+#include <cctype>
+#include <cstdlib>
+#include <string_view>
+#include <utility>
+
+#include <shared/log.hpp>
+#include <shared/panic.hpp>
+
+#include <mfdemu/impl/cpu.hpp>
+#include <mfdemu/impl/debug/condition.hpp>
+#include <mfdemu/impl/instructions.hpp>
+
+namespace mfdemu::impl {
+
+/** bit positions of the flags in the FL register */
+static constexpr std::array<std::pair<std::string_view, u8>, 6> FLAG_BITS = {{
+	{"of", 15},
+	{"cf", 14},
+	{"zf", 13},
+	{"nf", 12},
+	{"ie", 11},
+	{"rt", 10},
+}};
+
+namespace {
+
+/**
+ * @brief Recursive descent compiler, operator precedence follows C.
+ */
+class ConditionCompiler {
+   public:
+	explicit ConditionCompiler(const std::string &source) : m_source(source) {}
+
+	bool compile(std::vector<Condition::Instruction> &code) {
+		m_code = &code;
+		if(!parseOr()) {
+			return false;
+		}
+
+		skipSpace();
+		if(m_pos != m_source.size()) {
+			return error("unexpected \"" + m_source.substr(m_pos) + "\"");
+		}
+
+		return true;
+	}
+
+   private:
+	const std::string &m_source;
+	usize m_pos{0};
+	usize m_depth{0};
+	std::vector<Condition::Instruction> *m_code{nullptr};
+
+	bool error(const std::string &message) {
+		logError() << "invalid condition \"" << m_source << "\": " << message << "\n";
+		return false;
+	}
+
+	void skipSpace() {
+		while(m_pos < m_source.size() && std::isspace(m_source[m_pos]) != 0) {
+			m_pos++;
+		}
+	}
+
+	bool accept(std::string_view token) {
+		skipSpace();
+		if(m_source.compare(m_pos, token.size(), token) != 0) {
+			return false;
+		}
+
+		/* do not take "&" from "&&" or "<" from "<=" */
+		const usize next = m_pos + token.size();
+		if(token.size() == 1 && next < m_source.size()) {
+			const char following = m_source[next];
+			if(((token[0] == '&' || token[0] == '|') && following == token[0]) ||
+			   ((token[0] == '<' || token[0] == '>' || token[0] == '!') && following == '=')) {
+				return false;
+			}
+		}
+
+		m_pos = next;
+		return true;
+	}
+
+	bool emit(Condition::Op op, u16 arg, int depth_change) {
+		m_depth = static_cast<usize>(static_cast<int>(m_depth) + depth_change);
+		if(m_depth > Condition::MAX_STACK_DEPTH) {
+			return error("expression is nested too deeply");
+		}
+
+		m_code->push_back({.op = op, .arg = arg});
+		return true;
+	}
+
+	template <typename Next>
+	bool parseBinary(
+		Next next, std::initializer_list<std::pair<std::string_view, Condition::Op>> ops) {
+		if(!(this->*next)()) {
+			return false;
+		}
+
+		while(true) {
+			bool matched = false;
+			for(const auto &[token, op]: ops) {
+				if(!accept(token)) {
+					continue;
+				}
+
+				if(!(this->*next)() || !emit(op, 0, -1)) {
+					return false;
+				}
+
+				matched = true;
+				break;
+			}
+
+			if(!matched) {
+				return true;
+			}
+		}
+	}
+
+	bool parseOr() { return parseBinary(&ConditionCompiler::parseAnd, {{"||", Condition::Op::OR}}); }
+
+	bool parseAnd() {
+		return parseBinary(&ConditionCompiler::parseBitOr, {{"&&", Condition::Op::AND}});
+	}
+
+	bool parseBitOr() {
+		return parseBinary(&ConditionCompiler::parseBitXor, {{"|", Condition::Op::BIT_OR}});
+	}
+
+	bool parseBitXor() {
+		return parseBinary(&ConditionCompiler::parseBitAnd, {{"^", Condition::Op::BIT_XOR}});
+	}
+
+	bool parseBitAnd() {
+		return parseBinary(&ConditionCompiler::parseEquality, {{"&", Condition::Op::BIT_AND}});
+	}
+
+	bool parseEquality() {
+		return parseBinary(
+			&ConditionCompiler::parseRelational,
+			{{"==", Condition::Op::EQ}, {"!=", Condition::Op::NE}});
+	}
+
+	bool parseRelational() {
+		return parseBinary(
+			&ConditionCompiler::parseAdditive,
+			{{"<=", Condition::Op::LE},
+			 {">=", Condition::Op::GE},
+			 {"<", Condition::Op::LT},
+			 {">", Condition::Op::GT}});
+	}
+
+	bool parseAdditive() {
+		return parseBinary(
+			&ConditionCompiler::parseUnary, {{"+", Condition::Op::ADD}, {"-", Condition::Op::SUB}});
+	}
+
+	bool parseUnary() {
+		if(accept("!")) {
+			return parseUnary() && emit(Condition::Op::NOT, 0, 0);
+		}
+		if(accept("~")) {
+			return parseUnary() && emit(Condition::Op::BIT_NOT, 0, 0);
+		}
+		if(accept("-")) {
+			return parseUnary() && emit(Condition::Op::NEGATE, 0, 0);
+		}
+
+		return parsePrimary();
+	}
+
+	bool parsePrimary() {
+		if(accept("(")) {
+			if(!parseOr()) {
+				return false;
+			}
+
+			return accept(")") || error("expected \")\"");
+		}
+
+		skipSpace();
+		if(m_pos >= m_source.size()) {
+			return error("unexpected end of expression");
+		}
+
+		if(std::isdigit(m_source[m_pos]) != 0) {
+			const char *start = m_source.c_str() + m_pos;
+			char *end = nullptr;
+			const u64 value = std::strtoull(start, &end, 0);
+			if(value > UINT16_MAX) {
+				return error("literal does not fit into 16 bits");
+			}
+
+			m_pos += end - start;
+			return emit(Condition::Op::PUSH_CONST, value, 1);
+		}
+
+		const usize start = m_pos;
+		while(m_pos < m_source.size() &&
+			  (std::isalnum(m_source[m_pos]) != 0 || m_source[m_pos] == '.')) {
+			m_pos++;
+		}
+
+		const std::string name = m_source.substr(start, m_pos - start);
+		if(name.empty()) {
+			return error("unexpected \"" + m_source.substr(start) + "\"");
+		}
+
+		if(name.starts_with("fl.")) {
+			for(const auto &[flag, bit]: FLAG_BITS) {
+				if(name.substr(3) == flag) {
+					return emit(Condition::Op::PUSH_FLAG, bit, 1);
+				}
+			}
+
+			return error("unknown flag \"" + name + "\"");
+		}
+
+		for(usize ix = 0; ix < REGISTER_NAMES.size(); ix++) {
+			if(name == REGISTER_NAMES[ix]) {
+				return emit(Condition::Op::PUSH_REGISTER, ix, 1);
+			}
+		}
+
+		return error("unknown register \"" + name + "\"");
+	}
+};
+
+}  // namespace
+
+std::optional<Condition> Condition::compile(const std::string &source) {
+	Condition condition;
+	condition.m_source = source;
+
+	ConditionCompiler compiler(source);
+	if(!compiler.compile(condition.m_code)) {
+		return std::nullopt;
+	}
+
+	return condition;
+}
+
+bool Condition::evaluate(const Cpu &cpu) const {
+	std::array<u16, MAX_STACK_DEPTH> stack{};
+	usize top = 0;
+
+	for(const Instruction &instruction: m_code) {
+		switch(instruction.op) {
+		case Op::PUSH_CONST:
+			stack[top++] = instruction.arg;
+			continue;
+		case Op::PUSH_REGISTER:
+			stack[top++] = cpu.readRegister(instruction.arg);
+			continue;
+		case Op::PUSH_FLAG:
+			stack[top++] = (cpu.readRegister(REGISTER_FL) >> instruction.arg) & 1;
+			continue;
+		case Op::NOT:
+			stack[top - 1] = static_cast<u16>(stack[top - 1] == 0);
+			continue;
+		case Op::BIT_NOT:
+			stack[top - 1] = ~stack[top - 1];
+			continue;
+		case Op::NEGATE:
+			stack[top - 1] = -stack[top - 1];
+			continue;
+		default:
+			break;
+		}
+
+		const u16 rhs = stack[--top];
+		u16 &lhs = stack[top - 1];
+		switch(instruction.op) {
+		case Op::ADD:
+			lhs += rhs;
+			break;
+		case Op::SUB:
+			lhs -= rhs;
+			break;
+		case Op::BIT_AND:
+			lhs &= rhs;
+			break;
+		case Op::BIT_OR:
+			lhs |= rhs;
+			break;
+		case Op::BIT_XOR:
+			lhs ^= rhs;
+			break;
+		case Op::EQ:
+			lhs = static_cast<u16>(lhs == rhs);
+			break;
+		case Op::NE:
+			lhs = static_cast<u16>(lhs != rhs);
+			break;
+		case Op::LT:
+			lhs = static_cast<u16>(lhs < rhs);
+			break;
+		case Op::LE:
+			lhs = static_cast<u16>(lhs <= rhs);
+			break;
+		case Op::GT:
+			lhs = static_cast<u16>(lhs > rhs);
+			break;
+		case Op::GE:
+			lhs = static_cast<u16>(lhs >= rhs);
+			break;
+		case Op::AND:
+			lhs = static_cast<u16>(lhs != 0 && rhs != 0);
+			break;
+		case Op::OR:
+			lhs = static_cast<u16>(lhs != 0 || rhs != 0);
+			break;
+		default:
+			shared::panic("invalid condition opcode");
+		}
+	}
+
+	return top > 0 && stack[top - 1] != 0;
+}
+
+}  // namespace mfdemu::impl
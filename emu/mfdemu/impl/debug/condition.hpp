@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MFDEMU_IMPL_DEBUG_CONDITION_HPP
+#define MFDEMU_IMPL_DEBUG_CONDITION_HPP
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <shared/typedefs.hpp>
+
+namespace mfdemu::impl {
+
+class Cpu;
+
+/**
+ * @brief Breakpoint condition compiled into bytecode for a small stack machine.
+ *
+ * Conditions are C-like expressions over registers (acl, ah, sp, ...), flags
+ * (fl.of, fl.cf, fl.zf, fl.nf, fl.ie, fl.rt) and integer literals, e.g.
+ * "acl == 0x10 && fl.zf". All values are 16-bit, comparisons yield 0 or 1.
+ */
+class Condition {
+   public:
+	enum class Op : u8 {
+		PUSH_CONST,
+		PUSH_REGISTER,
+		PUSH_FLAG,
+		NOT,
+		BIT_NOT,
+		NEGATE,
+		ADD,
+		SUB,
+		BIT_AND,
+		BIT_OR,
+		BIT_XOR,
+		EQ,
+		NE,
+		LT,
+		LE,
+		GT,
+		GE,
+		AND,
+		OR,
+	};
+
+	struct Instruction {
+		Op op;
+		u16 arg;
+	};
+
+	static constexpr usize MAX_STACK_DEPTH = 16;
+
+	/**
+	 * @brief Compile the given expression, logs an error and returns
+	 * std::nullopt if it is malformed or too deeply nested.
+	 */
+	static std::optional<Condition> compile(const std::string &source);
+
+	bool evaluate(const Cpu &cpu) const;
+
+	const std::string &source() const { return m_source; }
+	const std::vector<Instruction> &code() const { return m_code; }
+
+   private:
+	std::string m_source;
+	std::vector<Instruction> m_code;
+};
+
+}  // namespace mfdemu::impl
+
+#endif
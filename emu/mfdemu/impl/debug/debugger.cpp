@@ -0,0 +1,502 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <utility>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <shared/log.hpp>
+
+#include <mfdemu/impl/debug/debugger.hpp>
+#include <mfdemu/impl/instructions.hpp>
+
+namespace mfdemu::impl {
+
+/** interval in ms in which blocking waits check for an abort */
+static constexpr int ABORT_CHECK_INTERVAL = 100;
+
+static std::optional<u16> parseValue(const std::string &str) {
+	char *end = nullptr;
+	const u64 value = std::strtoull(str.c_str(), &end, 0);
+	if(str.empty() || *end != '\0' || value > UINT16_MAX) {
+		return std::nullopt;
+	}
+
+	return value;
+}
+
+static std::optional<u8> parseRegister(const std::string &str) {
+	for(usize ix = 0; ix < REGISTER_NAMES.size(); ix++) {
+		if(str == REGISTER_NAMES[ix]) {
+			return ix;
+		}
+	}
+
+	return std::nullopt;
+}
+
+Debugger::Debugger(Cpu &cpu, const AioDevice &memory, Watchpoints &watchpoints)
+	: m_cpu(cpu), m_memory(memory), m_watchpoints(watchpoints) {}
+
+Debugger::~Debugger() {
+	if(m_clientFd >= 0) {
+		::close(m_clientFd);
+	}
+
+	if(m_listenFd >= 0) {
+		::close(m_listenFd);
+		::unlink(m_socketPath.c_str());
+	}
+}
+
+bool Debugger::openScript(const std::string &path) {
+	m_script.open(path, std::ios::in);
+	if(!m_script.is_open()) {
+		logError() << "could not open debugger script \"" << path << "\"\n";
+		return false;
+	}
+
+	return true;
+}
+
+bool Debugger::openSocket(const std::string &path) {
+	struct sockaddr_un addr{};
+	addr.sun_family = AF_UNIX;
+	if(path.size() >= sizeof(addr.sun_path)) {
+		logError() << "debugger socket path \"" << path << "\" is too long\n";
+		return false;
+	}
+
+	std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+	m_listenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+	if(m_listenFd < 0) {
+		logError() << "could not create debugger socket: " << std::strerror(errno) << "\n";
+		return false;
+	}
+
+	::unlink(path.c_str());
+	// NOLINTNEXTLINE
+	if(::bind(m_listenFd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) != 0 ||
+	   ::listen(m_listenFd, 1) != 0) {
+		logError() << "could not listen on \"" << path << "\": " << std::strerror(errno) << "\n";
+		::close(m_listenFd);
+		m_listenFd = -1;
+		return false;
+	}
+
+	m_socketPath = path;
+	logInfo() << "debugger listening on \"" << path << "\"\n";
+	return true;
+}
+
+void Debugger::setAbortCheck(std::function<bool()> check) {
+	m_abortCheck = std::move(check);
+}
+
+bool Debugger::attach() {
+	if(m_listenFd >= 0) {
+		return true;
+	}
+
+	return runCommands() != Action::QUIT;
+}
+
+void Debugger::setHistory(History *history) {
+	m_history = history;
+}
+
+bool Debugger::onStop() {
+	reportHits();
+	reportStop();
+	return runCommands() != Action::QUIT;
+}
+
+void Debugger::reportStop() {
+	std::ostringstream message;
+	message << "stopped at 0x" << std::hex << std::setfill('0') << std::setw(4) << m_cpu.ip()
+			<< std::dec << " (cycle " << m_cpu.cycles() << ")\n";
+	reply(message.str());
+}
+
+bool Debugger::poll() {
+	if(m_listenFd < 0) {
+		return true;
+	}
+
+	while(const std::optional<std::string> line = readLine(false)) {
+		if(execute(line.value()) == Action::QUIT) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+Debugger::Action Debugger::runCommands() {
+	while(true) {
+		const std::optional<std::string> line = readLine(true);
+		if(!line.has_value()) {
+			if(m_abortCheck && m_abortCheck()) {
+				return Action::QUIT;
+			}
+
+			/* end of script, keep reporting stops without further commands */
+			m_cpu.resume();
+			return Action::RESUME;
+		}
+
+		const Action action = execute(line.value());
+		if(action != Action::NONE) {
+			return action;
+		}
+	}
+}
+
+Debugger::Action Debugger::execute(const std::string &line) {
+	std::istringstream stream(line);
+	std::string command;
+	stream >> command;
+
+	if(command.empty() || command[0] == '#') {
+		return Action::NONE;
+	}
+
+	std::ostringstream out;
+	out << std::hex << std::setfill('0');
+
+	if(command == "break" || command == "b") {
+		std::string address_str;
+		std::string keyword;
+		stream >> address_str;
+
+		const std::optional<u16> address = parseValue(address_str);
+		if(!address.has_value()) {
+			reply("error: invalid address \"" + address_str + "\"\n");
+			return Action::NONE;
+		}
+
+		std::optional<Condition> condition;
+		if(stream >> keyword) {
+			std::string source;
+			std::getline(stream >> std::ws, source);
+			condition = Condition::compile(source);
+			if(keyword != "if" || !condition.has_value()) {
+				reply("error: invalid condition, expected \"if <condition>\"\n");
+				return Action::NONE;
+			}
+		}
+
+		m_cpu.breakpoints().set(address.value(), std::move(condition));
+	} else if(command == "delete" || command == "d") {
+		std::string address_str;
+		if(!(stream >> address_str)) {
+			m_cpu.breakpoints().clear();
+			return Action::NONE;
+		}
+
+		const std::optional<u16> address = parseValue(address_str);
+		if(!address.has_value() || !m_cpu.breakpoints().remove(address.value())) {
+			reply("error: no breakpoint at \"" + address_str + "\"\n");
+		}
+	} else if(command == "watch" || command == "w") {
+		std::string first_str;
+		std::string last_str;
+		std::string kinds_str;
+		std::string stop_str;
+		stream >> first_str >> last_str >> kinds_str >> stop_str;
+
+		const std::optional<u16> first = parseValue(first_str);
+		const std::optional<u16> last = parseValue(last_str);
+		u8 kinds = 0;
+		for(const char kind: kinds_str) {
+			kinds |= kind == 'r'   ? Watchpoints::READ
+					 : kind == 'w' ? Watchpoints::WRITE
+					 : kind == 'c' ? Watchpoints::CHANGE
+								   : 0xff;
+		}
+
+		if(!first.has_value() || !last.has_value() || kinds == 0 || kinds == 0xff ||
+		   (!stop_str.empty() && stop_str != "stop")) {
+			reply("error: usage: watch <first> <last> <r|w|c> [stop]\n");
+			return Action::NONE;
+		}
+
+		m_watchpoints.add(first.value(), last.value(), kinds, !stop_str.empty());
+	} else if(command == "unwatch") {
+		std::string first_str;
+		if(!(stream >> first_str)) {
+			m_watchpoints.clear();
+			return Action::NONE;
+		}
+
+		const std::optional<u16> first = parseValue(first_str);
+		if(!first.has_value() || !m_watchpoints.remove(first.value())) {
+			reply("error: no watchpoint at \"" + first_str + "\"\n");
+		}
+	} else if(command == "info") {
+		for(const auto &[address, breakpoint]: m_cpu.breakpoints().list()) {
+			out << "break 0x" << std::setw(4) << address << std::dec << " hits " << breakpoint.hits;
+			if(breakpoint.condition.has_value()) {
+				out << " if " << breakpoint.condition->source();
+			}
+			out << std::hex << "\n";
+		}
+
+		for(const Watchpoints::Watchpoint &watchpoint: m_watchpoints.list()) {
+			out << "watch 0x" << std::setw(4) << watchpoint.first << " 0x" << std::setw(4)
+				<< watchpoint.last << " "
+				<< ((watchpoint.kinds & Watchpoints::READ) != 0 ? "r" : "")
+				<< ((watchpoint.kinds & Watchpoints::WRITE) != 0 ? "w" : "")
+				<< ((watchpoint.kinds & Watchpoints::CHANGE) != 0 ? "c" : "")
+				<< (watchpoint.stop ? " stop" : "") << std::dec << " hits " << watchpoint.hits
+				<< std::hex << "\n";
+		}
+	} else if(command == "hits") {
+		m_reportedHits = 0;
+		reportHits();
+	} else if(command == "regs") {
+		for(const u8 reg: Cpu::REGISTER_FILE_IDS) {
+			out << REGISTER_NAMES[reg] << "=0x" << std::setw(4) << m_cpu.readRegister(reg)
+				<< (reg == Cpu::REGISTER_FILE_IDS.back() ? "\n" : " ");
+		}
+	} else if(command == "set") {
+		std::string reg_str;
+		std::string value_str;
+		stream >> reg_str >> value_str;
+
+		const std::optional<u8> reg = parseRegister(reg_str);
+		const std::optional<u16> value = parseValue(value_str);
+		if(!reg.has_value() || !value.has_value()) {
+			reply("error: usage: set <register> <value>\n");
+			return Action::NONE;
+		}
+
+		m_cpu.writeRegister(reg.value(), value.value());
+	} else if(command == "mem") {
+		constexpr u16 DEFAULT_WORDS = 8;
+		constexpr u16 WORDS_PER_LINE = 8;
+
+		std::string address_str;
+		std::string count_str;
+		stream >> address_str >> count_str;
+
+		const std::optional<u16> address = parseValue(address_str);
+		const std::optional<u16> count =
+			count_str.empty() ? DEFAULT_WORDS : parseValue(count_str);
+		if(!address.has_value() || !count.has_value()) {
+			reply("error: usage: mem <address> [<words>]\n");
+			return Action::NONE;
+		}
+
+		for(u32 ix = 0; ix < count.value(); ix++) {
+			const u32 word_address = address.value() + (ix * 2);
+			if(ix % WORDS_PER_LINE == 0) {
+				out << (ix == 0 ? "" : "\n") << "0x" << std::setw(4) << word_address << ":";
+			}
+
+			out << " " << std::setw(4) << m_memory.readWord(word_address);
+		}
+		out << "\n";
+	} else if(command == "step" || command == "s") {
+		m_cpu.step();
+		return Action::RESUME;
+	} else if(command == "continue" || command == "c") {
+		m_cpu.resume();
+		return Action::RESUME;
+	} else if(command == "back" || command == "rcontinue" || command == "rc" ||
+			  command == "rewind") {
+		if(m_history == nullptr) {
+			reply("error: history is not enabled\n");
+			return Action::NONE;
+		}
+
+		bool moved = false;
+		if(command == "back") {
+			moved = m_history->stepBack();
+		} else if(command == "rewind") {
+			std::string cycle_str;
+			stream >> cycle_str;
+
+			char *end = nullptr;
+			const u64 cycle = std::strtoull(cycle_str.c_str(), &end, 0);
+			if(cycle_str.empty() || *end != '\0') {
+				reply("error: invalid cycle \"" + cycle_str + "\"\n");
+				return Action::NONE;
+			}
+
+			moved = m_history->rewind(cycle);
+		} else {
+			moved = m_history->reverseContinue();
+		}
+
+		if(!moved) {
+			out << std::dec << "error: history only reaches back to cycle "
+				<< m_history->oldestCycle() << "\n";
+		} else {
+			reportStop();
+		}
+	} else if(command == "stop") {
+		m_cpu.requestStop();
+	} else if(command == "quit" || command == "q") {
+		return Action::QUIT;
+	} else {
+		out << "error: unknown command \"" << command << "\"\n";
+	}
+
+	reply(out.str());
+	return Action::NONE;
+}
+
+std::optional<std::string> Debugger::readLine(bool block) {
+	if(m_script.is_open()) {
+		std::string line;
+		if(!std::getline(m_script, line)) {
+			return std::nullopt;
+		}
+
+		return line;
+	}
+
+	if(m_listenFd < 0) {
+		return std::nullopt;
+	}
+
+	while(true) {
+		const usize newline = m_buffer.find('\n');
+		if(newline != std::string::npos) {
+			std::string line = m_buffer.substr(0, newline);
+			m_buffer.erase(0, newline + 1);
+			if(!line.empty() && line.back() == '\r') {
+				line.pop_back();
+			}
+
+			return line;
+		}
+
+		if(m_clientFd < 0) {
+			if(block && !waitReadable(m_listenFd)) {
+				return std::nullopt;
+			}
+
+			m_clientFd = ::accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK);
+			if(m_clientFd < 0) {
+				if(!block) {
+					return std::nullopt;
+				}
+				continue;
+			}
+		}
+
+		if(block && !waitReadable(m_clientFd)) {
+			return std::nullopt;
+		}
+
+		std::array<char, 256> chunk{};
+		const ssize_t count = ::read(m_clientFd, chunk.data(), chunk.size());
+		if(count > 0) {
+			m_buffer.append(chunk.data(), count);
+			continue;
+		}
+
+		if(count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			if(!block) {
+				return std::nullopt;
+			}
+			continue;
+		}
+
+		/* client disconnected, a new one may connect */
+		::close(m_clientFd);
+		m_clientFd = -1;
+		m_buffer.clear();
+		if(!block) {
+			return std::nullopt;
+		}
+	}
+}
+
+bool Debugger::waitReadable(int fd) {
+	while(true) {
+		struct pollfd pfd{.fd = fd, .events = POLLIN, .revents = 0};
+		if(::poll(&pfd, 1, ABORT_CHECK_INTERVAL) > 0) {
+			return true;
+		}
+
+		if(m_abortCheck && m_abortCheck()) {
+			return false;
+		}
+	}
+}
+
+void Debugger::reportHits() {
+	const std::vector<Watchpoints::Hit> history = m_watchpoints.history();
+	const u64 first_in_history = m_watchpoints.hitCount() - history.size();
+
+	std::ostringstream out;
+	out << std::setfill('0');
+	for(u64 ix = std::max(m_reportedHits, first_in_history); ix < m_watchpoints.hitCount(); ix++) {
+		const Watchpoints::Hit &hit = history[ix - first_in_history];
+		out << std::dec << "cycle " << hit.cycle << std::hex << " ip 0x" << std::setw(4) << hit.ip
+			<< (hit.kind == Watchpoints::READ	 ? " read "
+				: hit.kind == Watchpoints::WRITE ? " write "
+												 : " change ")
+			<< "0x" << std::setw(4) << hit.address << " 0x" << std::setw(4) << hit.old_value
+			<< " -> 0x" << std::setw(4) << hit.new_value << "\n";
+	}
+
+	m_reportedHits = m_watchpoints.hitCount();
+	reply(out.str());
+}
+
+void Debugger::reply(const std::string &text) {
+	if(text.empty()) {
+		return;
+	}
+
+	if(m_clientFd < 0) {
+		std::cerr << text;
+		return;
+	}
+
+	usize written = 0;
+	while(written < text.size()) {
+		const ssize_t count =
+			::send(m_clientFd, text.data() + written, text.size() - written, MSG_NOSIGNAL);
+		if(count <= 0) {
+			if(count < 0 && (errno == EAGAIN || errno == EINTR)) {
+				continue;
+			}
+			return;
+		}
+
+		written += count;
+	}
+}
+
+}  // namespace mfdemu::impl
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MFDEMU_IMPL_DEBUG_DEBUGGER_HPP
+#define MFDEMU_IMPL_DEBUG_DEBUGGER_HPP
+
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <string>
+
+#include <shared/typedefs.hpp>
+
+#include <mfdemu/impl/bus/aio_device.hpp>
+#include <mfdemu/impl/cpu.hpp>
+#include <mfdemu/impl/debug/history.hpp>
+#include <mfdemu/impl/debug/watchpoints.hpp>
+
+namespace mfdemu::impl {
+
+/**
+ * @brief Line based command interface to breakpoints and watchpoints, fed either by
+ * a script file or by clients of a local unix socket. Watchpoint hits are
+ * reported whenever the Cpu stops.
+ *
+ * Commands:
+ *   break <address> [if <condition>]      set a (conditional) breakpoint
+ *   delete [<address>]                    remove one or all breakpoints
+ *   watch <first> <last> <r|w|c> [stop]   watch reads, writes or value changes
+ *   unwatch [<first>]                     remove one or all watchpoints
+ *   info                                  list breakpoints and watchpoints
+ *   hits                                  print the recent watchpoint hits
+ *   regs                                  print all registers
+ *   set <register> <value>                write a register
+ *   mem <address> [<words>]               print memory
+ *   step                                  execute a single instruction
+ *   continue                              resume execution
+ *   back                                  go back one instruction
+ *   rcontinue                             go back to the last breakpoint hit
+ *   rewind <cycle>                        go back to the given cycle
+ *   stop                                  stop at the next instruction (socket only)
+ *   quit                                  end emulation
+ */
+class Debugger {
+   public:
+	Debugger(Cpu &cpu, const AioDevice &memory, Watchpoints &watchpoints);
+	~Debugger();
+
+	Debugger(const Debugger &) = delete;
+	Debugger &operator=(const Debugger &) = delete;
+
+	bool openScript(const std::string &path);
+	bool openSocket(const std::string &path);
+
+	/**
+	 * @brief Blocking waits give up once this returns true.
+	 */
+	void setAbortCheck(std::function<bool()> check);
+
+	/**
+	 * @brief Enables the reverse execution commands, may be nullptr.
+	 */
+	void setHistory(History *history);
+
+	/**
+	 * @brief Run the commands preceding the first "continue" of a script. A
+	 * socket does not block, clients may connect at any time.
+	 * @return false if the emulation should end.
+	 */
+	bool attach();
+
+	/**
+	 * @brief Report the stop and handle commands until the Cpu should resume.
+	 * At the end of a script all breakpoints are removed and the Cpu resumes.
+	 * @return false if the emulation should end.
+	 */
+	bool onStop();
+
+	/**
+	 * @brief Handle pending socket commands without blocking.
+	 * @return false if the emulation should end.
+	 */
+	bool poll();
+
+   private:
+	enum class Action : u8 {
+		NONE,
+		RESUME,
+		QUIT,
+	};
+
+	Action execute(const std::string &line);
+	void reportStop();
+	Action runCommands();
+
+	std::optional<std::string> readLine(bool block);
+	bool waitReadable(int fd);
+	void reply(const std::string &text);
+	void reportHits();
+
+	Cpu &m_cpu;
+	const AioDevice &m_memory;
+	Watchpoints &m_watchpoints;
+	History *m_history{nullptr};
+	u64 m_reportedHits{0};
+	std::function<bool()> m_abortCheck;
+
+	std::ifstream m_script;
+	bool m_scriptDone{false};
+
+	std::string m_socketPath;
+	int m_listenFd{-1};
+	int m_clientFd{-1};
+	std::string m_buffer;
+};
+
+}  // namespace mfdemu::impl
+
+#endif
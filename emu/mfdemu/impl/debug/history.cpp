@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include <shared/log.hpp>
+
+#include <mfdemu/impl/debug/history.hpp>
+
+namespace mfdemu::impl {
+
+History::History(Cpu &cpu, AioDevice &memory, u64 interval, usize capacity)
+	: m_cpu(cpu), m_memory(memory), m_interval(std::max<u64>(interval, 1)),
+	  m_capacity(std::max<usize>(capacity, 1)) {}
+
+void History::takeSnapshot() {
+	const AioDevice::PageSet dirty = m_memory.takeDirtyPages();
+
+	Snapshot snapshot{.context = m_cpu.saveContext(), .pages = {}};
+	if(m_snapshots.empty()) {
+		m_base = m_memory.data();
+	} else {
+		for(usize page = 0; page < dirty.size(); page++) {
+			if(!dirty.test(page) || page * AioDevice::PAGE_SIZE >= m_memory.size()) {
+				continue;
+			}
+
+			snapshot.pages.push_back({.page = static_cast<u8>(page), .data = m_memory.page(page)});
+		}
+	}
+
+	m_snapshots.push_back(std::move(snapshot));
+	m_nextSnapshot = m_cpu.cycles() + m_interval;
+
+	if(m_snapshots.size() <= m_capacity) {
+		return;
+	}
+
+	/* fold the delta of the second oldest snapshot into the base */
+	for(const PageDelta &delta: m_snapshots[1].pages) {
+		const usize offset = delta.page * AioDevice::PAGE_SIZE;
+		std::copy_n(
+			delta.data.begin(), std::min(AioDevice::PAGE_SIZE, m_base.size() - offset),
+			m_base.begin() + offset);
+	}
+
+	m_snapshots[1].pages.clear();
+	m_snapshots.pop_front();
+
+	const u64 oldest = m_snapshots.front().context.cycles;
+	while(!m_gioReads.empty() && m_gioReads.front().cycle <= oldest) {
+		m_gioReads.pop_front();
+	}
+	m_gioCursor = m_gioReads.size();
+
+	/* the change in effect at the oldest snapshot is still needed */
+	while(m_irqChanges.size() > 1 && m_irqChanges[1].cycle <= oldest + 1) {
+		m_irqChanges.pop_front();
+	}
+}
+
+void History::logGioRead(u8 value) {
+	m_gioReads.push_back({.cycle = m_cpu.cycles(), .value = value});
+	m_gioCursor = m_gioReads.size();
+}
+
+u8 History::gioRead() {
+	if(m_gioCursor >= m_gioReads.size()) {
+		logError() << "no logged GIO read for cycle " << m_cpu.cycles() << "\n";
+		return 0;
+	}
+
+	return m_gioReads[m_gioCursor++].value;
+}
+
+bool History::irq(bool pending) {
+	const u64 cycle = m_cpu.cycles() + 1;
+	if(cycle <= m_frontier) {
+		return loggedIrq(cycle);
+	}
+
+	const bool logged = !m_irqChanges.empty() && m_irqChanges.back().level;
+	if(pending != logged) {
+		m_irqChanges.push_back({.cycle = cycle, .level = pending});
+	}
+
+	return pending;
+}
+
+bool History::loggedIrq(u64 cycle) const {
+	const auto next = std::partition_point(
+		m_irqChanges.begin(), m_irqChanges.end(),
+		[cycle](const IrqChange &change) { return change.cycle <= cycle; });
+	return next != m_irqChanges.begin() && std::prev(next)->level;
+}
+
+u64 History::oldestCycle() const {
+	return m_snapshots.empty() ? 0 : m_snapshots.front().context.cycles;
+}
+
+usize History::pageMemory() const {
+	usize pages = 0;
+	for(const Snapshot &snapshot: m_snapshots) {
+		pages += snapshot.pages.size();
+	}
+
+	return (pages * sizeof(PageDelta)) + m_base.size();
+}
+
+void History::restore(usize index) {
+	std::vector<u8> image = m_base;
+	for(usize ix = 1; ix <= index; ix++) {
+		for(const PageDelta &delta: m_snapshots[ix].pages) {
+			const usize offset = delta.page * AioDevice::PAGE_SIZE;
+			std::copy_n(
+				delta.data.begin(), std::min(AioDevice::PAGE_SIZE, image.size() - offset),
+				image.begin() + offset);
+		}
+	}
+
+	m_memory.setData(std::move(image));
+	m_cpu.restoreContext(m_snapshots[index].context);
+
+	const u64 cycle = m_cpu.cycles();
+	m_gioCursor = std::partition_point(
+					  m_gioReads.begin(), m_gioReads.end(),
+					  [cycle](const GioRead &read) { return read.cycle <= cycle; }) -
+				  m_gioReads.begin();
+}
+
+void History::runTo(u64 cycle, const std::function<void()> &on_boundary) {
+	while(m_cpu.cycles() < cycle) {
+		if(on_boundary && m_cpu.atInstructionBoundary()) {
+			on_boundary();
+		}
+
+		m_cpu.irq = loggedIrq(m_cpu.cycles() + 1);
+		m_cpu.iclck();
+
+		/* stop requests of watchpoints */
+		if(m_cpu.stopped()) {
+			m_cpu.resume();
+		}
+	}
+}
+
+void History::goTo(u64 cycle) {
+	/* newest snapshot at or before cycle */
+	usize index = 0;
+	while(index + 1 < m_snapshots.size() && m_snapshots[index + 1].context.cycles <= cycle) {
+		index++;
+	}
+
+	restore(index);
+	runTo(cycle, {});
+}
+
+std::optional<u64>
+History::findLastBoundary(u64 before, const std::function<bool()> &predicate) {
+	usize index = 0;
+	while(index + 1 < m_snapshots.size() && m_snapshots[index + 1].context.cycles < before) {
+		index++;
+	}
+
+	u64 limit = before;
+	while(true) {
+		std::optional<u64> found;
+
+		restore(index);
+		runTo(limit, [this, &found, &predicate]() {
+			if(predicate()) {
+				found = m_cpu.cycles();
+			}
+		});
+
+		if(found.has_value()) {
+			return found;
+		}
+
+		if(index == 0) {
+			return std::nullopt;
+		}
+
+		limit = m_snapshots[index].context.cycles;
+		index--;
+	}
+}
+
+bool History::travel(const Search &search, u64 fallback) {
+	if(m_snapshots.empty()) {
+		return false;
+	}
+
+	/* breakpoints must not stop the re-execution */
+	Breakpoints breakpoints;
+	std::swap(breakpoints, m_cpu.breakpoints());
+	m_cpu.resume();
+
+	const std::optional<u64> target = search(breakpoints);
+	goTo(target.value_or(fallback));
+
+	std::swap(breakpoints, m_cpu.breakpoints());
+	m_cpu.stopAtBoundary();
+	return target.has_value();
+}
+
+bool History::stepBack() {
+	const u64 current = m_cpu.cycles();
+	return travel(
+		[this, current](const Breakpoints &) {
+			return findLastBoundary(current, [] { return true; });
+		},
+		current);
+}
+
+bool History::reverseContinue() {
+	const u64 current = m_cpu.cycles();
+	return travel(
+		[this, current](const Breakpoints &breakpoints) {
+			return findLastBoundary(current, [this, &breakpoints] {
+				return breakpoints.test(m_cpu.ip()) && breakpoints.matches(m_cpu.ip(), m_cpu);
+			});
+		},
+		oldestCycle());
+}
+
+bool History::rewind(u64 cycle) {
+	if(cycle >= m_cpu.cycles()) {
+		return false;
+	}
+
+	return travel(
+		[this, cycle](const Breakpoints &) {
+			return findLastBoundary(cycle + 1, [] { return true; });
+		},
+		oldestCycle());
+}
+
+}  // namespace mfdemu::impl
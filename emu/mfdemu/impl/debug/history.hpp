@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MFDEMU_IMPL_DEBUG_HISTORY_HPP
+#define MFDEMU_IMPL_DEBUG_HISTORY_HPP
+
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include <shared/typedefs.hpp>
+
+#include <mfdemu/impl/bus/aio_device.hpp>
+#include <mfdemu/impl/cpu.hpp>
+
+namespace mfdemu::impl {
+
+/**
+ * @brief Execution history for reverse debugging. Snapshots of the Cpu context
+ * and of the memory pages written since the previous snapshot are taken at the
+ * first instruction boundary every interval cycles and kept in a bounded ring.
+ * Going back restores the nearest older snapshot and re-executes forward.
+ *
+ * GIO reads and changes of the IRQ level are logged so that re-executed cycles
+ * see the same inputs, devices are neither read nor written while re-executing.
+ * Device state other than main memory is not rewound.
+ */
+class History {
+   public:
+	History(Cpu &cpu, AioDevice &memory, u64 interval, usize capacity);
+
+	/**
+	 * @brief Called after every cycle.
+	 */
+	void tick() {
+		/* snapshots of re-executed cycles already exist */
+		if(m_cpu.cycles() <= m_frontier && !m_snapshots.empty()) {
+			return;
+		}
+
+		m_frontier = m_cpu.cycles();
+		if(m_cpu.cycles() >= m_nextSnapshot && m_cpu.atInstructionBoundary()) {
+			takeSnapshot();
+		}
+	}
+
+	/**
+	 * @brief True during cycles which already ran before.
+	 */
+	bool reexecuting() const { return m_cpu.cycles() <= m_frontier; }
+
+	/** @brief Log a value read from a GIO device. */
+	void logGioRead(u8 value);
+
+	/** @brief The logged value for a GIO read while re-executing. */
+	u8 gioRead();
+
+	/**
+	 * @brief The IRQ level for the next cycle: the logged one if the cycle ran
+	 * before, otherwise pending, which is logged.
+	 */
+	bool irq(bool pending);
+
+	/**
+	 * @brief Go back to the previous instruction boundary. The Cpu is left
+	 * stopped.
+	 */
+	bool stepBack();
+
+	/**
+	 * @brief Go back to the last breakpoint hit, or to the oldest snapshot if
+	 * there is none. The Cpu is left stopped.
+	 */
+	bool reverseContinue();
+
+	/**
+	 * @brief Go to the last instruction boundary at or before cycle. The Cpu is
+	 * left stopped.
+	 */
+	bool rewind(u64 cycle);
+
+	u64 oldestCycle() const;
+	usize snapshotCount() const { return m_snapshots.size(); }
+
+	/** @brief Memory used by snapshot page copies, in bytes. */
+	usize pageMemory() const;
+
+   private:
+	struct PageDelta {
+		u8 page;
+		std::array<u8, AioDevice::PAGE_SIZE> data;
+	};
+
+	/** memory deltas hold the pages written since the previous snapshot */
+	struct Snapshot {
+		Cpu::Context context;
+		std::vector<PageDelta> pages;
+	};
+
+	struct GioRead {
+		u64 cycle;
+		u8 value;
+	};
+
+	struct IrqChange {
+		u64 cycle;
+		bool level;
+	};
+
+	using Search = std::function<std::optional<u64>(const Breakpoints &breakpoints)>;
+
+	void takeSnapshot();
+	bool loggedIrq(u64 cycle) const;
+	void restore(usize index);
+	void runTo(u64 cycle, const std::function<void()> &on_boundary);
+	void goTo(u64 cycle);
+	std::optional<u64> findLastBoundary(u64 before, const std::function<bool()> &predicate);
+	bool travel(const Search &search, u64 fallback);
+
+	Cpu &m_cpu;
+	AioDevice &m_memory;
+	u64 m_interval;
+	usize m_capacity;
+
+	std::deque<Snapshot> m_snapshots;
+	std::vector<u8> m_base;
+	u64 m_nextSnapshot{0};
+	u64 m_frontier{0};
+
+	std::deque<GioRead> m_gioReads;
+	usize m_gioCursor{0};
+
+	/** IRQ levels from the cycle they were first seen at, the line starts low */
+	std::deque<IrqChange> m_irqChanges;
+};
+
+}  // namespace mfdemu::impl
+
+#endif
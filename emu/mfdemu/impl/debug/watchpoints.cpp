@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include <mfdemu/impl/cpu.hpp>
+#include <mfdemu/impl/debug/watchpoints.hpp>
+
+namespace mfdemu::impl {
+
+void Watchpoints::add(u16 first, u16 last, u8 kinds, bool stop) {
+	remove(first);
+	m_watchpoints.push_back(
+		{.first = first, .last = std::max(first, last), .kinds = kinds, .stop = stop, .hits = 0});
+	updatePages();
+}
+
+bool Watchpoints::remove(u16 first) {
+	const auto it = std::find_if(
+		m_watchpoints.begin(), m_watchpoints.end(),
+		[first](const Watchpoint &watchpoint) { return watchpoint.first == first; });
+	if(it == m_watchpoints.end()) {
+		return false;
+	}
+
+	m_watchpoints.erase(it);
+	updatePages();
+	return true;
+}
+
+void Watchpoints::clear() {
+	m_watchpoints.clear();
+	updatePages();
+}
+
+void Watchpoints::updatePages() {
+	m_watchedPages.fill(false);
+
+	for(const Watchpoint &watchpoint: m_watchpoints) {
+		/* a word access at the end of the previous page overlaps the range too */
+		const usize first_page = (std::max<usize>(watchpoint.first, 1) - 1) / PAGE_SIZE;
+		for(usize page = first_page; page <= watchpoint.last / PAGE_SIZE; page++) {
+			m_watchedPages[page] = true;
+		}
+	}
+}
+
+void Watchpoints::access(u16 address, bool write, u16 old_value, u16 new_value) {
+	const u32 end = static_cast<u32>(address) + 1;
+	const Kind kind = !write ? READ : (old_value != new_value ? CHANGE : WRITE);
+
+	for(Watchpoint &watchpoint: m_watchpoints) {
+		if(end < watchpoint.first || address > watchpoint.last) {
+			continue;
+		}
+
+		/* a write which changes the value satisfies both WRITE and CHANGE */
+		const u8 matching = kind == CHANGE ? (WRITE | CHANGE) : kind;
+		if((watchpoint.kinds & matching) == 0) {
+			continue;
+		}
+
+		watchpoint.hits++;
+		m_history[m_hitCount % HISTORY_SIZE] = {
+			.cycle = m_cpu != nullptr ? m_cpu->cycles() : 0,
+			.ip = m_cpu != nullptr ? m_cpu->ip() : static_cast<u16>(0),
+			.address = address,
+			.old_value = old_value,
+			.new_value = new_value,
+			.kind = kind,
+		};
+		m_hitCount++;
+
+		if(watchpoint.stop && m_cpu != nullptr) {
+			m_cpu->requestStop();
+		}
+	}
+}
+
+std::vector<Watchpoints::Hit> Watchpoints::history() const {
+	const usize count = std::min<u64>(m_hitCount, HISTORY_SIZE);
+
+	std::vector<Hit> hits;
+	hits.reserve(count);
+	for(u64 ix = m_hitCount - count; ix < m_hitCount; ix++) {
+		hits.push_back(m_history[ix % HISTORY_SIZE]);
+	}
+
+	return hits;
+}
+
+}  // namespace mfdemu::impl
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MFDEMU_IMPL_DEBUG_WATCHPOINTS_HPP
+#define MFDEMU_IMPL_DEBUG_WATCHPOINTS_HPP
+
+#include <array>
+#include <vector>
+
+#include <shared/typedefs.hpp>
+
+namespace mfdemu::impl {
+
+class Cpu;
+
+/**
+ * @brief Data watchpoints on address ranges. Memory devices only consult the
+ * ranges for accesses to pages which contain a watched address.
+ */
+class Watchpoints {
+   public:
+	enum Kind : u8 {
+		READ = 1,
+		WRITE = 2,
+		CHANGE = 4,
+	};
+
+	struct Watchpoint {
+		u16 first;
+		u16 last;
+		u8 kinds;
+		bool stop;
+		u64 hits;
+	};
+
+	struct Hit {
+		u64 cycle;
+		u16 ip;
+		u16 address;
+		u16 old_value;
+		u16 new_value;
+		Kind kind;
+	};
+
+	static constexpr usize PAGE_SIZE = 0x100;
+	static constexpr usize HISTORY_SIZE = 256;
+
+	/**
+	 * @brief Hits record the IP and cycle of this Cpu, watchpoints with stop set
+	 * make it stop at the next instruction boundary.
+	 */
+	void attach(Cpu &cpu) { m_cpu = &cpu; }
+
+	/**
+	 * @brief Watch the range first..last for the given combination of Kind
+	 * values, replacing any watchpoint starting at the same address.
+	 */
+	void add(u16 first, u16 last, u8 kinds, bool stop);
+	bool remove(u16 first);
+	void clear();
+
+	/**
+	 * @brief Check if an access to the word at address may hit a watchpoint.
+	 */
+	bool watched(u16 address) const { return m_watchedPages[address / PAGE_SIZE]; }
+
+	/**
+	 * @brief Slow path for accesses to watched pages.
+	 */
+	void access(u16 address, bool write, u16 old_value, u16 new_value);
+
+	const std::vector<Watchpoint> &list() const { return m_watchpoints; }
+
+	/** @brief Number of hits recorded since the start. */
+	u64 hitCount() const { return m_hitCount; }
+
+	/**
+	 * @brief The most recent hits, oldest first.
+	 */
+	std::vector<Hit> history() const;
+
+   private:
+	void updatePages();
+
+	Cpu *m_cpu{nullptr};
+	std::array<bool, 0x10000 / PAGE_SIZE> m_watchedPages{};
+	std::vector<Watchpoint> m_watchpoints;
+
+	std::array<Hit, HISTORY_SIZE> m_history{};
+	u64 m_hitCount{0};
+};
+
+}  // namespace mfdemu::impl
+
+#endif
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <mfdemu/impl/devices/dma.hpp>
+
+namespace mfdemu::impl {
+
+DmaDevice::DmaDevice(
+	u16 base, AioDevice &memory, EventScheduler &scheduler, const PerfCounters &counters,
+	u64 cycles_per_word)
+	: TransferDevice(base, scheduler, counters),
+	  m_memory(memory),
+	  m_cyclesPerWord(cycles_per_word) {}
+
+std::optional<u64> DmaDevice::begin(u16 command) {
+	if(command != COMMAND_COPY && command != COMMAND_FILL) {
+		return std::nullopt;
+	}
+
+	m_command = command;
+	m_transferSource = m_source;
+	m_transferDestination = m_destination;
+	m_transferLength = m_length;
+	m_transferFill = m_fill;
+
+	const u64 words = (static_cast<u64>(m_length) + 1) / 2;
+	return words * m_cyclesPerWord;
+}
+
+u16 DmaDevice::finish() {
+	m_buffer.resize(m_transferLength);
+	if(m_command == COMMAND_COPY) {
+		m_memory.dmaRead(m_transferSource, m_buffer.data(), m_buffer.size());
+	} else {
+		for(usize ix = 0; ix < m_buffer.size(); ix++) {
+			m_buffer[ix] = ix % 2 == 0 ? m_transferFill >> 8 : m_transferFill & 0xFF;
+		}
+	}
+	m_memory.dmaWrite(m_transferDestination, m_buffer.data(), m_buffer.size());
+
+	return 0;
+}
+
+void DmaDevice::writeRegister(u16 offset, u16 value) {
+	switch(offset) {
+	case PORT_SOURCE:
+		m_source = value;
+		break;
+	case PORT_DESTINATION:
+		m_destination = value;
+		break;
+	case PORT_LENGTH:
+		m_length = value;
+		break;
+	case PORT_FILL:
+		m_fill = value;
+		break;
+	case PORT_COMMAND:
+		command(value);
+		break;
+	default:
+		break;
+	}
+}
+
+u16 DmaDevice::readRegister(u16 offset) {
+	switch(offset) {
+	case PORT_SOURCE:
+		return m_source;
+	case PORT_DESTINATION:
+		return m_destination;
+	case PORT_LENGTH:
+		return m_length;
+	case PORT_FILL:
+		return m_fill;
+	case PORT_COMMAND:
+		return status();
+	default:
+		return 0;
+	}
+}
+
+}  // namespace mfdemu::impl
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MFDEMU_IMPL_DEVICES_DMA_HPP
+#define MFDEMU_IMPL_DEVICES_DMA_HPP
+
+#include <optional>
+#include <vector>
+
+#include <shared/typedefs.hpp>
+
+#include <mfdemu/impl/bus/aio_device.hpp>
+#include <mfdemu/impl/devices/transfer.hpp>
+#include <mfdemu/impl/perf_counters.hpp>
+#include <mfdemu/impl/scheduler.hpp>
+
+namespace mfdemu::impl {
+
+/**
+ * @brief Memory to memory DMA controller. All registers are word-sized ports:
+ *
+ *   base + 0x00: source address
+ *   base + 0x02: destination address
+ *   base + 0x04: length in bytes
+ *   base + 0x06: fill word
+ *   base + 0x08: command (write) and status (read)
+ *
+ * COMMAND_COPY copies length bytes from source to destination as memmove
+ * would, COMMAND_FILL repeats the big endian fill word over length bytes at
+ * destination. Both run as a TransferDevice command which completes
+ * cycles-per-word cycles per started word later. The data is moved at
+ * completion, bypassing memory mapped devices.
+ */
+class DmaDevice : public TransferDevice {
+   public:
+	static constexpr u64 DEFAULT_CYCLES_PER_WORD = 1;
+
+	static constexpr u16 PORT_SOURCE = 0x00;
+	static constexpr u16 PORT_DESTINATION = 0x02;
+	static constexpr u16 PORT_LENGTH = 0x04;
+	static constexpr u16 PORT_FILL = 0x06;
+	static constexpr u16 PORT_COMMAND = 0x08;
+	static constexpr u16 PORT_COUNT = PORT_COMMAND + 2;
+
+	static constexpr u16 COMMAND_COPY = 1;
+	static constexpr u16 COMMAND_FILL = 2;
+
+	DmaDevice(
+		u16 base, AioDevice &memory, EventScheduler &scheduler, const PerfCounters &counters,
+		u64 cycles_per_word = DEFAULT_CYCLES_PER_WORD);
+
+   protected:
+	void writeRegister(u16 offset, u16 value) override;
+	u16 readRegister(u16 offset) override;
+
+	std::optional<u64> begin(u16 command) override;
+	u16 finish() override;
+
+   private:
+	AioDevice &m_memory;
+	u64 m_cyclesPerWord;
+
+	u16 m_source{0};
+	u16 m_destination{0};
+	u16 m_length{0};
+	u16 m_fill{0};
+
+	/** registers of the transfer in progress */
+	u16 m_command{0};
+	u16 m_transferSource{0};
+	u16 m_transferDestination{0};
+	u16 m_transferLength{0};
+	u16 m_transferFill{0};
+
+	/** staging area so that overlapping copies behave like memmove */
+	std::vector<u8> m_buffer;
+};
+
+}  // namespace mfdemu::impl
+
+#endif
@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <utility>
+
+#include <mfdemu/impl/devices/halt.hpp>
+
+namespace mfdemu::impl {
+
+HaltDevice::HaltDevice(u16 port, Handler handler) : m_port(port), m_handler(std::move(handler)) {}
+
+void HaltDevice::write(u16 address, u8 value, bool low) {
+	if(address != m_port) {
+		return;
+	}
+
+	if(!low) {
+		m_statusHigh = value;
+		return;
+	}
+
+	m_handler((static_cast<u16>(m_statusHigh) << 8) | value);
+}
+
+u8 HaltDevice::read(u16 address, bool low) {
+	return 0;
+}
+
+}  // namespace mfdemu::impl
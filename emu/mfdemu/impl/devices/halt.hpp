@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MFDEMU_IMPL_DEVICES_HALT_HPP
+#define MFDEMU_IMPL_DEVICES_HALT_HPP
+
+#include <functional>
+
+#include <shared/typedefs.hpp>
+
+#include <mfdemu/impl/bus/gio_device.hpp>
+
+namespace mfdemu::impl {
+
+/**
+ * @brief Single word-sized port which ends the emulation. The word written to
+ * it is the exit status of the guest, e.g. "out 1, HALT" halts with status 1.
+ * mfdemu exits with statuses 0 and 2 to 119 as they are and with 120 for any
+ * other, so that no status is mistaken for success. Reads return 0.
+ */
+class HaltDevice : public GioDevice {
+   public:
+	using Handler = std::function<void(u16 status)>;
+
+	HaltDevice(u16 port, Handler handler);
+
+   protected:
+	void write(u16 address, u8 value, bool low) override;
+	u8 read(u16 address, bool low) override;
+	bool stableRead(u16 address) const override { return true; }
+
+   private:
+	u16 m_port;
+	Handler m_handler;
+	u8 m_statusHigh{0};
+};
+
+}  // namespace mfdemu::impl
+
+#endif
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <bit>
+
+#include <mfdemu/impl/devices/pic.hpp>
+
+namespace mfdemu::impl {
+
+PicDevice::PicDevice(u16 base, const InterruptSink &lines, u8 first)
+	: RegisterDevice(base),
+	  m_lines(lines),
+	  m_first(first),
+	  m_vector(std::min<u16>(first, MAX_VECTOR)) {}
+
+u16 PicDevice::highestRank(u16 inputs) const {
+	/* rotated so that bit k is the input of rank k */
+	return std::countr_zero(std::rotr(inputs, m_priority));
+}
+
+bool PicDevice::pending() const {
+	return highestRank(requests()) < highestRank(m_inService);
+}
+
+u8 PicDevice::acknowledgeInterrupt() {
+	const u16 rank = highestRank(requests());
+	if(rank == INPUT_COUNT) {
+		/* spurious, the input with the lowest priority */
+		return m_vector + ((m_priority + INPUT_COUNT - 1) % INPUT_COUNT);
+	}
+
+	const u16 input = (rank + m_priority) % INPUT_COUNT;
+	m_inService |= static_cast<u16>(1 << input);
+	return m_vector + input;
+}
+
+void PicDevice::writeRegister(u16 offset, u16 value) {
+	switch(offset) {
+	case PORT_MASK:
+		m_mask = value;
+		break;
+	case PORT_PRIORITY:
+		m_priority = value % INPUT_COUNT;
+		break;
+	case PORT_VECTOR:
+		if(value <= MAX_VECTOR) {
+			m_vector = value;
+		}
+		break;
+	case PORT_COMMAND:
+		if((value & COMMAND_EOI) != 0) {
+			const u16 rank = highestRank(m_inService);
+			if(rank < INPUT_COUNT) {
+				m_inService &= ~static_cast<u16>(1 << ((rank + m_priority) % INPUT_COUNT));
+			}
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+u16 PicDevice::readRegister(u16 offset) {
+	switch(offset) {
+	case PORT_MASK:
+		return m_mask;
+	case PORT_PRIORITY:
+		return m_priority;
+	case PORT_VECTOR:
+		return m_vector;
+	case PORT_REQUESTS:
+		return requests();
+	case PORT_IN_SERVICE:
+		return m_inService;
+	default:
+		return 0;
+	}
+}
+
+}  // namespace mfdemu::impl
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef MFDEMU_IMPL_DEVICES_PIC_HPP
+#define MFDEMU_IMPL_DEVICES_PIC_HPP
+
+#include <shared/typedefs.hpp>
+
+#include <mfdemu/impl/bus/interrupts.hpp>
+#include <mfdemu/impl/bus/register_device.hpp>
+
+namespace mfdemu::impl {
+
+/**
+ * @brief Programmable interrupt controller which combines the INPUT_COUNT
+ * lines first..first + INPUT_COUNT - 1 into IRQ, input n is line first + n.
+ * It has word-sized ports at base + offset:
+ *
+ *   + 0x00: mask, bit n set masks input n
+ *   + 0x02: input with the highest priority, the others follow in rotating order
+ *   + 0x04: vector, input n is acknowledged with vector + n as IID, writes
+ *           above MAX_VECTOR are ignored so that the IIDs do not wrap
+ *   + 0x06: command (write) and raised inputs which are not masked (read)
+ *   + 0x08: inputs in service, read only
+ *
+ * Acknowledging takes the request with the highest priority and puts it in
+ * service. While an input is in service, it and all inputs of lower priority
+ * do not raise IRQ, those of higher priority still do, so ISRs nest by
+ * priority. Writing COMMAND_EOI ends the interrupt in service with the
+ * highest priority. If the request went away before it was acknowledged,
+ * the IID of the input with the lowest priority is put on the bus without
+ * putting it in service, its ISR should check the in service register.
+ *
+ * Initially nothing is masked, input 0 has the highest priority and the
+ * vector is first, so the IIDs are the line ids as without a controller.
+ */
+class PicDevice : public RegisterDevice, public InterruptController {
+   public:
+	static constexpr u16 INPUT_COUNT = 16;
+	static constexpr u16 MAX_VECTOR = InterruptSink::LINE_COUNT - INPUT_COUNT;
+
+	static constexpr u16 PORT_MASK = 0x00;
+	static constexpr u16 PORT_PRIORITY = 0x02;
+	static constexpr u16 PORT_VECTOR = 0x04;
+	static constexpr u16 PORT_COMMAND = 0x06;
+	static constexpr u16 PORT_REQUESTS = 0x06;
+	static constexpr u16 PORT_IN_SERVICE = 0x08;
+	static constexpr u16 PORT_COUNT = 0x0a;
+
+	static constexpr u16 COMMAND_EOI = 1;
+
+	PicDevice(u16 base, const InterruptSink &lines, u8 first);
+
+	bool pending() const override;
+	u8 acknowledgeInterrupt() override;
+
+   protected:
+	void writeRegister(u16 offset, u16 value) override;
+	u16 readRegister(u16 offset) override;
+
+	/* requests follow the lines, everything else only changes through the Cpu */
+	bool stableRegister(u16 offset) const override { return offset != PORT_REQUESTS; }
+
+   private:
+	u16 requests() const {
+		return static_cast<u16>(m_lines.raised(m_first, INPUT_COUNT)) & ~m_mask;
+	}
+
+	/** rank of the input with the highest priority in inputs, INPUT_COUNT if empty */
+	u16 highestRank(u16 inputs) const;
+
+	const InterruptSink &m_lines;
+	u8 m_first;
+
+	u16 m_mask{0};
+	u16 m_priority{0};
+	u8 m_vector;
+	u16 m_inService{0};
+};
+
+}  // namespace mfdemu::impl
+
+#endif
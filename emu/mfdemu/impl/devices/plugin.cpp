@@ -0,0 +1,233 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include <dlfcn.h>
+
+#include <shared/log.hpp>
+
+#include <mfdemu/impl/devices/plugin.hpp>
+
+namespace mfdemu::impl {
+
+PluginLibrary::~PluginLibrary() {
+	if(m_handle != nullptr) {
+		dlclose(m_handle);
+	}
+}
+
+bool PluginLibrary::open(const std::string &path) {
+	m_handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+	if(m_handle == nullptr) {
+		logError() << "could not load plugin \"" << path << "\": " << dlerror() << "\n";
+		return false;
+	}
+
+	auto describe =
+		reinterpret_cast<mfdemu_plugin_describe_fn>(dlsym(m_handle, MFDEMU_PLUGIN_DESCRIBE_SYMBOL));
+	if(describe == nullptr) {
+		logError() << "plugin \"" << path << "\" does not export " MFDEMU_PLUGIN_DESCRIBE_SYMBOL "\n";
+		return false;
+	}
+
+	m_descriptor = describe();
+	if(m_descriptor == nullptr || m_descriptor->abi_version != MFDEMU_PLUGIN_ABI_VERSION) {
+		logError() << "plugin \"" << path << "\" was built for ABI version "
+				   << (m_descriptor != nullptr ? m_descriptor->abi_version : 0)
+				   << ", expected " << MFDEMU_PLUGIN_ABI_VERSION << "\n";
+		return false;
+	}
+
+	if(m_descriptor->create == nullptr || m_descriptor->destroy == nullptr ||
+	   m_descriptor->read == nullptr || m_descriptor->write == nullptr) {
+		logError() << "plugin \"" << path << "\" lacks a required function\n";
+		return false;
+	}
+
+	const bool block_read = m_descriptor->read_block != nullptr;
+	const bool block_write = m_descriptor->write_block != nullptr;
+	if((m_descriptor->block_access != nullptr) != block_read || block_read != block_write) {
+		logError() << "plugin \"" << path << "\" implements only part of the block interface\n";
+		return false;
+	}
+
+	return true;
+}
+
+PluginDevice::PluginDevice(std::shared_ptr<PluginLibrary> library, u16 first, u16 last)
+	: m_library(std::move(library)), m_plugin(m_library->descriptor()),
+	  m_host{.context = this, .set_irq = hostSetIrq}, m_first(first), m_last(last),
+	  m_cacheable((m_plugin.flags & MFDEMU_PLUGIN_CACHEABLE_READS) != 0) {
+	if(m_cacheable) {
+		m_cache.resize(last - first + 1);
+	}
+}
+
+PluginDevice::~PluginDevice() {
+	if(m_instance != nullptr) {
+		m_plugin.destroy(m_instance);
+	}
+}
+
+bool PluginDevice::create(const std::string &params) {
+	m_instance = m_plugin.create(m_first, m_last, params.c_str(), &m_host);
+	if(m_instance == nullptr) {
+		logError() << "plugin \"" << m_plugin.name << "\" failed to create a device with \""
+				   << params << "\"\n";
+		return false;
+	}
+
+	return true;
+}
+
+void PluginDevice::setInterrupt(InterruptSink *sink, u8 id) {
+	m_interrupts = sink;
+	m_interrupt = id;
+}
+
+void PluginDevice::hostSetIrq(void *context, bool raised) {
+	auto *device = static_cast<PluginDevice *>(context);
+	if(device->m_interrupts == nullptr) {
+		return;
+	}
+
+	if(raised) {
+		device->m_interrupts->raise(device->m_interrupt);
+	} else {
+		device->m_interrupts->lower(device->m_interrupt);
+	}
+}
+
+void PluginDevice::clck() {
+	if(m_plugin.clck == nullptr) {
+		GioDevice::clck();
+		return;
+	}
+
+	mfdemu_plugin_pins pins{.mode = mode, .io = io};
+	m_plugin.clck(m_instance, &pins);
+	io = pins.io;
+}
+
+void PluginDevice::write(u16 address, u8 value, bool low) {
+	if(!low) {
+		m_pending = value;
+		return;
+	}
+
+	if(m_cacheable) {
+		std::fill(m_cache.begin(), m_cache.end(), std::nullopt);
+	}
+
+	m_plugin.write(m_instance, address, (static_cast<u16>(m_pending) << 8) | value);
+}
+
+u8 PluginDevice::read(u16 address, bool low) {
+	if(low) {
+		return m_pending;
+	}
+
+	u16 value = 0;
+	if(m_cacheable && address >= m_first && address <= m_last) {
+		std::optional<u16> &cached = m_cache[address - m_first];
+		if(!cached.has_value()) {
+			cached = m_plugin.read(m_instance, address);
+		}
+		value = cached.value();
+	} else {
+		value = m_plugin.read(m_instance, address);
+	}
+
+	m_pending = value & 0xff;
+	return value >> 8;
+}
+
+bool PluginDevice::blockAccess(u16 address, usize count) const {
+	return m_plugin.block_access != nullptr && m_plugin.block_access(m_instance, address, count);
+}
+
+void PluginDevice::readBlock(u16 address, u16 *out, usize count) {
+	m_plugin.read_block(m_instance, address, out, count);
+}
+
+void PluginDevice::writeBlock(u16 address, const u16 *data, usize count) {
+	if(m_cacheable) {
+		std::fill(m_cache.begin(), m_cache.end(), std::nullopt);
+	}
+
+	m_plugin.write_block(m_instance, address, data, count);
+}
+
+std::optional<PluginSpec> PluginSpec::parse(const std::string &spec) {
+	const usize at = spec.find('@');
+	if(at == std::string::npos || at == 0) {
+		logError() << "invalid plugin \"" << spec << "\", expected <path>@<first>[:<last>]"
+				   << "[,<params>]\n";
+		return std::nullopt;
+	}
+
+	PluginSpec result;
+	result.path = spec.substr(0, at);
+
+	const char *first_str = spec.c_str() + at + 1;
+	char *end = nullptr;
+	const u64 first = std::strtoull(first_str, &end, 0);
+	u64 last = first;
+	if(end != first_str && *end == ':') {
+		const char *last_str = end + 1;
+		last = std::strtoull(last_str, &end, 0);
+		if(end == last_str) {
+			end = nullptr;
+		}
+	}
+
+	if(end == nullptr || end == first_str || (*end != '\0' && *end != ',') || first > last ||
+	   last > UINT16_MAX) {
+		logError() << "invalid port range in plugin \"" << spec << "\"\n";
+		return std::nullopt;
+	}
+
+	result.first = first;
+	result.last = last;
+	if(*end == ',') {
+		result.params = end + 1;
+	}
+
+	return result;
+}
+
+std::shared_ptr<PluginDevice> loadPlugin(const PluginSpec &spec) {
+	auto library = std::make_shared<PluginLibrary>();
+	if(!library->open(spec.path)) {
+		return nullptr;
+	}
+
+	auto device = std::make_shared<PluginDevice>(std::move(library), spec.first, spec.last);
+	if(!device->create(spec.params)) {
+		return nullptr;
+	}
+
+	return device;
+}
+
+}  // namespace mfdemu::impl
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MFDEMU_IMPL_DEVICES_PLUGIN_HPP
+#define MFDEMU_IMPL_DEVICES_PLUGIN_HPP
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <shared/typedefs.hpp>
+
+#include <mfdemu/impl/bus/gio_device.hpp>
+#include <mfdemu/impl/bus/interrupts.hpp>
+#include <mfdemu/plugin.h>
+
+namespace mfdemu::impl {
+
+/**
+ * @brief Device plugin shared object, see mfdemu/plugin.h. It is unloaded
+ * once the library and all devices created from it are destroyed.
+ */
+class PluginLibrary {
+   public:
+	PluginLibrary() = default;
+	~PluginLibrary();
+
+	PluginLibrary(const PluginLibrary &) = delete;
+	PluginLibrary &operator=(const PluginLibrary &) = delete;
+
+	/**
+	 * @brief Load the shared object at path and check its ABI version.
+	 */
+	bool open(const std::string &path);
+
+	const mfdemu_plugin_descriptor &descriptor() const { return *m_descriptor; }
+
+   private:
+	void *m_handle{nullptr};
+	const mfdemu_plugin_descriptor *m_descriptor{nullptr};
+};
+
+/**
+ * @brief Instance of a plugin mapped to the ports first..last. Each word
+ * transferred on the bus is a single call into the plugin, unless the plugin
+ * takes whole blocks. Reads of plugins declaring MFDEMU_PLUGIN_CACHEABLE_READS
+ * are answered from a cache until the device is written.
+ */
+class PluginDevice : public GioDevice {
+   public:
+	PluginDevice(std::shared_ptr<PluginLibrary> library, u16 first, u16 last);
+	~PluginDevice() override;
+
+	PluginDevice(const PluginDevice &) = delete;
+	PluginDevice &operator=(const PluginDevice &) = delete;
+
+	/**
+	 * @brief Create the plugin instance, must succeed before the device is
+	 * used.
+	 */
+	bool create(const std::string &params);
+
+	/** @brief Interrupt line the plugin raises and lowers, see set_irq(). */
+	void setInterrupt(InterruptSink *sink, u8 id);
+
+	/** @brief Forwarded to the plugin if it has a pin-level interface. */
+	void clck() override;
+
+   protected:
+	void write(u16 address, u8 value, bool low) override;
+	u8 read(u16 address, bool low) override;
+	bool stableRead(u16 address) const override { return m_cacheable; }
+
+	bool blockAccess(u16 address, usize count) const override;
+	void readBlock(u16 address, u16 *out, usize count) override;
+	void writeBlock(u16 address, const u16 *data, usize count) override;
+
+   private:
+	static void hostSetIrq(void *context, bool raised);
+
+	std::shared_ptr<PluginLibrary> m_library;
+	const mfdemu_plugin_descriptor &m_plugin;
+	void *m_instance{nullptr};
+	mfdemu_plugin_host m_host;
+
+	InterruptSink *m_interrupts{nullptr};
+	u8 m_interrupt{0};
+
+	u16 m_first;
+	u16 m_last;
+	bool m_cacheable;
+
+	/** low byte of the word being read, high byte of the word being written */
+	u8 m_pending{0};
+
+	/** last value read per port, indexed by port - m_first */
+	std::vector<std::optional<u16>> m_cache;
+};
+
+/**
+ * @brief A plugin mapped to a port range, given as
+ * <path>@<first>[:<last>][,<params>].
+ */
+struct PluginSpec {
+	std::string path;
+	u16 first;
+	u16 last;
+	std::string params;
+
+	static std::optional<PluginSpec> parse(const std::string &spec);
+};
+
+/**
+ * @brief Load the plugin of spec and create an instance of it, nullptr on
+ * failure.
+ */
+std::shared_ptr<PluginDevice> loadPlugin(const PluginSpec &spec);
+
+}  // namespace mfdemu::impl
+
+#endif
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <mfdemu/impl/devices/pmu.hpp>
+
+namespace mfdemu::impl {
+
+PmuDevice::PmuDevice(u16 base, const PerfCounters &counters)
+	: RegisterDevice(base), m_counters(counters) {}
+
+void PmuDevice::writeRegister(u16 offset, u16 value) {
+	if(offset != PORT_CONTROL) {
+		return;
+	}
+
+	if((value & CONTROL_RESET) != 0) {
+		for(u8 counter = 0; counter < COUNTER_COUNT; counter++) {
+			m_offsets[counter] = liveValue(static_cast<Counter>(counter));
+			m_frozenValues[counter] = 0;
+		}
+	}
+
+	const bool freeze = (value & CONTROL_FREEZE) != 0;
+	if(freeze == m_frozen) {
+		return;
+	}
+
+	for(u8 counter = 0; counter < COUNTER_COUNT; counter++) {
+		const u64 live = liveValue(static_cast<Counter>(counter));
+		if(freeze) {
+			m_frozenValues[counter] = live - m_offsets[counter];
+		} else {
+			m_offsets[counter] = live - m_frozenValues[counter];
+		}
+	}
+
+	m_frozen = freeze;
+}
+
+u16 PmuDevice::readRegister(u16 offset) {
+	if(offset == PORT_CONTROL) {
+		return m_frozen ? CONTROL_FREEZE : 0;
+	}
+
+	if(offset >= PORT_CONTROL) {
+		return 0;
+	}
+
+	const auto counter = static_cast<Counter>(offset / 8);
+	const u16 word = (offset % 8) / 2;
+
+	if(word == 0) {
+		m_latched[counter] = value(counter);
+	}
+
+	return (m_latched[counter] >> ((3 - word) * 16)) & 0xFFFF;
+}
+
+u64 PmuDevice::liveValue(Counter counter) const {
+	switch(counter) {
+	case CYCLES:
+		return m_counters.cycles;
+	case RETIRED:
+		return m_counters.retired;
+	case BUS_TRANSACTIONS:
+		return m_counters.abus_reads + m_counters.abus_writes + m_counters.gio_reads +
+			   m_counters.gio_writes;
+	default:
+		return 0;
+	}
+}
+
+u64 PmuDevice::value(Counter counter) const {
+	return m_frozen ? m_frozenValues[counter] : liveValue(counter) - m_offsets[counter];
+}
+
+}  // namespace mfdemu::impl
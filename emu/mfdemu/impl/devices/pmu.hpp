@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MFDEMU_IMPL_DEVICES_PMU_HPP
+#define MFDEMU_IMPL_DEVICES_PMU_HPP
+
+#include <array>
+
+#include <shared/typedefs.hpp>
+
+#include <mfdemu/impl/bus/register_device.hpp>
+#include <mfdemu/impl/perf_counters.hpp>
+
+namespace mfdemu::impl {
+
+/**
+ * @brief Performance monitoring unit, makes the Cpu's performance counters
+ * visible to the guest.
+ *
+ * Every counter is 64 bits wide and is read as four words, most significant
+ * word first, from four consecutive (word-sized) ports. Reading the most
+ * significant word latches the whole counter so that the remaining words of
+ * the same value can be read afterwards.
+ *
+ *   base + 0x00..0x06: cycle counter
+ *   base + 0x08..0x0e: retired instructions
+ *   base + 0x10..0x16: bus transactions (AIO and GIO, reads and writes)
+ *   base + 0x18:       control register
+ *
+ * Writing CONTROL_RESET to the control register resets all counters to 0,
+ * setting CONTROL_FREEZE stops them and clearing it lets them continue from
+ * where they were frozen. Reading the control register returns the current
+ * freeze state.
+ */
+class PmuDevice : public RegisterDevice {
+   public:
+	enum Counter : u8 {
+		CYCLES,
+		RETIRED,
+		BUS_TRANSACTIONS,
+		COUNTER_COUNT,
+	};
+
+	static constexpr u16 PORT_CONTROL = 0x18;
+	static constexpr u16 PORT_COUNT = PORT_CONTROL + 2;
+
+	static constexpr u16 CONTROL_RESET = 1 << 0;
+	static constexpr u16 CONTROL_FREEZE = 1 << 1;
+
+	PmuDevice(u16 base, const PerfCounters &counters);
+
+   protected:
+	void writeRegister(u16 offset, u16 value) override;
+	u16 readRegister(u16 offset) override;
+
+   private:
+	u64 liveValue(Counter counter) const;
+	u64 value(Counter counter) const;
+
+	const PerfCounters &m_counters;
+
+	bool m_frozen{false};
+
+	/** live counter values which are reported as 0 */
+	std::array<u64, COUNTER_COUNT> m_offsets{};
+	/** values reported whilst frozen */
+	std::array<u64, COUNTER_COUNT> m_frozenValues{};
+	/** values latched by reading the most significant word */
+	std::array<u64, COUNTER_COUNT> m_latched{};
+};
+
+}  // namespace mfdemu::impl
+
+#endif
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <shared/log.hpp>
+
+#include <mfdemu/impl/devices/storage.hpp>
+
+namespace mfdemu::impl {
+
+StorageDevice::StorageDevice(
+	u16 base, AioDevice &memory, EventScheduler &scheduler, const PerfCounters &counters)
+	: TransferDevice(base, scheduler, counters), m_memory(memory) {}
+
+StorageDevice::~StorageDevice() {
+	if(m_data != nullptr) {
+		munmap(m_data, m_size);
+	}
+}
+
+bool StorageDevice::open(const std::string &path) {
+	const int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+	if(fd < 0) {
+		logError() << "could not open storage \"" << path << "\"\n";
+		return false;
+	}
+
+	struct stat info{};
+	if(fstat(fd, &info) != 0) {
+		logError() << "could not stat storage \"" << path << "\"\n";
+		::close(fd);
+		return false;
+	}
+
+	const usize size = (static_cast<usize>(info.st_size) / SECTOR_SIZE) * SECTOR_SIZE;
+	if(size == 0) {
+		::close(fd);
+		return true;
+	}
+
+	/* the mapping keeps the file open */
+	void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if(data == MAP_FAILED) {
+		logError() << "could not map storage \"" << path << "\"\n";
+		return false;
+	}
+
+	m_data = static_cast<u8 *>(data);
+	m_size = size;
+	return true;
+}
+
+std::optional<u64> StorageDevice::begin(u16 command) {
+	if(command != COMMAND_READ && command != COMMAND_WRITE) {
+		return std::nullopt;
+	}
+
+	m_command = command;
+	m_transferSector = m_sector;
+	m_transferCount = m_count;
+	m_transferAddress = m_memoryAddress;
+	return m_count * CYCLES_PER_SECTOR;
+}
+
+u16 StorageDevice::finish() {
+	const usize offset = static_cast<usize>(m_transferSector) * SECTOR_SIZE;
+	const usize length = static_cast<usize>(m_transferCount) * SECTOR_SIZE;
+	if(offset + length > m_size) {
+		return STATUS_ERROR;
+	}
+
+	if(m_command == COMMAND_READ) {
+		m_memory.dmaWrite(m_transferAddress, m_data + offset, length);
+	} else {
+		/* bytes past the end of memory would read as 0, keep the file there */
+		const usize available =
+			m_transferAddress < m_memory.size() ? m_memory.size() - m_transferAddress : 0;
+		m_memory.dmaRead(m_transferAddress, m_data + offset, std::min(length, available));
+	}
+
+	return 0;
+}
+
+void StorageDevice::writeRegister(u16 offset, u16 value) {
+	switch(offset) {
+	case PORT_SECTOR:
+		m_sector = value;
+		break;
+	case PORT_SECTOR_COUNT:
+		m_count = value;
+		break;
+	case PORT_ADDRESS:
+		m_memoryAddress = value;
+		break;
+	case PORT_COMMAND:
+		command(value);
+		break;
+	default:
+		break;
+	}
+}
+
+u16 StorageDevice::readRegister(u16 offset) {
+	switch(offset) {
+	case PORT_SECTOR:
+		return m_sector;
+	case PORT_SECTOR_COUNT:
+		return m_count;
+	case PORT_ADDRESS:
+		return m_memoryAddress;
+	case PORT_COMMAND:
+		return status();
+	case PORT_CAPACITY:
+		return std::min<usize>(capacity(), UINT16_MAX);
+	default:
+		return 0;
+	}
+}
+
+}  // namespace mfdemu::impl
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MFDEMU_IMPL_DEVICES_STORAGE_HPP
+#define MFDEMU_IMPL_DEVICES_STORAGE_HPP
+
+#include <optional>
+#include <string>
+
+#include <shared/typedefs.hpp>
+
+#include <mfdemu/impl/bus/aio_device.hpp>
+#include <mfdemu/impl/devices/transfer.hpp>
+#include <mfdemu/impl/perf_counters.hpp>
+#include <mfdemu/impl/scheduler.hpp>
+
+namespace mfdemu::impl {
+
+/**
+ * @brief Block storage backed by a host file which is mapped into memory.
+ * Sectors are moved between the file and main memory by DMA, there is no
+ * word-by-word data port. All registers are word-sized ports:
+ *
+ *   base + 0x00: first sector
+ *   base + 0x02: sector count
+ *   base + 0x04: main memory address
+ *   base + 0x06: command (write) and status (read)
+ *   base + 0x08: capacity in sectors, read only
+ *
+ * COMMAND_READ and COMMAND_WRITE run as a TransferDevice command with the
+ * current registers, it completes CYCLES_PER_SECTOR cycles per sector later.
+ * The data is moved at once then, STATUS_ERROR is set with STATUS_DONE if the
+ * sectors are out of range. Transfers past the end of main memory are cut
+ * short, a write leaves the rest of its sectors as they are in the file.
+ */
+class StorageDevice : public TransferDevice {
+   public:
+	static constexpr usize SECTOR_SIZE = 512;
+	static constexpr u64 CYCLES_PER_SECTOR = 256;
+
+	static constexpr u16 PORT_SECTOR = 0x00;
+	static constexpr u16 PORT_SECTOR_COUNT = 0x02;
+	static constexpr u16 PORT_ADDRESS = 0x04;
+	static constexpr u16 PORT_COMMAND = 0x06;
+	static constexpr u16 PORT_CAPACITY = 0x08;
+	static constexpr u16 PORT_COUNT = PORT_CAPACITY + 2;
+
+	static constexpr u16 COMMAND_READ = 1;
+	static constexpr u16 COMMAND_WRITE = 2;
+
+	static constexpr u16 STATUS_ERROR = 1 << 2;
+
+	StorageDevice(
+		u16 base, AioDevice &memory, EventScheduler &scheduler, const PerfCounters &counters);
+	~StorageDevice() override;
+
+	/**
+	 * @brief Map the file at path, its size is rounded down to whole sectors.
+	 */
+	bool open(const std::string &path);
+
+	usize capacity() const { return m_size / SECTOR_SIZE; }
+
+   protected:
+	void writeRegister(u16 offset, u16 value) override;
+	u16 readRegister(u16 offset) override;
+
+	std::optional<u64> begin(u16 command) override;
+	u16 finish() override;
+
+   private:
+	AioDevice &m_memory;
+
+	u8 *m_data{nullptr};
+	usize m_size{0};
+
+	u16 m_sector{0};
+	u16 m_count{0};
+	u16 m_memoryAddress{0};
+
+	/** registers of the transfer in progress */
+	u16 m_command{0};
+	u16 m_transferSector{0};
+	u16 m_transferCount{0};
+	u16 m_transferAddress{0};
+};
+
+}  // namespace mfdemu::impl
+
+#endif
@@ -0,0 +1,294 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <ctime>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <shared/log.hpp>
+
+#include <mfdemu/impl/devices/terminal.hpp>
+
+namespace mfdemu::impl {
+
+static_assert((Terminal::RING_SIZE & (Terminal::RING_SIZE - 1)) == 0);
+
+/** how long the reader thread waits for the guest to drain a full ring */
+static constexpr int FULL_RING_WAIT_MS = 1;
+
+Terminal::Terminal() : GioDevice(), m_input(STDIN_FILENO), m_output(STDOUT_FILENO) {
+	m_outputBuffer.reserve(OUTPUT_BUFFER_SIZE);
+
+	struct termios attr{};
+	tcgetattr(STDIN_FILENO, &attr);
+	attr.c_lflag &= ~(ICANON | ECHO);
+	tcsetattr(STDIN_FILENO, TCSANOW, &attr);
+}
+
+Terminal::Terminal(int input, int output)
+	: GioDevice(), m_input(input), m_ownsInput(input >= 0),
+	  m_output(output >= 0 ? output : STDOUT_FILENO), m_ownsOutput(output >= 0) {
+	m_outputBuffer.reserve(OUTPUT_BUFFER_SIZE);
+}
+
+Terminal::~Terminal() {
+	flush();
+	if(m_ownsOutput) {
+		::close(m_output);
+	}
+
+	if(m_reader.joinable()) {
+		const u8 wake = 0;
+		while(::write(m_wakePipe[1], &wake, 1) < 0 && errno == EINTR) {
+		}
+		m_reader.join();
+	}
+
+	for(int fd: m_wakePipe) {
+		if(fd >= 0) {
+			::close(fd);
+		}
+	}
+
+	if(m_ownsInput) {
+		::close(m_input);
+	}
+}
+
+u64 Terminal::now() {
+	constexpr u64 NANOSECONDS = 1000 * 1000 * 1000;
+	struct timespec ts{};
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * NANOSECONDS) + ts.tv_nsec;
+}
+
+void Terminal::flush() {
+	usize written = 0;
+	while(written < m_outputBuffer.size()) {
+		const ssize_t count =
+			::write(m_output, m_outputBuffer.data() + written, m_outputBuffer.size() - written);
+		if(count < 0 && errno == EINTR) {
+			continue;
+		}
+
+		/* output which can not be written is dropped rather than stalling the guest */
+		if(count <= 0) {
+			break;
+		}
+		written += count;
+	}
+
+	m_outputBuffer.clear();
+}
+
+void Terminal::setInterrupt(InterruptSink *sink, u8 id) {
+	if(m_interrupts != nullptr) {
+		m_interrupts->lower(m_interruptId);
+	}
+
+	m_interrupts = sink;
+	m_interruptId = id;
+	updateInterrupt();
+}
+
+void Terminal::start() {
+	if(m_started || m_input < 0) {
+		return;
+	}
+	m_started = true;
+
+	struct stat info{};
+	if(fstat(m_input, &info) == 0 && S_ISREG(info.st_mode)) {
+		std::array<u8, 4096> chunk{};
+		while(true) {
+			const ssize_t count = ::read(m_input, chunk.data(), chunk.size());
+			if(count < 0 && errno == EINTR) {
+				continue;
+			}
+
+			if(count <= 0) {
+				break;
+			}
+			m_fileInput.insert(m_fileInput.end(), chunk.begin(), chunk.begin() + count);
+		}
+
+		updateInterrupt();
+		return;
+	}
+
+	if(pipe2(m_wakePipe.data(), O_CLOEXEC) != 0) {
+		logError() << "could not create the console wake pipe, console input is disabled\n";
+		return;
+	}
+
+	m_reader = std::thread(&Terminal::readerLoop, this);
+}
+
+usize Terminal::available() const {
+	if(m_reader.joinable()) {
+		return m_ringTail.load(std::memory_order_acquire) -
+			   m_ringHead.load(std::memory_order_relaxed);
+	}
+
+	return m_fileInput.size() - m_fileOffset;
+}
+
+u8 Terminal::pop() {
+	if(available() == 0) {
+		return 0;
+	}
+
+	u8 value = 0;
+	if(m_reader.joinable()) {
+		const usize head = m_ringHead.load(std::memory_order_relaxed);
+		value = m_ring[head % RING_SIZE];
+		m_ringHead.store(head + 1, std::memory_order_release);
+	} else {
+		value = m_fileInput[m_fileOffset++];
+	}
+
+	updateInterrupt();
+	return value;
+}
+
+void Terminal::updateInterrupt() {
+	if(m_interrupts == nullptr) {
+		return;
+	}
+
+	/* lowered first so that input arriving in between raises it again */
+	m_interrupts->lower(m_interruptId);
+	if(available() > 0) {
+		m_interrupts->raise(m_interruptId);
+	}
+}
+
+void Terminal::readerLoop() {
+	std::array<pollfd, 2> fds{{
+		{.fd = m_input, .events = POLLIN, .revents = 0},
+		{.fd = m_wakePipe[0], .events = POLLIN, .revents = 0},
+	}};
+
+	while(true) {
+		const usize tail = m_ringTail.load(std::memory_order_relaxed);
+		const usize free = RING_SIZE - (tail - m_ringHead.load(std::memory_order_acquire));
+
+		/* a negative fd is ignored, with a full ring only the wake pipe is watched */
+		fds[0].fd = free > 0 ? m_input : -1;
+		if(poll(fds.data(), fds.size(), free > 0 ? -1 : FULL_RING_WAIT_MS) < 0) {
+			if(errno == EINTR) {
+				continue;
+			}
+			return;
+		}
+
+		if(fds[1].revents != 0) {
+			return;
+		}
+
+		if(fds[0].revents == 0) {
+			continue;
+		}
+
+		const usize length = std::min(free, RING_SIZE - (tail % RING_SIZE));
+		const ssize_t count = ::read(m_input, &m_ring[tail % RING_SIZE], length);
+		if(count < 0 && (errno == EINTR || errno == EAGAIN)) {
+			continue;
+		}
+
+		/* end of input or an error */
+		if(count <= 0) {
+			return;
+		}
+
+		m_ringTail.store(tail + count, std::memory_order_release);
+		if(m_interrupts != nullptr) {
+			m_interrupts->raise(m_interruptId);
+		}
+	}
+}
+
+void Terminal::write(u16 address, u8 value, bool low) {
+	if(low || address == m_statusPort) {
+		return;
+	}
+
+	if(m_outputBuffer.empty()) {
+		m_flushDeadline = now() + (FLUSH_DELAY_MS * 1000 * 1000);
+	}
+
+	m_outputBuffer.push_back(value);
+	if(value == '\n' || m_outputBuffer.size() == OUTPUT_BUFFER_SIZE) {
+		flush();
+	}
+}
+
+void Terminal::writeBlock(u16 address, const u16 *data, usize count) {
+	if(count == 0) {
+		return;
+	}
+
+	if(m_outputBuffer.empty()) {
+		m_flushDeadline = now() + (FLUSH_DELAY_MS * 1000 * 1000);
+	}
+
+	bool newline = false;
+	for(usize ix = 0; ix < count; ix++) {
+		const u8 value = data[ix] >> 8;
+		m_outputBuffer.push_back(value);
+		newline |= value == '\n';
+	}
+
+	if(newline || m_outputBuffer.size() >= OUTPUT_BUFFER_SIZE) {
+		flush();
+	}
+}
+
+void Terminal::readBlock(u16 address, u16 *out, usize count) {
+	flush();
+	for(usize ix = 0; ix < count; ix++) {
+		out[ix] = static_cast<u16>(pop()) << 8;
+	}
+}
+
+u8 Terminal::read(u16 address, bool low) {
+	/* the guest may wait for an answer to what it printed */
+	if(!low) {
+		flush();
+	}
+
+	if(address == m_statusPort) {
+		if(low) {
+			return m_statusLow;
+		}
+
+		const usize count = std::min<usize>(available(), UINT16_MAX);
+		m_statusLow = count & 0xff;
+		return count >> 8;
+	}
+
+	return low ? 0 : pop();
+}
+
+}  // namespace mfdemu::impl
@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MFDEMU_IMPL_DEVICES_TERMINAL_HPP
+#define MFDEMU_IMPL_DEVICES_TERMINAL_HPP
+
+#include <array>
+#include <atomic>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include <shared/typedefs.hpp>
+
+#include <mfdemu/impl/bus/gio_device.hpp>
+#include <mfdemu/impl/bus/interrupts.hpp>
+
+namespace mfdemu::impl {
+
+/**
+ * @brief Console at the console port. It stays built in since the console
+ * options configure it, a device plugin mapped to that port replaces it.
+ *
+ * The high byte of a word written to the data port is printed. Output is
+ * collected and written with a single write(2) on a newline, once the buffer
+ * is full, before the guest reads from the terminal and at most
+ * FLUSH_DELAY_MS after the first unwritten byte (see flushExpired()). The data
+ * port is a stream port, block transfers to it stay at the port and are
+ * appended to the buffer at once.
+ *
+ * A word read from the data port carries the next input byte in its high
+ * byte, or 0 if there is no input; reads never wait for input. Input from a
+ * tty or a pipe is read by a reader thread into a ring buffer, regular files
+ * are read up front so that runs stay deterministic.
+ *
+ * The optional status port reads as the number of buffered input bytes. With
+ * an interrupt id set, its line is raised while input is buffered.
+ */
+class Terminal : public GioDevice {
+   public:
+	/** input bytes buffered by the reader thread, a power of two */
+	static constexpr usize RING_SIZE = 4096;
+	static constexpr usize OUTPUT_BUFFER_SIZE = 4096;
+	static constexpr u64 FLUSH_DELAY_MS = 20;
+
+	/** interactive terminal on stdin/stdout, stdin is switched to raw mode */
+	Terminal();
+
+	/**
+	 * headless terminal, an input of -1 reads nothing and an output of -1
+	 * writes to stdout. The terminal takes ownership of both.
+	 */
+	Terminal(int input, int output);
+
+	Terminal(const Terminal &) = delete;
+	Terminal &operator=(const Terminal &) = delete;
+
+	~Terminal() override;
+
+	/** @brief Answer reads of port with the number of buffered input bytes. */
+	void setStatusPort(std::optional<u16> port) { m_statusPort = port; }
+	std::optional<u16> statusPort() const { return m_statusPort; }
+
+	/**
+	 * @brief Raise the line id of sink while input is buffered, must be called
+	 * before start().
+	 */
+	void setInterrupt(InterruptSink *sink, u8 id);
+
+	/**
+	 * @brief Start reading input, called once the terminal is configured. Does
+	 * nothing if it was started already.
+	 */
+	void start();
+
+	/** @brief Number of input bytes which can be read right away. */
+	usize available() const;
+
+	/** @brief Write out all buffered output. */
+	void flush();
+
+	/**
+	 * @brief Write out buffered output once its oldest byte waited for
+	 * FLUSH_DELAY_MS, cheap to call if nothing is buffered.
+	 */
+	void flushExpired() {
+		if(!m_outputBuffer.empty() && now() >= m_flushDeadline) {
+			flush();
+		}
+	}
+
+   protected:
+	void write(u16 address, u8 value, bool low) override;
+	u8 read(u16 address, bool low) override;
+	bool streamPort(u16 address) const override { return address != m_statusPort; }
+
+	/* block transfers at the data port take all bytes at once */
+	bool blockAccess(u16 address, usize count) const override {
+		return address != m_statusPort;
+	}
+	void readBlock(u16 address, u16 *out, usize count) override;
+	void writeBlock(u16 address, const u16 *data, usize count) override;
+
+   private:
+	static u64 now();
+
+	u8 pop();
+	void updateInterrupt();
+	void readerLoop();
+
+	int m_input;
+	bool m_ownsInput{false};
+	int m_output;
+	bool m_ownsOutput{false};
+
+	std::vector<u8> m_outputBuffer;
+	/** CLOCK_MONOTONIC time in ns at which the buffered output is written */
+	u64 m_flushDeadline{0};
+
+	std::optional<u16> m_statusPort;
+	InterruptSink *m_interrupts{nullptr};
+	u8 m_interruptId{0};
+	u8 m_statusLow{0};
+	bool m_started{false};
+
+	/** whole input if it is a regular file */
+	std::vector<u8> m_fileInput;
+	usize m_fileOffset{0};
+
+	/** single producer (reader thread), single consumer ring, the counters
+	 * only ever grow and are taken modulo RING_SIZE */
+	std::array<u8, RING_SIZE> m_ring{};
+	std::atomic<usize> m_ringHead{0};
+	std::atomic<usize> m_ringTail{0};
+
+	/** written to by the destructor to wake the reader thread */
+	std::array<int, 2> m_wakePipe{-1, -1};
+	std::thread m_reader;
+};
+
+}  // namespace mfdemu::impl
+
+#endif
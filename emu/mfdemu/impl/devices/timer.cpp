@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include <mfdemu/impl/devices/timer.hpp>
+
+namespace mfdemu::impl {
+
+TimerDevice::TimerDevice(u16 base, EventScheduler &scheduler, const PerfCounters &counters)
+	: RegisterDevice(base), m_scheduler(scheduler), m_counters(counters) {}
+
+TimerDevice::~TimerDevice() {
+	for(Channel &channel: m_channels) {
+		if(channel.event.has_value()) {
+			m_scheduler.cancel(channel.event.value());
+		}
+	}
+}
+
+u64 TimerDevice::period(const Channel &channel) {
+	const u64 ticks = channel.reload == 0 ? 0x10000 : channel.reload;
+	const u64 prescaler = channel.prescaler == 0 ? 1 : channel.prescaler;
+	return ticks * prescaler;
+}
+
+void TimerDevice::schedule(u16 index) {
+	Channel &channel = m_channels[index];
+	channel.event = m_scheduler.schedule(channel.expiry, [this, index] { expire(index); });
+}
+
+void TimerDevice::expire(u16 index) {
+	Channel &channel = m_channels[index];
+	channel.event = std::nullopt;
+	channel.expired = true;
+	raiseInterrupt(index);
+
+	if((channel.control & CONTROL_PERIODIC) != 0) {
+		channel.expiry += period(channel);
+		schedule(index);
+	} else {
+		channel.control &= ~CONTROL_ENABLE;
+	}
+}
+
+void TimerDevice::control(u16 index, u16 value) {
+	Channel &channel = m_channels[index];
+
+	if((value & CONTROL_ACKNOWLEDGE) != 0) {
+		channel.expired = false;
+		lowerInterrupt(index);
+		return;
+	}
+
+	if(channel.event.has_value()) {
+		m_scheduler.cancel(channel.event.value());
+		channel.event = std::nullopt;
+	}
+
+	channel.control = value & (CONTROL_ENABLE | CONTROL_PERIODIC);
+	if((channel.control & CONTROL_ENABLE) != 0) {
+		channel.expiry = m_counters.cycles + period(channel);
+		schedule(index);
+	}
+}
+
+void TimerDevice::writeRegister(u16 offset, u16 value) {
+	const u16 index = offset / CHANNEL_PORTS;
+	if(index >= CHANNEL_COUNT) {
+		return;
+	}
+
+	switch(offset % CHANNEL_PORTS) {
+	case PORT_RELOAD:
+		m_channels[index].reload = value;
+		break;
+	case PORT_PRESCALER:
+		m_channels[index].prescaler = value;
+		break;
+	case PORT_CONTROL:
+		control(index, value);
+		break;
+	default:
+		break;
+	}
+}
+
+u16 TimerDevice::readRegister(u16 offset) {
+	const u16 index = offset / CHANNEL_PORTS;
+	if(index >= CHANNEL_COUNT) {
+		return 0;
+	}
+
+	const Channel &channel = m_channels[index];
+	switch(offset % CHANNEL_PORTS) {
+	case PORT_RELOAD:
+		return channel.reload;
+	case PORT_PRESCALER:
+		return channel.prescaler;
+	case PORT_CONTROL:
+		return channel.control | (channel.expired ? STATUS_EXPIRED : 0);
+	case PORT_COUNTER: {
+		if((channel.control & CONTROL_ENABLE) == 0) {
+			return 0;
+		}
+
+		/* a tick is left until its last cycle passed */
+		const u64 prescaler = channel.prescaler == 0 ? 1 : channel.prescaler;
+		const u64 cycles = channel.expiry - m_counters.cycles;
+		return std::min<u64>((cycles + prescaler - 1) / prescaler, UINT16_MAX);
+	}
+	default:
+		return 0;
+	}
+}
+
+}  // namespace mfdemu::impl
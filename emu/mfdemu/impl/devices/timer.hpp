@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MFDEMU_IMPL_DEVICES_TIMER_HPP
+#define MFDEMU_IMPL_DEVICES_TIMER_HPP
+
+#include <array>
+#include <optional>
+
+#include <shared/typedefs.hpp>
+
+#include <mfdemu/impl/bus/register_device.hpp>
+#include <mfdemu/impl/perf_counters.hpp>
+#include <mfdemu/impl/scheduler.hpp>
+
+namespace mfdemu::impl {
+
+/**
+ * @brief Programmable interval timer with CHANNEL_COUNT channels. Channel n
+ * has four word-sized ports at base + n * CHANNEL_PORTS:
+ *
+ *   + 0x00: reload, ticks from start to expiry, 0 counts as 0x10000
+ *   + 0x02: prescaler, cycles per tick, 0 counts as 1
+ *   + 0x04: control (write) and status (read)
+ *   + 0x06: ticks left until expiry, read only
+ *
+ * Writing CONTROL_ENABLE (re)starts the channel from its reload value,
+ * writing control without it stops the channel. On expiry STATUS_EXPIRED is
+ * set and interrupt n is raised, so the interrupt is acknowledged with the
+ * channel number above the first line as IID. A one-shot channel stops then, a
+ * CONTROL_PERIODIC one restarts right away so its period does not drift.
+ * Writing CONTROL_ACKNOWLEDGE clears STATUS_EXPIRED and lowers the line, the
+ * other bits are ignored then.
+ *
+ * Expiries are scheduled as events, the timer costs nothing between them.
+ */
+class TimerDevice : public RegisterDevice {
+   public:
+	static constexpr u16 CHANNEL_COUNT = 4;
+	static constexpr u16 CHANNEL_PORTS = 0x08;
+	static constexpr u16 PORT_COUNT = CHANNEL_COUNT * CHANNEL_PORTS;
+
+	static constexpr u16 PORT_RELOAD = 0x00;
+	static constexpr u16 PORT_PRESCALER = 0x02;
+	static constexpr u16 PORT_CONTROL = 0x04;
+	static constexpr u16 PORT_COUNTER = 0x06;
+
+	static constexpr u16 CONTROL_ENABLE = 1 << 0;
+	static constexpr u16 CONTROL_PERIODIC = 1 << 1;
+	static constexpr u16 CONTROL_ACKNOWLEDGE = 1 << 2;
+	static constexpr u16 STATUS_EXPIRED = 1 << 3;
+
+	TimerDevice(u16 base, EventScheduler &scheduler, const PerfCounters &counters);
+	~TimerDevice() override;
+
+	TimerDevice(const TimerDevice &) = delete;
+	TimerDevice &operator=(const TimerDevice &) = delete;
+
+   protected:
+	void writeRegister(u16 offset, u16 value) override;
+	u16 readRegister(u16 offset) override;
+
+	/* only the counter changes between expiries */
+	bool stableRegister(u16 offset) const override {
+		return (offset % CHANNEL_PORTS) != PORT_COUNTER;
+	}
+
+   private:
+	struct Channel {
+		u16 reload{0};
+		u16 prescaler{0};
+		u16 control{0};
+		bool expired{false};
+
+		/** cycle the channel expires at while it is enabled */
+		u64 expiry{0};
+		std::optional<EventScheduler::EventId> event;
+	};
+
+	/** cycles from start to expiry */
+	static u64 period(const Channel &channel);
+
+	void control(u16 index, u16 value);
+	void schedule(u16 index);
+	void expire(u16 index);
+
+	EventScheduler &m_scheduler;
+	const PerfCounters &m_counters;
+
+	std::array<Channel, CHANNEL_COUNT> m_channels;
+};
+
+}  // namespace mfdemu::impl
+
+#endif
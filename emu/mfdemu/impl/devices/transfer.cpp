@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <mfdemu/impl/devices/transfer.hpp>
+
+namespace mfdemu::impl {
+
+TransferDevice::TransferDevice(u16 base, EventScheduler &scheduler, const PerfCounters &counters)
+	: RegisterDevice(base), m_scheduler(scheduler), m_counters(counters) {}
+
+TransferDevice::~TransferDevice() {
+	if(m_event.has_value()) {
+		m_scheduler.cancel(m_event.value());
+	}
+}
+
+void TransferDevice::command(u16 value) {
+	if((m_status & STATUS_BUSY) != 0) {
+		return;
+	}
+
+	if(value == COMMAND_ACKNOWLEDGE) {
+		m_status = 0;
+		lowerInterrupt();
+		return;
+	}
+
+	const std::optional<u64> cycles = begin(value);
+	if(!cycles.has_value()) {
+		return;
+	}
+
+	m_status = STATUS_BUSY;
+	m_event = m_scheduler.schedule(m_counters.cycles + cycles.value(), [this] {
+		m_event = std::nullopt;
+		m_status = STATUS_DONE | finish();
+		raiseInterrupt();
+	});
+}
+
+}  // namespace mfdemu::impl
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef MFDEMU_IMPL_DEVICES_TRANSFER_HPP
+#define MFDEMU_IMPL_DEVICES_TRANSFER_HPP
+
+#include <optional>
+
+#include <shared/typedefs.hpp>
+
+#include <mfdemu/impl/bus/register_device.hpp>
+#include <mfdemu/impl/perf_counters.hpp>
+#include <mfdemu/impl/scheduler.hpp>
+
+namespace mfdemu::impl {
+
+/**
+ * @brief Register device which runs one command at a time in the background.
+ * A command written with command() sets STATUS_BUSY and completes some cycles
+ * later as an event, which sets STATUS_DONE and raises interrupt 0 until
+ * COMMAND_ACKNOWLEDGE clears both. Commands written while busy are ignored.
+ */
+class TransferDevice : public RegisterDevice {
+   public:
+	static constexpr u16 COMMAND_ACKNOWLEDGE = 3;
+
+	static constexpr u16 STATUS_BUSY = 1 << 0;
+	static constexpr u16 STATUS_DONE = 1 << 1;
+
+	~TransferDevice() override;
+
+	TransferDevice(const TransferDevice &) = delete;
+	TransferDevice &operator=(const TransferDevice &) = delete;
+
+   protected:
+	TransferDevice(u16 base, EventScheduler &scheduler, const PerfCounters &counters);
+
+	/**
+	 * @brief Take the registers for command and return the cycles it takes,
+	 * nothing if it is not a command of the device.
+	 */
+	virtual std::optional<u64> begin(u16 command) = 0;
+
+	/** @brief Carry out the command, returns status bits set with STATUS_DONE. */
+	virtual u16 finish() = 0;
+
+	void command(u16 value);
+	u16 status() const { return m_status; }
+
+	/* registers only change through writes and the completion event */
+	bool stableRegister(u16 offset) const override { return true; }
+
+   private:
+	EventScheduler &m_scheduler;
+	const PerfCounters &m_counters;
+	std::optional<EventScheduler::EventId> m_event;
+	u16 m_status{0};
+};
+
+}  // namespace mfdemu::impl
+
+#endif
@@ -0,0 +1,246 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+#include <shared/log.hpp>
+
+#include <mfdemu/impl/farm/job.hpp>
+#include <mfdemu/mri.hpp>
+
+namespace mfdemu::impl {
+
+static bool parseNumber(const std::string &str, u64 max, u64 &value) {
+	char *end = nullptr;
+	value = std::strtoull(str.c_str(), &end, 0);
+	return !str.empty() && *end == '\0' && value <= max;
+}
+
+std::optional<FarmJob> FarmJob::parse(const std::string &line, const FarmJob &defaults) {
+	FarmJob job = defaults;
+	std::istringstream stream(line);
+
+	if(!(stream >> job.image_path)) {
+		logError() << "job without an image\n";
+		return std::nullopt;
+	}
+
+	std::string option;
+	while(stream >> option) {
+		const usize separator = option.find('=');
+		if(separator == std::string::npos) {
+			logError() << "invalid job option \"" << option << "\", expected <key>=<value>\n";
+			return std::nullopt;
+		}
+
+		const std::string key = option.substr(0, separator);
+		const std::string value = option.substr(separator + 1);
+
+		if(key == "in") {
+			job.console_in = value;
+			continue;
+		}
+
+		if(key == "out") {
+			job.console_out = value;
+			continue;
+		}
+
+		u64 number = 0;
+		const u64 max = key == "max-cycles" || key == "max-time" || key == "hang-cycles"
+							? UINT64_MAX / 1000
+							: UINT16_MAX;
+		if(!parseNumber(value, max, number)) {
+			logError() << "invalid value for job option \"" << key << "\": " << value << "\n";
+			return std::nullopt;
+		}
+
+		if(key == "max-cycles") {
+			job.limits.max_cycles = number;
+		} else if(key == "max-time") {
+			job.limits.max_time_ms = number * 1000;
+		} else if(key == "hang-cycles") {
+			job.limits.progress_cycles = number;
+		} else if(key == "halt-port") {
+			job.halt_port = number;
+		} else if(key == "exit-ip") {
+			job.exit_ip = number;
+		} else if(key == "expect") {
+			job.expected_status = number;
+		} else {
+			logError() << "unknown job option \"" << key << "\"\n";
+			return std::nullopt;
+		}
+	}
+
+	return job;
+}
+
+std::optional<std::vector<FarmJob>> readJobList(const std::string &path, const FarmJob &defaults) {
+	std::ifstream stream(path);
+	if(!stream.is_open()) {
+		logError() << "could not open job list " << path << "\n";
+		return std::nullopt;
+	}
+
+	std::vector<FarmJob> jobs;
+	std::map<std::string, std::shared_ptr<const MemoryImage>> images;
+
+	std::string line;
+	usize line_number = 0;
+	while(std::getline(stream, line)) {
+		line_number++;
+
+		const usize first = line.find_first_not_of(" \t\r");
+		if(first == std::string::npos || line[first] == '#') {
+			continue;
+		}
+
+		std::optional<FarmJob> job = FarmJob::parse(line, defaults);
+		if(!job.has_value()) {
+			logError() << "in " << path << ":" << line_number << "\n";
+			return std::nullopt;
+		}
+
+		/* parsing exits on invalid images, so this has to happen before any
+		 * worker is started */
+		std::shared_ptr<const MemoryImage> &image = images[job->image_path];
+		if(image == nullptr) {
+			std::ifstream image_stream(job->image_path, std::ios::in | std::ios::binary);
+			if(!image_stream.is_open()) {
+				logError() << "could not open image " << job->image_path << "\n";
+				return std::nullopt;
+			}
+
+			const std::vector<u8> contents(
+				(std::istreambuf_iterator<char>(image_stream)), std::istreambuf_iterator<char>());
+			image = std::make_shared<const MemoryImage>(parseMRIFromBytes(contents));
+		}
+
+		job->image = image;
+		jobs.push_back(std::move(job.value()));
+	}
+
+	return jobs;
+}
+
+FarmResult runFarmJob(System &system, const FarmJob &job) {
+	FarmResult result{};
+	std::ostringstream report;
+
+	system.reset();
+	system.loadImage(*job.image);
+
+	/* console output of a job is discarded unless it names a file */
+	if(!system.setConsole({
+		   .headless = true,
+		   .input = job.console_in,
+		   .output = job.console_out.empty() ? "/dev/null" : job.console_out,
+	   })) {
+		result.reason = System::StopReason::NONE;
+		result.report = "could not open the console files\n";
+		return result;
+	}
+
+	if(job.halt_port.has_value()) {
+		system.setHaltPort(job.halt_port.value());
+	}
+
+	if(job.exit_ip.has_value()) {
+		system.setExitIp(job.exit_ip.value());
+	}
+
+	if(job.limits.max_cycles != 0 || job.limits.max_time_ms != 0 ||
+	   job.limits.progress_cycles != 0) {
+		system.setHangLimits(job.limits, report);
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	system.run();
+	result.seconds =
+		std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	result.reason = system.stopReason();
+	result.guest_status = system.guestStatus();
+	result.cycles = system.cpu().perfCounters().cycles;
+	result.retired = system.cpu().perfCounters().retired;
+	result.report = report.str();
+
+	/* without an expected status any clean halt or reaching the exit ip passes */
+	if(job.expected_status.has_value()) {
+		result.passed = result.reason == System::StopReason::HALT &&
+						result.guest_status == job.expected_status.value();
+	} else {
+		result.passed = (result.reason == System::StopReason::HALT && result.guest_status == 0) ||
+						result.reason == System::StopReason::EXIT_IP;
+	}
+
+	return result;
+}
+
+static void writeJsonString(std::ostream &stream, const std::string &str) {
+	stream << '"';
+	for(const char c: str) {
+		if(c == '"' || c == '\\') {
+			stream << '\\' << c;
+		} else if(static_cast<u8>(c) < 0x20) {
+			stream << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+				   << static_cast<u16>(c) << std::dec << std::setfill(' ');
+		} else {
+			stream << c;
+		}
+	}
+	stream << '"';
+}
+
+void writeFarmReport(
+	std::ostream &stream,
+	const std::vector<FarmJob> &jobs,
+	const std::vector<FarmResult> &results,
+	double seconds) {
+	usize passed = 0;
+	for(const FarmResult &result: results) {
+		passed += result.passed ? 1 : 0;
+	}
+
+	stream << "{\n"
+		   << "  \"jobs\": " << results.size() << ",\n"
+		   << "  \"passed\": " << passed << ",\n"
+		   << "  \"failed\": " << results.size() - passed << ",\n"
+		   << "  \"wall_seconds\": " << seconds << ",\n"
+		   << "  \"results\": [";
+
+	for(usize ix = 0; ix < results.size(); ix++) {
+		const FarmResult &result = results[ix];
+		stream << (ix == 0 ? "\n" : ",\n") << "    {\"image\": ";
+		writeJsonString(stream, jobs[ix].image_path);
+		stream << ", \"stop_reason\": \"" << System::stopReasonName(result.reason) << "\""
+			   << ", \"guest_status\": " << result.guest_status
+			   << ", \"cycles\": " << result.cycles << ", \"retired\": " << result.retired
+			   << ", \"seconds\": " << result.seconds
+			   << ", \"passed\": " << (result.passed ? "true" : "false") << "}";
+	}
+
+	stream << "\n  ]\n}\n";
+}
+
+}  // namespace mfdemu::impl
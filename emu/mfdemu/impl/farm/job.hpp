@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MFDEMU_IMPL_FARM_JOB_HPP
+#define MFDEMU_IMPL_FARM_JOB_HPP
+
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <shared/typedefs.hpp>
+
+#include <mfdemu/impl/hang_detector.hpp>
+#include <mfdemu/impl/system.hpp>
+
+namespace mfdemu::impl {
+
+/**
+ * @brief One emulator run of a farm. Job lists hold one job per line, the MRI
+ * path followed by options in key=value form:
+ *
+ *   in=<path>          console input, nothing is read without it
+ *   out=<path>         console output, discarded without it
+ *   max-cycles=<n>     cycle budget
+ *   max-time=<s>       wall clock budget in seconds
+ *   hang-cycles=<n>    stop after n cycles without progress
+ *   halt-port=<port>   port of the HaltDevice
+ *   exit-ip=<address>  stop once this instruction is reached
+ *   expect=<status>    status the guest has to halt with to pass
+ *
+ * Empty lines and lines starting with # are ignored. Options which are not
+ * given are taken from the defaults passed to the parser.
+ */
+struct FarmJob {
+	std::string image_path;
+	std::string console_in;
+	std::string console_out;
+	HangDetector::Limits limits{};
+	std::optional<u16> halt_port;
+	std::optional<u16> exit_ip;
+	std::optional<u16> expected_status;
+
+	/** parsed image, shared by all jobs running the same file */
+	std::shared_ptr<const MemoryImage> image;
+
+	static std::optional<FarmJob> parse(const std::string &line, const FarmJob &defaults);
+};
+
+struct FarmResult {
+	System::StopReason reason;
+	u16 guest_status;
+	u64 cycles;
+	u64 retired;
+	double seconds;
+	bool passed;
+
+	/** hang report, empty unless the hang detector stopped the run */
+	std::string report;
+};
+
+/**
+ * @brief Read a job list and parse every distinct image once.
+ */
+std::optional<std::vector<FarmJob>> readJobList(const std::string &path, const FarmJob &defaults);
+
+/**
+ * @brief Run a job on a System which is reset first, so that it can be reused.
+ */
+FarmResult runFarmJob(System &system, const FarmJob &job);
+
+/**
+ * @brief Write all results and a summary as a JSON object.
+ */
+void writeFarmReport(
+	std::ostream &stream,
+	const std::vector<FarmJob> &jobs,
+	const std::vector<FarmResult> &results,
+	double seconds);
+
+}  // namespace mfdemu::impl
+
+#endif
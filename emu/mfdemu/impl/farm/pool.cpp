@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <thread>
+
+#include <mfdemu/impl/farm/pool.hpp>
+
+namespace mfdemu::impl {
+
+WorkStealingPool::WorkStealingPool(usize workers)
+	: m_queues(workers > 0 ? workers : std::max(1U, std::thread::hardware_concurrency())) {}
+
+bool WorkStealingPool::takeOwn(usize worker, usize &task) {
+	Queue &queue = m_queues[worker];
+	const std::lock_guard<std::mutex> lock(queue.mutex);
+	if(queue.tasks.empty()) {
+		return false;
+	}
+
+	task = queue.tasks.back();
+	queue.tasks.pop_back();
+	return true;
+}
+
+bool WorkStealingPool::steal(usize worker, usize &task) {
+	for(usize offset = 1; offset < m_queues.size(); offset++) {
+		Queue &victim = m_queues[(worker + offset) % m_queues.size()];
+		const std::lock_guard<std::mutex> lock(victim.mutex);
+		if(!victim.tasks.empty()) {
+			task = victim.tasks.front();
+			victim.tasks.pop_front();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void WorkStealingPool::run(usize count, const Task &task) {
+	/* tasks are never added while running, so empty queues everywhere mean
+	 * there is nothing left to steal */
+	for(usize ix = 0; ix < count; ix++) {
+		m_queues[ix % m_queues.size()].tasks.push_back(ix);
+	}
+
+	auto work = [this, &task](usize worker) {
+		usize next = 0;
+		while(takeOwn(worker, next) || steal(worker, next)) {
+			task(worker, next);
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for(usize worker = 1; worker < m_queues.size(); worker++) {
+		threads.emplace_back(work, worker);
+	}
+
+	work(0);
+	for(std::thread &thread: threads) {
+		thread.join();
+	}
+}
+
+}  // namespace mfdemu::impl
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MFDEMU_IMPL_FARM_POOL_HPP
+#define MFDEMU_IMPL_FARM_POOL_HPP
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include <shared/typedefs.hpp>
+
+namespace mfdemu::impl {
+
+/**
+ * @brief Runs a fixed set of tasks on worker threads. Tasks are dealt out to
+ * per-worker queues up front. A worker takes tasks from the back of its own
+ * queue and, once that is empty, steals from the front of the others, so
+ * long-running tasks do not leave the remaining workers idle.
+ */
+class WorkStealingPool {
+   public:
+	/** @brief Called with the index of the worker and of the task. */
+	using Task = std::function<void(usize worker, usize task)>;
+
+	/**
+	 * @param workers Number of threads, 0 uses one per hardware thread.
+	 */
+	explicit WorkStealingPool(usize workers);
+
+	usize workers() const { return m_queues.size(); }
+
+	/**
+	 * @brief Run the tasks 0..count-1 and return once all of them finished.
+	 */
+	void run(usize count, const Task &task);
+
+   private:
+	struct alignas(64) Queue {
+		std::mutex mutex;
+		std::deque<usize> tasks;
+	};
+
+	bool takeOwn(usize worker, usize &task);
+	bool steal(usize worker, usize &task);
+
+	std::vector<Queue> m_queues;
+};
+
+}  // namespace mfdemu::impl
+
+#endif
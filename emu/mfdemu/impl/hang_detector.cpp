@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <iomanip>
+
+#include <mfdemu/impl/hang_detector.hpp>
+#include <mfdemu/impl/instructions.hpp>
+
+namespace mfdemu::impl {
+
+HangDetector::HangDetector(const Cpu &cpu, Limits limits)
+	: m_cpu(cpu), m_limits(limits), m_start(std::chrono::steady_clock::now()) {
+	m_nextSample = std::min(m_cpu.cycles() + SAMPLE_INTERVAL, cycleLimit());
+	resetWindow();
+}
+
+const char *HangDetector::reasonName(Reason reason) {
+	switch(reason) {
+	case Reason::NONE:
+		return "none";
+	case Reason::NO_PROGRESS:
+		return "no forward progress";
+	case Reason::CYCLE_LIMIT:
+		return "cycle limit reached";
+	case Reason::TIME_LIMIT:
+		return "time limit reached";
+	}
+
+	return "";
+}
+
+u64 HangDetector::progressEvents() const {
+	using State = Cpu::CpuState;
+	const PerfCounters &perf = m_cpu.perfCounters();
+	return perf.gio_reads + perf.gio_writes +
+		   perf.state_cycles[static_cast<usize>(State::HARD_INTERRUPT)] +
+		   perf.state_cycles[static_cast<usize>(State::INTERRUPT)];
+}
+
+void HangDetector::resetWindow() {
+	m_windowStart = m_cpu.cycles();
+	m_windowEvents = progressEvents();
+	m_ipSet.clear();
+}
+
+HangDetector::Reason HangDetector::sample() {
+	const u64 cycles = m_cpu.cycles();
+	m_nextSample = std::min(cycles + SAMPLE_INTERVAL, cycleLimit());
+
+	if(cycles >= cycleLimit()) {
+		return Reason::CYCLE_LIMIT;
+	}
+
+	if(m_limits.max_time_ms > 0) {
+		const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+			std::chrono::steady_clock::now() - m_start);
+		if(static_cast<u64>(elapsed.count()) >= m_limits.max_time_ms) {
+			return Reason::TIME_LIMIT;
+		}
+	}
+
+	if(m_limits.progress_cycles == 0) {
+		return Reason::NONE;
+	}
+
+	if(progressEvents() != m_windowEvents) {
+		resetWindow();
+		return Reason::NONE;
+	}
+
+	const u16 ip = m_cpu.ip();
+	if(std::find(m_ipSet.begin(), m_ipSet.end(), ip) == m_ipSet.end()) {
+		if(m_ipSet.size() == IP_SET_SIZE) {
+			resetWindow();
+		}
+		m_ipSet.push_back(ip);
+	}
+
+	return cycles - m_windowStart >= m_limits.progress_cycles ? Reason::NO_PROGRESS
+															   : Reason::NONE;
+}
+
+void HangDetector::writeReport(std::ostream &stream, Reason reason) const {
+	stream << "stopped: " << reasonName(reason) << " at cycle " << m_cpu.cycles() << "\n";
+
+	stream << std::hex << std::setfill('0');
+	if(reason == Reason::NO_PROGRESS) {
+		stream << "looping over:";
+		for(const u16 ip: m_ipSet) {
+			stream << " 0x" << std::setw(4) << ip;
+		}
+		stream << "\n";
+	}
+
+	stream << "registers:";
+	const Cpu::RegisterFile registers = m_cpu.registerFile();
+	for(usize ix = 0; ix < registers.size(); ix++) {
+		stream << " " << REGISTER_NAMES[Cpu::REGISTER_FILE_IDS[ix]] << "=0x" << std::setw(4)
+			   << registers[ix];
+	}
+	stream << std::dec << std::setfill(' ') << "\n";
+
+	if(m_cpu.trace() != nullptr) {
+		m_cpu.trace()->write(stream);
+	}
+}
+
+}  // namespace mfdemu::impl
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MFDEMU_IMPL_HANG_DETECTOR_HPP
+#define MFDEMU_IMPL_HANG_DETECTOR_HPP
+
+#include <chrono>
+#include <ostream>
+#include <vector>
+
+#include <shared/typedefs.hpp>
+
+#include <mfdemu/impl/cpu.hpp>
+
+namespace mfdemu::impl {
+
+/**
+ * @brief Budgets and forward progress check for unattended runs. The Cpu is
+ * only sampled every SAMPLE_INTERVAL cycles. A run makes no progress if every
+ * sampled instruction pointer falls into a set of at most IP_SET_SIZE addresses
+ * and no GIO access or interrupt happened for the configured number of cycles.
+ */
+class HangDetector {
+   public:
+	static constexpr u64 SAMPLE_INTERVAL = 4096;
+	static constexpr usize IP_SET_SIZE = 16;
+
+	enum class Reason : u8 {
+		NONE,
+		NO_PROGRESS,
+		CYCLE_LIMIT,
+		TIME_LIMIT,
+	};
+
+	/** @brief Limits which are 0 are disabled. */
+	struct Limits {
+		u64 max_cycles;
+		u64 max_time_ms;
+		u64 progress_cycles;
+	};
+
+	HangDetector(const Cpu &cpu, Limits limits);
+
+	/**
+	 * @brief Called after every cycle, returns why the run should stop.
+	 */
+	Reason check() {
+		if(m_cpu.cycles() < m_nextSample) {
+			return Reason::NONE;
+		}
+
+		return sample();
+	}
+
+	/** @brief First cycle the run may not reach, UINT64_MAX if unlimited. */
+	u64 cycleLimit() const { return m_limits.max_cycles > 0 ? m_limits.max_cycles : UINT64_MAX; }
+
+	/**
+	 * @brief Write the reason, registers, call stack and instruction trace of
+	 * the Cpu as plain text.
+	 */
+	void writeReport(std::ostream &stream, Reason reason) const;
+
+	static const char *reasonName(Reason reason);
+
+   private:
+	Reason sample();
+	void resetWindow();
+	u64 progressEvents() const;
+
+	const Cpu &m_cpu;
+	Limits m_limits;
+	std::chrono::steady_clock::time_point m_start;
+
+	u64 m_nextSample{0};
+	u64 m_windowStart{0};
+	u64 m_windowEvents{0};
+	std::vector<u16> m_ipSet;
+};
+
+}  // namespace mfdemu::impl
+
+#endif
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <bit>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <vector>
+
+#include <shared/log.hpp>
+
+#include <mfdemu/impl/heatmap.hpp>
+
+namespace mfdemu::impl {
+
+bool MemoryHeatmap::writePpm(const std::string &path) const {
+	std::ofstream stream(path, std::ios::out | std::ios::trunc | std::ios::binary);
+	if(!stream.is_open()) {
+		logError() << "could not open \"" << path << "\" for writing the heatmap\n";
+		return false;
+	}
+
+	std::array<u64, ACCESS_COUNT> max{};
+	for(u8 access = 0; access < ACCESS_COUNT; access++) {
+		max[access] = *std::max_element(m_counts[access].cbegin(), m_counts[access].cend());
+	}
+
+	/* log2 scaling, so a handful of accesses is still visible next to hot loops */
+	auto scale = [](u64 value, u64 max_value) -> char {
+		if(value == 0) {
+			return 0;
+		}
+
+		const u64 bits = std::bit_width(value);
+		const u64 max_bits = std::bit_width(max_value);
+		return static_cast<char>(0x20 + ((bits * 0xdf) / max_bits));
+	};
+
+	stream << "P6\n256 256\n255\n";
+	for(u32 address = 0; address < 0x10000; address++) {
+		stream << scale(m_counts[WRITE][address], max[WRITE])
+			   << scale(m_counts[READ][address], max[READ])
+			   << scale(m_counts[EXECUTE][address], max[EXECUTE]);
+	}
+
+	return stream.good();
+}
+
+bool MemoryHeatmap::writeReport(const std::string &path, usize top) const {
+	std::ofstream stream(path, std::ios::out | std::ios::trunc);
+	if(!stream.is_open()) {
+		logError() << "could not open \"" << path << "\" for writing the heatmap report\n";
+		return false;
+	}
+
+	stream << std::setfill('0');
+
+	/* hot data addresses */
+
+	std::vector<u16> addresses;
+	for(u32 address = 0; address < 0x10000; address++) {
+		if(m_counts[READ][address] + m_counts[WRITE][address] > 0) {
+			addresses.push_back(address);
+		}
+	}
+
+	auto data_accesses = [this](u16 address) {
+		return m_counts[READ][address] + m_counts[WRITE][address];
+	};
+
+	const usize address_count = std::min(top, addresses.size());
+	std::partial_sort(
+		addresses.begin(), addresses.begin() + address_count, addresses.end(),
+		[&data_accesses](u16 lhs, u16 rhs) { return data_accesses(lhs) > data_accesses(rhs); });
+
+	stream << "# hot data addresses\n# rank address reads writes\n";
+	for(usize ix = 0; ix < address_count; ix++) {
+		const u16 address = addresses[ix];
+		stream << std::dec << std::setw(0) << ix + 1 << " 0x" << std::hex << std::setw(4) << address
+			   << std::dec << std::setw(0) << " " << m_counts[READ][address] << " "
+			   << m_counts[WRITE][address] << "\n";
+	}
+
+	/* hot pages */
+
+	std::array<std::array<u64, ACCESS_COUNT>, PAGE_COUNT> page_counts{};
+	for(u32 address = 0; address < 0x10000; address++) {
+		for(u8 access = 0; access < ACCESS_COUNT; access++) {
+			page_counts[address / PAGE_SIZE][access] += m_counts[access][address];
+		}
+	}
+
+	auto page_accesses = [&page_counts](usize page) {
+		return std::accumulate(page_counts[page].cbegin(), page_counts[page].cend(), 0ULL);
+	};
+
+	std::vector<usize> pages;
+	usize data_pages = 0;
+	for(usize page = 0; page < PAGE_COUNT; page++) {
+		if(page_accesses(page) == 0) {
+			continue;
+		}
+
+		pages.push_back(page);
+		data_pages += static_cast<usize>(page_counts[page][READ] + page_counts[page][WRITE] > 0);
+	}
+
+	const usize page_count = std::min(top, pages.size());
+	std::partial_sort(
+		pages.begin(), pages.begin() + page_count, pages.end(),
+		[&page_accesses](usize lhs, usize rhs) { return page_accesses(lhs) > page_accesses(rhs); });
+
+	stream << "\n# hot pages (" << PAGE_SIZE << " bytes)\n# rank page reads writes executes\n";
+	for(usize ix = 0; ix < page_count; ix++) {
+		const usize page = pages[ix];
+		stream << std::dec << std::setw(0) << ix + 1 << " 0x" << std::hex << std::setw(4)
+			   << page * PAGE_SIZE << std::dec << std::setw(0) << " " << page_counts[page][READ]
+			   << " " << page_counts[page][WRITE] << " " << page_counts[page][EXECUTE] << "\n";
+	}
+
+	/* working set */
+
+	stream << std::dec << std::setw(0) << "\n# working set\n"
+		   << "pages " << pages.size() << " (" << pages.size() * PAGE_SIZE << " bytes)\n"
+		   << "data pages " << data_pages << " (" << data_pages * PAGE_SIZE << " bytes)\n";
+
+	return stream.good();
+}
+
+}  // namespace mfdemu::impl
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MFDEMU_IMPL_HEATMAP_HPP
+#define MFDEMU_IMPL_HEATMAP_HPP
+
+#include <array>
+#include <string>
+
+#include <shared/typedefs.hpp>
+
+namespace mfdemu::impl {
+
+/**
+ * @brief Per-address access counters for the whole address space, recorded
+ * whenever the Cpu puts an address on the AIO bus.
+ */
+class MemoryHeatmap {
+   public:
+	enum Access : u8 {
+		READ,
+		WRITE,
+		EXECUTE,
+		ACCESS_COUNT,
+	};
+
+	static constexpr usize PAGE_SIZE = 0x100;
+	static constexpr usize PAGE_COUNT = 0x10000 / PAGE_SIZE;
+
+	void record(u16 address, Access access) { m_counts[access][address]++; }
+
+	u64 count(u16 address, Access access) const { return m_counts[access][address]; }
+
+	/**
+	 * @brief Write the heatmap as a 256x256 binary PPM image where each pixel is
+	 * one address (one row per page). Writes are shown in red, data reads in
+	 * green and instruction fetches in blue, each on a logarithmic scale.
+	 */
+	bool writePpm(const std::string &path) const;
+
+	/**
+	 * @brief Write a plain text report ranking the hottest data addresses and
+	 * pages, followed by the working set size.
+	 * @param top Number of entries listed per ranking.
+	 */
+	bool writeReport(const std::string &path, usize top) const;
+
+   private:
+	std::array<std::array<u64, 0x10000>, ACCESS_COUNT> m_counts{};
+};
+
+}  // namespace mfdemu::impl
+
+#endif
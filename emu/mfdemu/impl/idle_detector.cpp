@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <mfdemu/impl/idle_detector.hpp>
+
+namespace mfdemu::impl {
+
+u64 IdleDetector::sideEffects() const {
+	const PerfCounters &perf = m_cpu.perfCounters();
+	return perf.abus_writes + perf.gio_writes + m_ioBus.volatileReads();
+}
+
+void IdleDetector::arm() {
+	m_armed = true;
+	m_confirmed = false;
+	m_headIp = m_cpu.ip();
+	m_headCycle = m_cpu.cycles();
+	m_headRegisters = m_cpu.registerFile();
+	m_headIrq = m_cpu.irq;
+	m_headSideEffects = sideEffects();
+}
+
+bool IdleDetector::observeBoundary() {
+	if(!m_armed || m_cpu.ip() != m_headIp) {
+		if(!m_armed || m_cpu.cycles() - m_headCycle > WINDOW) {
+			arm();
+		}
+		return false;
+	}
+
+	const u64 period = m_cpu.cycles() - m_headCycle;
+	if(sideEffects() != m_headSideEffects || m_cpu.irq != m_headIrq ||
+	   m_cpu.registerFile() != m_headRegisters) {
+		arm();
+		return false;
+	}
+
+	/* the first iteration may have started in the middle of the loop */
+	if(!m_confirmed || period != m_period) {
+		m_confirmed = true;
+		m_period = period;
+		m_headCycle = m_cpu.cycles();
+		m_headPerf = m_cpu.perfCounters();
+		return false;
+	}
+
+	return true;
+}
+
+u64 IdleDetector::skip(u64 limit) {
+	const u64 cycles = m_cpu.cycles();
+	const u64 iterations = limit > cycles ? (limit - cycles) / m_period : 0;
+	if(iterations > 0) {
+		m_cpu.fastForward(m_headPerf, iterations);
+	}
+
+	m_headCycle = m_cpu.cycles();
+	m_headPerf = m_cpu.perfCounters();
+	return iterations * m_period;
+}
+
+}  // namespace mfdemu::impl
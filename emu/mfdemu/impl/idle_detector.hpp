@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MFDEMU_IMPL_IDLE_DETECTOR_HPP
+#define MFDEMU_IMPL_IDLE_DETECTOR_HPP
+
+#include <shared/typedefs.hpp>
+
+#include <mfdemu/impl/bus/gio_bus.hpp>
+#include <mfdemu/impl/cpu.hpp>
+#include <mfdemu/impl/perf_counters.hpp>
+
+namespace mfdemu::impl {
+
+/**
+ * @brief Detects loops which can not make progress on their own, like
+ * "_wait: jmp _wait" or polling a status port. A loop is idle if two
+ * consecutive iterations return to the same instruction with the same
+ * registers and IRQ level, took the same number of cycles and neither wrote
+ * memory, wrote a GIO port nor read a GIO port whose value may change outside
+ * of scheduled events. Such a loop repeats unchanged until the next event, so
+ * whole iterations can be skipped.
+ */
+class IdleDetector {
+   public:
+	/** @brief Loops longer than this many cycles are not detected. */
+	static constexpr u64 WINDOW = 256;
+
+	IdleDetector(Cpu &cpu, const GioBus &io_bus) : m_cpu(cpu), m_ioBus(io_bus) {}
+
+	/**
+	 * @brief Called after every cycle, true if the Cpu is at the head of an
+	 * idle loop. skip() must be called whenever this returns true.
+	 */
+	bool observe() {
+		if(!m_cpu.atInstructionBoundary()) {
+			return false;
+		}
+
+		return observeBoundary();
+	}
+
+	/**
+	 * @brief Skip as many whole iterations as fit before limit, accounting
+	 * their cycles to the Cpu counters.
+	 * @return The number of cycles skipped.
+	 */
+	u64 skip(u64 limit);
+
+	u64 period() const { return m_period; }
+
+   private:
+	bool observeBoundary();
+	void arm();
+	u64 sideEffects() const;
+
+	Cpu &m_cpu;
+	const GioBus &m_ioBus;
+
+	bool m_armed{false};
+	bool m_confirmed{false};
+	u16 m_headIp{0};
+	u64 m_headCycle{0};
+	u64 m_period{0};
+	Cpu::RegisterFile m_headRegisters{};
+	bool m_headIrq{false};
+	u64 m_headSideEffects{0};
+
+	/** counters at the start of the current iteration, once confirmed */
+	PerfCounters m_headPerf;
+};
+
+}  // namespace mfdemu::impl
+
+#endif
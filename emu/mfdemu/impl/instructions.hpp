@@ -18,6 +18,8 @@
 #ifndef MFDEMU_IMPL_INSTRUCTIONS_HPP
 #define MFDEMU_IMPL_INSTRUCTIONS_HPP
 
+#include <array>
+
 #include <shared/typedefs.hpp>
 
 namespace mfdemu::impl {
@@ -101,6 +103,173 @@ constexpr u8 OPCODE_SUB = 0x4b;
 constexpr u8 OPCODE_TEST = 0x4c;
 constexpr u8 OPCODE_XOR = 0x4d;
 
+/**
+ * @brief Mnemonics of all opcodes, indexed by opcode. Reserved opcodes map to
+ * an empty string.
+ */
+constexpr std::array<const char *, 0x4e> INSTRUCTION_NAMES = {
+	/* 0x00 */ "ADC",
+	/* 0x01 */ "ADD",
+	/* 0x02 */ "AND",
+	/* 0x03 */ "BIN",
+	/* 0x04 */ "BOT",
+	/* 0x05 */ "CALL",
+	/* 0x06 */ "",
+	/* 0x07 */ "CMP",
+	/* 0x08 */ "DEC",
+	/* 0x09 */ "DIV",
+	/* 0x0a */ "IDIV",
+	/* 0x0b */ "IMUL",
+	/* 0x0c */ "IN",
+	/* 0x0d */ "INC",
+	/* 0x0e */ "INT",
+	/* 0x0f */ "IRET",
+	/* 0x10 */ "JMP",
+	/* 0x11 */ "JZ",
+	/* 0x12 */ "JG",
+	/* 0x13 */ "JGE",
+	/* 0x14 */ "JL",
+	/* 0x15 */ "JLE",
+	/* 0x16 */ "JC",
+	/* 0x17 */ "JS",
+	/* 0x18 */ "JNZ",
+	/* 0x19 */ "JNC",
+	/* 0x1a */ "JNS",
+	/* 0x1b */ "LD",
+	/* 0x1c */ "MOV",
+	/* 0x1d */ "MUL",
+	/* 0x1e */ "NEG",
+	/* 0x1f */ "NOP",
+	/* 0x20 */ "NOT",
+	/* 0x21 */ "OR",
+	/* 0x22 */ "OUT",
+	/* 0x23 */ "POP",
+	/* 0x24 */ "PUSH",
+	/* 0x25 */ "RET",
+	/* 0x26 */ "ROL",
+	/* 0x27 */ "ROR",
+	/* 0x28 */ "SL",
+	/* 0x29 */ "SR",
+	/* 0x2a */ "ST",
+	/* 0x2b */ "CLO",
+	/* 0x2c */ "CLC",
+	/* 0x2d */ "CLZ",
+	/* 0x2e */ "CLN",
+	/* 0x2f */ "CLI",
+	/* 0x30 */ "",
+	/* 0x31 */ "",
+	/* 0x32 */ "",
+	/* 0x33 */ "",
+	/* 0x34 */ "",
+	/* 0x35 */ "",
+	/* 0x36 */ "",
+	/* 0x37 */ "",
+	/* 0x38 */ "",
+	/* 0x39 */ "",
+	/* 0x3a */ "",
+	/* 0x3b */ "STO",
+	/* 0x3c */ "STC",
+	/* 0x3d */ "STZ",
+	/* 0x3e */ "STN",
+	/* 0x3f */ "STI",
+	/* 0x40 */ "",
+	/* 0x41 */ "",
+	/* 0x42 */ "",
+	/* 0x43 */ "",
+	/* 0x44 */ "",
+	/* 0x45 */ "",
+	/* 0x46 */ "",
+	/* 0x47 */ "",
+	/* 0x48 */ "",
+	/* 0x49 */ "",
+	/* 0x4a */ "",
+	/* 0x4b */ "SUB",
+	/* 0x4c */ "TEST",
+	/* 0x4d */ "XOR",
+};
+
+/** @brief Number of operands of each opcode, indexed by opcode. */
+constexpr std::array<u8, 0x4e> INSTRUCTION_OPERAND_COUNT = {
+	/* 0x00: ADC .........*/ 1,
+	/* 0x01: ADD .........*/ 1,
+	/* 0x02: AND .........*/ 1,
+	/* 0x03: BIN .........*/ 2,
+	/* 0x04: BOT .........*/ 2,
+	/* 0x05: CALL ........*/ 1,
+	/* 0x06: _RESERVED_00 */ 0,
+	/* 0x07: CMP .........*/ 2,
+	/* 0x08: DEC .........*/ 1,
+	/* 0x09: DIV .........*/ 1,
+	/* 0x0a: IDIV ........*/ 1,
+	/* 0x0b: IMUL ........*/ 1,
+	/* 0x0c: IN ..........*/ 2,
+	/* 0x0d: INC .........*/ 1,
+	/* 0x0e: INT .........*/ 1,
+	/* 0x0f: IRET ........*/ 0,
+	/* 0x10: JMP .........*/ 1,
+	/* 0x11: JZ ..........*/ 1,
+	/* 0x12: JG ..........*/ 1,
+	/* 0x13: JGE .........*/ 1,
+	/* 0x14: JL ..........*/ 1,
+	/* 0x15: JLE .........*/ 1,
+	/* 0x16: JC ..........*/ 1,
+	/* 0x17: JS ..........*/ 1,
+	/* 0x18: JNZ .........*/ 1,
+	/* 0x19: JNC .........*/ 1,
+	/* 0x1a: JNS .........*/ 1,
+	/* 0x1b: LD ..........*/ 2,
+	/* 0x1c: MOV .........*/ 2,
+	/* 0x1d: MUL .........*/ 1,
+	/* 0x1e: NEG .........*/ 1,
+	/* 0x1f: NOP .........*/ 0,
+	/* 0x20: NOT .........*/ 1,
+	/* 0x21: OR ..........*/ 1,
+	/* 0x22: OUT .........*/ 2,
+	/* 0x23: POP .........*/ 1,
+	/* 0x24: PUSH ........*/ 1,
+	/* 0x25: RET .........*/ 0,
+	/* 0x26: ROL .........*/ 2,
+	/* 0x27: ROR .........*/ 2,
+	/* 0x28: SL ..........*/ 2,
+	/* 0x29: SR ..........*/ 2,
+	/* 0x2a: ST ..........*/ 2,
+	/* 0x2b: CLO .........*/ 0,
+	/* 0x2c: CLC .........*/ 0,
+	/* 0x2d: CLZ .........*/ 0,
+	/* 0x2e: CLN .........*/ 0,
+	/* 0x2f: CLI .........*/ 0,
+	/* 0x30: _RESERVED_01 */ 0,
+	/* 0x31: _RESERVED_02 */ 0,
+	/* 0x32: _RESERVED_03 */ 0,
+	/* 0x33: _RESERVED_04 */ 0,
+	/* 0x34: _RESERVED_05 */ 0,
+	/* 0x35: _RESERVED_06 */ 0,
+	/* 0x36: _RESERVED_07 */ 0,
+	/* 0x37: _RESERVED_08 */ 0,
+	/* 0x38: _RESERVED_09 */ 0,
+	/* 0x39: _RESERVED_10 */ 0,
+	/* 0x3a: _RESERVED_11 */ 0,
+	/* 0x3b: STO .........*/ 0,
+	/* 0x3c: STC .........*/ 0,
+	/* 0x3d: STZ .........*/ 0,
+	/* 0x3e: STN .........*/ 0,
+	/* 0x3f: STI .........*/ 0,
+	/* 0x40: _RESERVED_12 */ 0,
+	/* 0x41: _RESERVED_13 */ 0,
+	/* 0x42: _RESERVED_14 */ 0,
+	/* 0x43: _RESERVED_15 */ 0,
+	/* 0x44: _RESERVED_16 */ 0,
+	/* 0x45: _RESERVED_17 */ 0,
+	/* 0x46: _RESERVED_18 */ 0,
+	/* 0x47: _RESERVED_19 */ 0,
+	/* 0x48: _RESERVED_20 */ 0,
+	/* 0x49: _RESERVED_21 */ 0,
+	/* 0x4a: _RESERVED_22 */ 0,
+	/* 0x4b: SUB .........*/ 1,
+	/* 0x4c: TEST ........*/ 1,
+	/* 0x4d: XOR .........*/ 1,
+};
+
 /** registers */
 
 constexpr u8 REGISTER_AL = 0x00;
@@ -121,6 +290,12 @@ constexpr u8 REGISTER_AR = 0x0e;
 constexpr u8 REGISTER_FL = 0x0f;
 constexpr u8 REGISTER_IID = 0x10;
 
+/** lower case register names as used in assembly, indexed by register id */
+constexpr std::array<const char *, 0x11> REGISTER_NAMES = {
+	"al", "ah", "acl", "bl", "bh", "bcl", "cl", "ch", "ccl",
+	"dl", "dh", "dcl", "sp", "ip", "ar", "fl", "iid",
+};
+
 }  // namespace mfdemu::impl
 
 #endif
\ No newline at end of file
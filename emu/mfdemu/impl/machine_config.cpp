@@ -0,0 +1,531 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <shared/log.hpp>
+
+#include <mfdemu/impl/bus/gio_device.hpp>
+#include <mfdemu/impl/bus/interrupts.hpp>
+#include <mfdemu/impl/devices/dma.hpp>
+#include <mfdemu/impl/devices/pic.hpp>
+#include <mfdemu/impl/devices/plugin.hpp>
+#include <mfdemu/impl/devices/pmu.hpp>
+#include <mfdemu/impl/devices/storage.hpp>
+#include <mfdemu/impl/devices/timer.hpp>
+#include <mfdemu/impl/machine_config.hpp>
+
+namespace mfdemu::impl {
+
+static constexpr u64 NANOSECONDS = 1000 * 1000 * 1000;
+
+static std::string trim(const std::string &str) {
+	const usize first = str.find_first_not_of(" \t\r");
+	if(first == std::string::npos) {
+		return "";
+	}
+
+	return str.substr(first, str.find_last_not_of(" \t\r") - first + 1);
+}
+
+static std::optional<u64> parseNumber(const std::string &str) {
+	char *end = nullptr;
+	const u64 value = std::strtoull(str.c_str(), &end, 0);
+	if(str.empty() || *end != '\0') {
+		return std::nullopt;
+	}
+
+	return value;
+}
+
+/** <first>[:<last>] */
+static std::optional<std::pair<u16, u16>> parseRange(const std::string &str) {
+	const usize colon = str.find(':');
+	const std::optional<u64> first = parseNumber(trim(str.substr(0, colon)));
+	const std::optional<u64> last =
+		colon == std::string::npos ? first : parseNumber(trim(str.substr(colon + 1)));
+
+	if(!first.has_value() || !last.has_value() || first.value() > last.value() ||
+	   last.value() > UINT16_MAX) {
+		return std::nullopt;
+	}
+
+	return std::make_pair(first.value(), last.value());
+}
+
+/** one [kind name] section while parsing */
+struct Section {
+	std::string kind;
+	std::string name;
+	usize line;
+	std::vector<std::pair<std::string, std::string>> entries;
+
+	const std::string *get(const std::string &key) const {
+		for(const auto &[entry_key, value]: entries) {
+			if(entry_key == key) {
+				return &value;
+			}
+		}
+
+		return nullptr;
+	}
+};
+
+static std::optional<MachineConfig::Memory> parseMemory(
+	const Section &section, const std::string &name) {
+	const std::string *range_str = section.get("range");
+	const std::string *type = section.get("type");
+	const std::string *mri_device = section.get("mri-device");
+
+	const std::optional<std::pair<u16, u16>> range =
+		range_str != nullptr ? parseRange(*range_str) : std::nullopt;
+	if(!range.has_value() || range->first % AioDevice::PAGE_SIZE != 0 ||
+	   (range->second + 1) % AioDevice::PAGE_SIZE != 0) {
+		logError() << name << ":" << section.line << ": memory \"" << section.name
+				   << "\" needs a page aligned range = <first>:<last>\n";
+		return std::nullopt;
+	}
+
+	MachineConfig::Memory memory{
+		.name = section.name,
+		.first = range->first,
+		.last = range->second,
+		.access = AioDevice::Access::READ_WRITE,
+		.mri_device = 0,
+	};
+
+	if(type == nullptr || *type == "ram") {
+		memory.access = AioDevice::Access::READ_WRITE;
+	} else if(*type == "rom") {
+		memory.access = AioDevice::Access::READ_ONLY;
+	} else if(*type == "none") {
+		memory.access = AioDevice::Access::NONE;
+	} else {
+		logError() << name << ":" << section.line << ": unknown memory type \"" << *type
+				   << "\"\n";
+		return std::nullopt;
+	}
+
+	if(mri_device != nullptr) {
+		const std::optional<u64> device = parseNumber(*mri_device);
+		if(!device.has_value() || device.value() > UINT32_MAX) {
+			logError() << name << ":" << section.line << ": invalid mri-device \""
+					   << *mri_device << "\"\n";
+			return std::nullopt;
+		}
+		memory.mri_device = device.value();
+	}
+
+	return memory;
+}
+
+/** ports taken from the given one by devices with a fixed register layout, 0 otherwise */
+static u32 fixedPortCount(MachineConfig::DeviceType type) {
+	switch(type) {
+	case MachineConfig::DeviceType::PMU:
+		return PmuDevice::PORT_COUNT;
+	case MachineConfig::DeviceType::STORAGE:
+		return StorageDevice::PORT_COUNT;
+	case MachineConfig::DeviceType::DMA:
+		return DmaDevice::PORT_COUNT;
+	case MachineConfig::DeviceType::TIMER:
+		return TimerDevice::PORT_COUNT;
+	case MachineConfig::DeviceType::PIC:
+		return PicDevice::PORT_COUNT;
+	default:
+		return 0;
+	}
+}
+
+/** interrupt lines taken from irq on, 0 if the device has none */
+static u32 interruptLines(MachineConfig::DeviceType type) {
+	switch(type) {
+	case MachineConfig::DeviceType::TERMINAL:
+	case MachineConfig::DeviceType::STORAGE:
+	case MachineConfig::DeviceType::DMA:
+	case MachineConfig::DeviceType::PLUGIN:
+		return 1;
+	case MachineConfig::DeviceType::TIMER:
+		return TimerDevice::CHANNEL_COUNT;
+	case MachineConfig::DeviceType::PIC:
+		return PicDevice::INPUT_COUNT;
+	default:
+		return 0;
+	}
+}
+
+static std::optional<MachineConfig::Device> parseDevice(
+	const Section &section, const std::string &name) {
+	const std::string *ports = section.get("ports");
+	const std::string *type = section.get("type");
+	const std::string *path = section.get("path");
+	const std::string *params = section.get("params");
+	const std::string *irq = section.get("irq");
+	const std::string *cycles_per_word = section.get("cycles-per-word");
+
+	const std::optional<std::pair<u16, u16>> range =
+		ports != nullptr ? parseRange(*ports) : std::nullopt;
+	if(!range.has_value()) {
+		logError() << name << ":" << section.line << ": device \"" << section.name
+				   << "\" needs ports = <first>[:<last>]\n";
+		return std::nullopt;
+	}
+
+	MachineConfig::Device device{
+		.name = section.name,
+		.type = MachineConfig::DeviceType::PLUGIN,
+		.first = range->first,
+		.last = range->second,
+		.path = path != nullptr ? *path : "",
+		.params = params != nullptr ? *params : "",
+	};
+
+	if(type == nullptr) {
+		logError() << name << ":" << section.line << ": device \"" << section.name
+				   << "\" has no type\n";
+		return std::nullopt;
+	} else if(*type == "terminal") {
+		device.type = MachineConfig::DeviceType::TERMINAL;
+	} else if(*type == "halt") {
+		device.type = MachineConfig::DeviceType::HALT;
+	} else if(*type == "pmu") {
+		device.type = MachineConfig::DeviceType::PMU;
+	} else if(*type == "plugin") {
+		device.type = MachineConfig::DeviceType::PLUGIN;
+	} else if(*type == "storage") {
+		device.type = MachineConfig::DeviceType::STORAGE;
+	} else if(*type == "dma") {
+		device.type = MachineConfig::DeviceType::DMA;
+	} else if(*type == "timer") {
+		device.type = MachineConfig::DeviceType::TIMER;
+	} else if(*type == "pic") {
+		device.type = MachineConfig::DeviceType::PIC;
+	} else {
+		logError() << name << ":" << section.line << ": unknown device type \"" << *type
+				   << "\"\n";
+		return std::nullopt;
+	}
+
+	if(device.path.empty() && (device.type == MachineConfig::DeviceType::PLUGIN ||
+								  device.type == MachineConfig::DeviceType::STORAGE)) {
+		logError() << name << ":" << section.line << ": " << *type << " \"" << section.name
+				   << "\" needs a path\n";
+		return std::nullopt;
+	}
+
+	/* a terminal may have a status port right after its data port */
+	if(device.type == MachineConfig::DeviceType::TERMINAL && device.last - device.first > 1) {
+		logError() << name << ":" << section.line << ": terminal \"" << section.name
+				   << "\" takes a data and an optional status port\n";
+		return std::nullopt;
+	}
+
+	if(device.type != MachineConfig::DeviceType::PLUGIN &&
+	   device.type != MachineConfig::DeviceType::TERMINAL && device.first != device.last) {
+		logError() << name << ":" << section.line << ": device \"" << section.name
+				   << "\" takes a single port\n";
+		return std::nullopt;
+	}
+
+	if(irq != nullptr) {
+		const std::optional<u64> id = parseNumber(*irq);
+		const u32 lines = interruptLines(device.type);
+		if(lines == 0) {
+			logError() << name << ":" << section.line << ": device \"" << section.name
+					   << "\" can not interrupt\n";
+			return std::nullopt;
+		}
+
+		if(!id.has_value() || id.value() + lines > InterruptSink::LINE_COUNT) {
+			logError() << name << ":" << section.line << ": invalid irq \"" << *irq << "\"\n";
+			return std::nullopt;
+		}
+		device.irq = id.value();
+	}
+
+	if(cycles_per_word != nullptr) {
+		device.cycles_per_word = parseNumber(*cycles_per_word);
+		if(device.type != MachineConfig::DeviceType::DMA) {
+			logError() << name << ":" << section.line << ": device \"" << section.name
+					   << "\" has no cycles-per-word\n";
+			return std::nullopt;
+		}
+
+		if(!device.cycles_per_word.has_value()) {
+			logError() << name << ":" << section.line << ": invalid cycles-per-word \""
+					   << *cycles_per_word << "\"\n";
+			return std::nullopt;
+		}
+	}
+
+	const u32 port_count = fixedPortCount(device.type);
+	if(port_count > 0 && device.first + port_count - 1 > UINT16_MAX) {
+		logError() << name << ":" << section.line << ": " << *type << " \"" << section.name
+				   << "\" does not fit below port 0xffff\n";
+		return std::nullopt;
+	}
+
+	return device;
+}
+
+std::optional<MachineConfig> MachineConfig::read(const std::string &path) {
+	std::ifstream stream(path);
+	if(!stream.is_open()) {
+		logError() << "could not open machine file \"" << path << "\"\n";
+		return std::nullopt;
+	}
+
+	return parse(stream, path);
+}
+
+std::optional<MachineConfig> MachineConfig::parse(std::istream &stream, const std::string &name) {
+	std::vector<Section> sections;
+	std::string raw_line;
+	usize line_number = 0;
+
+	while(std::getline(stream, raw_line)) {
+		line_number++;
+		const std::string line = trim(raw_line);
+		if(line.empty() || line[0] == ';' || line[0] == '#') {
+			continue;
+		}
+
+		if(line[0] == '[') {
+			if(line.back() != ']') {
+				logError() << name << ":" << line_number << ": unterminated section header\n";
+				return std::nullopt;
+			}
+
+			const std::string header = trim(line.substr(1, line.size() - 2));
+			const usize space = header.find_first_of(" \t");
+			sections.push_back({
+				.kind = header.substr(0, space),
+				.name = space == std::string::npos ? "" : trim(header.substr(space)),
+				.line = line_number,
+				.entries = {},
+			});
+			continue;
+		}
+
+		const usize equals = line.find('=');
+		if(equals == std::string::npos || sections.empty()) {
+			logError() << name << ":" << line_number << ": expected <key> = <value>\n";
+			return std::nullopt;
+		}
+
+		sections.back().entries.emplace_back(
+			trim(line.substr(0, equals)), trim(line.substr(equals + 1)));
+	}
+
+	MachineConfig config;
+	for(const Section &section: sections) {
+		if(section.kind == "machine") {
+			const std::string *clock = section.get("clock");
+			if(clock == nullptr) {
+				continue;
+			}
+
+			config.clock_hz = parseNumber(*clock);
+			if(!config.clock_hz.has_value()) {
+				logError() << name << ":" << section.line << ": invalid clock \"" << *clock
+						   << "\"\n";
+				return std::nullopt;
+			}
+		} else if(section.kind == "memory") {
+			const std::optional<Memory> memory = parseMemory(section, name);
+			if(!memory.has_value()) {
+				return std::nullopt;
+			}
+			config.memory.push_back(memory.value());
+		} else if(section.kind == "device") {
+			const std::optional<Device> device = parseDevice(section, name);
+			if(!device.has_value()) {
+				return std::nullopt;
+			}
+
+			const auto is_pic = [](const Device &other) { return other.type == DeviceType::PIC; };
+			if(is_pic(device.value()) &&
+			   std::any_of(config.devices.begin(), config.devices.end(), is_pic)) {
+				logError() << name << ":" << section.line
+						   << ": there can only be one interrupt controller\n";
+				return std::nullopt;
+			}
+			config.devices.push_back(device.value());
+		} else {
+			logError() << name << ":" << section.line << ": unknown section \"" << section.kind
+					   << "\"\n";
+			return std::nullopt;
+		}
+	}
+
+	/* with an interrupt controller only its inputs reach the Cpu */
+	const auto pic =
+		std::find_if(config.devices.begin(), config.devices.end(), [](const Device &device) {
+			return device.type == DeviceType::PIC;
+		});
+	if(pic != config.devices.end()) {
+		const u32 first = pic->irq.value_or(0);
+		for(const Device &device: config.devices) {
+			if(device.type == DeviceType::PIC || !device.irq.has_value()) {
+				continue;
+			}
+
+			if(*device.irq < first ||
+			   *device.irq + interruptLines(device.type) > first + PicDevice::INPUT_COUNT) {
+				logError() << name << ": irq of device \"" << device.name
+						   << "\" is not an input of pic \"" << pic->name << "\"\n";
+				return std::nullopt;
+			}
+		}
+	}
+
+	return config;
+}
+
+u64 MachineConfig::cycleSpan() const {
+	return clock_hz.value() == 0 ? 0 : std::max<u64>(NANOSECONDS / clock_hz.value(), 1);
+}
+
+std::vector<u8> MachineConfig::memoryImage(const std::vector<u8> &mri_data) const {
+	constexpr usize DEVICE_SIZE = 0x10000;
+	if(memory.empty()) {
+		std::vector<u8> result(
+			mri_data.begin(),
+			mri_data.begin() + static_cast<std::ptrdiff_t>(std::min(mri_data.size(), DEVICE_SIZE)));
+		result.resize(DEVICE_SIZE);
+		return result;
+	}
+
+	std::vector<u8> result(DEVICE_SIZE);
+	for(const Memory &region: memory) {
+		const usize base = region.mri_device * DEVICE_SIZE;
+		for(usize address = region.first; address <= region.last; address++) {
+			result[address] = base + address < mri_data.size() ? mri_data[base + address] : 0;
+		}
+	}
+
+	return result;
+}
+
+bool MachineConfig::apply(System &system) const {
+	if(!memory.empty()) {
+		AioDevice &main_memory = system.mainMemory();
+		main_memory.setAccess(0, AioDevice::PAGE_COUNT - 1, AioDevice::Access::NONE);
+		for(const Memory &region: memory) {
+			main_memory.setAccess(
+				region.first / AioDevice::PAGE_SIZE, region.last / AioDevice::PAGE_SIZE,
+				region.access);
+		}
+	}
+
+	system.setConsolePort(std::nullopt);
+	for(const Device &device: devices) {
+		/* devices on the GIO bus are mapped after the switch */
+		std::shared_ptr<GioDevice> io_device;
+		u16 last = device.last;
+		switch(device.type) {
+		case DeviceType::TERMINAL:
+			system.setConsolePort(device.first);
+			system.setConsoleStatusPort(
+				device.last != device.first ? std::optional<u16>(device.last) : std::nullopt);
+			system.setConsoleInterrupt(device.irq);
+			break;
+		case DeviceType::HALT:
+			system.setHaltPort(device.first);
+			break;
+		case DeviceType::PMU:
+			io_device = std::make_shared<PmuDevice>(device.first, system.cpu().perfCounters());
+			last = device.first + PmuDevice::PORT_COUNT - 1;
+			break;
+		case DeviceType::STORAGE: {
+			auto storage = std::make_shared<StorageDevice>(
+				device.first, system.mainMemory(), system.scheduler(),
+				system.cpu().perfCounters());
+			if(!storage->open(device.path)) {
+				return false;
+			}
+			if(device.irq.has_value()) {
+				storage->setInterrupt(&system.interrupts(), *device.irq);
+			}
+			io_device = std::move(storage);
+			last = device.first + StorageDevice::PORT_COUNT - 1;
+			break;
+		}
+		case DeviceType::DMA: {
+			auto dma = std::make_shared<DmaDevice>(
+				device.first, system.mainMemory(), system.scheduler(),
+				system.cpu().perfCounters(),
+				device.cycles_per_word.value_or(DmaDevice::DEFAULT_CYCLES_PER_WORD));
+			if(device.irq.has_value()) {
+				dma->setInterrupt(&system.interrupts(), *device.irq);
+			}
+			io_device = std::move(dma);
+			last = device.first + DmaDevice::PORT_COUNT - 1;
+			break;
+		}
+		case DeviceType::TIMER: {
+			auto timer = std::make_shared<TimerDevice>(
+				device.first, system.scheduler(), system.cpu().perfCounters());
+			if(device.irq.has_value()) {
+				timer->setInterrupt(&system.interrupts(), *device.irq);
+			}
+			io_device = std::move(timer);
+			last = device.first + TimerDevice::PORT_COUNT - 1;
+			break;
+		}
+		case DeviceType::PIC: {
+			auto pic = std::make_shared<PicDevice>(
+				device.first, system.interrupts(), device.irq.value_or(0));
+			system.setInterruptController(pic.get());
+			io_device = std::move(pic);
+			last = device.first + PicDevice::PORT_COUNT - 1;
+			break;
+		}
+		case DeviceType::PLUGIN: {
+			std::shared_ptr<PluginDevice> plugin = loadPlugin({
+				.path = device.path,
+				.first = device.first,
+				.last = device.last,
+				.params = device.params,
+			});
+			if(plugin == nullptr) {
+				return false;
+			}
+			if(device.irq.has_value()) {
+				plugin->setInterrupt(&system.interrupts(), *device.irq);
+			}
+			io_device = std::move(plugin);
+			break;
+		}
+		}
+
+		if(io_device != nullptr && !system.mapIoDevice(device.first, last, std::move(io_device))) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+}  // namespace mfdemu::impl
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MFDEMU_IMPL_MACHINE_CONFIG_HPP
+#define MFDEMU_IMPL_MACHINE_CONFIG_HPP
+
+#include <istream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <shared/typedefs.hpp>
+
+#include <mfdemu/impl/bus/aio_device.hpp>
+#include <mfdemu/impl/system.hpp>
+
+namespace mfdemu::impl {
+
+/**
+ * @brief Description of a board variant, read from a machine file:
+ *
+ *   ; comments start with ';' or '#'
+ *   [machine]
+ *   clock = 1000000            ; Hz, 0 runs unthrottled
+ *
+ *   [memory rom]               ; AIO address range, page aligned
+ *   range = 0xc000:0xffff
+ *   type = rom                 ; ram, rom or none
+ *   mri-device = 1             ; MRI load device the contents come from
+ *
+ *   [device console]           ; GIO port range
+ *   ports = 0x1000:0x1001      ; terminal: data and optional status port
+ *   type = terminal            ; terminal, halt, pmu, storage, dma, timer, pic or plugin
+ *   irq = 1                    ; interrupt id, first of one per channel for a timer,
+ *                              ; first input line for a pic (default 0)
+ *   cycles-per-word = 1        ; dma only, transfer cost
+ *   path = ./dev.so            ; plugin shared object or storage image
+ *   params = ...               ; plugin only
+ *
+ * Addresses not covered by a memory section read as 0. Without memory
+ * sections the whole address space is RAM loaded from MRI device 0, without
+ * a terminal device there is no console. There may be one pic device, the
+ * Cpu is interrupted through it then and the irq of every other device must
+ * be one of its inputs. apply() resolves everything into the flat per-page
+ * and per-port tables of the buses.
+ */
+struct MachineConfig {
+	struct Memory {
+		std::string name;
+		u16 first;
+		u16 last;
+		AioDevice::Access access;
+		u32 mri_device;
+	};
+
+	enum class DeviceType : u8 {
+		TERMINAL,
+		HALT,
+		PMU,
+		PLUGIN,
+		STORAGE,
+		DMA,
+		TIMER,
+		PIC,
+	};
+
+	struct Device {
+		std::string name;
+		DeviceType type;
+		u16 first;
+		u16 last;
+		std::string path;
+		std::string params;
+		std::optional<u8> irq;
+		std::optional<u64> cycles_per_word;
+	};
+
+	/** cycles per second, 0 runs unthrottled */
+	std::optional<u64> clock_hz;
+	std::vector<Memory> memory;
+	std::vector<Device> devices;
+
+	static std::optional<MachineConfig> read(const std::string &path);
+	static std::optional<MachineConfig> parse(std::istream &stream, const std::string &name);
+
+	/**
+	 * @brief Nanoseconds per cycle as used by System, the clock must be set.
+	 */
+	u64 cycleSpan() const;
+
+	/**
+	 * @brief Main memory contents built from the parsed MRI. Padded images
+	 * hold the data of load device n at n * 0x10000, compact images only
+	 * hold device 0.
+	 */
+	std::vector<u8> memoryImage(const std::vector<u8> &mri_data) const;
+
+	/**
+	 * @brief Set the memory access of system and map the devices, the memory
+	 * contents must be loaded already.
+	 */
+	bool apply(System &system) const;
+};
+
+}  // namespace mfdemu::impl
+
+#endif
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <array>
+#include <ostream>
+
+#include <mfdemu/impl/instructions.hpp>
+#include <mfdemu/impl/perf_counters.hpp>
+
+namespace mfdemu::impl {
+
+/** names of Cpu::CpuState values, in declaration order */
+static constexpr std::array<const char *, PerfCounters::STATE_COUNT> STATE_NAMES = {
+	"ABUS_READ", "ABUS_READ_INDIRECT", "ABUS_WRITE", "ABUS_WRITE_INDIRECT",
+	"GIO_READ",	 "GIO_WRITE",		   "INST_EXEC",	 "INST_FETCH",
+	"RESET",	 "HARD_INTERRUPT",	   "INTERRUPT",
+};
+
+void PerfCounters::repeat(const PerfCounters &start, u64 times) {
+	cycles += (cycles - start.cycles) * times;
+	retired += (retired - start.retired) * times;
+	abus_reads += (abus_reads - start.abus_reads) * times;
+	abus_writes += (abus_writes - start.abus_writes) * times;
+	gio_reads += (gio_reads - start.gio_reads) * times;
+	gio_writes += (gio_writes - start.gio_writes) * times;
+
+	for(usize ix = 0; ix < STATE_COUNT; ix++) {
+		state_cycles[ix] += (state_cycles[ix] - start.state_cycles[ix]) * times;
+	}
+
+	for(usize ix = 0; ix < opcodes.size(); ix++) {
+		Opcode &opcode = opcodes[ix];
+		const Opcode &start_opcode = start.opcodes[ix];
+		opcode.cycles += (opcode.cycles - start_opcode.cycles) * times;
+		opcode.retired += (opcode.retired - start_opcode.retired) * times;
+		opcode.bus_reads += (opcode.bus_reads - start_opcode.bus_reads) * times;
+		opcode.bus_writes += (opcode.bus_writes - start_opcode.bus_writes) * times;
+	}
+}
+
+PerfCounters::OpcodeSpan PerfCounters::opcodeSpan(u8 opcode) const {
+	return {
+		.opcode = opcode,
+		.cycles = cycles,
+		.abus_reads = abus_reads,
+		.abus_writes = abus_writes,
+		.gio_reads = gio_reads,
+		.gio_writes = gio_writes,
+		.state_cycles = state_cycles,
+		.counts = opcodes[opcode],
+	};
+}
+
+void PerfCounters::repeat(const OpcodeSpan &start, u64 times) {
+	cycles += (cycles - start.cycles) * times;
+	abus_reads += (abus_reads - start.abus_reads) * times;
+	abus_writes += (abus_writes - start.abus_writes) * times;
+	gio_reads += (gio_reads - start.gio_reads) * times;
+	gio_writes += (gio_writes - start.gio_writes) * times;
+
+	for(usize ix = 0; ix < STATE_COUNT; ix++) {
+		state_cycles[ix] += (state_cycles[ix] - start.state_cycles[ix]) * times;
+	}
+
+	Opcode &opcode = opcodes[start.opcode];
+	opcode.cycles += (opcode.cycles - start.counts.cycles) * times;
+	opcode.retired += (opcode.retired - start.counts.retired) * times;
+	opcode.bus_reads += (opcode.bus_reads - start.counts.bus_reads) * times;
+	opcode.bus_writes += (opcode.bus_writes - start.counts.bus_writes) * times;
+}
+
+void PerfCounters::writeJson(std::ostream &stream) const {
+	stream << "{\n"
+		   << "  \"cycles\": " << cycles << ",\n"
+		   << "  \"retired\": " << retired << ",\n"
+		   << "  \"abus_reads\": " << abus_reads << ",\n"
+		   << "  \"abus_writes\": " << abus_writes << ",\n"
+		   << "  \"gio_reads\": " << gio_reads << ",\n"
+		   << "  \"gio_writes\": " << gio_writes << ",\n"
+		   << "  \"states\": {";
+
+	for(usize ix = 0; ix < STATE_COUNT; ix++) {
+		stream << (ix == 0 ? "\n" : ",\n") << "    \"" << STATE_NAMES[ix]
+			   << "\": " << state_cycles[ix];
+	}
+
+	stream << "\n  },\n  \"opcodes\": {";
+
+	bool first = true;
+	for(usize ix = 0; ix < opcodes.size(); ix++) {
+		const Opcode &opcode = opcodes[ix];
+		if(ix == OPCODE_NONE || (opcode.cycles == 0 && opcode.retired == 0)) {
+			continue;
+		}
+
+		stream << (first ? "\n" : ",\n") << "    \"";
+		if(ix < INSTRUCTION_NAMES.size() && *INSTRUCTION_NAMES[ix] != '\0') {
+			stream << INSTRUCTION_NAMES[ix];
+		} else {
+			stream << "0x" << std::hex << ix << std::dec;
+		}
+
+		stream << "\": {"
+			   << "\"cycles\": " << opcode.cycles << ", \"retired\": " << opcode.retired
+			   << ", \"bus_reads\": " << opcode.bus_reads
+			   << ", \"bus_writes\": " << opcode.bus_writes << "}";
+		first = false;
+	}
+
+	stream << "\n  }\n}\n";
+}
+
+}  // namespace mfdemu::impl
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MFDEMU_IMPL_PERF_COUNTERS_HPP
+#define MFDEMU_IMPL_PERF_COUNTERS_HPP
+
+#include <array>
+#include <ostream>
+
+#include <shared/typedefs.hpp>
+
+namespace mfdemu::impl {
+
+/**
+ * @brief Built-in performance counters of the Cpu. These are updated
+ * unconditionally on every clock cycle and are cheap enough to stay enabled.
+ */
+struct PerfCounters {
+	/** @brief Number of values in Cpu::CpuState. */
+	static constexpr usize STATE_COUNT = 11;
+
+	/**
+	 * @brief Opcode slot used for cycles which are not spent executing an
+	 * instruction (fetching, resets, interrupts). No opcode uses this value.
+	 */
+	static constexpr u8 OPCODE_NONE = 0xff;
+
+	struct Opcode {
+		u64 cycles;
+		u64 retired;
+		u64 bus_reads;
+		u64 bus_writes;
+	};
+
+	u64 cycles{0};
+	u64 retired{0};
+
+	u64 abus_reads{0};
+	u64 abus_writes{0};
+	u64 gio_reads{0};
+	u64 gio_writes{0};
+
+	std::array<u64, STATE_COUNT> state_cycles{};
+	std::array<Opcode, 0x100> opcodes{};
+
+	/**
+	 * @brief The counters which advance while a single opcode executes and
+	 * nothing retires, cheaper to take than a copy of all counters.
+	 */
+	struct OpcodeSpan {
+		u8 opcode;
+		u64 cycles;
+		u64 abus_reads;
+		u64 abus_writes;
+		u64 gio_reads;
+		u64 gio_writes;
+		std::array<u64, STATE_COUNT> state_cycles;
+		Opcode counts;
+	};
+
+	OpcodeSpan opcodeSpan(u8 opcode) const;
+
+	/**
+	 * @brief Write all counters as a JSON object to the given stream.
+	 * Opcodes which were never executed are omitted.
+	 */
+	void writeJson(std::ostream &stream) const;
+
+	/**
+	 * @brief Add the counts accumulated since start the given number of times
+	 * again, used when identical loop iterations are skipped.
+	 */
+	void repeat(const PerfCounters &start, u64 times);
+
+	/** @brief Same as repeat() for counts taken with opcodeSpan(). */
+	void repeat(const OpcodeSpan &start, u64 times);
+};
+
+}  // namespace mfdemu::impl
+
+#endif
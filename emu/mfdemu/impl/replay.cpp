@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <iterator>
+
+#include <shared/log.hpp>
+
+#include <mfdemu/impl/cpu.hpp>
+#include <mfdemu/impl/replay.hpp>
+
+namespace mfdemu::impl {
+
+InputRecorder::InputRecorder(const Cpu &cpu) : m_cpu(cpu) {}
+
+bool InputRecorder::open(const std::string &path) {
+	m_stream.open(path, std::ios::out | std::ios::trunc | std::ios::binary);
+	if(!m_stream.is_open()) {
+		logError() << "could not open \"" << path << "\" for recording\n";
+		return false;
+	}
+
+	m_stream.write(replay::MAGIC, sizeof(replay::MAGIC));
+	m_lastCycle = m_cpu.cycles();
+	return true;
+}
+
+void InputRecorder::gioRead(u8 value) {
+	writeRecord(replay::GIO_READ);
+	m_stream.put(static_cast<char>(value));
+}
+
+void InputRecorder::irq(bool level) {
+	writeRecord(level ? replay::IRQ_HIGH : replay::IRQ_LOW);
+}
+
+void InputRecorder::close() {
+	if(!m_stream.is_open()) {
+		return;
+	}
+
+	writeRecord(replay::END);
+	m_stream.close();
+}
+
+void InputRecorder::writeRecord(replay::RecordType type) {
+	m_stream.put(static_cast<char>(type));
+
+	u64 delta = m_cpu.cycles() - m_lastCycle;
+	m_lastCycle = m_cpu.cycles();
+	do {
+		const u8 byte = delta & 0x7f;
+		delta >>= 7;
+		m_stream.put(static_cast<char>(byte | (delta != 0 ? 0x80 : 0)));
+	} while(delta != 0);
+}
+
+InputReplayer::InputReplayer(const Cpu &cpu) : m_cpu(cpu) {}
+
+bool InputReplayer::open(const std::string &path) {
+	std::ifstream stream(path, std::ios::in | std::ios::binary);
+	if(!stream.is_open()) {
+		logError() << "could not open recording \"" << path << "\"\n";
+		return false;
+	}
+
+	const std::vector<u8> data(
+		(std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+	if(data.size() < sizeof(replay::MAGIC) ||
+	   !std::equal(std::begin(replay::MAGIC), std::end(replay::MAGIC), data.begin())) {
+		logError() << "\"" << path << "\" is not a recording\n";
+		return false;
+	}
+
+	u64 cycle = 0;
+	usize pos = sizeof(replay::MAGIC);
+	while(pos < data.size()) {
+		const u8 type = data[pos++];
+
+		u64 delta = 0;
+		for(u8 shift = 0; pos < data.size() && shift < 64; shift += 7) {
+			const u8 byte = data[pos++];
+			delta |= static_cast<u64>(byte & 0x7f) << shift;
+			if((byte & 0x80) == 0) {
+				break;
+			}
+		}
+		cycle += delta;
+
+		switch(type) {
+		case replay::END:
+			m_endCycle = cycle;
+			return true;
+		case replay::GIO_READ:
+			if(pos >= data.size()) {
+				break;
+			}
+			m_gioReads.push_back({.cycle = cycle, .value = data[pos++]});
+			continue;
+		case replay::IRQ_LOW:
+		case replay::IRQ_HIGH:
+			m_irqChanges.push_back({.cycle = cycle, .level = type == replay::IRQ_HIGH});
+			continue;
+		default:
+			break;
+		}
+
+		break;
+	}
+
+	logError() << "recording \"" << path << "\" is truncated or corrupt\n";
+	return false;
+}
+
+u8 InputReplayer::gioRead() {
+	if(m_gioIndex >= m_gioReads.size() || m_gioReads[m_gioIndex].cycle != m_cpu.cycles()) {
+		if(!m_diverged) {
+			logError() << "replay diverged from the recording at cycle " << m_cpu.cycles() << "\n";
+		}
+
+		m_diverged = true;
+		return 0;
+	}
+
+	return m_gioReads[m_gioIndex++].value;
+}
+
+bool InputReplayer::irq() {
+	while(m_irqIndex < m_irqChanges.size() && m_irqChanges[m_irqIndex].cycle <= m_cpu.cycles()) {
+		m_irq = m_irqChanges[m_irqIndex++].level;
+	}
+
+	return m_irq;
+}
+
+bool InputReplayer::finished() const {
+	return m_diverged || m_cpu.cycles() >= m_endCycle;
+}
+
+}  // namespace mfdemu::impl
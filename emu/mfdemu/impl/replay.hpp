@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MFDEMU_IMPL_REPLAY_HPP
+#define MFDEMU_IMPL_REPLAY_HPP
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <shared/typedefs.hpp>
+
+namespace mfdemu::impl {
+
+class Cpu;
+
+/**
+ * @brief Input log file format: the magic "MFDREC" and a version byte followed
+ * by records of a type byte, the LEB128 encoded number of cycles since the
+ * previous record and, for GIO reads, the value read.
+ */
+namespace replay {
+constexpr char MAGIC[] = {'M', 'F', 'D', 'R', 'E', 'C', 1};
+
+enum RecordType : u8 {
+	END = 0,
+	GIO_READ = 1,
+	IRQ_LOW = 2,
+	IRQ_HIGH = 3,
+};
+}  // namespace replay
+
+/**
+ * @brief Logs all nondeterministic inputs of a run: bytes read from GIO
+ * devices and changes of the IRQ line, stamped with the Cpu cycle.
+ */
+class InputRecorder {
+   public:
+	explicit InputRecorder(const Cpu &cpu);
+
+	bool open(const std::string &path);
+
+	void gioRead(u8 value);
+	void irq(bool level);
+
+	/**
+	 * @brief Mark the end of the recording at the current cycle.
+	 */
+	void close();
+
+   private:
+	void writeRecord(replay::RecordType type);
+
+	const Cpu &m_cpu;
+	std::ofstream m_stream;
+	u64 m_lastCycle{0};
+};
+
+/**
+ * @brief Feeds the inputs of a recording back at the cycles they were
+ * recorded at.
+ */
+class InputReplayer {
+   public:
+	explicit InputReplayer(const Cpu &cpu);
+
+	bool open(const std::string &path);
+
+	/**
+	 * @brief The next recorded GIO read, 0 once the recording is exhausted.
+	 * Marks the replay as diverged if the read happens at another cycle.
+	 */
+	u8 gioRead();
+
+	/**
+	 * @brief The recorded IRQ level for the current cycle.
+	 */
+	bool irq();
+
+	/**
+	 * @brief True once the end of the recording is reached or the run diverged
+	 * from it.
+	 */
+	bool finished() const;
+
+   private:
+	struct GioRead {
+		u64 cycle;
+		u8 value;
+	};
+
+	struct IrqChange {
+		u64 cycle;
+		bool level;
+	};
+
+	const Cpu &m_cpu;
+	std::vector<GioRead> m_gioReads;
+	std::vector<IrqChange> m_irqChanges;
+	usize m_gioIndex{0};
+	usize m_irqIndex{0};
+	bool m_irq{false};
+	u64 m_endCycle{0};
+	bool m_diverged{false};
+};
+
+}  // namespace mfdemu::impl
+
+#endif
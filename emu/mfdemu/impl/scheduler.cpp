@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <utility>
+
+#include <mfdemu/impl/scheduler.hpp>
+
+namespace mfdemu::impl {
+
+EventScheduler::EventId EventScheduler::schedule(u64 cycle, Callback callback) {
+	const EventId id{.cycle = cycle, .sequence = m_sequence++};
+	m_events.emplace(std::make_pair(id.cycle, id.sequence), std::move(callback));
+	return id;
+}
+
+void EventScheduler::cancel(EventId id) {
+	m_events.erase(std::make_pair(id.cycle, id.sequence));
+}
+
+void EventScheduler::runEvents(u64 cycle) {
+	while(!m_events.empty() && m_events.begin()->first.first <= cycle) {
+		const Callback callback = std::move(m_events.begin()->second);
+		m_events.erase(m_events.begin());
+		callback();
+	}
+}
+
+}  // namespace mfdemu::impl
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MFDEMU_IMPL_SCHEDULER_HPP
+#define MFDEMU_IMPL_SCHEDULER_HPP
+
+#include <functional>
+#include <map>
+#include <utility>
+
+#include <shared/typedefs.hpp>
+
+namespace mfdemu::impl {
+
+/**
+ * @brief Queue of device events keyed by the Cpu cycle they are due at. Events
+ * due at the same cycle run in the order they were scheduled. The System runs
+ * due events before every cycle and never fast-forwards past the next one.
+ */
+class EventScheduler {
+   public:
+	using Callback = std::function<void()>;
+
+	/** @brief Value of nextCycle() if no event is scheduled. */
+	static constexpr u64 NO_EVENT = UINT64_MAX;
+
+	struct EventId {
+		u64 cycle;
+		u64 sequence;
+	};
+
+	/**
+	 * @brief Run callback once the Cpu reached cycle. Callbacks may schedule
+	 * further events.
+	 */
+	EventId schedule(u64 cycle, Callback callback);
+
+	/** @brief Remove an event, does nothing if it already ran. */
+	void cancel(EventId id);
+
+	u64 nextCycle() const { return m_events.empty() ? NO_EVENT : m_events.begin()->first.first; }
+	bool empty() const { return m_events.empty(); }
+
+	/** @brief Run all events due at or before cycle. */
+	void runDue(u64 cycle) {
+		if(nextCycle() <= cycle) {
+			runEvents(cycle);
+		}
+	}
+
+   private:
+	void runEvents(u64 cycle);
+
+	std::map<std::pair<u64, u64>, Callback> m_events;
+	u64 m_sequence{0};
+};
+
+}  // namespace mfdemu::impl
+
+#endif
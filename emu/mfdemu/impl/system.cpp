@@ -15,107 +15,536 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
 #include <cstddef>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <memory>
-#include <termios.h>
 #include <utility>
 #include <vector>
 
 #include <fcntl.h>
 #include <unistd.h>
 
+#include <shared/log.hpp>
+
 #include <mfdemu/impl/bus/aio_device.hpp>
 #include <mfdemu/impl/bus/gio_device.hpp>
+#include <mfdemu/impl/devices/halt.hpp>
+#include <mfdemu/impl/devices/terminal.hpp>
+#include <mfdemu/impl/idle_detector.hpp>
 #include <mfdemu/impl/system.hpp>
 
 namespace mfdemu::impl {
 
-/**
- * @note this terminal device is temporary and will disappear as soon as the "device plugin" system
- * is implemented
- */
-class Terminal : public GioDevice {
-   public:
-	Terminal() : GioDevice() {
-		struct termios attr{};
-		tcgetattr(STDIN_FILENO, &attr);
-		attr.c_lflag &= ~(ICANON | ECHO);
-		tcsetattr(STDIN_FILENO, TCSANOW, &attr);
-	}
-
-   protected:
-	void write(u16 address, u8 value, bool low) override {
-		if(address != 0x1000 || low) {
-			return;
+System::System(u32 cycle_span, u16 main_memory_size)
+	: m_cycleSpan(cycle_span),
+	  m_mainMemory(std::make_shared<AioDevice>(false, main_memory_size)),
+	  m_ioBus(std::make_shared<GioBus>()) {
+	m_cpu.connectAddressDevice(m_mainMemory);
+	m_cpu.connectIoDevice(m_ioBus);
+}
+
+void System::setMainMemoryData(std::vector<u8> data) {
+	m_mainMemory->setData(std::move(data));
+}
+
+void System::loadImage(const MemoryImage &image) {
+	m_mainMemory->loadImage(image);
+}
+
+void System::reset() {
+	m_stopRequested.store(false, std::memory_order_relaxed);
+	m_perfDumpRequested.store(false, std::memory_order_relaxed);
+
+	m_waveform = nullptr;
+	m_debugger = nullptr;
+	m_watchpoints = Watchpoints();
+	m_history = nullptr;
+	m_recorder = nullptr;
+	m_replayer = nullptr;
+	m_recordedIrq = false;
+	m_idleSkip = true;
+	m_coverage = false;
+	m_scheduler = EventScheduler();
+	m_hangDetector = nullptr;
+	m_hangReport = nullptr;
+	m_console = nullptr;
+	m_consolePort = DEFAULT_CONSOLE_PORT;
+	m_consoleStatusPort = std::nullopt;
+	m_consoleInterrupt = std::nullopt;
+	m_exitIp = std::nullopt;
+	m_stopReason = StopReason::NONE;
+	m_guestStatus = 0;
+
+	m_mainMemory->setWatchpoints(nullptr);
+	m_ioBus = std::make_shared<GioBus>();
+	m_cpu.connectIoDevice(m_ioBus);
+	m_cpu.clear();
+}
+
+AioDevice &System::mainMemory() {
+	return *m_mainMemory;
+}
+
+bool System::mapIoDevice(u16 first, u16 last, std::shared_ptr<GioDevice> device) {
+	return m_ioBus->mapDevice(first, last, std::move(device));
+}
+
+void System::stop() {
+	m_stopRequested.store(true, std::memory_order_relaxed);
+}
+
+void System::requestPerfDump() {
+	m_perfDumpRequested.store(true, std::memory_order_relaxed);
+}
+
+void System::setPerfDumpHandler(std::function<void(const PerfCounters &)> handler) {
+	m_perfDumpHandler = std::move(handler);
+}
+
+bool System::enableWaveform(const std::string &path, VcdTrigger start, VcdTrigger stop) {
+	m_waveform = std::make_unique<VcdWriter>(start, stop);
+	if(!m_waveform->open(path)) {
+		m_waveform = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+bool System::attachDebuggerScript(const std::string &path) {
+	m_debugger = std::make_unique<Debugger>(m_cpu, *m_mainMemory, m_watchpoints);
+	if(!m_debugger->openScript(path)) {
+		m_debugger = nullptr;
+		return false;
+	}
+
+	m_watchpoints.attach(m_cpu);
+	m_mainMemory->setWatchpoints(&m_watchpoints);
+
+	return true;
+}
+
+bool System::attachDebuggerSocket(const std::string &path) {
+	m_debugger = std::make_unique<Debugger>(m_cpu, *m_mainMemory, m_watchpoints);
+	if(!m_debugger->openSocket(path)) {
+		m_debugger = nullptr;
+		return false;
+	}
+
+	m_watchpoints.attach(m_cpu);
+	m_mainMemory->setWatchpoints(&m_watchpoints);
+
+	m_debugger->setAbortCheck([this] { return m_stopRequested.load(std::memory_order_relaxed); });
+	return true;
+}
+
+void System::enableHistory(u64 interval, usize capacity) {
+	m_history = std::make_unique<History>(m_cpu, *m_mainMemory, interval, capacity);
+	m_ioBus->setHistory(m_history.get());
+}
+
+bool System::startRecording(const std::string &path) {
+	m_recorder = std::make_unique<InputRecorder>(m_cpu);
+	if(!m_recorder->open(path)) {
+		m_recorder = nullptr;
+		return false;
+	}
+
+	m_ioBus->setRecorder(m_recorder.get());
+	return true;
+}
+
+bool System::startReplay(const std::string &path) {
+	m_replayer = std::make_unique<InputReplayer>(m_cpu);
+	if(!m_replayer->open(path)) {
+		m_replayer = nullptr;
+		return false;
+	}
+
+	m_ioBus->setReplayer(m_replayer.get());
+	m_cycleSpan = 0;
+	return true;
+}
+
+void System::sampleWaveform() {
+	m_waveform->sample({
+		.cycle = m_cpu.cycles() - 1,
+		.ip = m_cpu.ip(),
+		.aio = m_mainMemory->io,
+		.gio = m_ioBus->io,
+		.clk = m_cpu.clk(),
+		.ams = m_cpu.ams(),
+		.gms = m_cpu.gms(),
+		.ira = m_cpu.ira(),
+		.irq = m_cpu.irq,
+		.reset = m_cpu.reset,
+	});
+}
+
+void System::setHangLimits(HangDetector::Limits limits, std::ostream &report) {
+	m_cpu.enableTrace();
+	m_hangDetector = std::make_unique<HangDetector>(m_cpu, limits);
+	m_hangReport = &report;
+}
+
+bool System::setConsole(const ConsoleConfig &config) {
+	if(!config.headless) {
+		m_console = std::make_shared<Terminal>();
+		return true;
+	}
+
+	int input = -1;
+	if(!config.input.empty()) {
+		input = ::open(config.input.c_str(), O_RDONLY | O_CLOEXEC);
+		if(input < 0) {
+			logError() << "could not open console input \"" << config.input << "\"\n";
+			return false;
+		}
+	}
+
+	int output = -1;
+	if(!config.output.empty()) {
+		output = ::open(config.output.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+		if(output < 0) {
+			logError() << "could not open console output \"" << config.output << "\"\n";
+			if(input >= 0) {
+				::close(input);
+			}
+			return false;
 		}
+	}
+
+	m_console = std::make_shared<Terminal>(input, output);
+	return true;
+}
+
+void System::setConsolePort(std::optional<u16> port) {
+	m_consolePort = port;
+}
+
+void System::setConsoleStatusPort(std::optional<u16> port) {
+	m_consoleStatusPort = port;
+}
+
+void System::setConsoleInterrupt(std::optional<u8> id) {
+	m_consoleInterrupt = id;
+}
+
+void System::setHaltPort(u16 port) {
+	m_ioBus->mapDevice(port, port, std::make_shared<HaltDevice>(port, [this](u16 status) {
+		m_guestStatus = status;
+		m_stopReason = StopReason::HALT;
+		m_stopRequested.store(true, std::memory_order_relaxed);
+	}));
+}
+
+void System::setExitIp(u16 ip) {
+	m_exitIp = ip;
+	m_cpu.breakpoints().set(ip, std::nullopt);
+}
+
+const char *System::stopReasonName(StopReason reason) {
+	switch(reason) {
+	case StopReason::NONE:
+		return "none";
+	case StopReason::HALT:
+		return "halt";
+	case StopReason::EXIT_IP:
+		return "exit_ip";
+	case StopReason::NO_PROGRESS:
+		return "no_progress";
+	case StopReason::CYCLE_LIMIT:
+		return "cycle_limit";
+	case StopReason::TIME_LIMIT:
+		return "time_limit";
+	}
+
+	return "";
+}
 
-		std::cout << value;
+bool System::writeStateJson(const std::string &path, const std::vector<MemoryRange> &ranges) const {
+	std::ofstream stream(path, std::ios::out | std::ios::trunc);
+	if(!stream.is_open()) {
+		logError() << "could not open \"" << path << "\" for writing the state dump\n";
+		return false;
 	}
-	u8 read(u16 address, bool low) override {
-		if(address != 0x1000 || low) {
-			return 0;
+
+	const PerfCounters &perf = m_cpu.perfCounters();
+	stream << "{\n"
+		   << "  \"reason\": \"" << stopReasonName(m_stopReason) << "\",\n"
+		   << "  \"guest_status\": " << m_guestStatus << ",\n"
+		   << "  \"cycles\": " << perf.cycles << ",\n"
+		   << "  \"retired\": " << perf.retired << ",\n"
+		   << "  \"registers\": {";
+
+	const Cpu::RegisterFile registers = m_cpu.registerFile();
+	for(usize ix = 0; ix < registers.size(); ix++) {
+		stream << (ix == 0 ? "" : ", ") << "\"" << REGISTER_NAMES[Cpu::REGISTER_FILE_IDS[ix]]
+			   << "\": " << registers[ix];
+	}
+
+	/* memory contents are given as hex strings, one byte per two digits */
+	stream << "},\n  \"memory\": [";
+	for(usize ix = 0; ix < ranges.size(); ix++) {
+		const auto [first, last] = ranges[ix];
+		stream << (ix == 0 ? "\n" : ",\n") << "    {\"address\": " << first << ", \"data\": \""
+			   << std::hex << std::setfill('0');
+		for(u32 address = first; address <= last; address++) {
+			stream << std::setw(2) << static_cast<u32>(m_mainMemory->readByte(address));
 		}
+		stream << std::dec << "\"}";
+	}
+
+	stream << (ranges.empty() ? "]\n}\n" : "\n  ]\n}\n");
+	return true;
+}
+
+void System::setIdleSkip(bool enabled) {
+	m_idleSkip = enabled;
+}
+
+void System::setCoverage(bool enabled) {
+	m_coverage = enabled;
+}
+
+EventScheduler &System::scheduler() {
+	return m_scheduler;
+}
+
+InterruptSink &System::interrupts() {
+	return m_ioBus->interrupts();
+}
 
-		// NOLINTBEGIN
-		u8 in[1];
-		usize n = ::read(STDIN_FILENO, in, 1);
-		// NOLINTEND
+void System::setInterruptController(InterruptController *controller) {
+	m_ioBus->setInterruptController(controller);
+}
+
+Cpu &System::cpu() {
+	return m_cpu;
+}
+
+const Cpu &System::cpu() const {
+	return m_cpu;
+}
 
-		return n > 0 ? in[0] : 0;
+/** the debugger socket is polled every 64K cycles */
+static constexpr u64 DEBUGGER_POLL_MASK = 0xffff;
+
+/** at most this many cycles are skipped at once so that stop requests are seen */
+static constexpr u64 IDLE_SKIP_LIMIT = 0x10000;
+
+/** buffered console output is checked for its flush deadline every 4K cycles */
+static constexpr u64 CONSOLE_FLUSH_INTERVAL = 0x1000;
+
+static System::StopReason toStopReason(HangDetector::Reason reason) {
+	switch(reason) {
+	case HangDetector::Reason::NONE:
+		break;
+	case HangDetector::Reason::NO_PROGRESS:
+		return System::StopReason::NO_PROGRESS;
+	case HangDetector::Reason::CYCLE_LIMIT:
+		return System::StopReason::CYCLE_LIMIT;
+	case HangDetector::Reason::TIME_LIMIT:
+		return System::StopReason::TIME_LIMIT;
 	}
-};
 
-System::System(u32 cycle_span, u16 main_memory_size)
-	: m_cycleSpan(cycle_span), m_mainMemory(std::make_shared<AioDevice>(false, main_memory_size)) {
-	m_cpu.connectAddressDevice(m_mainMemory);
+	return System::StopReason::NONE;
 }
 
-void System::setMainMemoryData(std::vector<u8> data) {
-	m_mainMemory->setData(std::move(data));
+static void sleepUntil(u64 time) {
+	constexpr u64 NANOSECONDS = 1000 * 1000 * 1000;
+	const struct timespec target{
+		.tv_sec = static_cast<__time_t>(time / NANOSECONDS),
+		.tv_nsec = static_cast<long>(time % NANOSECONDS),
+	};
+
+	while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &target, nullptr) == EINTR) {
+	}
+}
+
+u64 System::skipLimit() const {
+	u64 limit = m_scheduler.nextCycle();
+	if(m_hangDetector != nullptr) {
+		limit = std::min(limit, m_hangDetector->cycleLimit());
+	}
+	return limit;
 }
 
 void System::run() {
 	struct timespec ts{};
 	u64 last_time = 0;
+	u64 next_console_flush = 0;
 
 #ifdef SHOW_CYCLES
 	u64 last_speed_time = 0;
 	u64 cycles = 0;
 #endif
 
-	m_cpu.connectIoDevice(std::make_shared<Terminal>());
+	if(m_consolePort.has_value() && !m_ioBus->mapped(m_consolePort.value())) {
+		if(m_console == nullptr) {
+			m_console = std::make_shared<Terminal>();
+		}
+		m_ioBus->mapDevice(m_consolePort.value(), m_consolePort.value(), m_console);
+
+		if(m_consoleStatusPort.has_value() && !m_ioBus->mapped(m_consoleStatusPort.value())) {
+			m_console->setStatusPort(m_consoleStatusPort);
+			m_ioBus->mapDevice(
+				m_consoleStatusPort.value(), m_consoleStatusPort.value(), m_console);
+		}
+
+		if(m_consoleInterrupt.has_value()) {
+			m_console->setInterrupt(&m_ioBus->interrupts(), m_consoleInterrupt.value());
+		}
+		m_console->start();
+	}
 
 	/* trigger reset */
 	m_cpu.reset = true;
 	m_cpu.iclck();
+	if(m_waveform != nullptr) {
+		sampleWaveform();
+	}
 	m_cpu.reset = false;
 
-	while(true) {
-		assert(clock_gettime(CLOCK_MONOTONIC, &ts) == 0);
-		const u64 current_time =
-			(ts.tv_sec * (static_cast<__time_t>(1000 * 1000 * 1000))) + ts.tv_nsec;
+	/* skipping is not visible to the guest, but it is to per-cycle observers */
+	const bool block_transfers = m_waveform == nullptr && m_debugger == nullptr &&
+								 m_history == nullptr && m_cpu.heatmap() == nullptr &&
+								 !m_coverage;
+	std::unique_ptr<IdleDetector> idle_detector;
+	if(m_idleSkip && block_transfers && m_recorder == nullptr && m_replayer == nullptr) {
+		idle_detector = std::make_unique<IdleDetector>(m_cpu, *m_ioBus);
+	}
 
-#ifdef SHOW_CYCLES
-		if(current_time - last_speed_time > (1000 * 1000 * 1000)) {
-			std::cout << "\r" << cycles << " Hz" << std::flush;
-			last_speed_time = current_time;
-			cycles = 0;
+	if(m_debugger != nullptr) {
+		m_debugger->setHistory(m_history.get());
+		if(!m_debugger->attach()) {
+			return;
 		}
-#endif
+	}
 
-		if(current_time - last_time < m_cycleSpan) {
-			continue;
+	while(!m_stopRequested.load(std::memory_order_relaxed)) {
+		if(m_perfDumpRequested.load(std::memory_order_relaxed)) {
+			m_perfDumpRequested.store(false, std::memory_order_relaxed);
+			if(m_perfDumpHandler) {
+				m_perfDumpHandler(m_cpu.perfCounters());
+			}
 		}
 
+		/* a cycle span of 0 runs unthrottled */
+		if(m_cycleSpan > 0) {
+			assert(clock_gettime(CLOCK_MONOTONIC, &ts) == 0);
+			const u64 current_time =
+				(ts.tv_sec * (static_cast<__time_t>(1000 * 1000 * 1000))) + ts.tv_nsec;
+
 #ifdef SHOW_CYCLES
-		cycles++;
+			if(current_time - last_speed_time > (1000 * 1000 * 1000)) {
+				std::cout << "\r" << cycles << " Hz" << std::flush;
+				last_speed_time = current_time;
+				cycles = 0;
+			}
 #endif
 
-		last_time = current_time;
+			if(current_time - last_time < m_cycleSpan) {
+				continue;
+			}
+
+#ifdef SHOW_CYCLES
+			cycles++;
+#endif
+
+			last_time = current_time;
+		}
+
+		if(m_replayer != nullptr) {
+			if(m_replayer->finished()) {
+				break;
+			}
+			m_cpu.irq = m_replayer->irq();
+		} else {
+			m_cpu.irq = m_ioBus->interruptPending();
+			if(m_history != nullptr) {
+				m_cpu.irq = m_history->irq(m_cpu.irq);
+			}
+			if(m_recorder != nullptr && m_cpu.irq != m_recordedIrq) {
+				m_recordedIrq = m_cpu.irq;
+				m_recorder->irq(m_recordedIrq);
+			}
+		}
+
+		m_scheduler.runDue(m_cpu.cycles());
 
 		m_cpu.iclck();
+		if(m_cpu.stopped()) {
+			if(m_exitIp.has_value() && m_cpu.ip() == m_exitIp.value()) {
+				m_stopReason = StopReason::EXIT_IP;
+				break;
+			}
+
+			if(m_debugger == nullptr || !m_debugger->onStop()) {
+				break;
+			}
+			continue;
+		}
+
+		if(m_waveform != nullptr) {
+			sampleWaveform();
+		}
+
+		if(m_history != nullptr) {
+			m_history->tick();
+		}
+
+		u64 skipped = 0;
+		if(block_transfers && m_cpu.inBlockLoop()) {
+			skipped = m_cpu.blockTransfer(skipLimit());
+		} else if(idle_detector != nullptr && idle_detector->observe()) {
+			skipped = idle_detector->skip(
+				std::min(skipLimit(), m_cpu.cycles() + IDLE_SKIP_LIMIT));
+		}
+
+		/* keep the pace by sleeping through the skipped cycles */
+		if(skipped > 0 && m_cycleSpan > 0) {
+			last_time += skipped * m_cycleSpan;
+			sleepUntil(last_time);
+		}
+
+		if(m_hangDetector != nullptr) {
+			const HangDetector::Reason reason = m_hangDetector->check();
+			if(reason != HangDetector::Reason::NONE) {
+				m_stopReason = toStopReason(reason);
+				m_hangDetector->writeReport(*m_hangReport, reason);
+				break;
+			}
+		}
+
+		if(m_debugger != nullptr && (m_cpu.cycles() & DEBUGGER_POLL_MASK) == 0 &&
+		   !m_debugger->poll()) {
+			break;
+		}
+
+		/* compared against a cycle count since idle skipping jumps over cycles */
+		if(m_console != nullptr && m_cpu.cycles() >= next_console_flush) {
+			m_console->flushExpired();
+			next_console_flush = m_cpu.cycles() + CONSOLE_FLUSH_INTERVAL;
+		}
+	}
+
+	if(m_console != nullptr) {
+		m_console->flush();
+	}
+
+	if(m_waveform != nullptr) {
+		m_waveform->close();
+	}
+
+	if(m_recorder != nullptr) {
+		m_recorder->close();
 	}
 }
 
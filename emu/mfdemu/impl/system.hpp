@@ -18,27 +18,245 @@
 #ifndef MFDEMU_IMPL_SYSTEM_HPP
 #define MFDEMU_IMPL_SYSTEM_HPP
 
+#include <atomic>
+#include <functional>
+#include <iostream>
 #include <memory>
+#include <optional>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include <shared/typedefs.hpp>
 
 #include <mfdemu/impl/bus/aio_device.hpp>
+#include <mfdemu/impl/bus/gio_bus.hpp>
 #include <mfdemu/impl/cpu.hpp>
+#include <mfdemu/impl/debug/debugger.hpp>
+#include <mfdemu/impl/debug/history.hpp>
+#include <mfdemu/impl/devices/terminal.hpp>
+#include <mfdemu/impl/hang_detector.hpp>
+#include <mfdemu/impl/replay.hpp>
+#include <mfdemu/impl/scheduler.hpp>
+#include <mfdemu/impl/vcd_writer.hpp>
 
 namespace mfdemu::impl {
 class System {
    public:
+	enum class StopReason : u8 {
+		NONE,
+		HALT,
+		EXIT_IP,
+		NO_PROGRESS,
+		CYCLE_LIMIT,
+		TIME_LIMIT,
+	};
+
+	static constexpr u16 DEFAULT_CONSOLE_PORT = 0x1000;
+
+	/**
+	 * @brief Where the terminal at the console port reads from and writes to. An
+	 * interactive console switches stdin to raw mode. A headless console leaves
+	 * the tty alone, reads from input (nothing if empty) and writes to output
+	 * (stdout if empty).
+	 */
+	struct ConsoleConfig {
+		bool headless;
+		std::string input;
+		std::string output;
+	};
+
+	/** @brief Inclusive address range of main memory. */
+	using MemoryRange = std::pair<u16, u16>;
+
 	System(u32 cycle_span, u16 main_memory_size);
 
 	void setMainMemoryData(std::vector<u8> data);
 
+	/**
+	 * @brief Load an image into main memory. Its pages are shared with every
+	 * other System it is loaded into until they are written to.
+	 */
+	void loadImage(const MemoryImage &image);
+
+	/**
+	 * @brief Return to the state after construction so that the System can run
+	 * another program. Mapped GIO devices and all run options are removed, main
+	 * memory is left as it is.
+	 */
+	void reset();
+
+	/**
+	 * @brief Connect a device to the ports first..last of the GIO bus. A device
+	 * mapped to the console port replaces the terminal. Returns false if the
+	 * device could not be mapped, see GioBus::mapDevice().
+	 */
+	bool mapIoDevice(u16 first, u16 last, std::shared_ptr<GioDevice> device);
+
+	/**
+	 * @brief Resets the Cpu and keeps clocking it until stop() is called.
+	 */
 	void run();
 
+	/**
+	 * @brief Makes run() return after the current cycle. Safe to call from a
+	 * signal handler.
+	 */
+	void stop();
+
+	/**
+	 * @brief Makes run() pass the current performance counters to the handler
+	 * set via setPerfDumpHandler() after the current cycle. Safe to call from a
+	 * signal handler.
+	 */
+	void requestPerfDump();
+
+	void setPerfDumpHandler(std::function<void(const PerfCounters &)> handler);
+
+	/**
+	 * @brief Record the Cpu pins and bus lines of every cycle between the start
+	 * and stop triggers to the given VCD file while run() is active.
+	 */
+	bool enableWaveform(const std::string &path, VcdTrigger start, VcdTrigger stop);
+
+	/**
+	 * @brief Drive the breakpoint engine from the commands in a script file or
+	 * from clients of a unix socket created at the given path.
+	 */
+	bool attachDebuggerScript(const std::string &path);
+	bool attachDebuggerSocket(const std::string &path);
+
+	/**
+	 * @brief Keep snapshots every interval cycles so that an attached debugger
+	 * can go back in time.
+	 * @param capacity Maximum number of snapshots kept.
+	 */
+	void enableHistory(u64 interval, usize capacity);
+
+	/**
+	 * @brief Log all GIO reads and IRQ changes of the next run() to a file.
+	 */
+	bool startRecording(const std::string &path);
+
+	/**
+	 * @brief Feed the inputs of a recording to the next run() instead of
+	 * reading devices. The replay runs unthrottled and ends with the recording.
+	 */
+	bool startReplay(const std::string &path);
+
+	/**
+	 * @brief Stop run() once a limit is exceeded or no progress is made, see
+	 * HangDetector. A report is written to report and stopReason() is set.
+	 */
+	void setHangLimits(HangDetector::Limits limits, std::ostream &report = std::cerr);
+
+	/**
+	 * @brief Replace the default interactive console, must be called before
+	 * run().
+	 */
+	bool setConsole(const ConsoleConfig &config);
+
+	/**
+	 * @brief Map the terminal to port instead of DEFAULT_CONSOLE_PORT, there is
+	 * no terminal if port is empty.
+	 */
+	void setConsolePort(std::optional<u16> port);
+
+	/**
+	 * @brief Port at which the terminal reports the number of buffered input
+	 * bytes, none if port is empty.
+	 */
+	void setConsoleStatusPort(std::optional<u16> port);
+
+	/**
+	 * @brief Interrupt id the terminal requests while input is buffered, no
+	 * interrupts if id is empty.
+	 */
+	void setConsoleInterrupt(std::optional<u8> id);
+
+	/**
+	 * @brief Map a HaltDevice to port, run() stops once the guest writes its
+	 * exit status there.
+	 */
+	void setHaltPort(u16 port);
+
+	/**
+	 * @brief Let controller decide which raised interrupt line the Cpu takes,
+	 * see GioBus::setInterruptController().
+	 */
+	void setInterruptController(InterruptController *controller);
+
+	/**
+	 * @brief Stop run() once the instruction at ip is about to be executed.
+	 */
+	void setExitIp(u16 ip);
+
+	StopReason stopReason() const { return m_stopReason; }
+	static const char *stopReasonName(StopReason reason);
+
+	/** @brief Status written to the halt port, 0 if the guest did not halt. */
+	u16 guestStatus() const { return m_guestStatus; }
+
+	/**
+	 * @brief Write the stop reason, guest status, counters, registers and the
+	 * given memory ranges as a JSON object.
+	 */
+	bool writeStateJson(const std::string &path, const std::vector<MemoryRange> &ranges) const;
+
+	/**
+	 * @brief Skip iterations of idle loops up to the next scheduled event.
+	 * Enabled by default, it is never active while the waveform, debugger,
+	 * history, heatmap, coverage, recording or replay are in use.
+	 */
+	void setIdleSkip(bool enabled);
+
+	/**
+	 * @brief Mark the coverage collected by the Cpu as being reported, which
+	 * disables idle skipping and batched block transfers so that every executed
+	 * cycle is seen by the Cpu.
+	 */
+	void setCoverage(bool enabled);
+
+	Cpu &cpu();
+	const Cpu &cpu() const;
+	AioDevice &mainMemory();
+	EventScheduler &scheduler();
+	InterruptSink &interrupts();
+
    private:
+	std::atomic<bool> m_stopRequested{false};
+	std::atomic<bool> m_perfDumpRequested{false};
+	std::function<void(const PerfCounters &)> m_perfDumpHandler;
+
+	std::unique_ptr<VcdWriter> m_waveform;
+	std::unique_ptr<Debugger> m_debugger;
+	Watchpoints m_watchpoints;
+	std::unique_ptr<History> m_history;
+	std::unique_ptr<InputRecorder> m_recorder;
+	std::unique_ptr<InputReplayer> m_replayer;
+	bool m_recordedIrq{false};
+	bool m_idleSkip{true};
+	bool m_coverage{false};
+	std::unique_ptr<HangDetector> m_hangDetector;
+	std::ostream *m_hangReport{nullptr};
+	std::shared_ptr<Terminal> m_console;
+	std::optional<u16> m_consolePort{DEFAULT_CONSOLE_PORT};
+	std::optional<u16> m_consoleStatusPort;
+	std::optional<u8> m_consoleInterrupt;
+	std::optional<u16> m_exitIp;
+	StopReason m_stopReason{StopReason::NONE};
+	u16 m_guestStatus{0};
+	EventScheduler m_scheduler;
+
+	void sampleWaveform();
+
+	/** first cycle skipping must not pass: the next event or the hang limit */
+	u64 skipLimit() const;
+
 	u32 m_cycleSpan;
 	Cpu m_cpu;
 	std::shared_ptr<AioDevice> m_mainMemory;
+	std::shared_ptr<GioBus> m_ioBus;
 	/* AsciiConsole m_console; */
 };
 }  // namespace mfdemu::impl
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <iomanip>
+
+#include <mfdemu/impl/instructions.hpp>
+#include <mfdemu/impl/trace.hpp>
+
+namespace mfdemu::impl {
+
+void ExecutionTrace::call(u16 call_site, u16 target) {
+	if(m_callStack.size() >= MAX_CALL_DEPTH) {
+		m_callStack.erase(m_callStack.begin());
+	}
+
+	m_callStack.push_back({.call_site = call_site, .target = target});
+}
+
+void ExecutionTrace::ret() {
+	if(!m_callStack.empty()) {
+		m_callStack.pop_back();
+	}
+}
+
+std::vector<ExecutionTrace::Entry> ExecutionTrace::entries() const {
+	std::vector<Entry> entries;
+	const u64 first = m_count > RING_SIZE ? m_count - RING_SIZE : 0;
+	for(u64 ix = first; ix < m_count; ix++) {
+		entries.push_back(m_ring[ix & (RING_SIZE - 1)]);
+	}
+
+	return entries;
+}
+
+void ExecutionTrace::write(std::ostream &stream) const {
+	stream << std::hex << std::setfill('0');
+
+	stream << "call stack:\n";
+	if(m_callStack.empty()) {
+		stream << "  (empty)\n";
+	}
+
+	for(usize ix = m_callStack.size(); ix > 0; ix--) {
+		const Frame &frame = m_callStack[ix - 1];
+		stream << "  #" << std::dec << m_callStack.size() - ix << std::hex << " 0x"
+			   << std::setw(4) << frame.target << " called from 0x" << std::setw(4)
+			   << frame.call_site << "\n";
+	}
+
+	stream << "trace, oldest first:\n";
+	for(const Entry &entry: entries()) {
+		stream << "  " << std::dec << std::setfill(' ') << std::setw(12) << entry.cycle
+			   << std::hex << std::setfill('0') << "  0x" << std::setw(4) << entry.ip << "  ";
+		if(entry.opcode < INSTRUCTION_NAMES.size() && *INSTRUCTION_NAMES[entry.opcode] != '\0') {
+			stream << INSTRUCTION_NAMES[entry.opcode];
+		} else {
+			stream << "0x" << std::setw(2) << static_cast<u32>(entry.opcode);
+		}
+		stream << "\n";
+	}
+
+	stream << std::dec << std::setfill(' ');
+}
+
+}  // namespace mfdemu::impl
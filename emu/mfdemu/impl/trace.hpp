@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MFDEMU_IMPL_TRACE_HPP
+#define MFDEMU_IMPL_TRACE_HPP
+
+#include <array>
+#include <ostream>
+#include <vector>
+
+#include <shared/typedefs.hpp>
+
+namespace mfdemu::impl {
+
+/**
+ * @brief Ring of the last fetched instructions and a shadow call stack
+ * maintained from CALL and RET, both used for post-mortem state dumps.
+ */
+class ExecutionTrace {
+   public:
+	/** @brief Number of instructions kept, must be a power of two. */
+	static constexpr usize RING_SIZE = 64;
+
+	/** @brief Deeper calls drop the oldest frames. */
+	static constexpr usize MAX_CALL_DEPTH = 256;
+
+	struct Entry {
+		u64 cycle;
+		u16 ip;
+		u8 opcode;
+	};
+
+	struct Frame {
+		u16 call_site;
+		u16 target;
+	};
+
+	void fetched(u64 cycle, u16 ip, u8 opcode) {
+		m_ring[m_count++ & (RING_SIZE - 1)] = {.cycle = cycle, .ip = ip, .opcode = opcode};
+	}
+
+	void call(u16 call_site, u16 target);
+	void ret();
+
+	/** @brief Traced instructions, oldest first. */
+	std::vector<Entry> entries() const;
+	const std::vector<Frame> &callStack() const { return m_callStack; }
+
+	/**
+	 * @brief Write the call stack, innermost frame first, and the trace as
+	 * plain text.
+	 */
+	void write(std::ostream &stream) const;
+
+   private:
+	std::array<Entry, RING_SIZE> m_ring{};
+	u64 m_count{0};
+	std::vector<Frame> m_callStack;
+};
+
+}  // namespace mfdemu::impl
+
+#endif
@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <utility>
+
+#include <shared/log.hpp>
+
+#include <mfdemu/impl/vcd_writer.hpp>
+
+namespace mfdemu::impl {
+
+std::optional<VcdTrigger> VcdTrigger::parse(const std::string &str) {
+	const usize separator = str.find(':');
+	if(separator == std::string::npos) {
+		logError() << "invalid trigger \"" << str << "\", expected ip:<address> or cycle:<number>\n";
+		return std::nullopt;
+	}
+
+	const std::string kind = str.substr(0, separator);
+	const std::string value = str.substr(separator + 1);
+
+	VcdTrigger trigger;
+	if(kind == "ip") {
+		trigger.kind = IP;
+	} else if(kind == "cycle") {
+		trigger.kind = CYCLE;
+	} else {
+		logError() << "invalid trigger kind \"" << kind << "\", expected ip or cycle\n";
+		return std::nullopt;
+	}
+
+	char *end = nullptr;
+	trigger.value = std::strtoull(value.c_str(), &end, 0);
+	if(value.empty() || *end != '\0' || (trigger.kind == IP && trigger.value > 0xffff)) {
+		logError() << "invalid trigger value \"" << value << "\"\n";
+		return std::nullopt;
+	}
+
+	return trigger;
+}
+
+/** VCD identifiers of the recorded signals */
+static constexpr char ID_ICLK = '!';
+static constexpr char ID_CLK = '"';
+static constexpr char ID_AMS = '#';
+static constexpr char ID_GMS = '$';
+static constexpr char ID_IRA = '%';
+static constexpr char ID_IRQ = '&';
+static constexpr char ID_RESET = '\'';
+static constexpr char ID_AIO = '(';
+static constexpr char ID_GIO = ')';
+static constexpr char ID_IP = '*';
+
+VcdWriter::VcdWriter(VcdTrigger start, VcdTrigger stop)
+	: m_start(start), m_stop(stop), m_capturing(start.kind == VcdTrigger::NONE) {
+	m_batch.reserve(BATCH_SIZE);
+}
+
+VcdWriter::~VcdWriter() {
+	close();
+}
+
+bool VcdWriter::open(const std::string &path) {
+	m_stream.open(path, std::ios::out | std::ios::trunc);
+	if(!m_stream.is_open()) {
+		logError() << "could not open \"" << path << "\" for writing the waveform\n";
+		return false;
+	}
+
+	m_stream << "$version mfdemu $end\n"
+			 << "$timescale 1 ns $end\n"
+			 << "$scope module mfd0816 $end\n"
+			 << "$var wire 1 " << ID_ICLK << " ICLK $end\n"
+			 << "$var wire 1 " << ID_CLK << " CLK $end\n"
+			 << "$var wire 1 " << ID_AMS << " AMS $end\n"
+			 << "$var wire 1 " << ID_GMS << " GMS $end\n"
+			 << "$var wire 1 " << ID_IRA << " IRA $end\n"
+			 << "$var wire 1 " << ID_IRQ << " IRQ $end\n"
+			 << "$var wire 1 " << ID_RESET << " RESET $end\n"
+			 << "$var wire 16 " << ID_AIO << " AIO [15:0] $end\n"
+			 << "$var wire 8 " << ID_GIO << " GIO [7:0] $end\n"
+			 << "$var reg 16 " << ID_IP << " IP [15:0] $end\n"
+			 << "$upscope $end\n"
+			 << "$enddefinitions $end\n";
+
+	m_writer = std::thread(&VcdWriter::writerLoop, this);
+	return true;
+}
+
+void VcdWriter::close() {
+	if(!m_writer.joinable()) {
+		return;
+	}
+
+	if(!m_batch.empty()) {
+		submitBatch();
+	}
+
+	{
+		const std::lock_guard<std::mutex> lock(m_mutex);
+		m_closing = true;
+	}
+
+	m_queueNotEmpty.notify_one();
+	m_writer.join();
+	m_stream.flush();
+}
+
+void VcdWriter::submitBatch() {
+	if(!m_writer.joinable()) {
+		m_batch.clear();
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_queueNotFull.wait(lock, [this] { return m_queue.size() < QUEUE_DEPTH; });
+		m_queue.push_back(std::move(m_batch));
+	}
+
+	m_queueNotEmpty.notify_one();
+	m_batch = {};
+	m_batch.reserve(BATCH_SIZE);
+}
+
+void VcdWriter::writerLoop() {
+	std::string out;
+
+	while(true) {
+		std::vector<Sample> batch;
+
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_queueNotEmpty.wait(lock, [this] { return m_closing || !m_queue.empty(); });
+			if(m_queue.empty()) {
+				return;
+			}
+
+			batch = std::move(m_queue.front());
+			m_queue.pop_front();
+		}
+
+		m_queueNotFull.notify_one();
+
+		out.clear();
+		for(const Sample &sample: batch) {
+			writeSample(out, sample);
+		}
+
+		m_stream.write(out.data(), static_cast<std::streamsize>(out.size()));
+	}
+}
+
+static void appendBit(std::string &out, bool value, char id) {
+	out += value ? '1' : '0';
+	out += id;
+	out += '\n';
+}
+
+static void appendVector(std::string &out, u16 value, u8 width, char id) {
+	out += 'b';
+	for(u8 bit = width; bit > 0; bit--) {
+		out += ((value >> (bit - 1)) & 1) != 0 ? '1' : '0';
+	}
+
+	out += ' ';
+	out += id;
+	out += '\n';
+}
+
+void VcdWriter::writeSample(std::string &out, const Sample &sample) {
+	out += '#';
+	out += std::to_string(sample.cycle * 2);
+	out += '\n';
+
+	/* everything is dumped on the first sample, only changes afterwards. ICLK
+	 * and CLK fall every half cycle, so their rising edges are always written. */
+	const bool all = !m_last.has_value();
+	if(all) {
+		out += "$dumpvars\n";
+	}
+
+	appendBit(out, true, ID_ICLK);
+	if(all || sample.clk) {
+		appendBit(out, sample.clk, ID_CLK);
+	}
+	if(all || sample.ams != m_last->ams) {
+		appendBit(out, sample.ams, ID_AMS);
+	}
+	if(all || sample.gms != m_last->gms) {
+		appendBit(out, sample.gms, ID_GMS);
+	}
+	if(all || sample.ira != m_last->ira) {
+		appendBit(out, sample.ira, ID_IRA);
+	}
+	if(all || sample.irq != m_last->irq) {
+		appendBit(out, sample.irq, ID_IRQ);
+	}
+	if(all || sample.reset != m_last->reset) {
+		appendBit(out, sample.reset, ID_RESET);
+	}
+	if(all || sample.aio != m_last->aio) {
+		appendVector(out, sample.aio, 16, ID_AIO);
+	}
+	if(all || sample.gio != m_last->gio) {
+		appendVector(out, sample.gio, 8, ID_GIO);
+	}
+	if(all || sample.ip != m_last->ip) {
+		appendVector(out, sample.ip, 16, ID_IP);
+	}
+
+	if(all) {
+		out += "$end\n";
+	}
+
+	out += '#';
+	out += std::to_string((sample.cycle * 2) + 1);
+	out += '\n';
+	appendBit(out, false, ID_ICLK);
+	if(sample.clk) {
+		appendBit(out, false, ID_CLK);
+	}
+
+	m_last = sample;
+}
+
+}  // namespace mfdemu::impl
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MFDEMU_IMPL_VCD_WRITER_HPP
+#define MFDEMU_IMPL_VCD_WRITER_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <shared/typedefs.hpp>
+
+namespace mfdemu::impl {
+
+/**
+ * @brief Condition starting or stopping a VCD capture window.
+ */
+struct VcdTrigger {
+	enum Kind : u8 {
+		NONE,
+		IP,
+		CYCLE,
+	};
+
+	Kind kind{NONE};
+	u64 value{0};
+
+	bool matches(u64 cycle, u16 ip) const {
+		return (kind == IP && ip == value) || (kind == CYCLE && cycle == value);
+	}
+
+	/**
+	 * @brief Parse a trigger of the form "ip:<address>" or "cycle:<number>".
+	 */
+	static std::optional<VcdTrigger> parse(const std::string &str);
+};
+
+/**
+ * @brief Streams the Cpu pins and bus lines into a value change dump. Samples
+ * are handed to a writer thread in batches through a bounded queue, so the
+ * emulation thread only blocks if the writer falls behind by a full queue.
+ *
+ * Each cycle spans two time units: ICLK (and CLK, if the bus is clocked) is high
+ * during the first and low during the second.
+ */
+class VcdWriter {
+   public:
+	struct Sample {
+		u64 cycle;
+		u16 ip;
+		u16 aio;
+		u8 gio;
+		bool clk;
+		bool ams;
+		bool gms;
+		bool ira;
+		bool irq;
+		bool reset;
+	};
+
+	static constexpr usize BATCH_SIZE = 4096;
+	static constexpr usize QUEUE_DEPTH = 16;
+
+	VcdWriter(VcdTrigger start, VcdTrigger stop);
+	~VcdWriter();
+
+	VcdWriter(const VcdWriter &) = delete;
+	VcdWriter &operator=(const VcdWriter &) = delete;
+
+	/**
+	 * @brief Open the output file, write the header and start the writer thread.
+	 */
+	bool open(const std::string &path);
+
+	/**
+	 * @brief Record one cycle. Samples outside of a capture window are
+	 * dropped. Once the stop trigger fired, capturing resumes on the next match
+	 * of the start trigger.
+	 */
+	void sample(const Sample &sample) {
+		if(!m_capturing) {
+			if(!m_start.matches(sample.cycle, sample.ip)) {
+				return;
+			}
+
+			m_capturing = true;
+		}
+
+		m_batch.push_back(sample);
+		if(m_batch.size() == BATCH_SIZE) {
+			submitBatch();
+		}
+
+		if(m_stop.matches(sample.cycle, sample.ip)) {
+			m_capturing = false;
+		}
+	}
+
+	/**
+	 * @brief Write out all pending samples and stop the writer thread.
+	 */
+	void close();
+
+   private:
+	void submitBatch();
+	void writerLoop();
+	void writeSample(std::string &out, const Sample &sample);
+
+	VcdTrigger m_start;
+	VcdTrigger m_stop;
+	bool m_capturing;
+	std::vector<Sample> m_batch;
+
+	std::mutex m_mutex;
+	std::condition_variable m_queueNotFull;
+	std::condition_variable m_queueNotEmpty;
+	std::deque<std::vector<Sample>> m_queue;
+	bool m_closing{false};
+	std::thread m_writer;
+
+	/** only accessed by the writer thread once it is running */
+	std::ofstream m_stream;
+	std::optional<Sample> m_last;
+};
+
+}  // namespace mfdemu::impl
+
+#endif
@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <mfdemu/impl/devices/halt.hpp>
+#include <mfdemu/machine.hpp>
+#include <mfdemu/mri.hpp>
+
+namespace mfdemu {
+
+using namespace impl;
+
+/** GIO device forwarding every byte to host callbacks */
+class CallbackGioDevice : public GioDevice {
+   public:
+	CallbackGioDevice(Machine::GioRead read, Machine::GioWrite write)
+		: m_read(std::move(read)), m_write(std::move(write)) {}
+
+   protected:
+	void write(u16 address, u8 value, bool low) override {
+		if(m_write) {
+			m_write(address, value, low);
+		}
+	}
+
+	u8 read(u16 address, bool low) override { return m_read ? m_read(address, low) : 0; }
+
+   private:
+	Machine::GioRead m_read;
+	Machine::GioWrite m_write;
+};
+
+/** AIO mapped device forwarding every word to host callbacks */
+class CallbackAioDevice : public AioMappedDevice {
+   public:
+	CallbackAioDevice(Machine::AioRead read, Machine::AioWrite write)
+		: m_read(std::move(read)), m_write(std::move(write)) {}
+
+	u16 read(u16 address) override { return m_read ? m_read(address) : 0; }
+
+	void write(u16 address, u16 value) override {
+		if(m_write) {
+			m_write(address, value);
+		}
+	}
+
+   private:
+	Machine::AioRead m_read;
+	Machine::AioWrite m_write;
+};
+
+Machine::Machine(const MemoryImage &image)
+	: m_memory(std::make_shared<AioDevice>(false, image.size())),
+	  m_ioBus(std::make_shared<GioBus>()) {
+	m_memory->loadImage(image);
+	m_cpu.connectAddressDevice(m_memory);
+	m_cpu.connectIoDevice(m_ioBus);
+	reset();
+}
+
+std::unique_ptr<Machine> Machine::fromMRI(const std::vector<u8> &bytes) {
+	const std::optional<std::vector<u8>> data = tryParseMRIFromBytes(bytes);
+	if(!data.has_value()) {
+		return nullptr;
+	}
+
+	return std::make_unique<Machine>(MemoryImage(data.value()));
+}
+
+void Machine::reset() {
+	m_cpu.cancelStop();
+	m_cpu.reset = true;
+	m_cpu.iclck();
+	m_cpu.reset = false;
+
+	m_stopRequested = false;
+	m_halted = false;
+	m_guestStatus = 0;
+}
+
+bool Machine::mapIoDevice(u16 first, u16 last, GioRead read, GioWrite write) {
+	return m_ioBus->mapDevice(
+		first, last, std::make_shared<CallbackGioDevice>(std::move(read), std::move(write)));
+}
+
+bool Machine::mapMemoryDevice(u16 first, u16 last, AioRead read, AioWrite write) {
+	return m_memory->mapDevice(
+		first, last, std::make_shared<CallbackAioDevice>(std::move(read), std::move(write)));
+}
+
+bool Machine::setHaltPort(u16 port) {
+	return m_ioBus->mapDevice(port, port, std::make_shared<HaltDevice>(port, [this](u16 status) {
+		m_guestStatus = status;
+		m_halted = true;
+	}));
+}
+
+Machine::Event Machine::step() {
+	if(m_halted) {
+		return Event::HALT;
+	}
+
+	/* resuming from a stop skips the breakpoint check at this boundary */
+	if(m_cpu.atInstructionBoundary()) {
+		m_cpu.stopAtBoundary();
+		m_cpu.resume();
+	}
+
+	m_stopRequested = false;
+	do {
+		m_cpu.iclck();
+		if(m_halted) {
+			return Event::HALT;
+		}
+
+		if(m_stopRequested) {
+			return Event::STOP_REQUESTED;
+		}
+	} while(!m_cpu.atInstructionBoundary());
+
+	return Event::NONE;
+}
+
+Machine::Event Machine::run(u64 max_cycles) {
+	if(m_halted) {
+		return Event::HALT;
+	}
+
+	if(m_cpu.stopped()) {
+		m_cpu.resume();
+	}
+
+	m_stopRequested = false;
+	const u64 end = m_cpu.cycles() + std::min(max_cycles, UINT64_MAX - m_cpu.cycles());
+	while(m_cpu.cycles() < end) {
+		m_cpu.iclck();
+		if(m_cpu.stopped()) {
+			return Event::BREAKPOINT;
+		}
+
+		if(m_cpu.inBlockLoop()) {
+			m_cpu.blockTransfer(end);
+		}
+
+		if(m_halted) {
+			return Event::HALT;
+		}
+
+		if(m_stopRequested) {
+			return Event::STOP_REQUESTED;
+		}
+	}
+
+	return Event::CYCLE_LIMIT;
+}
+
+void Machine::setBreakpoint(u16 ip) {
+	m_cpu.breakpoints().set(ip, std::nullopt);
+}
+
+void Machine::removeBreakpoint(u16 ip) {
+	m_cpu.breakpoints().remove(ip);
+}
+
+std::vector<u8> Machine::readMemory(u16 address, usize size) const {
+	std::vector<u8> data(size);
+	for(usize ix = 0; ix < size; ix++) {
+		data[ix] = m_memory->readByte(address + ix);
+	}
+
+	return data;
+}
+
+void Machine::writeMemory(u16 address, const std::vector<u8> &data) {
+	m_memory->writeData(address, data);
+}
+
+std::optional<Machine::Snapshot> Machine::snapshot() {
+	if(!m_cpu.atInstructionBoundary()) {
+		return std::nullopt;
+	}
+
+	return Snapshot{
+		.cpu = m_cpu.saveContext(),
+		.memory = m_memory->snapshot(),
+		.guest_status = m_guestStatus,
+		.halted = m_halted,
+	};
+}
+
+void Machine::restore(const Snapshot &snapshot) {
+	m_cpu.cancelStop();
+	m_cpu.restoreContext(snapshot.cpu);
+	m_memory->loadImage(snapshot.memory);
+
+	m_stopRequested = false;
+	m_halted = snapshot.halted;
+	m_guestStatus = snapshot.guest_status;
+}
+
+}  // namespace mfdemu
@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MFDEMU_MACHINE_HPP
+#define MFDEMU_MACHINE_HPP
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include <shared/typedefs.hpp>
+
+#include <mfdemu/impl/bus/aio_device.hpp>
+#include <mfdemu/impl/bus/gio_bus.hpp>
+#include <mfdemu/impl/cpu.hpp>
+
+namespace mfdemu {
+
+/**
+ * @brief Embedding API of the emulator, a single machine driven by the host.
+ * It has main memory and an empty GIO bus; the terminal and all other devices
+ * are provided by the host through callbacks. Nothing is throttled and no
+ * threads are used, all callbacks run on the thread calling step() or run().
+ */
+class Machine {
+   public:
+	/** @brief Why step() or run() returned. */
+	enum class Event : u8 {
+		NONE,
+		/** the guest wrote its exit status to the halt port */
+		HALT,
+		/** a breakpoint was reached, the instruction there was not executed */
+		BREAKPOINT,
+		/** requestStop() was called by a callback */
+		STOP_REQUESTED,
+		/** the given number of cycles ran */
+		CYCLE_LIMIT,
+	};
+
+	using GioRead = std::function<u8(u16 port, bool low)>;
+	using GioWrite = std::function<void(u16 port, u8 value, bool low)>;
+	using AioRead = std::function<u16(u16 address)>;
+	using AioWrite = std::function<void(u16 address, u16 value)>;
+
+	/**
+	 * @brief State of a machine at an instruction boundary. Memory pages are
+	 * shared with the machine until either side writes to them, taking a
+	 * snapshot is cheap. Host devices are not part of it.
+	 */
+	struct Snapshot {
+		impl::Cpu::Context cpu;
+		impl::MemoryImage memory;
+		u16 guest_status;
+		bool halted;
+	};
+
+	/**
+	 * @brief Machine with image as its main memory, reset and ready to run.
+	 */
+	explicit Machine(const impl::MemoryImage &image);
+
+	/**
+	 * @brief Machine running the program in the given MRI file contents,
+	 * nullptr if they are invalid.
+	 */
+	static std::unique_ptr<Machine> fromMRI(const std::vector<u8> &bytes);
+
+	Machine(const Machine &) = delete;
+	Machine &operator=(const Machine &) = delete;
+
+	/**
+	 * @brief Reset the Cpu. Memory and devices are left as they are.
+	 */
+	void reset();
+
+	/**
+	 * @brief Call read and write for GIO transfers to the ports first..last. A
+	 * word transfer calls them twice, for the high byte and then the low byte.
+	 * Returns false if first is above last or too many devices are mapped.
+	 */
+	bool mapIoDevice(u16 first, u16 last, GioRead read, GioWrite write);
+
+	/**
+	 * @brief Call read and write for word accesses to the addresses
+	 * first..last instead of accessing memory. Returns false if first is above
+	 * last.
+	 */
+	bool mapMemoryDevice(u16 first, u16 last, AioRead read, AioWrite write);
+
+	/**
+	 * @brief Map a device to port which halts the machine once the guest writes
+	 * its exit status there. Returns false if too many devices are mapped.
+	 */
+	bool setHaltPort(u16 port);
+
+	/**
+	 * @brief Execute the rest of the current instruction, or the next one at
+	 * an instruction boundary. Breakpoints are not checked.
+	 */
+	Event step();
+
+	/**
+	 * @brief Run until an event occurs, at most max_cycles cycles. Running
+	 * again after a breakpoint continues past it. A halted machine does not
+	 * run until it is reset.
+	 */
+	Event run(u64 max_cycles = UINT64_MAX);
+
+	/**
+	 * @brief Make step() or run() return after the current cycle, to be called
+	 * from a device callback.
+	 */
+	void requestStop() { m_stopRequested = true; }
+
+	void setBreakpoint(u16 ip);
+	void removeBreakpoint(u16 ip);
+
+	/** @brief See REGISTER_* in mfdemu/impl/instructions.hpp for ids. */
+	u16 readRegister(u8 id) const { return m_cpu.readRegister(id); }
+	void writeRegister(u8 id, u16 value) { m_cpu.writeRegister(id, value); }
+
+	/**
+	 * @brief Access main memory directly, mapped devices are bypassed. Bytes
+	 * past the end of memory read as 0 and are not written.
+	 */
+	std::vector<u8> readMemory(u16 address, usize size) const;
+	void writeMemory(u16 address, const std::vector<u8> &data);
+
+	u64 cycles() const { return m_cpu.cycles(); }
+	u64 retired() const { return m_cpu.perfCounters().retired; }
+	bool atInstructionBoundary() const { return m_cpu.atInstructionBoundary(); }
+	bool halted() const { return m_halted; }
+
+	/** @brief Status written to the halt port, 0 if the guest did not halt. */
+	u16 guestStatus() const { return m_guestStatus; }
+
+	/**
+	 * @brief Save the current state, nothing if the Cpu is not at an
+	 * instruction boundary.
+	 */
+	std::optional<Snapshot> snapshot();
+
+	/**
+	 * @brief Return to a saved state, a breakpoint at its ip stops the next
+	 * run() right away.
+	 */
+	void restore(const Snapshot &snapshot);
+
+   private:
+	impl::Cpu m_cpu;
+	std::shared_ptr<impl::AioDevice> m_memory;
+	std::shared_ptr<impl::GioBus> m_ioBus;
+
+	bool m_stopRequested{false};
+	bool m_halted{false};
+	u16 m_guestStatus{0};
+};
+
+}  // namespace mfdemu
+
+#endif
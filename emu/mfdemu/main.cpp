@@ -15,15 +15,27 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <csignal>
 #include <cstdint>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <shared/cli/args.hpp>
+#include <shared/line_table.hpp>
 #include <shared/log.hpp>
 #include <shared/panic.hpp>
 
+#include <mfdemu/impl/bus/interrupts.hpp>
+#include <mfdemu/impl/devices/plugin.hpp>
+#include <mfdemu/impl/devices/pmu.hpp>
+#include <mfdemu/impl/machine_config.hpp>
 #include <mfdemu/impl/system.hpp>
 #include <mfdemu/mri.hpp>
 
@@ -41,19 +53,157 @@ using namespace mfdemu;
 	std::exit(0);
 }
 
+/**
+ * exit codes besides 0 and 1 for host errors which a guest status is never
+ * reported as: guest statuses out of range and runs stopped by the hang
+ * detector
+ */
+static constexpr int EXIT_GUEST_STATUS = 120;
+static constexpr int EXIT_NO_PROGRESS = 121;
+static constexpr int EXIT_CYCLE_LIMIT = 122;
+static constexpr int EXIT_TIME_LIMIT = 123;
+
+/**
+ * exit code of a guest which halted with status: 0 and 2 to 119 as they are,
+ * any other status as EXIT_GUEST_STATUS so that a failing guest is never
+ * reported as success, a host error or a hang
+ */
+static int guestExitCode(u16 status) {
+	return status == 1 || status >= EXIT_GUEST_STATUS ? EXIT_GUEST_STATUS : status;
+}
+
+static impl::System *running_system = nullptr;
+
+static void handleSignal(int signal) {
+	if(running_system == nullptr) {
+		return;
+	}
+
+	if(signal == SIGUSR1) {
+		running_system->requestPerfDump();
+		return;
+	}
+
+	running_system->stop();
+}
+
+static void writePerfCounters(const std::string &path, const impl::PerfCounters &counters) {
+	if(path.empty()) {
+		counters.writeJson(std::cerr);
+		return;
+	}
+
+	std::ofstream stream(path, std::ios::out | std::ios::trunc);
+	if(!stream.is_open()) {
+		logError() << "could not open \"" << path << "\" for writing performance counters\n";
+		return;
+	}
+
+	counters.writeJson(stream);
+}
+
+/**
+ * @brief Parse a comma separated list of inclusive address ranges given as
+ * <first>:<last>, e.g. "0xd000:0xd00f,0x8000:0x80ff".
+ */
+static std::optional<std::vector<impl::System::MemoryRange>>
+parseMemoryRanges(const std::string &str) {
+	std::vector<impl::System::MemoryRange> ranges;
+	std::istringstream stream(str);
+	std::string range;
+
+	while(std::getline(stream, range, ',')) {
+		char *end = nullptr;
+		const u64 first = std::strtoull(range.c_str(), &end, 0);
+		if(*end != ':') {
+			logError() << "invalid memory range \"" << range << "\", expected <first>:<last>\n";
+			return std::nullopt;
+		}
+
+		const char *last_str = end + 1;
+		const u64 last = std::strtoull(last_str, &end, 0);
+		if(*last_str == '\0' || *end != '\0' || first > last || last > UINT16_MAX) {
+			logError() << "invalid memory range \"" << range << "\", expected <first>:<last>\n";
+			return std::nullopt;
+		}
+
+		ranges.emplace_back(first, last);
+	}
+
+	return ranges;
+}
+
 int main(int argc, char **argv) {
 	shared::program_name = "mfdemu";
 
 	shared::cli::Argument<std::string> arg_verbosity("-v", "--verbosity");
 	shared::cli::Argument<bool> arg_licenses("-l", "--licenses", true);
 	shared::cli::Argument<std::string> arg_infile("-i");
+	shared::cli::Argument<std::string> arg_machine("-m", "--machine");
 	shared::cli::Argument<u64> arg_cycle_span("-c", "--cycle-span");
+	shared::cli::Argument<std::string> arg_perf_json("-p", "--perf-json");
+	shared::cli::Argument<u16> arg_pmu_port("--pmu-port");
+	shared::cli::Argument<std::string> arg_plugins("--plugins");
+	shared::cli::Argument<std::string> arg_coverage("--coverage");
+	shared::cli::Argument<std::string> arg_line_table("-g", "--line-table");
+	shared::cli::Argument<std::string> arg_heatmap("--heatmap");
+	shared::cli::Argument<std::string> arg_vcd("--vcd");
+	shared::cli::Argument<std::string> arg_vcd_start("--vcd-start");
+	shared::cli::Argument<std::string> arg_vcd_stop("--vcd-stop");
+	shared::cli::Argument<std::string> arg_debug_script("--debug-script");
+	shared::cli::Argument<std::string> arg_debug_socket("--debug-socket");
+	shared::cli::Argument<u64> arg_history("--history");
+	shared::cli::Argument<u64> arg_history_depth("--history-depth");
+	shared::cli::Argument<std::string> arg_record("--record");
+	shared::cli::Argument<bool> arg_no_idle_skip("--no-idle-skip", "", true);
+	shared::cli::Argument<u64> arg_max_cycles("--max-cycles");
+	shared::cli::Argument<u64> arg_max_time("--max-time");
+	shared::cli::Argument<u64> arg_hang_cycles("--hang-cycles");
+	shared::cli::Argument<bool> arg_headless("--headless", "", true);
+	shared::cli::Argument<std::string> arg_console_in("--console-in");
+	shared::cli::Argument<std::string> arg_console_out("--console-out");
+	shared::cli::Argument<u16> arg_console_status("--console-status");
+	shared::cli::Argument<u16> arg_console_irq("--console-irq");
+	shared::cli::Argument<u16> arg_halt_port("--halt-port");
+	shared::cli::Argument<u16> arg_exit_ip("--exit-ip");
+	shared::cli::Argument<std::string> arg_dump_state("--dump-state");
+	shared::cli::Argument<std::string> arg_dump_memory("--dump-memory");
+	shared::cli::Argument<std::string> arg_replay("--replay");
 
 	shared::cli::ArgumentParser parser;
 	parser.addArgument(&arg_verbosity);
 	parser.addArgument(&arg_licenses);
 	parser.addArgument(&arg_infile);
+	parser.addArgument(&arg_machine);
 	parser.addArgument(&arg_cycle_span);
+	parser.addArgument(&arg_perf_json);
+	parser.addArgument(&arg_pmu_port);
+	parser.addArgument(&arg_plugins);
+	parser.addArgument(&arg_coverage);
+	parser.addArgument(&arg_line_table);
+	parser.addArgument(&arg_heatmap);
+	parser.addArgument(&arg_vcd);
+	parser.addArgument(&arg_vcd_start);
+	parser.addArgument(&arg_vcd_stop);
+	parser.addArgument(&arg_debug_script);
+	parser.addArgument(&arg_debug_socket);
+	parser.addArgument(&arg_history);
+	parser.addArgument(&arg_history_depth);
+	parser.addArgument(&arg_record);
+	parser.addArgument(&arg_no_idle_skip);
+	parser.addArgument(&arg_max_cycles);
+	parser.addArgument(&arg_max_time);
+	parser.addArgument(&arg_hang_cycles);
+	parser.addArgument(&arg_headless);
+	parser.addArgument(&arg_console_in);
+	parser.addArgument(&arg_console_out);
+	parser.addArgument(&arg_console_status);
+	parser.addArgument(&arg_console_irq);
+	parser.addArgument(&arg_halt_port);
+	parser.addArgument(&arg_exit_ip);
+	parser.addArgument(&arg_dump_state);
+	parser.addArgument(&arg_dump_memory);
+	parser.addArgument(&arg_replay);
 	parser.parse(argc - 1, argv + 1);  // NOLINT
 
 	if(arg_licenses.get().value_or(false)) {
@@ -62,8 +212,23 @@ int main(int argc, char **argv) {
 
 	shared::Logger::stringSetLogLevel(arg_verbosity.get().value_or(""));
 
+	std::optional<impl::MachineConfig> machine;
+	if(arg_machine.get().has_value()) {
+		machine = impl::MachineConfig::read(arg_machine.get().value());
+		if(!machine.has_value()) {
+			return 1;
+		}
+	}
+
+	/* headless runs are unthrottled unless a cycle span or a clock is given */
+	const bool headless = arg_headless.get().value_or(false);
 	constexpr u64 DEFAULT_CYCLE_SPAN = 1000; /* ~10MHz */
-	const u64 cycle_span = arg_cycle_span.get().value_or(DEFAULT_CYCLE_SPAN);
+	u64 cycle_span = headless ? 0 : DEFAULT_CYCLE_SPAN;
+	if(arg_cycle_span.get().has_value()) {
+		cycle_span = arg_cycle_span.get().value();
+	} else if(machine.has_value() && machine->clock_hz.has_value()) {
+		cycle_span = machine->cycleSpan();
+	}
 
 	std::cerr << "MFDEMU, emulator for the mfd0816 fantasy architecture\n"
 			  << "Copyright (C) 2024  Marie Eckert\n\n";
@@ -74,13 +239,255 @@ int main(int argc, char **argv) {
 		return 1;
 	}
 
+	const std::optional<std::string> coverage_file = arg_coverage.get();
+	std::optional<shared::LineTable> line_table;
+	if(coverage_file.has_value()) {
+		if(!arg_line_table.get().has_value()) {
+			logError() << "coverage output requires a line table, specify using \"-g <file>\"\n";
+			return 1;
+		}
+
+		line_table = shared::LineTable::read(arg_line_table.get().value());
+		if(!line_table.has_value()) {
+			return 1;
+		}
+	}
+
+	if(!headless && (arg_console_in.get().has_value() || arg_console_out.get().has_value())) {
+		logError() << "--console-in and --console-out require --headless\n";
+		return 1;
+	}
+
+	if(arg_console_irq.get().value_or(0) >= impl::InterruptSink::LINE_COUNT) {
+		logError() << "--console-irq must be below " << impl::InterruptSink::LINE_COUNT << "\n";
+		return 1;
+	}
+
+	std::vector<impl::System::MemoryRange> dump_ranges;
+	if(arg_dump_memory.get().has_value()) {
+		const std::optional<std::vector<impl::System::MemoryRange>> ranges =
+			parseMemoryRanges(arg_dump_memory.get().value());
+		if(!ranges.has_value()) {
+			return 1;
+		}
+		dump_ranges = ranges.value();
+	}
+
 	std::ifstream stream(infile.value(), std::ios::in | std::ios::binary);
 	const std::vector<u8> contents(
 		(std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
 
+	/* counters are written to the given file at exit and whenever SIGUSR1 is
+	 * received. Without a file, SIGUSR1 prints them to stderr. */
+	const std::string perf_json = arg_perf_json.get().value_or("");
+
+	std::vector<u8> image = parseMRIFromBytes(contents);
+	if(machine.has_value()) {
+		image = machine->memoryImage(image);
+	}
+
 	impl::System the_system(cycle_span, UINT16_MAX);
-	the_system.setMainMemoryData(parseMRIFromBytes(contents));
+	the_system.setMainMemoryData(image);
+	if(machine.has_value() && !machine->apply(the_system)) {
+		return 1;
+	}
+
+	if(arg_console_status.get().has_value()) {
+		the_system.setConsoleStatusPort(arg_console_status.get());
+	}
+
+	if(arg_console_irq.get().has_value()) {
+		the_system.setConsoleInterrupt(arg_console_irq.get().value());
+	}
+	the_system.setPerfDumpHandler(
+		[&perf_json](const impl::PerfCounters &counters) { writePerfCounters(perf_json, counters); });
+
+	const std::optional<u16> pmu_port = arg_pmu_port.get();
+	if(pmu_port.has_value()) {
+		if(pmu_port.value() + impl::PmuDevice::PORT_COUNT - 1 > UINT16_MAX) {
+			logError() << "pmu at port 0x" << std::hex << pmu_port.value() << std::dec
+					   << " does not fit below port 0xffff\n";
+			return 1;
+		}
+
+		auto pmu = std::make_shared<impl::PmuDevice>(
+			pmu_port.value(), the_system.cpu().perfCounters());
+		const u16 pmu_last = pmu_port.value() + impl::PmuDevice::PORT_COUNT - 1;
+		if(!the_system.mapIoDevice(pmu_port.value(), pmu_last, std::move(pmu))) {
+			return 1;
+		}
+	}
+
+	/* plugins are given as <path>@<first>[:<last>][,<params>], separated by ';' */
+	if(arg_plugins.get().has_value()) {
+		std::stringstream plugins(arg_plugins.get().value());
+		std::string spec_str;
+		while(std::getline(plugins, spec_str, ';')) {
+			const std::optional<impl::PluginSpec> spec = impl::PluginSpec::parse(spec_str);
+			if(!spec.has_value()) {
+				return 1;
+			}
+
+			std::shared_ptr<impl::PluginDevice> device = impl::loadPlugin(spec.value());
+			if(device == nullptr) {
+				return 1;
+			}
+			if(!the_system.mapIoDevice(spec->first, spec->last, std::move(device))) {
+				return 1;
+			}
+		}
+	}
+
+	/* heatmap is written to <prefix>.ppm and the ranking to <prefix>.txt */
+	const std::optional<std::string> heatmap_prefix = arg_heatmap.get();
+	if(heatmap_prefix.has_value()) {
+		the_system.cpu().enableHeatmap();
+	}
+
+	/* triggers are given as ip:<address> or cycle:<number>, without a start
+	 * trigger the capture starts at reset */
+	if(arg_vcd.get().has_value()) {
+		impl::VcdTrigger start;
+		impl::VcdTrigger stop;
+
+		if(arg_vcd_start.get().has_value()) {
+			const std::optional<impl::VcdTrigger> trigger =
+				impl::VcdTrigger::parse(arg_vcd_start.get().value());
+			if(!trigger.has_value()) {
+				return 1;
+			}
+			start = trigger.value();
+		}
+
+		if(arg_vcd_stop.get().has_value()) {
+			const std::optional<impl::VcdTrigger> trigger =
+				impl::VcdTrigger::parse(arg_vcd_stop.get().value());
+			if(!trigger.has_value()) {
+				return 1;
+			}
+			stop = trigger.value();
+		}
+
+		if(!the_system.enableWaveform(arg_vcd.get().value(), start, stop)) {
+			return 1;
+		}
+	}
+
+	/* snapshots are taken every --history cycles, only the last
+	 * --history-depth of them are kept */
+	constexpr u64 DEFAULT_HISTORY_DEPTH = 256;
+	if(arg_history.get().has_value()) {
+		if(arg_history.get().value() == 0) {
+			logError() << "history interval must be greater than 0\n";
+			return 1;
+		}
+
+		the_system.enableHistory(
+			arg_history.get().value(), arg_history_depth.get().value_or(DEFAULT_HISTORY_DEPTH));
+	}
+
+	if(arg_debug_script.get().has_value() && arg_debug_socket.get().has_value()) {
+		logError() << "--debug-script and --debug-socket can not be used together\n";
+		return 1;
+	}
+
+	if(arg_debug_script.get().has_value() &&
+	   !the_system.attachDebuggerScript(arg_debug_script.get().value())) {
+		return 1;
+	}
+
+	if(arg_debug_socket.get().has_value() &&
+	   !the_system.attachDebuggerSocket(arg_debug_socket.get().value())) {
+		return 1;
+	}
+
+	if(arg_record.get().has_value() && arg_replay.get().has_value()) {
+		logError() << "--record and --replay can not be used together\n";
+		return 1;
+	}
+
+	if(arg_record.get().has_value() && !the_system.startRecording(arg_record.get().value())) {
+		return 1;
+	}
+
+	if(arg_replay.get().has_value() && !the_system.startReplay(arg_replay.get().value())) {
+		return 1;
+	}
+
+	if(!the_system.setConsole({
+		   .headless = headless,
+		   .input = arg_console_in.get().value_or(""),
+		   .output = arg_console_out.get().value_or(""),
+	   })) {
+		return 1;
+	}
+
+	if(arg_halt_port.get().has_value()) {
+		the_system.setHaltPort(arg_halt_port.get().value());
+	}
+
+	if(arg_exit_ip.get().has_value()) {
+		the_system.setExitIp(arg_exit_ip.get().value());
+	}
+
+	/* --max-time is given in seconds */
+	if(arg_max_cycles.get().has_value() || arg_max_time.get().has_value() ||
+	   arg_hang_cycles.get().has_value()) {
+		the_system.setHangLimits({
+			.max_cycles = arg_max_cycles.get().value_or(0),
+			.max_time_ms = arg_max_time.get().value_or(0) * 1000,
+			.progress_cycles = arg_hang_cycles.get().value_or(0),
+		});
+	}
+
+	the_system.setIdleSkip(!arg_no_idle_skip.get().value_or(false));
+	the_system.setCoverage(coverage_file.has_value());
+
+	running_system = &the_system;
+	std::signal(SIGINT, handleSignal);
+	std::signal(SIGTERM, handleSignal);
+	std::signal(SIGUSR1, handleSignal);
+
 	the_system.run();
 
+	running_system = nullptr;
+
+	if(!perf_json.empty()) {
+		writePerfCounters(perf_json, the_system.cpu().perfCounters());
+	}
+
+	if(coverage_file.has_value() &&
+	   !the_system.cpu().coverage().writeLcov(coverage_file.value(), line_table.value(), image)) {
+		return 1;
+	}
+
+	constexpr usize HEATMAP_REPORT_ENTRIES = 32;
+	if(heatmap_prefix.has_value()) {
+		const impl::MemoryHeatmap &heatmap = *the_system.cpu().heatmap();
+		if(!heatmap.writePpm(heatmap_prefix.value() + ".ppm") ||
+		   !heatmap.writeReport(heatmap_prefix.value() + ".txt", HEATMAP_REPORT_ENTRIES)) {
+			return 1;
+		}
+	}
+
+	if(arg_dump_state.get().has_value() &&
+	   !the_system.writeStateJson(arg_dump_state.get().value(), dump_ranges)) {
+		return 1;
+	}
+
+	switch(the_system.stopReason()) {
+	case impl::System::StopReason::NONE:
+	case impl::System::StopReason::EXIT_IP:
+		return 0;
+	case impl::System::StopReason::HALT:
+		return guestExitCode(the_system.guestStatus());
+	case impl::System::StopReason::NO_PROGRESS:
+		return EXIT_NO_PROGRESS;
+	case impl::System::StopReason::CYCLE_LIMIT:
+		return EXIT_CYCLE_LIMIT;
+	case impl::System::StopReason::TIME_LIMIT:
+		return EXIT_TIME_LIMIT;
+	}
+
 	return 0;
 }
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * C interface of libmfdemu, see mfdemu/machine.hpp for the semantics of each
+ * call. Machines are not thread-safe, but separate machines may be used from
+ * separate threads.
+ */
+
+#ifndef MFDEMU_MFDEMU_H
+#define MFDEMU_MFDEMU_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Incremented whenever a call or type in this file changes incompatibly. */
+#define MFDEMU_API_VERSION 1
+
+typedef struct mfdemu_machine mfdemu_machine;
+typedef struct mfdemu_snapshot mfdemu_snapshot;
+
+typedef enum mfdemu_event {
+	MFDEMU_EVENT_NONE = 0,
+	MFDEMU_EVENT_HALT = 1,
+	MFDEMU_EVENT_BREAKPOINT = 2,
+	MFDEMU_EVENT_STOP_REQUESTED = 3,
+	MFDEMU_EVENT_CYCLE_LIMIT = 4,
+} mfdemu_event;
+
+typedef enum mfdemu_register {
+	MFDEMU_REG_AL = 0x00,
+	MFDEMU_REG_AH = 0x01,
+	MFDEMU_REG_ACL = 0x02,
+	MFDEMU_REG_BL = 0x03,
+	MFDEMU_REG_BH = 0x04,
+	MFDEMU_REG_BCL = 0x05,
+	MFDEMU_REG_CL = 0x06,
+	MFDEMU_REG_CH = 0x07,
+	MFDEMU_REG_CCL = 0x08,
+	MFDEMU_REG_DL = 0x09,
+	MFDEMU_REG_DH = 0x0a,
+	MFDEMU_REG_DCL = 0x0b,
+	MFDEMU_REG_SP = 0x0c,
+	MFDEMU_REG_IP = 0x0d,
+	MFDEMU_REG_AR = 0x0e,
+	MFDEMU_REG_FL = 0x0f,
+	MFDEMU_REG_IID = 0x10,
+} mfdemu_register;
+
+/** Called once per byte of a GIO transfer, the high byte first. */
+typedef uint8_t (*mfdemu_gio_read_fn)(void *user, uint16_t port, bool low);
+typedef void (*mfdemu_gio_write_fn)(void *user, uint16_t port, uint8_t value, bool low);
+
+/** Called once per word accessed on the address bus. */
+typedef uint16_t (*mfdemu_aio_read_fn)(void *user, uint16_t address);
+typedef void (*mfdemu_aio_write_fn)(void *user, uint16_t address, uint16_t value);
+
+/** MFDEMU_API_VERSION of the library. */
+unsigned mfdemu_api_version(void);
+
+/** Machine running the given MRI file contents, NULL if they are invalid. */
+mfdemu_machine *mfdemu_create(const uint8_t *mri, size_t size);
+void mfdemu_destroy(mfdemu_machine *machine);
+void mfdemu_reset(mfdemu_machine *machine);
+
+/**
+ * Either callback may be NULL, reads then return 0 and writes are dropped.
+ * false if first is above last or no more devices fit on the bus.
+ */
+bool mfdemu_map_gio(
+	mfdemu_machine *machine, uint16_t first, uint16_t last, mfdemu_gio_read_fn read,
+	mfdemu_gio_write_fn write, void *user);
+bool mfdemu_map_aio(
+	mfdemu_machine *machine, uint16_t first, uint16_t last, mfdemu_aio_read_fn read,
+	mfdemu_aio_write_fn write, void *user);
+bool mfdemu_set_halt_port(mfdemu_machine *machine, uint16_t port);
+
+mfdemu_event mfdemu_step(mfdemu_machine *machine);
+mfdemu_event mfdemu_run_cycles(mfdemu_machine *machine, uint64_t cycles);
+mfdemu_event mfdemu_run(mfdemu_machine *machine);
+
+/** May only be called from a callback of the machine. */
+void mfdemu_request_stop(mfdemu_machine *machine);
+
+void mfdemu_set_breakpoint(mfdemu_machine *machine, uint16_t ip);
+void mfdemu_remove_breakpoint(mfdemu_machine *machine, uint16_t ip);
+
+/** Unknown registers read as 0 and are not written. */
+uint16_t mfdemu_read_register(const mfdemu_machine *machine, mfdemu_register reg);
+void mfdemu_write_register(mfdemu_machine *machine, mfdemu_register reg, uint16_t value);
+
+void mfdemu_read_memory(
+	const mfdemu_machine *machine, uint16_t address, uint8_t *data, size_t size);
+void mfdemu_write_memory(
+	mfdemu_machine *machine, uint16_t address, const uint8_t *data, size_t size);
+
+uint64_t mfdemu_cycles(const mfdemu_machine *machine);
+uint64_t mfdemu_retired(const mfdemu_machine *machine);
+bool mfdemu_halted(const mfdemu_machine *machine);
+uint16_t mfdemu_guest_status(const mfdemu_machine *machine);
+
+/**
+ * NULL if the machine is not at an instruction boundary. The machine shares its
+ * memory with the snapshot and copies each page again on its next write to it.
+ */
+mfdemu_snapshot *mfdemu_snapshot_take(mfdemu_machine *machine);
+void mfdemu_snapshot_restore(mfdemu_machine *machine, const mfdemu_snapshot *snapshot);
+void mfdemu_snapshot_free(mfdemu_snapshot *snapshot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -15,7 +15,10 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <cstdlib>
 #include <cstring>
+#include <optional>
+#include <utility>
 
 #include <shared/log.hpp>
 
@@ -27,11 +30,11 @@ using namespace shared::mri_types;
 
 namespace mfdemu {
 
-static std::vector<u8> parseCompact(const std::vector<u8> &data) {
+static std::optional<std::vector<u8>> parseCompact(const std::vector<u8> &data) {
 	const usize base_required_size = MRI_MIN_SIZE + sizeof(u32);
 	if(data.size() < base_required_size) {
 		logError() << "invalid MRI: input smaller than minimal needed size (2)\n";
-		std::exit(1);
+		return std::nullopt;
 	}
 
 	const u32 entry_count = BIGENDIAN32(
@@ -41,7 +44,7 @@ static std::vector<u8> parseCompact(const std::vector<u8> &data) {
 
 	if(data.size() < required_size) {
 		logError() << "invalid MRI: input smaller than minimal needed size (3)\n";
-		std::exit(1);
+		return std::nullopt;
 	}
 
 	std::vector<TableEntry> entries;
@@ -71,7 +74,7 @@ static std::vector<u8> parseCompact(const std::vector<u8> &data) {
 		if(entry.file_offset >= data.size() ||
 		   entry.file_offset + entry.length - 1 >= data.size()) {
 			logError() << "invalid MRI: unexpected end of input\n";
-			std::exit(1);
+			return std::nullopt;
 		}
 
 		for(u32 ix = 0; ix < entry.length; ix++) {
@@ -82,10 +85,10 @@ static std::vector<u8> parseCompact(const std::vector<u8> &data) {
 	return result;
 }
 
-std::vector<u8> parseMRIFromBytes(const std::vector<u8> &data) {
+std::optional<std::vector<u8>> tryParseMRIFromBytes(const std::vector<u8> &data) {
 	if(data.size() < MRI_MIN_SIZE) {
 		logError() << "invalid MRI: input smaller than minimal needed size (1)\n";
-		std::exit(1);
+		return std::nullopt;
 	}
 
 	Header header{};
@@ -94,13 +97,13 @@ std::vector<u8> parseMRIFromBytes(const std::vector<u8> &data) {
 	// NOLINTNEXTLINE
 	if(std::strcmp(header.magic, MRI_MAGIC) != 0) {
 		logError() << "invalid MRI: invalid magic\n";
-		std::exit(1);
+		return std::nullopt;
 	}
 
 	if(header.version != MRI_VERSION) {
 		logError() << "invalid MRI: version mismatch, supported version: " << std::hex
 				   << MRI_VERSION << std::dec << "\n";
-		std::exit(1);
+		return std::nullopt;
 	}
 
 	header.data_offset = BIGENDIAN32(header.data_offset);
@@ -109,7 +112,21 @@ std::vector<u8> parseMRIFromBytes(const std::vector<u8> &data) {
 		return parseCompact(data);
 	}
 
-	return {data.begin() + header.data_offset, data.end()};
+	if(header.data_offset > data.size()) {
+		logError() << "invalid MRI: data offset past the end of input\n";
+		return std::nullopt;
+	}
+
+	return std::vector<u8>(data.begin() + header.data_offset, data.end());
+}
+
+std::vector<u8> parseMRIFromBytes(const std::vector<u8> &data) {
+	std::optional<std::vector<u8>> result = tryParseMRIFromBytes(data);
+	if(!result.has_value()) {
+		std::exit(1);
+	}
+
+	return std::move(result.value());
 }
 
 }  // namespace mfdemu
\ No newline at end of file
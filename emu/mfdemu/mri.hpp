@@ -18,14 +18,24 @@
 #ifndef MFDEMU_MRI_HPP
 #define MFDEMU_MRI_HPP
 
+#include <optional>
 #include <vector>
 
 #include <shared/mri_types.hpp>
 
 namespace mfdemu {
 
+/**
+ * @brief Memory contents described by an MRI file, exits on invalid input.
+ */
 std::vector<u8> parseMRIFromBytes(const std::vector<u8> &data);
 
+/**
+ * @brief Like parseMRIFromBytes(), but logs the error and returns nothing on
+ * invalid input.
+ */
+std::optional<std::vector<u8>> tryParseMRIFromBytes(const std::vector<u8> &data);
+
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * ABI of GIO device plugins. A plugin is a shared object exporting
+ * mfdemu_plugin_describe(), which returns a descriptor that stays valid while
+ * the object is loaded. Each mapping of the plugin creates a new instance.
+ *
+ * Devices on the GIO bus are accessed through the transaction interface, one
+ * call per word transferred, or through the optional block interface when the
+ * Cpu moves a whole block with BIN/BOT. The optional pin-level clck() is only
+ * used when the device is connected to a Cpu directly. An instance interrupts
+ * the Cpu through the host callbacks it is created with.
+ */
+
+#ifndef MFDEMU_PLUGIN_H
+#define MFDEMU_PLUGIN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Incremented whenever the descriptor changes incompatibly. */
+#define MFDEMU_PLUGIN_ABI_VERSION 2
+
+/**
+ * Reads have no side effects and a port reads the same value until the device
+ * is written, the emulator may cache them and skip loops polling the device.
+ */
+#define MFDEMU_PLUGIN_CACHEABLE_READS (1u << 0)
+
+/** Bus lines of a GIO device, see DESIGN for the protocol. */
+typedef struct mfdemu_plugin_pins {
+	bool mode;
+	uint8_t io;
+} mfdemu_plugin_pins;
+
+/**
+ * Emulator services given to an instance, valid until it is destroyed. The
+ * callbacks may be called from any thread.
+ */
+typedef struct mfdemu_plugin_host {
+	/** passed back to every callback */
+	void *context;
+
+	/**
+	 * Raise or lower the interrupt line of the instance, given as irq in the
+	 * device description. Lines are level triggered, keep the line raised
+	 * until the request was served. Does nothing if the device has no irq.
+	 */
+	void (*set_irq)(void *context, bool raised);
+} mfdemu_plugin_host;
+
+typedef struct mfdemu_plugin_descriptor {
+	/** MFDEMU_PLUGIN_ABI_VERSION the plugin was built against */
+	uint32_t abi_version;
+	/** MFDEMU_PLUGIN_* flags */
+	uint32_t flags;
+	const char *name;
+
+	/**
+	 * Create an instance mapped to the ports first..last. params is the
+	 * string given in the device description, never NULL. Returns NULL on
+	 * failure.
+	 */
+	void *(*create)(
+		uint16_t first, uint16_t last, const char *params, const mfdemu_plugin_host *host);
+	void (*destroy)(void *instance);
+
+	/** Transaction interface, called once per word transferred. */
+	uint16_t (*read)(void *instance, uint16_t port);
+	void (*write)(void *instance, uint16_t port, uint16_t value);
+
+	/** Pin-level interface, may be NULL. Called once per bus clock. */
+	void (*clck)(void *instance, mfdemu_plugin_pins *pins);
+
+	/**
+	 * Block interface, either all NULL or all set. block_access() returns
+	 * true if the count words starting at port, advancing by 2 per word, may
+	 * be transferred by a single read_block() or write_block() call with the
+	 * same effect as one read() or write() per word.
+	 */
+	bool (*block_access)(void *instance, uint16_t port, size_t count);
+	void (*read_block)(void *instance, uint16_t port, uint16_t *out, size_t count);
+	void (*write_block)(void *instance, uint16_t port, const uint16_t *data, size_t count);
+} mfdemu_plugin_descriptor;
+
+typedef const mfdemu_plugin_descriptor *(*mfdemu_plugin_describe_fn)(void);
+
+/** The symbol every plugin exports. */
+#define MFDEMU_PLUGIN_DESCRIBE_SYMBOL "mfdemu_plugin_describe"
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <shared/cli/args.hpp>
+#include <shared/log.hpp>
+#include <shared/panic.hpp>
+
+#include <mfdemu/impl/farm/job.hpp>
+#include <mfdemu/impl/farm/pool.hpp>
+#include <mfdemu/impl/system.hpp>
+
+#define VERSION "0.0 (develop)"
+
+using namespace mfdemu;
+
+[[noreturn]] static void licenses() {
+	std::cerr << "MFDFARM "
+				 "--------------------------------------------------------------"
+				 "----------\n\n"
+			  << "Copyright (C) 2024  Marie Eckert\n"
+			  << "Licensed under the GPL v3 License.\n"
+			  << "See <https://www.gnu.org/licenses/>.\n";
+	std::exit(0);
+}
+
+/** exit code if any job did not pass */
+static constexpr int EXIT_FAILED_JOBS = 2;
+
+int main(int argc, char **argv) {
+	shared::program_name = "mfdfarm";
+
+	shared::cli::Argument<std::string> arg_verbosity("-v", "--verbosity");
+	shared::cli::Argument<bool> arg_licenses("-l", "--licenses", true);
+	shared::cli::Argument<std::string> arg_joblist("-i");
+	shared::cli::Argument<u64> arg_workers("-j", "--jobs");
+	shared::cli::Argument<std::string> arg_report("-o", "--report");
+	shared::cli::Argument<u16> arg_halt_port("--halt-port");
+	shared::cli::Argument<u64> arg_max_cycles("--max-cycles");
+	shared::cli::Argument<u64> arg_max_time("--max-time");
+	shared::cli::Argument<u64> arg_hang_cycles("--hang-cycles");
+
+	shared::cli::ArgumentParser parser;
+	parser.addArgument(&arg_verbosity);
+	parser.addArgument(&arg_licenses);
+	parser.addArgument(&arg_joblist);
+	parser.addArgument(&arg_workers);
+	parser.addArgument(&arg_report);
+	parser.addArgument(&arg_halt_port);
+	parser.addArgument(&arg_max_cycles);
+	parser.addArgument(&arg_max_time);
+	parser.addArgument(&arg_hang_cycles);
+	parser.parse(argc - 1, argv + 1);  // NOLINT
+
+	if(arg_licenses.get().value_or(false)) {
+		licenses();
+	}
+
+	shared::Logger::stringSetLogLevel(arg_verbosity.get().value_or(""));
+
+	std::cerr << "MFDFARM, batch runner for the mfdemu emulator\n"
+			  << "Copyright (C) 2024  Marie Eckert\n\n";
+
+	const std::optional<std::string> joblist = arg_joblist.get();
+	if(!joblist.has_value()) {
+		logError() << "no job list specified! specify using \"-i <file>\"\n";
+		return 1;
+	}
+
+	/* options given here apply to every job which does not set them itself */
+	impl::FarmJob defaults;
+	defaults.halt_port = arg_halt_port.get();
+	defaults.limits = {
+		.max_cycles = arg_max_cycles.get().value_or(0),
+		.max_time_ms = arg_max_time.get().value_or(0) * 1000,
+		.progress_cycles = arg_hang_cycles.get().value_or(0),
+	};
+
+	const std::optional<std::vector<impl::FarmJob>> jobs =
+		impl::readJobList(joblist.value(), defaults);
+	if(!jobs.has_value()) {
+		return 1;
+	}
+
+	std::ofstream report_file;
+	if(arg_report.get().has_value()) {
+		report_file.open(arg_report.get().value());
+		if(!report_file.is_open()) {
+			logError() << "could not open report " << arg_report.get().value() << "\n";
+			return 1;
+		}
+	}
+
+	impl::WorkStealingPool pool(arg_workers.get().value_or(0));
+
+	/* every worker reuses its System for all jobs it runs */
+	std::vector<std::unique_ptr<impl::System>> systems(pool.workers());
+	std::vector<impl::FarmResult> results(jobs->size());
+	std::mutex stderr_mutex;
+
+	const auto start = std::chrono::steady_clock::now();
+
+	pool.run(jobs->size(), [&](usize worker, usize task) {
+		if(systems[worker] == nullptr) {
+			systems[worker] = std::make_unique<impl::System>(0, UINT16_MAX);
+		}
+
+		const impl::FarmJob &job = jobs.value()[task];
+		results[task] = impl::runFarmJob(*systems[worker], job);
+
+		if(!results[task].report.empty()) {
+			const std::lock_guard<std::mutex> lock(stderr_mutex);
+			std::cerr << "job " << task << " (" << job.image_path << "):\n"
+					  << results[task].report;
+		}
+	});
+
+	const double seconds =
+		std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	impl::writeFarmReport(
+		report_file.is_open() ? report_file : std::cout, jobs.value(), results, seconds);
+
+	for(const impl::FarmResult &result: results) {
+		if(!result.passed) {
+			return EXIT_FAILED_JOBS;
+		}
+	}
+
+	return 0;
+}
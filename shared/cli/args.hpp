@@ -18,6 +18,7 @@
 #ifndef MFDASM_CLI_ARGS_HPP
 #define MFDASM_CLI_ARGS_HPP
 
+#include <iomanip>
 #include <ios>
 #include <optional>
 #include <sstream>
@@ -34,6 +35,9 @@ T getAs(const std::string &str) {
 	std::stringstream convert;
 	convert << std::boolalpha << str;
 
+	/* integers may be given in decimal, hexadecimal (0x) or octal (0) notation */
+	convert >> std::setbase(0);
+
 	T value;
 	convert >> value;
 	return value;
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <fstream>
+#include <ios>
+#include <string>
+
+#include "line_table.hpp"
+
+#include "log.hpp"
+
+namespace shared {
+
+static constexpr const char *LINE_TABLE_MAGIC = "MFDLINES";
+static constexpr u32 LINE_TABLE_VERSION = 1;
+
+bool LineTable::write(const std::string &path) const {
+	std::ofstream stream(path, std::ios::out | std::ios::trunc);
+	if(!stream.is_open()) {
+		logError() << "could not open line table \"" << path << "\" for writing\n";
+		return false;
+	}
+
+	stream << LINE_TABLE_MAGIC << " " << LINE_TABLE_VERSION << "\n"
+		   << "source " << source << "\n";
+
+	for(const LineTableEntry &entry: entries) {
+		stream << std::hex << entry.address << std::dec << " " << entry.lineno << "\n";
+	}
+
+	return stream.good();
+}
+
+std::optional<LineTable> LineTable::read(const std::string &path) {
+	std::ifstream stream(path, std::ios::in);
+	if(!stream.is_open()) {
+		logError() << "could not open line table \"" << path << "\"\n";
+		return std::nullopt;
+	}
+
+	std::string magic;
+	u32 version = 0;
+	stream >> magic >> version;
+	if(magic != LINE_TABLE_MAGIC || version != LINE_TABLE_VERSION) {
+		logError() << "invalid line table \"" << path << "\": bad magic or version\n";
+		return std::nullopt;
+	}
+
+	LineTable table;
+	std::string keyword;
+	stream >> keyword >> std::ws;
+	if(keyword != "source") {
+		logError() << "invalid line table \"" << path << "\": missing source\n";
+		return std::nullopt;
+	}
+	std::getline(stream, table.source);
+
+	u32 address = 0;
+	u32 lineno = 0;
+	while(stream >> std::hex >> address >> std::dec >> lineno) {
+		table.entries.push_back({.address = static_cast<u16>(address), .lineno = lineno});
+	}
+
+	return table;
+}
+
+}  // namespace shared
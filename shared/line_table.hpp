@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef SHARED_LINE_TABLE_HPP
+#define SHARED_LINE_TABLE_HPP
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "typedefs.hpp"
+
+namespace shared {
+
+struct LineTableEntry {
+	u16 address;
+	u32 lineno;
+};
+
+/**
+ * @brief Maps the addresses of assembled instructions back to the lines of
+ * the source file they were assembled from. Written by mfdasm, used by mfdemu
+ * for source level reports (e.g. coverage).
+ *
+ * The on-disk format is plain text:
+ *
+ *   MFDLINES 1
+ *   source <path>
+ *   <address> <lineno>
+ *   ...
+ *
+ * where addresses are written in hexadecimal and line numbers in decimal.
+ */
+struct LineTable {
+	std::string source;
+	std::vector<LineTableEntry> entries;
+
+	bool write(const std::string &path) const;
+
+	static std::optional<LineTable> read(const std::string &path);
+};
+
+}  // namespace shared
+
+#endif
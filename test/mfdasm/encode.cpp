@@ -97,4 +97,52 @@ TEST_SUITE("Instruction Encoding") {
 			section_ptr->data ==
 			std::vector<u8>{impl::Instruction::ST, 0b00000000 | 0b1010, 0x00, 0x64, 0x02});
 	}
+
+	TEST_CASE("encode forward references in operand 2") {
+		/* expected:
+		 * > Section
+		 * Offset 0, Size 8
+		 * > Bytes
+		 * 0: 0x04 (BOT)
+		 * 1: 0b00000001 (Op.1 IMM, Op.2 DIR)
+		 * 2: 0x10 (Op.1 HI)
+		 * 3: 0x00 (Op.1 LO)
+		 * 4: 0x00 (Op.2 HI)
+		 * 5: 0x06 (Op.2 LO, msg)
+		 * 6: 0x00 0x00 (msg)
+		 */
+		std::shared_ptr<impl::mri::Section> section_ptr = test::mfdasm::tryParseAndTranslateAsm(R"(
+			section a at 0
+			bot 0x1000, [msg]
+			msg: dw 0
+		)");
+		REQUIRE(section_ptr != nullptr);
+		CHECK(
+			section_ptr->data ==
+			std::vector<u8>{impl::Instruction::BOT, 0b0001, 0x10, 0x00, 0x00, 0x06, 0x00, 0x00});
+	}
+
+	TEST_CASE("line table") {
+		impl::Assembler asem;
+		REQUIRE(test::mfdasm::tryParseAsm(
+			R"(section a at 0x100
+			mov 100, acl
+			label:
+			st 100, [[acl]]
+			dw 0
+			jmp label)",
+			asem));
+
+		Result<impl::mri::SectionTable, impl::AsmError> maybe_bytes = asem.astToBytes();
+		REQUIRE(maybe_bytes.isOk());
+
+		const std::vector<shared::LineTableEntry> lines = maybe_bytes.unwrap().lines();
+		REQUIRE(lines.size() == 3);
+		CHECK(lines[0].address == 0x100);
+		CHECK(lines[0].lineno == 2);
+		CHECK(lines[1].address == 0x105);
+		CHECK(lines[1].lineno == 4);
+		CHECK(lines[2].address == 0x10c);
+		CHECK(lines[2].lineno == 6);
+	}
 }
\ No newline at end of file
@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <mfdemu/impl/bus/aio_device.hpp>
+#include <mfdemu/impl/bus/gio_bus.hpp>
+#include <mfdemu/impl/cpu.hpp>
+#include <mfdemu/impl/devices/terminal.hpp>
+#include <mfdemu/impl/instructions.hpp>
+
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>
+
+#include "test_cpu.hpp"
+
+namespace test::mfdemu {
+constexpr u16 TERMINAL_PORT = 0x1000;
+constexpr u16 SPIN_IP = 0x45;
+
+/* 0x00: ld  acl, 40
+ * 0x05: bin 0x1000, [0x2000]
+ * 0x0b: ld  acl, 40
+ * 0x10: bot 0x1000, [0x2000]
+ * 0x16: ld  acl, 10
+ * 0x1b: bin 0x1000, dcl
+ * 0x20: ld  acl, 5
+ * 0x25: ld  bcl, 0x2100
+ * 0x2a: bot 0x1000, bcl             ; writes the value of bcl as it is
+ * 0x2f: ld  acl, 0                  ; 256 words from unmapped ports
+ * 0x34: bin 0x3000, [0x2000]
+ * 0x3a: ld  acl, 8
+ * 0x3f: bot 0x3000, [0x2000]
+ * 0x45: jmp 0x45 */
+static const std::vector<u8> BLOCK_CODE = {
+	OPCODE_LD,	0x80, REGISTER_ACL, 0x00, 40,	OPCODE_BIN, 0x01, 0x10, 0x00, 0x20, 0x00,
+	OPCODE_LD,	0x80, REGISTER_ACL, 0x00, 40,	OPCODE_BOT, 0x01, 0x10, 0x00, 0x20, 0x00,
+	OPCODE_LD,	0x80, REGISTER_ACL, 0x00, 10,	OPCODE_BIN, 0x08, 0x10, 0x00, REGISTER_DCL,
+	OPCODE_LD,	0x80, REGISTER_ACL, 0x00, 5,	OPCODE_LD,	0x80, REGISTER_BCL, 0x21, 0x00,
+	OPCODE_BOT, 0x08, 0x10, 0x00, REGISTER_BCL, OPCODE_LD,	0x80, REGISTER_ACL, 0x00, 0,
+	OPCODE_BIN, 0x01, 0x30, 0x00, 0x20, 0x00,	OPCODE_LD,	0x80, REGISTER_ACL, 0x00, 8,
+	OPCODE_BOT, 0x01, 0x30, 0x00, 0x20, 0x00,	OPCODE_JMP, 0x00, 0x00, SPIN_IP,
+};
+
+struct BlockRun {
+	u64 clocks;
+	Cpu::RegisterFile registers;
+	std::string perf;
+	std::vector<u8> memory;
+	std::string output;
+	u64 volatile_reads;
+};
+
+static std::string readFile(const std::string &path) {
+	std::ifstream stream(path, std::ios::binary);
+	return {std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+}
+
+/* runs BLOCK_CODE up to the final jmp, a window of 0 disables block transfers */
+static BlockRun runBlockCode(u64 window) {
+	const std::string input = "/tmp/emu_block_test_in." + std::to_string(getpid());
+	const std::string output = "/tmp/emu_block_test_out." + std::to_string(getpid());
+	{
+		std::ofstream stream(input, std::ios::binary);
+		stream << "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+	}
+
+	std::vector<u8> code = BLOCK_CODE;
+	code.resize(0x10000);
+	code[0xfffe] = 0x00;
+	code[0xffff] = 0x00;
+
+	auto memory = std::make_shared<AioDevice>(false, code.size());
+	memory->setData(code);
+
+	auto terminal = std::make_shared<Terminal>(
+		open(input.c_str(), O_RDONLY | O_CLOEXEC),
+		open(output.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644));
+	terminal->start();
+	auto io_bus = std::make_shared<GioBus>();
+	io_bus->mapDevice(TERMINAL_PORT, TERMINAL_PORT, terminal);
+
+	CpuTest cpu;
+	cpu.connectAddressDevice(memory);
+	cpu.connectIoDevice(io_bus);
+	cpu.newState(CpuTest::CpuState::INST_FETCH);
+
+	BlockRun run{};
+	while(!cpu.atInstructionBoundary() || cpu.ip() != SPIN_IP) {
+		cpu.iclck();
+		run.clocks++;
+		if(window > 0 && cpu.inBlockLoop()) {
+			cpu.blockTransfer(cpu.cycles() + window);
+		}
+	}
+
+	terminal->flush();
+	terminal.reset();
+
+	std::ostringstream perf;
+	cpu.perfCounters().writeJson(perf);
+	run.registers = cpu.registerFile();
+	run.perf = perf.str();
+	run.memory = memory->data();
+	run.output = readFile(output);
+	run.volatile_reads = io_bus->volatileReads();
+
+	std::remove(input.c_str());
+	std::remove(output.c_str());
+	return run;
+}
+
+TEST_SUITE("Block I/O") {
+	TEST_CASE("block transfers match word by word execution") {
+		const BlockRun reference = runBlockCode(0);
+		CHECK_EQ(reference.output.substr(0, 40), "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMN");
+		CHECK_EQ(reference.output.substr(40), "!!!!!");
+		CHECK_EQ(reference.registers[3], 'X' << 8);
+
+		/* a small window splits the words over several block transfers */
+		for(const u64 window: {UINT64_MAX / 2, u64{50}}) {
+			const BlockRun run = runBlockCode(window);
+			CHECK_LT(run.clocks, reference.clocks);
+			CHECK(run.registers == reference.registers);
+			CHECK_EQ(run.perf, reference.perf);
+			CHECK(run.memory == reference.memory);
+			CHECK_EQ(run.output, reference.output);
+			CHECK_EQ(run.volatile_reads, reference.volatile_reads);
+		}
+	}
+}
+}  // namespace test::mfdemu
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <mfdemu/impl/bus/aio_device.hpp>
+#include <mfdemu/impl/cpu.hpp>
+#include <mfdemu/impl/debug/condition.hpp>
+#include <mfdemu/impl/instructions.hpp>
+
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>
+
+#include "test_cpu.hpp"
+
+namespace test::mfdemu {
+TEST_SUITE("Breakpoints") {
+	TEST_CASE("condition evaluation") {
+		CpuTest cpu;
+		cpu.m_regACL = 0x10;
+		cpu.m_regFL.zf = true;
+
+		auto check = [&cpu](const char *source, bool expected) {
+			const std::optional<Condition> condition = Condition::compile(source);
+			REQUIRE(condition.has_value());
+			CHECK_EQ(condition->evaluate(cpu), expected);
+		};
+
+		check("acl == 0x10 && fl.zf", true);
+		check("acl == 0x10 && !fl.zf", false);
+		check("al == 0x10 || ah != 0", true);
+		check("(acl + 2) == 0x12", true);
+		check("acl - 0x11 == 0xffff", true);
+		check("acl & 0x30 == 0x10", false);
+		check("(acl & 0x30) == 0x10", true);
+		check("acl >= 16 && acl < 17 && ~acl != 0", true);
+
+		CHECK_FALSE(Condition::compile("acl ==").has_value());
+		CHECK_FALSE(Condition::compile("xyz == 1").has_value());
+		CHECK_FALSE(Condition::compile("fl.xx").has_value());
+		CHECK_FALSE(Condition::compile("0x10000").has_value());
+
+		std::string deep = "acl";
+		for(usize ix = 0; ix < Condition::MAX_STACK_DEPTH; ix++) {
+			deep = "1 + (" + deep + ")";
+		}
+		CHECK_FALSE(Condition::compile(deep).has_value());
+	}
+
+	TEST_CASE("stop, resume and step") {
+		/* inc acl (x4) */
+		std::vector<u8> code = {
+			OPCODE_INC, 0x80, REGISTER_ACL, OPCODE_INC, 0x80, REGISTER_ACL,
+			OPCODE_INC, 0x80, REGISTER_ACL, OPCODE_INC, 0x80, REGISTER_ACL,
+		};
+		code.resize(0x10000);
+
+		auto memory = std::make_shared<AioDevice>(false, code.size());
+		memory->setData(code);
+
+		CpuTest cpu;
+		cpu.connectAddressDevice(memory);
+		cpu.newState(CpuTest::CpuState::INST_FETCH);
+		cpu.breakpoints().set(0x0003, Condition::compile("acl == 5"));
+		cpu.breakpoints().set(0x0006, Condition::compile("acl == 2"));
+
+		auto run_until_stopped = [&cpu]() {
+			for(int ix = 0; ix < 1000 && !cpu.stopped(); ix++) {
+				cpu.iclck();
+			}
+		};
+
+		run_until_stopped();
+		REQUIRE(cpu.stopped());
+		CHECK_EQ(cpu.m_regIP, 0x0006);
+		CHECK_EQ(cpu.m_regACL, 2);
+		CHECK_EQ(cpu.breakpoints().list().at(0x0003).hits, 0);
+		CHECK_EQ(cpu.breakpoints().list().at(0x0006).hits, 1);
+		CHECK_EQ(cpu.perfCounters().retired, 2);
+
+		cpu.step();
+		run_until_stopped();
+		REQUIRE(cpu.stopped());
+		CHECK_EQ(cpu.m_regIP, 0x0009);
+		CHECK_EQ(cpu.m_regACL, 3);
+
+		cpu.writeRegister(REGISTER_ACL, 0x10);
+		cpu.breakpoints().clear();
+		cpu.resume();
+		while(cpu.perfCounters().retired < 4) {
+			cpu.iclck();
+		}
+
+		CHECK_FALSE(cpu.stopped());
+		CHECK_EQ(cpu.m_regACL, 0x11);
+	}
+}
+}  // namespace test::mfdemu
@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <array>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <mfdemu/impl/bus/gio_bus.hpp>
+#include <mfdemu/impl/devices/terminal.hpp>
+#include <mfdemu/impl/system.hpp>
+#include <mfdemu/mri.hpp>
+
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>
+
+#include "test_cpu.hpp"
+
+namespace test::mfdemu {
+
+/* MRI of:
+ *
+ * 0x1100:       mov  0x0f00, sp
+ * 0x1105:       ld   dcl, 0
+ * 0x110a:       sti
+ * 0x110c: wait: cmp  dcl, 3            ; wait for three console interrupts
+ * 0x1111:       jnz  wait
+ * 0x1115:       out  ccl, HALT         ; HALT = 0x1001
+ * 0x111a: spin: jmp  spin
+ * 0x111e: isr:  in   TERMINAL, bcl
+ * 0x1123:       mov  iid, ccl
+ * 0x1127:       inc  dcl
+ * 0x112a:       iret */
+/* clang-format off */
+static const std::vector<u8> IRQ_MRI = {
+	0x4d, 0x52, 0x49, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x54,
+	0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x24,
+	0x11, 0x00, 0x00, 0x2c, 0x00, 0x00, 0x00, 0x50, 0xff, 0xfc, 0x00, 0x04,
+	0x1c, 0x08, 0x0f, 0x00, 0x0c, 0x1b, 0x80, 0x0b, 0x00, 0x00, 0x3f, 0x00,
+	0x07, 0x80, 0x0b, 0x00, 0x03, 0x18, 0x00, 0x11, 0x0c, 0x22, 0x80, 0x08,
+	0x10, 0x01, 0x10, 0x00, 0x11, 0x1a, 0x0c, 0x08, 0x10, 0x00, 0x05, 0x1c,
+	0x88, 0x10, 0x08, 0x0d, 0x80, 0x0b, 0x0f, 0x00, 0x11, 0x1e, 0x11, 0x00,
+};
+
+/* MRI of:
+ *
+ * 0x1100:       ld   acl, 3
+ * 0x1105:       bot  TERMINAL, [msg]   ; msg = 0x2000: dw 0x4f00, 0x4b00, 0x0a00
+ * 0x110b:       ld   acl, 2
+ * 0x1110:       ld   bcl, 0x2100
+ * 0x1115:       bot  TERMINAL, bcl
+ * 0x111a:       out  acl, HALT
+ * 0x111f: spin: jmp  spin */
+static const std::vector<u8> BOT_MRI = {
+	0x4d, 0x52, 0x49, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x59,
+	0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x2c,
+	0x11, 0x00, 0x00, 0x23, 0x00, 0x00, 0x00, 0x4f, 0x20, 0x00, 0x00, 0x06,
+	0x00, 0x00, 0x00, 0x55, 0xff, 0xfc, 0x00, 0x04, 0x1b, 0x80, 0x02, 0x00,
+	0x03, 0x04, 0x01, 0x10, 0x00, 0x20, 0x00, 0x1b, 0x80, 0x02, 0x00, 0x02,
+	0x1b, 0x80, 0x05, 0x21, 0x00, 0x04, 0x08, 0x10, 0x00, 0x05, 0x22, 0x80,
+	0x02, 0x10, 0x01, 0x10, 0x00, 0x11, 0x1f, 0x4f, 0x00, 0x4b, 0x00, 0x0a,
+	0x00, 0x00, 0x00, 0x11, 0x00,
+};
+/* clang-format on */
+
+static std::string readFile(const std::string &path) {
+	std::ifstream stream(path, std::ios::in | std::ios::binary);
+	return {std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+}
+
+/* run a whole GIO transaction, returns the word read */
+static u16 transfer(CpuTest &cpu, bool write, u16 port, u16 value = 0) {
+	cpu.newState(write ? CpuTest::CpuState::GIO_WRITE : CpuTest::CpuState::GIO_READ);
+	cpu.m_ioBusAddress = port;
+	cpu.m_ioBusOutput = value;
+	for(int cycle = 0; cycle < 5; cycle++) {
+		cpu.iclck();
+	}
+
+	return cpu.m_ioBusInput;
+}
+
+static u16 readPort(CpuTest &cpu, u16 port) {
+	return transfer(cpu, false, port);
+}
+
+TEST_SUITE("Console") {
+	TEST_CASE("reader thread and status port") {
+		std::array<int, 2> fds{};
+		REQUIRE(pipe(fds.data()) == 0);
+
+		auto terminal = std::make_shared<Terminal>(fds[0], -1);
+		terminal->setStatusPort(0x1002);
+
+		auto bus = std::make_shared<GioBus>();
+		bus->mapDevice(0x1000, 0x1000, terminal);
+		bus->mapDevice(0x1002, 0x1002, terminal);
+		terminal->setInterrupt(&bus->interrupts(), 4);
+		terminal->start();
+
+		CpuTest cpu;
+		cpu.connectIoDevice(bus);
+
+		/* nothing buffered, reads return right away */
+		CHECK_EQ(readPort(cpu, 0x1002), 0);
+		CHECK_EQ(readPort(cpu, 0x1000), 0);
+		CHECK_FALSE(bus->interrupts().pending());
+
+		REQUIRE(write(fds[1], "ab", 2) == 2);
+		while(terminal->available() < 2) {
+			usleep(100);
+		}
+
+		CHECK(bus->interrupts().pending());
+		CHECK_EQ(bus->interrupts().acknowledge(), 4);
+		CHECK_EQ(readPort(cpu, 0x1002), 2);
+		CHECK_EQ(readPort(cpu, 0x1000), 'a' << 8);
+		CHECK_EQ(readPort(cpu, 0x1002), 1);
+		CHECK_EQ(readPort(cpu, 0x1000), 'b' << 8);
+		CHECK_EQ(readPort(cpu, 0x1002), 0);
+		CHECK_FALSE(bus->interrupts().pending());
+
+		close(fds[1]);
+	}
+
+	TEST_CASE("interrupt delivery") {
+		const std::string input = "/tmp/emu_console_test." + std::to_string(getpid());
+		std::ofstream(input) << "xyz";
+
+		System system(0, UINT16_MAX);
+		system.setMainMemoryData(::mfdemu::parseMRIFromBytes(IRQ_MRI));
+		REQUIRE(system.setConsole({.headless = true, .input = input, .output = "/dev/null"}));
+		system.setConsoleInterrupt(9);
+		system.setHaltPort(0x1001);
+		system.run();
+
+		/* each byte interrupted once and was read by the handler */
+		CHECK_EQ(system.stopReason(), System::StopReason::HALT);
+		CHECK_EQ(system.guestStatus(), 9);
+		CHECK_EQ(system.cpu().readRegister(REGISTER_DCL), 3);
+		CHECK_EQ(system.cpu().readRegister(REGISTER_BCL), 'z' << 8);
+		CHECK_EQ(system.cpu().readRegister(REGISTER_IID), 0);
+		CHECK_EQ(system.cpu().readRegister(REGISTER_SP), 0x0f00);
+
+		/* taking interrupts leaves nothing behind on the state stack, only the
+		 * fetch below the OUT to the halt port remains once it finished */
+		Cpu &cpu = system.cpu();
+		while(cpu.saveContext().state.top() != Cpu::CpuState::INST_FETCH) {
+			cpu.iclck();
+		}
+		CHECK_EQ(cpu.saveContext().state.size(), 1);
+
+		std::remove(input.c_str());
+	}
+
+	TEST_CASE("buffered output") {
+		const std::string output = "/tmp/emu_console_test." + std::to_string(getpid());
+		const int fd = open(output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		REQUIRE(fd >= 0);
+
+		auto terminal = std::make_shared<Terminal>(-1, fd);
+		auto bus = std::make_shared<GioBus>();
+		bus->mapDevice(0x1000, 0x1000, terminal);
+		CpuTest cpu;
+		cpu.connectIoDevice(bus);
+
+		/* only the high byte is printed, a newline flushes */
+		transfer(cpu, true, 0x1000, 'a' << 8 | 'x');
+		transfer(cpu, true, 0x1000, 'b' << 8);
+		CHECK_EQ(readFile(output), "");
+		transfer(cpu, true, 0x1000, '\n' << 8);
+		CHECK_EQ(readFile(output), "ab\n");
+
+		transfer(cpu, true, 0x1000, 'c' << 8);
+		terminal->flushExpired();
+		CHECK_EQ(readFile(output), "ab\n");
+		usleep((Terminal::FLUSH_DELAY_MS + 5) * 1000);
+		terminal->flushExpired();
+		CHECK_EQ(readFile(output), "ab\nc");
+
+		/* reading flushes so that prompts are visible */
+		transfer(cpu, true, 0x1000, '>' << 8);
+		readPort(cpu, 0x1000);
+		CHECK_EQ(readFile(output), "ab\nc>");
+
+		std::remove(output.c_str());
+	}
+
+	TEST_CASE("block output to the stream port") {
+		const std::string output = "/tmp/emu_console_test." + std::to_string(getpid());
+
+		System system(0, UINT16_MAX);
+		system.setMainMemoryData(::mfdemu::parseMRIFromBytes(BOT_MRI));
+		REQUIRE(system.setConsole({.headless = true, .input = "", .output = output}));
+		system.setHaltPort(0x1001);
+		system.run();
+
+		CHECK_EQ(system.stopReason(), System::StopReason::HALT);
+		CHECK_EQ(system.guestStatus(), 0);
+		CHECK_EQ(readFile(output), "OK\n!!");
+
+		std::remove(output.c_str());
+	}
+}
+}  // namespace test::mfdemu
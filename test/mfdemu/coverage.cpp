@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <shared/line_table.hpp>
+
+#include <mfdemu/impl/bus/aio_device.hpp>
+#include <mfdemu/impl/bus/gio_bus.hpp>
+#include <mfdemu/impl/coverage.hpp>
+#include <mfdemu/impl/instructions.hpp>
+
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>
+
+#include "test_cpu.hpp"
+
+namespace test::mfdemu {
+/* 0x00:       mov 3, acl
+ * 0x05: loop: dec acl
+ * 0x08:       cmp acl, 0
+ * 0x0d:       jnz loop
+ * 0x11: end:  jmp end
+ * 0x15:       jz end */
+static const std::vector<u8> LOOP_CODE = {
+	OPCODE_MOV, 0x08, 0x00, 0x03, REGISTER_ACL,
+	OPCODE_DEC, 0x80, REGISTER_ACL,
+	OPCODE_CMP, 0x80, REGISTER_ACL, 0x00, 0x00,
+	OPCODE_JNZ, 0x00, 0x00, 0x05,
+	OPCODE_JMP, 0x00, 0x00, 0x11,
+	OPCODE_JZ,  0x00, 0x00, 0x11,
+};
+
+static void runLoopCode(CpuTest &cpu) {
+	std::vector<u8> code = LOOP_CODE;
+	code.resize(0x10000);
+
+	auto memory = std::make_shared<AioDevice>(false, code.size());
+	memory->setData(code);
+
+	cpu.connectAddressDevice(memory);
+	cpu.connectIoDevice(std::make_shared<GioBus>());
+	cpu.newState(CpuTest::CpuState::INST_FETCH);
+	while(cpu.cycles() < 1000) {
+		cpu.iclck();
+	}
+}
+
+TEST_SUITE("Coverage") {
+	TEST_CASE("executed instructions and branch outcomes") {
+		CpuTest cpu;
+		runLoopCode(cpu);
+		const Coverage &coverage = cpu.coverage();
+
+		CHECK(coverage.executed(0x00));
+		CHECK(coverage.executed(0x05));
+		CHECK(coverage.executed(0x08));
+		CHECK(coverage.executed(0x0d));
+		CHECK(coverage.executed(0x11));
+		CHECK_FALSE(coverage.executed(0x15));
+
+		/* operand bytes are never fetched as instructions */
+		CHECK_FALSE(coverage.executed(0x01));
+		CHECK_FALSE(coverage.executed(0x0e));
+
+		CHECK(coverage.taken(0x0d));
+		CHECK(coverage.notTaken(0x0d));
+		CHECK_FALSE(coverage.taken(0x15));
+		CHECK_FALSE(coverage.notTaken(0x15));
+
+		/* unconditional jumps are not branches */
+		CHECK_FALSE(coverage.taken(0x11));
+		CHECK_FALSE(coverage.notTaken(0x11));
+	}
+
+	TEST_CASE("lcov tracefile") {
+		CpuTest cpu;
+		runLoopCode(cpu);
+
+		shared::LineTable lines;
+		lines.source = "loop.asm";
+		lines.entries = {{0x00, 1}, {0x05, 2}, {0x08, 3}, {0x0d, 4}, {0x11, 5}, {0x15, 6}};
+
+		const std::string tmp_file = "/tmp/emu_coverage_test." + std::to_string(getpid());
+		REQUIRE(cpu.coverage().writeLcov(tmp_file, lines, LOOP_CODE));
+
+		std::ifstream stream(tmp_file);
+		std::stringstream contents;
+		contents << stream.rdbuf();
+		std::remove(tmp_file.c_str());
+
+		CHECK_EQ(contents.str(),
+				 "TN:\n"
+				 "SF:loop.asm\n"
+				 "BRDA:4,0,0,1\n"
+				 "BRDA:4,0,1,1\n"
+				 "BRDA:6,0,0,-\n"
+				 "BRDA:6,0,1,-\n"
+				 "BRF:4\n"
+				 "BRH:2\n"
+				 "DA:1,1\n"
+				 "DA:2,1\n"
+				 "DA:3,1\n"
+				 "DA:4,1\n"
+				 "DA:5,1\n"
+				 "DA:6,0\n"
+				 "LF:6\n"
+				 "LH:5\n"
+				 "end_of_record\n");
+	}
+}
+}  // namespace test::mfdemu
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+#include <vector>
+
+#include <mfdemu/impl/bus/aio_device.hpp>
+#include <mfdemu/impl/bus/gio_bus.hpp>
+#include <mfdemu/impl/devices/dma.hpp>
+#include <mfdemu/impl/scheduler.hpp>
+
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>
+
+#include "test_cpu.hpp"
+
+namespace test::mfdemu {
+constexpr u16 DMA_BASE = 0x4000;
+constexpr u8 DMA_IRQ = 7;
+
+TEST_SUITE("DMA") {
+	TEST_CASE("copy, fill and completion interrupt") {
+		PerfCounters counters;
+		EventScheduler scheduler;
+		AioDevice memory(false, 0x10000);
+		std::vector<u8> data(0x10000);
+		for(usize ix = 0; ix < 8; ix++) {
+			data[0x1000 + ix] = ix + 1;
+		}
+		memory.setData(data);
+
+		auto dma = std::make_shared<DmaDevice>(DMA_BASE, memory, scheduler, counters, 3);
+		auto bus = std::make_shared<GioBus>();
+		dma->setInterrupt(&bus->interrupts(), DMA_IRQ);
+		bus->mapDevice(DMA_BASE, DMA_BASE + DmaDevice::PORT_COUNT - 1, dma);
+
+		CpuTest cpu;
+		cpu.connectIoDevice(bus);
+
+		/* overlapping copy one word up, 8 bytes are 4 words at 3 cycles */
+		gioWrite(cpu, DMA_BASE + DmaDevice::PORT_SOURCE, 0x1000);
+		gioWrite(cpu, DMA_BASE + DmaDevice::PORT_DESTINATION, 0x1002);
+		gioWrite(cpu, DMA_BASE + DmaDevice::PORT_LENGTH, 8);
+		gioWrite(cpu, DMA_BASE + DmaDevice::PORT_COMMAND, DmaDevice::COMMAND_COPY);
+		CHECK_EQ(gioRead(cpu, DMA_BASE + DmaDevice::PORT_COMMAND), DmaDevice::STATUS_BUSY);
+		CHECK_EQ(scheduler.nextCycle(), 12);
+
+		/* commands are ignored while busy */
+		gioWrite(cpu, DMA_BASE + DmaDevice::PORT_COMMAND, DmaDevice::COMMAND_FILL);
+
+		counters.cycles = 12;
+		scheduler.runDue(counters.cycles);
+		CHECK_EQ(gioRead(cpu, DMA_BASE + DmaDevice::PORT_COMMAND), DmaDevice::STATUS_DONE);
+		CHECK_EQ(memory.readWord(0x1000), 0x0102);
+		CHECK_EQ(memory.readWord(0x1002), 0x0102);
+		CHECK_EQ(memory.readWord(0x1004), 0x0304);
+		CHECK_EQ(memory.readWord(0x1008), 0x0708);
+		CHECK_EQ(memory.readWord(0x100a), 0);
+		CHECK(bus->interrupts().pending());
+
+		gioWrite(cpu, DMA_BASE + DmaDevice::PORT_COMMAND, DmaDevice::COMMAND_ACKNOWLEDGE);
+		CHECK_EQ(gioRead(cpu, DMA_BASE + DmaDevice::PORT_COMMAND), 0);
+		CHECK_FALSE(bus->interrupts().pending());
+
+		/* odd fill lengths end on the high byte of the fill word */
+		gioWrite(cpu, DMA_BASE + DmaDevice::PORT_DESTINATION, 0x2000);
+		gioWrite(cpu, DMA_BASE + DmaDevice::PORT_LENGTH, 5);
+		gioWrite(cpu, DMA_BASE + DmaDevice::PORT_FILL, 0xbeef);
+		gioWrite(cpu, DMA_BASE + DmaDevice::PORT_COMMAND, DmaDevice::COMMAND_FILL);
+		CHECK_EQ(scheduler.nextCycle(), 12 + 9);
+
+		counters.cycles += 9;
+		scheduler.runDue(counters.cycles);
+		CHECK_EQ(memory.readWord(0x2000), 0xbeef);
+		CHECK_EQ(memory.readWord(0x2002), 0xbeef);
+		CHECK_EQ(memory.readWord(0x2004), 0xbe00);
+		CHECK(memory.takeDirtyPages()[0x20]);
+	}
+}
+}  // namespace test::mfdemu
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include <mfdemu/impl/farm/job.hpp>
+#include <mfdemu/impl/farm/pool.hpp>
+#include <mfdemu/impl/instructions.hpp>
+#include <mfdemu/impl/system.hpp>
+
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>
+
+namespace test::mfdemu {
+using namespace ::mfdemu::impl;
+
+/* 0x0100: ld  acl, 0x0005
+ *         out acl, 0x1001
+ * 0x010a: jmp 0x010a */
+static std::vector<u8> haltingProgram() {
+	std::vector<u8> code(0x10000);
+	const std::vector<u8> program = {
+		OPCODE_LD,	0x80, REGISTER_ACL, 0x00, 0x05, OPCODE_OUT, 0x80,
+		REGISTER_ACL, 0x10, 0x01,		  OPCODE_JMP, 0x00, 0x01, 0x0a,
+	};
+	std::copy(program.begin(), program.end(), code.begin() + 0x0100);
+	code[RESET_VECTOR] = 0x01;
+	code[RESET_VECTOR + 1] = 0x00;
+	return code;
+}
+
+TEST_SUITE("Farm") {
+	TEST_CASE("every task runs exactly once") {
+		constexpr usize TASKS = 1000;
+		WorkStealingPool pool(4);
+		REQUIRE_EQ(pool.workers(), 4);
+
+		std::vector<std::atomic<u32>> runs(TASKS);
+		std::atomic<bool> bad_worker{false};
+		pool.run(TASKS, [&](usize worker, usize task) {
+			if(worker >= pool.workers()) {
+				bad_worker = true;
+			}
+			runs[task]++;
+		});
+
+		CHECK_FALSE(bad_worker);
+		CHECK(std::all_of(runs.begin(), runs.end(), [](const auto &count) { return count == 1; }));
+
+		/* the pool can be used again */
+		pool.run(TASKS, [&](usize, usize task) { runs[task]++; });
+		CHECK(std::all_of(runs.begin(), runs.end(), [](const auto &count) { return count == 2; }));
+	}
+
+	TEST_CASE("job lines") {
+		FarmJob defaults;
+		defaults.halt_port = 0x1001;
+		defaults.limits.max_cycles = 1000;
+
+		const std::optional<FarmJob> job =
+			FarmJob::parse("a.mri out=a.txt max-time=2 exit-ip=0x1234 expect=3", defaults);
+		REQUIRE(job.has_value());
+		CHECK_EQ(job->image_path, "a.mri");
+		CHECK_EQ(job->console_out, "a.txt");
+		CHECK(job->console_in.empty());
+		CHECK_EQ(job->limits.max_cycles, 1000);
+		CHECK_EQ(job->limits.max_time_ms, 2000);
+		CHECK_EQ(job->halt_port.value(), 0x1001);
+		CHECK_EQ(job->exit_ip.value(), 0x1234);
+		CHECK_EQ(job->expected_status.value(), 3);
+
+		CHECK_FALSE(FarmJob::parse("a.mri exit-ip=0x10000", defaults).has_value());
+		CHECK_FALSE(FarmJob::parse("a.mri speed=3", defaults).has_value());
+		CHECK_FALSE(FarmJob::parse("a.mri expect", defaults).has_value());
+	}
+
+	TEST_CASE("systems are reused across jobs") {
+		FarmJob job;
+		job.image = std::make_shared<const MemoryImage>(haltingProgram());
+		job.halt_port = 0x1001;
+		job.expected_status = 5;
+
+		System system(0, UINT16_MAX);
+		const FarmResult first = runFarmJob(system, job);
+		CHECK_EQ(first.reason, System::StopReason::HALT);
+		CHECK_EQ(first.guest_status, 5);
+		CHECK(first.passed);
+
+		/* a job which fails must not leak its options into the next one */
+		FarmJob failing = job;
+		failing.halt_port.reset();
+		failing.limits.max_cycles = 5000;
+		const FarmResult second = runFarmJob(system, failing);
+		CHECK_EQ(second.reason, System::StopReason::CYCLE_LIMIT);
+		CHECK_FALSE(second.passed);
+		CHECK_FALSE(second.report.empty());
+
+		const FarmResult third = runFarmJob(system, job);
+		CHECK_EQ(third.reason, System::StopReason::HALT);
+		CHECK_EQ(third.cycles, first.cycles);
+		CHECK_EQ(third.retired, first.retired);
+		CHECK(third.passed);
+	}
+}
+}  // namespace test::mfdemu
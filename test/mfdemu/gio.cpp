@@ -1,5 +1,6 @@
 #include <memory>
 
+#include <mfdemu/impl/bus/gio_bus.hpp>
 #include <mfdemu/impl/bus/gio_device.hpp>
 #include <mfdemu/impl/cpu.hpp>
 
@@ -69,5 +70,18 @@ TEST_SUITE("GIO") {
 
 		REQUIRE_EQ(cpu.m_ioBusInput, 0xfeed);
 	}
+
+	TEST_CASE("bus port ranges") {
+		auto test_dev = std::make_shared<GioDeviceTest>();
+		GioBus bus;
+
+		CHECK_FALSE(bus.mapDevice(10, 5, test_dev));
+		CHECK_FALSE(bus.mapped(5));
+		CHECK_FALSE(bus.mapped(10));
+
+		CHECK(bus.mapDevice(0xfff0, 0xffff, test_dev));
+		CHECK(bus.mapped(0xffff));
+		CHECK_FALSE(bus.mapped(0xffef));
+	}
 }
 }  // namespace test::mfdemu
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include <mfdemu/impl/bus/aio_device.hpp>
+#include <mfdemu/impl/cpu.hpp>
+#include <mfdemu/impl/hang_detector.hpp>
+#include <mfdemu/impl/instructions.hpp>
+
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>
+
+#include "test_cpu.hpp"
+
+namespace test::mfdemu {
+TEST_SUITE("HangDetector") {
+	TEST_CASE("limits, call stack and trace") {
+		/* call 0x0010
+		 * ...
+		 * 0x0010: inc acl
+		 *         jmp 0x0010 */
+		std::vector<u8> code = {OPCODE_CALL, 0x00, 0x00, 0x10};
+		code.resize(0x10);
+		code.insert(
+			code.end(), {OPCODE_INC, 0x80, REGISTER_ACL, OPCODE_JMP, 0x00, 0x00, 0x10});
+		code.resize(0x10000);
+
+		auto memory = std::make_shared<AioDevice>(false, code.size());
+		memory->setData(code);
+
+		CpuTest cpu;
+		cpu.m_regSP = 0x8000;
+		cpu.connectAddressDevice(memory);
+		cpu.newState(CpuTest::CpuState::INST_FETCH);
+		cpu.enableTrace();
+
+		constexpr u64 PROGRESS_CYCLES = 100000;
+		HangDetector detector(
+			cpu, {.max_cycles = 1000000, .max_time_ms = 0, .progress_cycles = PROGRESS_CYCLES});
+		CHECK_EQ(detector.cycleLimit(), 1000000);
+
+		HangDetector::Reason reason = HangDetector::Reason::NONE;
+		while(reason == HangDetector::Reason::NONE) {
+			cpu.iclck();
+			reason = detector.check();
+		}
+
+		CHECK_EQ(reason, HangDetector::Reason::NO_PROGRESS);
+		CHECK_GE(cpu.cycles(), PROGRESS_CYCLES);
+		CHECK_LT(cpu.cycles(), PROGRESS_CYCLES + (2 * HangDetector::SAMPLE_INTERVAL));
+		CHECK_EQ(cpu.m_regSP, 0x7ffe);
+
+		const ExecutionTrace &trace = *cpu.trace();
+		REQUIRE_EQ(trace.callStack().size(), 1);
+		CHECK_EQ(trace.callStack()[0].call_site, 0x0000);
+		CHECK_EQ(trace.callStack()[0].target, 0x0010);
+		CHECK_EQ(trace.entries().size(), ExecutionTrace::RING_SIZE);
+		for(const ExecutionTrace::Entry &entry: trace.entries()) {
+			CHECK((entry.opcode == OPCODE_INC || entry.opcode == OPCODE_JMP));
+		}
+
+		std::ostringstream report;
+		detector.writeReport(report, reason);
+		CHECK_NE(report.str().find("no forward progress"), std::string::npos);
+		CHECK_NE(report.str().find("#0 0x0010 called from 0x0000"), std::string::npos);
+
+		HangDetector budget(cpu, {.max_cycles = cpu.cycles() + 1000, .max_time_ms = 0,
+								  .progress_cycles = 0});
+		while(reason != HangDetector::Reason::CYCLE_LIMIT) {
+			cpu.iclck();
+			reason = budget.check();
+		}
+		CHECK_EQ(cpu.cycles(), budget.cycleLimit());
+	}
+}
+}  // namespace test::mfdemu
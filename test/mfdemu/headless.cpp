@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <mfdemu/impl/instructions.hpp>
+#include <mfdemu/impl/system.hpp>
+
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>
+
+namespace test::mfdemu {
+using namespace ::mfdemu::impl;
+
+static std::string readFile(const std::string &path) {
+	std::ifstream stream(path, std::ios::in | std::ios::binary);
+	return {std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+}
+
+/* 0x0100: ld  acl, 0x4100
+ *         out acl, 0x1000
+ *         ld  acl, 0x0203
+ *         out acl, 0x1001
+ * 0x0114: jmp 0x0114 */
+static std::vector<u8> haltingProgram() {
+	std::vector<u8> code(0x10000);
+	const std::vector<u8> program = {
+		OPCODE_LD,	0x80, REGISTER_ACL, 0x41, 0x00, OPCODE_OUT, 0x80, REGISTER_ACL, 0x10, 0x00,
+		OPCODE_LD,	0x80, REGISTER_ACL, 0x02, 0x03, OPCODE_OUT, 0x80, REGISTER_ACL, 0x10, 0x01,
+		OPCODE_JMP, 0x00, 0x01,			0x14,
+	};
+	std::copy(program.begin(), program.end(), code.begin() + 0x0100);
+	code[RESET_VECTOR] = 0x01;
+	code[RESET_VECTOR + 1] = 0x00;
+	return code;
+}
+
+TEST_SUITE("Headless") {
+	TEST_CASE("halt port, console output and state dump") {
+		const std::string output = "/tmp/emu_headless_test." + std::to_string(getpid());
+		const std::string state = output + ".json";
+
+		System system(0, UINT16_MAX);
+		system.setMainMemoryData(haltingProgram());
+		REQUIRE(system.setConsole({.headless = true, .input = "", .output = output}));
+		system.setHaltPort(0x1001);
+		system.run();
+
+		CHECK_EQ(system.stopReason(), System::StopReason::HALT);
+		CHECK_EQ(system.guestStatus(), 0x0203);
+		CHECK_EQ(system.cpu().readRegister(REGISTER_ACL), 0x0203);
+
+		REQUIRE(system.writeStateJson(state, {{0x0100, 0x0101}}));
+		const std::string json = readFile(state);
+		CHECK_NE(json.find("\"reason\": \"halt\""), std::string::npos);
+		CHECK_NE(json.find("\"guest_status\": 515"), std::string::npos);
+		CHECK_NE(json.find("{\"address\": 256, \"data\": \"1b80\"}"), std::string::npos);
+
+		std::remove(state.c_str());
+		std::remove(output.c_str());
+	}
+
+	TEST_CASE("exit ip") {
+		const std::string output = "/tmp/emu_headless_test." + std::to_string(getpid());
+
+		/* the console output is flushed once the system is gone */
+		{
+			System system(0, UINT16_MAX);
+			system.setMainMemoryData(haltingProgram());
+			REQUIRE(system.setConsole({.headless = true, .input = "", .output = output}));
+			system.setExitIp(0x0114);
+			system.run();
+
+			CHECK_EQ(system.stopReason(), System::StopReason::EXIT_IP);
+			CHECK_EQ(system.cpu().ip(), 0x0114);
+		}
+
+		CHECK_EQ(readFile(output), "A");
+		std::remove(output.c_str());
+	}
+}
+}  // namespace test::mfdemu
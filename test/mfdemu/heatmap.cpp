@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+#include <vector>
+
+#include <mfdemu/impl/bus/aio_device.hpp>
+#include <mfdemu/impl/cpu.hpp>
+#include <mfdemu/impl/heatmap.hpp>
+#include <mfdemu/impl/instructions.hpp>
+
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>
+
+#include "test_cpu.hpp"
+
+namespace test::mfdemu {
+TEST_SUITE("Memory Heatmap") {
+	TEST_CASE("fetches, reads and writes") {
+		/* st 0x1234, 0x0100
+		 * div [0x0100] */
+		std::vector<u8> code = {OPCODE_ST, 0x00, 0x12, 0x34, 0x01, 0x00, OPCODE_DIV, 0x10, 0x01, 0x00};
+		code.resize(0x10000);
+
+		auto memory = std::make_shared<AioDevice>(false, code.size());
+		memory->setData(code);
+
+		CpuTest cpu;
+		cpu.m_regAR = 0x2468;
+		cpu.connectAddressDevice(memory);
+		cpu.enableHeatmap();
+		cpu.newState(CpuTest::CpuState::INST_FETCH);
+
+		while(cpu.perfCounters().retired < 2) {
+			cpu.iclck();
+		}
+
+		REQUIRE(cpu.heatmap() != nullptr);
+		const MemoryHeatmap &heatmap = *cpu.heatmap();
+		CHECK_EQ(cpu.m_regAR, 2);
+
+		for(const u16 address: {0x0000, 0x0002, 0x0004, 0x0006, 0x0008}) {
+			CHECK_EQ(heatmap.count(address, MemoryHeatmap::EXECUTE), 1);
+			CHECK_EQ(heatmap.count(address, MemoryHeatmap::READ), 0);
+		}
+
+		CHECK_EQ(heatmap.count(0x0100, MemoryHeatmap::WRITE), 1);
+		CHECK_EQ(heatmap.count(0x0100, MemoryHeatmap::READ), 1);
+		CHECK_EQ(heatmap.count(0x0100, MemoryHeatmap::EXECUTE), 0);
+	}
+}
+}  // namespace test::mfdemu
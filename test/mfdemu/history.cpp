@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <mfdemu/impl/bus/aio_device.hpp>
+#include <mfdemu/impl/bus/gio_bus.hpp>
+#include <mfdemu/impl/cpu.hpp>
+#include <mfdemu/impl/debug/condition.hpp>
+#include <mfdemu/impl/debug/history.hpp>
+#include <mfdemu/impl/instructions.hpp>
+
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>
+
+#include "test_cpu.hpp"
+
+namespace test::mfdemu {
+TEST_SUITE("History") {
+	TEST_CASE("step back, rewind and reverse continue") {
+		/* loop:
+		 *   inc acl
+		 *   st acl, 0x0100
+		 *   jmp loop */
+		std::vector<u8> code = {
+			OPCODE_INC, 0x80, REGISTER_ACL, OPCODE_ST,	0x80, REGISTER_ACL, 0x01,
+			0x00,		OPCODE_JMP, 0x00, 0x00,			0x00,
+		};
+		code.resize(0x10000);
+
+		auto memory = std::make_shared<AioDevice>(false, code.size());
+		memory->setData(code);
+
+		CpuTest cpu;
+		cpu.connectAddressDevice(memory);
+		cpu.newState(CpuTest::CpuState::INST_FETCH);
+
+		constexpr u64 INTERVAL = 20;
+		constexpr usize CAPACITY = 8;
+		History history(cpu, *memory, INTERVAL, CAPACITY);
+
+		auto stored = [&memory]() {
+			return (memory->data()[0x0100] << 8) | memory->data()[0x0101];
+		};
+
+		while(cpu.perfCounters().retired < 30) {
+			cpu.iclck();
+			history.tick();
+		}
+
+		const u64 end_cycle = cpu.cycles();
+		CHECK_EQ(cpu.m_regACL, 10);
+		CHECK_EQ(stored(), 10);
+		CHECK_EQ(history.snapshotCount(), CAPACITY);
+		CHECK_GT(history.oldestCycle(), 0);
+
+		REQUIRE(history.stepBack());
+		CHECK(cpu.stopped());
+		CHECK(cpu.atInstructionBoundary());
+		CHECK_LT(cpu.cycles(), end_cycle);
+		CHECK_EQ(cpu.m_regIP, 0x0008);
+
+		REQUIRE(history.stepBack());
+		CHECK_EQ(cpu.m_regIP, 0x0003);
+		CHECK_EQ(cpu.m_regACL, 10);
+		CHECK_EQ(stored(), 9);
+
+		REQUIRE(history.stepBack());
+		CHECK_EQ(cpu.m_regIP, 0x0000);
+		CHECK_EQ(cpu.m_regACL, 9);
+
+		const u64 rewound = cpu.cycles();
+		CHECK_FALSE(history.rewind(rewound));
+		REQUIRE(history.rewind(rewound - 1));
+		CHECK_LT(cpu.cycles(), rewound);
+		CHECK_EQ(cpu.m_regIP, 0x0008);
+
+		cpu.breakpoints().set(0x0003, Condition::compile("acl == 8"));
+		REQUIRE(history.reverseContinue());
+		CHECK_EQ(cpu.m_regIP, 0x0003);
+		CHECK_EQ(cpu.m_regACL, 8);
+		CHECK_EQ(stored(), 7);
+		CHECK(cpu.breakpoints().test(0x0003));
+
+		/* running forward again reaches the same state */
+		cpu.resume();
+		cpu.breakpoints().clear();
+		while(cpu.cycles() < end_cycle) {
+			cpu.iclck();
+			history.tick();
+		}
+		CHECK_EQ(cpu.m_regACL, 10);
+		CHECK_EQ(stored(), 10);
+		CHECK_EQ(history.snapshotCount(), CAPACITY);
+	}
+
+	TEST_CASE("interrupts are replayed") {
+		/* loop:
+		 *   inc acl
+		 *   jmp loop
+		 * handler (0x0100):
+		 *   inc bcl
+		 * halt:
+		 *   jmp halt */
+		std::vector<u8> code = {
+			OPCODE_INC, 0x80, REGISTER_ACL, OPCODE_JMP, 0x00, 0x00, 0x00,
+		};
+		code.resize(0x10000);
+		const std::vector<u8> handler = {
+			OPCODE_INC, 0x80, REGISTER_BCL, OPCODE_JMP, 0x00, 0x01, 0x03,
+		};
+		std::copy(handler.begin(), handler.end(), code.begin() + 0x0100);
+		code[INTERRUPT_VECTOR] = 0x01;
+		code[INTERRUPT_VECTOR + 1] = 0x00;
+
+		auto memory = std::make_shared<AioDevice>(false, code.size());
+		memory->setData(code);
+
+		CpuTest cpu;
+		cpu.connectAddressDevice(memory);
+		cpu.newState(CpuTest::CpuState::INST_FETCH);
+		cpu.m_regSP = 0x8000;
+		cpu.m_regFL.ie = true;
+
+		History history(cpu, *memory, 10, 64);
+		auto bus = std::make_shared<GioBus>();
+		bus->setHistory(&history);
+		cpu.connectIoDevice(bus);
+
+		/* the line goes high after ten instructions and stays high, the
+		 * interrupt is taken once as entering the handler clears IE */
+		while(cpu.perfCounters().retired < 20) {
+			cpu.irq = history.irq(cpu.perfCounters().retired >= 10);
+			cpu.iclck();
+			history.tick();
+		}
+
+		const u64 end_cycle = cpu.cycles();
+		const u16 acl = cpu.m_regACL;
+		CHECK_EQ(cpu.m_regBCL, 1);
+		CHECK_GE(cpu.m_regIP, 0x0100);
+
+		/* re-execution sees the logged level, not the live one */
+		REQUIRE(history.rewind(history.oldestCycle()));
+		CHECK_EQ(cpu.m_regBCL, 0);
+		cpu.resume();
+		while(cpu.cycles() < end_cycle) {
+			cpu.irq = history.irq(false);
+			cpu.iclck();
+			history.tick();
+		}
+		CHECK_EQ(cpu.m_regACL, acl);
+		CHECK_EQ(cpu.m_regBCL, 1);
+
+		REQUIRE(history.stepBack());
+		CHECK_EQ(cpu.m_regBCL, 1);
+		CHECK_GE(cpu.m_regIP, 0x0100);
+	}
+}
+}  // namespace test::mfdemu
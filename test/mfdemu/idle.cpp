@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+#include <vector>
+
+#include <mfdemu/impl/bus/aio_device.hpp>
+#include <mfdemu/impl/bus/gio_bus.hpp>
+#include <mfdemu/impl/cpu.hpp>
+#include <mfdemu/impl/idle_detector.hpp>
+#include <mfdemu/impl/instructions.hpp>
+#include <mfdemu/impl/scheduler.hpp>
+
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>
+
+#include "test_cpu.hpp"
+
+namespace test::mfdemu {
+static void runIdleCode(std::vector<u8> code, u64 cycles, u64 &skipped, u64 &period) {
+	code.resize(0x10000);
+
+	auto memory = std::make_shared<AioDevice>(false, code.size());
+	memory->setData(code);
+	auto io_bus = std::make_shared<GioBus>();
+
+	CpuTest cpu;
+	cpu.connectAddressDevice(memory);
+	cpu.connectIoDevice(io_bus);
+	cpu.newState(CpuTest::CpuState::INST_FETCH);
+
+	IdleDetector detector(cpu, *io_bus);
+	skipped = 0;
+	period = 0;
+	while(cpu.cycles() < cycles) {
+		cpu.iclck();
+		if(detector.observe()) {
+			skipped += detector.skip(cycles);
+			period = detector.period();
+		}
+	}
+}
+
+TEST_SUITE("Idle") {
+	TEST_CASE("event order and cancel") {
+		EventScheduler scheduler;
+		std::vector<int> order;
+
+		scheduler.schedule(20, [&order] { order.push_back(2); });
+		scheduler.schedule(10, [&order] { order.push_back(1); });
+		const EventScheduler::EventId cancelled =
+			scheduler.schedule(10, [&order] { order.push_back(0); });
+		scheduler.schedule(20, [&order, &scheduler] {
+			order.push_back(3);
+			scheduler.schedule(20, [&order] { order.push_back(4); });
+		});
+		scheduler.cancel(cancelled);
+
+		CHECK_EQ(scheduler.nextCycle(), 10);
+		scheduler.runDue(9);
+		CHECK(order.empty());
+
+		scheduler.runDue(10);
+		CHECK_EQ(order.size(), 1);
+
+		scheduler.runDue(25);
+		const std::vector<int> expected = {1, 2, 3, 4};
+		CHECK(order == expected);
+		CHECK(scheduler.empty());
+		CHECK_EQ(scheduler.nextCycle(), EventScheduler::NO_EVENT);
+	}
+
+	TEST_CASE("skip idle loop") {
+		/* _wait: in 0x0010, acl
+		 *        jmp _wait */
+		u64 skipped = 0;
+		u64 period = 0;
+		runIdleCode(
+			{OPCODE_IN, 0x08, 0x00, 0x10, REGISTER_ACL, OPCODE_JMP, 0x00, 0x00, 0x00}, 100000,
+			skipped, period);
+
+		CHECK_GT(period, 0);
+		CHECK_GT(skipped, 90000);
+		CHECK_EQ(skipped % period, 0);
+	}
+
+	TEST_CASE("loops with side effects are not skipped") {
+		/* loop: inc acl
+		 *       jmp loop */
+		u64 skipped = 0;
+		u64 period = 0;
+		runIdleCode(
+			{OPCODE_INC, 0x80, REGISTER_ACL, OPCODE_JMP, 0x00, 0x00, 0x00}, 10000, skipped,
+			period);
+		CHECK_EQ(skipped, 0);
+
+		/* loop: st 0x1234, 0x0100
+		 *       jmp loop */
+		runIdleCode(
+			{OPCODE_ST, 0x00, 0x12, 0x34, 0x01, 0x00, OPCODE_JMP, 0x00, 0x00, 0x00}, 10000,
+			skipped, period);
+		CHECK_EQ(skipped, 0);
+	}
+
+	TEST_CASE("skipped cycles are accounted") {
+		/* _wait: jmp _wait */
+		std::vector<u8> code = {OPCODE_JMP, 0x00, 0x00, 0x00};
+		code.resize(0x10000);
+
+		auto memory = std::make_shared<AioDevice>(false, code.size());
+		memory->setData(code);
+		auto io_bus = std::make_shared<GioBus>();
+
+		auto reference_memory = std::make_shared<AioDevice>(false, code.size());
+		reference_memory->setData(code);
+		auto reference_io_bus = std::make_shared<GioBus>();
+
+		CpuTest reference;
+		reference.connectAddressDevice(reference_memory);
+		reference.connectIoDevice(reference_io_bus);
+		reference.newState(CpuTest::CpuState::INST_FETCH);
+
+		CpuTest cpu;
+		cpu.connectAddressDevice(memory);
+		cpu.connectIoDevice(io_bus);
+		cpu.newState(CpuTest::CpuState::INST_FETCH);
+
+		IdleDetector detector(cpu, *io_bus);
+		u64 skipped = 0;
+		while(cpu.cycles() < 5000) {
+			cpu.iclck();
+			if(detector.observe()) {
+				skipped += detector.skip(5000);
+			}
+		}
+
+		while(reference.cycles() < cpu.cycles()) {
+			reference.iclck();
+		}
+
+		CHECK_GT(skipped, 0);
+		CHECK_EQ(cpu.cycles(), reference.cycles());
+		CHECK_EQ(cpu.perfCounters().retired, reference.perfCounters().retired);
+		CHECK_EQ(cpu.perfCounters().abus_reads, reference.perfCounters().abus_reads);
+		CHECK_EQ(
+			cpu.perfCounters().opcodes[OPCODE_JMP].cycles,
+			reference.perfCounters().opcodes[OPCODE_JMP].cycles);
+		CHECK(cpu.registerFile() == reference.registerFile());
+	}
+}
+}  // namespace test::mfdemu
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include <mfdemu/impl/batch/lockstep.hpp>
+#include <mfdemu/impl/instructions.hpp>
+#include <mfdemu/impl/system.hpp>
+
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>
+
+namespace test::mfdemu {
+using namespace ::mfdemu::impl;
+
+/* 0x0100: ld   acl, [0x2000]
+ *         ld   bcl, 0
+ *         ld   ar, 0x1234
+ *         in   0x3000, ccl
+ * 0x0114: cmp  acl, 0
+ *         jz   0x0147
+ *         add  acl
+ *         xor  0x5a5a
+ *         test 1
+ *         jz   0x012f
+ *         inc  ccl
+ * 0x012f: sl   bcl, 1
+ *         inc  bcl
+ *         ld   dcl, bcl
+ *         st   bcl, [0x2002]
+ *         dec  acl
+ *         jmp  0x0114
+ * 0x0147: mul  3
+ *         out  ar, 0x1001
+ * 0x0150: jmp  0x0150 */
+static std::vector<u8> checksumProgram() {
+	std::vector<u8> code(0x10000);
+	/* clang-format off */
+	const std::vector<u8> program = {
+		OPCODE_LD,   0x81, REGISTER_ACL, 0x20, 0x00,
+		OPCODE_LD,   0x80, REGISTER_BCL, 0x00, 0x00,
+		OPCODE_LD,   0x80, REGISTER_AR,  0x12, 0x34,
+		OPCODE_IN,   0x08, 0x30, 0x00, REGISTER_CCL,
+		OPCODE_CMP,  0x80, REGISTER_ACL, 0x00, 0x00,
+		OPCODE_JZ,   0x00, 0x01, 0x47,
+		OPCODE_ADD,  0x80, REGISTER_ACL,
+		OPCODE_XOR,  0x00, 0x5a, 0x5a,
+		OPCODE_TEST, 0x00, 0x00, 0x01,
+		OPCODE_JZ,   0x00, 0x01, 0x2f,
+		OPCODE_INC,  0x80, REGISTER_CCL,
+		OPCODE_SL,   0x80, REGISTER_BCL, 0x00, 0x01,
+		OPCODE_INC,  0x80, REGISTER_BCL,
+		OPCODE_LD,   0x88, REGISTER_DCL, REGISTER_BCL,
+		OPCODE_ST,   0x81, REGISTER_BCL, 0x20, 0x02,
+		OPCODE_DEC,  0x80, REGISTER_ACL,
+		OPCODE_JMP,  0x00, 0x01, 0x14,
+		OPCODE_MUL,  0x00, 0x00, 0x03,
+		OPCODE_OUT,  0x80, REGISTER_AR,  0x10, 0x01,
+		OPCODE_JMP,  0x00, 0x01, 0x50,
+	};
+	/* clang-format on */
+	std::copy(program.begin(), program.end(), code.begin() + 0x0100);
+	code[RESET_VECTOR] = 0x01;
+	code[RESET_VECTOR + 1] = 0x00;
+	return code;
+}
+
+static std::vector<u8> laneInput(usize lane) {
+	return {0x00, static_cast<u8>(lane % 13)};
+}
+
+TEST_SUITE("Lockstep") {
+	TEST_CASE("lanes match scalar runs") {
+		constexpr usize LANES = 64;
+		const std::vector<u8> image = checksumProgram();
+
+		LockstepBatch batch(image, LANES);
+		for(usize lane = 0; lane < LANES; lane++) {
+			batch.writeMemory(lane, 0x2000, laneInput(lane));
+		}
+		batch.setExitIp(0x0150);
+		batch.run(UINT64_MAX);
+
+		CHECK_GT(batch.stats().vector_steps, 0);
+		CHECK_GT(batch.stats().scalar_instructions, 0);
+
+		for(usize lane = 0; lane < LANES; lane++) {
+			std::vector<u8> lane_image = image;
+			const std::vector<u8> input = laneInput(lane);
+			std::copy(input.begin(), input.end(), lane_image.begin() + 0x2000);
+
+			System system(0, UINT16_MAX);
+			system.setMainMemoryData(lane_image);
+			REQUIRE(system.setConsole({.headless = true, .input = "", .output = "/dev/null"}));
+			system.setIdleSkip(false);
+			system.setExitIp(0x0150);
+			system.run();
+
+			CHECK_EQ(batch.state(lane), LockstepBatch::LaneState::EXIT_IP);
+			CHECK_EQ(batch.cycles(lane), system.cpu().cycles());
+			CHECK_EQ(batch.retired(lane), system.cpu().perfCounters().retired);
+			for(const u8 id: Cpu::REGISTER_FILE_IDS) {
+				CHECK_EQ(batch.readRegister(lane, id), system.cpu().readRegister(id));
+			}
+			CHECK_EQ(batch.readRegister(lane, REGISTER_BH), system.cpu().readRegister(REGISTER_BH));
+
+			/* written by the scalar Cpu between lane kernels */
+			CHECK_EQ(batch.memory(lane).readWord(0x2002), batch.readRegister(lane, REGISTER_BCL));
+		}
+	}
+
+	TEST_CASE("halt and instruction limit") {
+		constexpr usize LANES = 16;
+		const std::vector<u8> image = checksumProgram();
+
+		LockstepBatch batch(image, LANES);
+		for(usize lane = 0; lane < LANES; lane++) {
+			batch.writeMemory(lane, 0x2000, laneInput(lane));
+		}
+		batch.setHaltPort(0x1001);
+		batch.run(50);
+
+		for(usize lane = 0; lane < LANES; lane++) {
+			/* 4 instructions set up, 12 or 13 per iteration and 4 more until
+			 * the halt, so lanes with more than 3 iterations hit the limit */
+			if(lane % 13 <= 3) {
+				CHECK_EQ(batch.state(lane), LockstepBatch::LaneState::HALTED);
+				CHECK_EQ(batch.guestStatus(lane), batch.readRegister(lane, REGISTER_AR));
+			} else {
+				CHECK_EQ(batch.state(lane), LockstepBatch::LaneState::LIMIT);
+				CHECK_EQ(batch.retired(lane), 50);
+			}
+		}
+	}
+}
+}  // namespace test::mfdemu
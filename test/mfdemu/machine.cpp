@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <mfdemu/impl/instructions.hpp>
+#include <mfdemu/machine.hpp>
+#include <mfdemu/mfdemu.h>
+
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>
+
+namespace test::mfdemu {
+using ::mfdemu::Machine;
+
+/* MRI of:
+ *
+ * 0x1100: loop: in  TERMINAL, acl      ; echo the terminal until it reads 0
+ * 0x1105:       cmp acl, 0
+ * 0x110a:       jz  done
+ * 0x110e:       out acl, TERMINAL
+ * 0x1113:       jmp loop
+ * 0x1117: done: ld  bcl, 0x1234
+ * 0x111c:       st  bcl, [0x2000]
+ * 0x1121:       ld  acl, 0x0007
+ * 0x1126:       out acl, HALT           ; HALT = 0x1001
+ * 0x112b: spin: jmp spin */
+/* clang-format off */
+static const std::vector<u8> ECHO_MRI = {
+	0x4d, 0x52, 0x49, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x57,
+	0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x24,
+	0x11, 0x00, 0x00, 0x2f, 0x00, 0x00, 0x00, 0x53, 0xff, 0xfc, 0x00, 0x04,
+	0x0c, 0x08, 0x10, 0x00, 0x02, 0x07, 0x80, 0x02, 0x00, 0x00, 0x11, 0x00,
+	0x11, 0x17, 0x22, 0x80, 0x02, 0x10, 0x00, 0x10, 0x00, 0x11, 0x00, 0x1b,
+	0x80, 0x05, 0x12, 0x34, 0x2a, 0x81, 0x05, 0x20, 0x00, 0x1b, 0x80, 0x02,
+	0x00, 0x07, 0x22, 0x80, 0x02, 0x10, 0x01, 0x10, 0x00, 0x11, 0x2b, 0x00,
+	0x00, 0x11, 0x00,
+};
+/* clang-format on */
+
+struct Terminal {
+	std::string input;
+	usize position{0};
+	std::string output;
+};
+
+static u8 terminalRead(void *user, u16 port, bool low) {
+	Terminal &terminal = *static_cast<Terminal *>(user);
+	if(low || terminal.position >= terminal.input.size()) {
+		return 0;
+	}
+
+	return terminal.input[terminal.position++];
+}
+
+static void terminalWrite(void *user, u16 port, u8 value, bool low) {
+	if(!low) {
+		static_cast<Terminal *>(user)->output += static_cast<char>(value);
+	}
+}
+
+static u16 wordAt(const Machine &machine, u16 address) {
+	const std::vector<u8> data = machine.readMemory(address, 2);
+	return (data[0] << 8) | data[1];
+}
+
+TEST_SUITE("Machine") {
+	TEST_CASE("C API") {
+		CHECK_EQ(mfdemu_api_version(), MFDEMU_API_VERSION);
+
+		const u8 garbage[] = {1, 2, 3};
+		CHECK(mfdemu_create(garbage, sizeof(garbage)) == nullptr);
+
+		mfdemu_machine *machine = mfdemu_create(ECHO_MRI.data(), ECHO_MRI.size());
+		REQUIRE(machine != nullptr);
+
+		Terminal terminal{.input = "hello"};
+		CHECK(mfdemu_map_gio(machine, 0x1000, 0x1000, terminalRead, terminalWrite, &terminal));
+		CHECK(mfdemu_set_halt_port(machine, 0x1001));
+
+		CHECK_EQ(mfdemu_run_cycles(machine, 10), MFDEMU_EVENT_CYCLE_LIMIT);
+		CHECK_EQ(mfdemu_cycles(machine), 11);
+
+		CHECK_EQ(mfdemu_run(machine), MFDEMU_EVENT_HALT);
+		CHECK(mfdemu_halted(machine));
+		CHECK_EQ(mfdemu_guest_status(machine), 7);
+		CHECK_EQ(terminal.output, "hello");
+		CHECK_EQ(mfdemu_read_register(machine, MFDEMU_REG_BCL), 0x1234);
+		CHECK_EQ(mfdemu_read_register(machine, static_cast<mfdemu_register>(0x20)), 0);
+
+		u8 data[2];
+		mfdemu_read_memory(machine, 0x2000, data, sizeof(data));
+		CHECK_EQ(data[0], 0x12);
+		CHECK_EQ(data[1], 0x34);
+
+		/* halted machines stay halted until reset */
+		const u64 cycles = mfdemu_cycles(machine);
+		CHECK_EQ(mfdemu_run(machine), MFDEMU_EVENT_HALT);
+		CHECK_EQ(mfdemu_cycles(machine), cycles);
+
+		mfdemu_reset(machine);
+		CHECK_FALSE(mfdemu_halted(machine));
+		CHECK_EQ(mfdemu_run(machine), MFDEMU_EVENT_HALT);
+		CHECK_EQ(terminal.output, "hello");
+
+		mfdemu_destroy(machine);
+	}
+
+	TEST_CASE("C API rejects invalid mappings") {
+		mfdemu_machine *machine = mfdemu_create(ECHO_MRI.data(), ECHO_MRI.size());
+		REQUIRE(machine != nullptr);
+
+		CHECK_FALSE(mfdemu_map_gio(machine, 0x1001, 0x1000, nullptr, nullptr, nullptr));
+		CHECK_FALSE(mfdemu_map_aio(machine, 0x2001, 0x2000, nullptr, nullptr, nullptr));
+
+		/* a full bus refuses further devices instead of aborting */
+		bool mapped = true;
+		for(u16 port = 0; mapped && port < 0x200; port++) {
+			mapped = mfdemu_map_gio(machine, port, port, nullptr, nullptr, nullptr);
+		}
+		CHECK_FALSE(mapped);
+		CHECK_FALSE(mfdemu_set_halt_port(machine, 0x1001));
+
+		mfdemu_destroy(machine);
+	}
+
+	TEST_CASE("memory devices") {
+		std::unique_ptr<Machine> machine = Machine::fromMRI(ECHO_MRI);
+		REQUIRE(machine != nullptr);
+		machine->setHaltPort(0x1001);
+
+		std::vector<std::pair<u16, u16>> writes;
+		machine->mapMemoryDevice(0x2000, 0x20ff, nullptr, [&](u16 address, u16 value) {
+			writes.emplace_back(address, value);
+		});
+
+		CHECK_EQ(machine->run(), Machine::Event::HALT);
+		REQUIRE_EQ(writes.size(), 1);
+		CHECK_EQ(writes[0].first, 0x2000);
+		CHECK_EQ(writes[0].second, 0x1234);
+		CHECK_EQ(wordAt(*machine, 0x2000), 0);
+	}
+
+	TEST_CASE("stepping and stop requests") {
+		std::unique_ptr<Machine> machine = Machine::fromMRI(ECHO_MRI);
+		REQUIRE(machine != nullptr);
+		machine->mapIoDevice(
+			0x1000, 0x1000,
+			[&](u16, bool) {
+				machine->requestStop();
+				return 0;
+			},
+			nullptr);
+
+		/* the first step finishes the reset */
+		CHECK_EQ(machine->step(), Machine::Event::NONE);
+		CHECK_EQ(machine->readRegister(::mfdemu::impl::REGISTER_IP), 0x1100);
+		CHECK_EQ(machine->retired(), 0);
+
+		CHECK_EQ(machine->step(), Machine::Event::STOP_REQUESTED);
+		CHECK_FALSE(machine->atInstructionBoundary());
+		CHECK_FALSE(machine->snapshot().has_value());
+
+		machine->setBreakpoint(0x1105);
+		CHECK_EQ(machine->run(), Machine::Event::STOP_REQUESTED);
+		CHECK_EQ(machine->run(), Machine::Event::BREAKPOINT);
+		CHECK_EQ(machine->readRegister(::mfdemu::impl::REGISTER_IP), 0x1105);
+		CHECK_EQ(machine->retired(), 1);
+
+		/* stepping ignores the breakpoint */
+		CHECK_EQ(machine->step(), Machine::Event::NONE);
+		CHECK_EQ(machine->readRegister(::mfdemu::impl::REGISTER_IP), 0x110a);
+	}
+
+	TEST_CASE("snapshots") {
+		std::unique_ptr<Machine> machine = Machine::fromMRI(ECHO_MRI);
+		REQUIRE(machine != nullptr);
+		machine->setHaltPort(0x1001);
+		machine->setBreakpoint(0x1117);
+
+		CHECK_EQ(machine->run(), Machine::Event::BREAKPOINT);
+		const std::optional<Machine::Snapshot> snapshot = machine->snapshot();
+		REQUIRE(snapshot.has_value());
+
+		CHECK_EQ(machine->run(), Machine::Event::HALT);
+		const u64 cycles = machine->cycles();
+		CHECK_EQ(wordAt(*machine, 0x2000), 0x1234);
+
+		machine->restore(snapshot.value());
+		CHECK_FALSE(machine->halted());
+		CHECK_EQ(machine->readRegister(::mfdemu::impl::REGISTER_IP), 0x1117);
+		CHECK_EQ(wordAt(*machine, 0x2000), 0);
+
+		CHECK_EQ(machine->run(), Machine::Event::BREAKPOINT);
+		machine->writeRegister(::mfdemu::impl::REGISTER_IP, 0x1121);
+		CHECK_EQ(machine->run(), Machine::Event::HALT);
+		CHECK_EQ(machine->guestStatus(), 7);
+		CHECK_LT(machine->cycles(), cycles);
+		CHECK_EQ(wordAt(*machine, 0x2000), 0);
+
+		machine->restore(snapshot.value());
+		CHECK_EQ(machine->run(), Machine::Event::BREAKPOINT);
+		CHECK_EQ(machine->run(), Machine::Event::HALT);
+		CHECK_EQ(machine->cycles(), cycles);
+	}
+}
+}  // namespace test::mfdemu
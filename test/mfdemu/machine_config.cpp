@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <mfdemu/impl/bus/aio_device.hpp>
+#include <mfdemu/impl/machine_config.hpp>
+#include <mfdemu/impl/system.hpp>
+
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>
+
+namespace test::mfdemu {
+using namespace ::mfdemu::impl;
+
+static std::optional<MachineConfig> parse(const std::string &text) {
+	std::istringstream stream(text);
+	return MachineConfig::parse(stream, "test.ini");
+}
+
+/* run an AIO transaction through the bus protocol, returns the word read */
+static u16 access(AioDevice &memory, bool write, u16 address, u16 value = 0) {
+	memory.mode = true;
+	memory.clck();
+	memory.io = address;
+	memory.clck();
+	memory.mode = write;
+	memory.clck();
+	memory.mode = false;
+	memory.io = value;
+	memory.clck();
+	return memory.io;
+}
+
+TEST_SUITE("Machine config") {
+	TEST_CASE("parsing") {
+		const std::optional<MachineConfig> config = parse(R"(
+; board with a ROM at the top
+[machine]
+clock = 2000000
+
+[memory ram]
+range = 0x0000:0x7fff
+
+[memory rom]
+range = 0xc000 : 0xffff
+type = rom
+mri-device = 1
+
+# devices
+[device console]
+type = terminal
+ports = 0x1000:0x1001
+irq = 3
+
+[device scratch]
+type = plugin
+ports = 0x2000:0x200f
+path = ./scratch.so
+params = a = b
+irq = 5
+
+[device dma]
+type = dma
+ports = 0x3000
+cycles-per-word = 4
+)");
+		REQUIRE(config.has_value());
+		CHECK_EQ(config->clock_hz.value(), 2000000);
+		CHECK_EQ(config->cycleSpan(), 500);
+
+		REQUIRE_EQ(config->memory.size(), 2);
+		CHECK_EQ(config->memory[0].name, "ram");
+		CHECK_EQ(config->memory[0].first, 0x0000);
+		CHECK_EQ(config->memory[0].last, 0x7fff);
+		CHECK(config->memory[0].access == AioDevice::Access::READ_WRITE);
+		CHECK_EQ(config->memory[1].first, 0xc000);
+		CHECK(config->memory[1].access == AioDevice::Access::READ_ONLY);
+		CHECK_EQ(config->memory[1].mri_device, 1);
+
+		REQUIRE_EQ(config->devices.size(), 3);
+		CHECK(config->devices[0].type == MachineConfig::DeviceType::TERMINAL);
+		CHECK_EQ(config->devices[0].first, 0x1000);
+		CHECK_EQ(config->devices[0].last, 0x1001);
+		CHECK_EQ(config->devices[0].irq.value(), 3);
+		CHECK(config->devices[1].type == MachineConfig::DeviceType::PLUGIN);
+		CHECK_EQ(config->devices[1].last, 0x200f);
+		CHECK_EQ(config->devices[1].path, "./scratch.so");
+		CHECK_EQ(config->devices[1].params, "a = b");
+		CHECK_EQ(config->devices[1].irq.value(), 5);
+		CHECK(config->devices[2].type == MachineConfig::DeviceType::DMA);
+		CHECK_EQ(config->devices[2].cycles_per_word.value(), 4);
+	}
+
+	TEST_CASE("errors") {
+		CHECK(parse("clock = 1\n") == std::nullopt);
+		CHECK(parse("[machine\n") == std::nullopt);
+		CHECK(parse("[machine]\nclock = fast\n") == std::nullopt);
+		CHECK(parse("[board]\n") == std::nullopt);
+		CHECK(parse("[memory a]\nrange = 0x0010:0x00ff\n") == std::nullopt);
+		CHECK(parse("[memory a]\nrange = 0:0xff\ntype = flash\n") == std::nullopt);
+		CHECK(parse("[device a]\nports = 1\n") == std::nullopt);
+		CHECK(parse("[device a]\nports = 1:2\ntype = halt\n") == std::nullopt);
+		CHECK(parse("[device a]\nports = 1\ntype = plugin\n") == std::nullopt);
+		CHECK(parse("[device a]\nports = 0xfff0\ntype = pmu\n") == std::nullopt);
+		CHECK(parse("[device a]\nports = 1\ntype = storage\n") == std::nullopt);
+		CHECK(
+			parse("[device a]\nports = 0xfffa\ntype = storage\npath = a.img\n") == std::nullopt);
+		CHECK(parse("[device a]\nports = 1:3\ntype = terminal\n") == std::nullopt);
+		CHECK(parse("[device a]\nports = 1\ntype = terminal\nirq = 256\n") == std::nullopt);
+		CHECK(parse("[device a]\nports = 1\ntype = halt\nirq = 1\n") == std::nullopt);
+		CHECK(parse("[device a]\nports = 1\ntype = pmu\ncycles-per-word = 1\n") == std::nullopt);
+		CHECK(parse("[device a]\nports = 1\ntype = dma\ncycles-per-word = x\n") == std::nullopt);
+		CHECK(parse("[device a]\nports = 1\ntype = timer\nirq = 253\n") == std::nullopt);
+		CHECK(parse("[device a]\nports = 1\ntype = timer\nirq = 252\n") != std::nullopt);
+		CHECK(parse("[device a]\nports = 1\ntype = pic\nirq = 241\n") == std::nullopt);
+		CHECK(parse("[device a]\nports = 1\ntype = pic\nirq = 240\n") != std::nullopt);
+		CHECK(
+			parse("[device a]\nports = 1\ntype = pic\n[device b]\nports = 0x20\ntype = pic\n") ==
+			std::nullopt);
+
+		/* devices interrupt through the inputs of a pic only */
+		const std::string pic = "[device p]\nports = 0x20\ntype = pic\nirq = 16\n";
+		CHECK(parse(pic + "[device a]\nports = 1\ntype = terminal\nirq = 3\n") == std::nullopt);
+		CHECK(parse("[device a]\nports = 1\ntype = terminal\nirq = 31\n" + pic) != std::nullopt);
+		CHECK(parse(pic + "[device a]\nports = 1\ntype = timer\nirq = 29\n") == std::nullopt);
+		CHECK(parse(pic + "[device a]\nports = 1\ntype = timer\nirq = 28\n") != std::nullopt);
+	}
+
+	TEST_CASE("memory layout") {
+		const std::optional<MachineConfig> config = parse(R"(
+[memory ram]
+range = 0x0000:0x00ff
+[memory rom]
+range = 0xff00:0xffff
+type = rom
+mri-device = 1
+)");
+		REQUIRE(config.has_value());
+
+		/* padded image of two devices */
+		std::vector<u8> mri_data(0x20000);
+		mri_data[0x0010] = 0x11;
+		mri_data[0x1000] = 0x22;
+		mri_data[0xff00] = 0x33;
+		mri_data[0x1ff00] = 0x44;
+
+		const std::vector<u8> image = config->memoryImage(mri_data);
+		REQUIRE_EQ(image.size(), 0x10000);
+		CHECK_EQ(image[0x0010], 0x11);
+		CHECK_EQ(image[0x1000], 0);
+		CHECK_EQ(image[0xff00], 0x44);
+
+		System system(0, UINT16_MAX);
+		system.setMainMemoryData(image);
+		REQUIRE(config->apply(system));
+
+		AioDevice &memory = system.mainMemory();
+		access(memory, true, 0x0010, 0xabcd);
+		CHECK_EQ(access(memory, false, 0x0010), 0xabcd);
+
+		/* rom writes are dropped, unmapped addresses read 0 */
+		access(memory, true, 0xff00, 0xabcd);
+		CHECK_EQ(access(memory, false, 0xff00), 0x4400);
+		access(memory, true, 0x1000, 0xabcd);
+		CHECK_EQ(memory.readByte(0x1000), 0);
+		CHECK_EQ(access(memory, false, 0x0fff), 0);
+	}
+
+	TEST_CASE("default memory") {
+		const std::optional<MachineConfig> config = parse("[machine]\n");
+		REQUIRE(config.has_value());
+		CHECK_FALSE(config->clock_hz.has_value());
+
+		std::vector<u8> mri_data(0x20000, 0x55);
+		const std::vector<u8> image = config->memoryImage(mri_data);
+		CHECK_EQ(image.size(), 0x10000);
+		CHECK_EQ(image[0xffff], 0x55);
+	}
+}
+}  // namespace test::mfdemu
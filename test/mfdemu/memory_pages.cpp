@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+#include <vector>
+
+#include <mfdemu/impl/bus/aio_device.hpp>
+
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>
+
+namespace test::mfdemu {
+using namespace ::mfdemu::impl;
+
+/* write a word through the bus protocol */
+static void busWrite(AioDevice &device, u16 address, u16 value) {
+	device.mode = true;
+	device.clck();
+	device.io = address;
+	device.clck();
+	device.clck();
+	device.mode = false;
+	device.io = value;
+	device.clck();
+}
+
+/* read a word through the bus protocol */
+static u16 busRead(AioDevice &device, u16 address) {
+	device.mode = true;
+	device.clck();
+	device.io = address;
+	device.clck();
+	device.mode = false;
+	device.clck();
+	device.clck();
+	return device.io;
+}
+
+/* reads return a fixed tag */
+class TagDevice : public AioMappedDevice {
+   public:
+	explicit TagDevice(u16 tag) : m_tag(tag) {}
+
+	u16 read(u16 address) override { return m_tag; }
+	void write(u16 address, u16 value) override {}
+
+   private:
+	u16 m_tag;
+};
+
+TEST_SUITE("Memory pages") {
+	TEST_CASE("images are shared until written") {
+		std::vector<u8> data(0x10000);
+		data[0x00ff] = 0x12;
+		data[0x0100] = 0x34;
+		data[0x8000] = 0x56;
+		const MemoryImage image(data);
+
+		AioDevice first(false, 0x10000);
+		AioDevice second(false, 0x10000);
+		first.loadImage(image);
+		second.loadImage(image);
+
+		CHECK_EQ(first.size(), 0x10000);
+		CHECK_EQ(first.privatePages(), 0);
+		CHECK_EQ(first.readWord(0x00ff), 0x1234);
+		CHECK_EQ(first.readWord(0xffff), 0);
+
+		busWrite(first, 0x8000, 0xbeef);
+		CHECK_EQ(first.readWord(0x8000), 0xbeef);
+		CHECK_EQ(second.readWord(0x8000), 0x5600);
+		CHECK_EQ(first.privatePages(), 1);
+		CHECK(first.takeDirtyPages().test(0x80));
+
+		/* zero pages are shared as well */
+		second.writeData(0x4000, {0xaa});
+		CHECK_EQ(second.readByte(0x4000), 0xaa);
+		CHECK_EQ(first.readByte(0x4000), 0);
+		CHECK_EQ(second.privatePages(), 1);
+
+		AioDevice third(false, 0x10000);
+		third.loadImage(image);
+		CHECK_EQ(third.readWord(0x8000), 0x5600);
+		CHECK_EQ(third.readByte(0x4000), 0);
+		CHECK(third.data() == data);
+	}
+
+	TEST_CASE("snapshots give up the pages") {
+		std::vector<u8> data(0x10000);
+		data[0x8000] = 0x56;
+		const MemoryImage image(data);
+
+		AioDevice device(false, 0x10000);
+		device.loadImage(image);
+		busWrite(device, 0x8000, 0x0001);
+		CHECK_EQ(device.privatePages(), 1);
+
+		{
+			const MemoryImage snapshot = device.snapshot();
+			CHECK_EQ(device.privatePages(), 0);
+
+			AioDevice other(false, 0x10000);
+			other.loadImage(snapshot);
+			busWrite(device, 0x8000, 0x0002);
+			CHECK_EQ(other.readWord(0x8000), 0x0001);
+			CHECK_EQ(device.readWord(0x8000), 0x0002);
+		}
+
+		/* owned again after one copy, later writes stay in place */
+		CHECK_EQ(device.privatePages(), 1);
+		busWrite(device, 0x8000, 0x0003);
+		CHECK_EQ(device.privatePages(), 1);
+		CHECK_EQ(device.readWord(0x8000), 0x0003);
+	}
+
+	TEST_CASE("plain data") {
+		std::vector<u8> data(0x0300);
+		data[0x0201] = 0x77;
+
+		AioDevice device(false, data.size());
+		device.setData(data);
+		CHECK_EQ(device.size(), 0x0300);
+		CHECK_EQ(device.readByte(0x0201), 0x77);
+		CHECK_EQ(device.readByte(0x0300), 0);
+		CHECK(device.data() == data);
+
+		/* writes past the end are discarded */
+		busWrite(device, 0x02ff, 0x1234);
+		CHECK(device.data() == data);
+	}
+	TEST_CASE("mapped devices") {
+		AioDevice device(false, 0x10000);
+		device.setData(std::vector<u8>(0x10000, 0x11));
+
+		device.mapDevice(0x1000, 0x1fff, std::make_shared<TagDevice>(1));
+		device.mapDevice(0x1010, 0x101f, std::make_shared<TagDevice>(2));
+		device.mapDevice(0x20f0, 0x210f, std::make_shared<TagDevice>(3));
+
+		CHECK_EQ(busRead(device, 0x0ffe), 0x1111);
+		CHECK_EQ(busRead(device, 0x1000), 1);
+		CHECK_EQ(busRead(device, 0x1010), 2);
+		CHECK_EQ(busRead(device, 0x101e), 2);
+		CHECK_EQ(busRead(device, 0x1020), 1);
+		CHECK_EQ(busRead(device, 0x1ffe), 1);
+
+		/* a mapping may start and end within a page */
+		CHECK_EQ(busRead(device, 0x20ee), 0x1111);
+		CHECK_EQ(busRead(device, 0x20f0), 3);
+		CHECK_EQ(busRead(device, 0x2100), 3);
+		CHECK_EQ(busRead(device, 0x2110), 0x1111);
+
+		/* covering the whole range again takes precedence everywhere */
+		device.mapDevice(0x1000, 0x1fff, std::make_shared<TagDevice>(4));
+		CHECK_EQ(busRead(device, 0x1010), 4);
+		CHECK_EQ(busRead(device, 0x1ffe), 4);
+	}
+}
+}  // namespace test::mfdemu
@@ -0,0 +1,47 @@
+#include <memory>
+#include <numeric>
+#include <vector>
+
+#include <mfdemu/impl/bus/aio_device.hpp>
+#include <mfdemu/impl/cpu.hpp>
+#include <mfdemu/impl/instructions.hpp>
+
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>
+
+#include "test_cpu.hpp"
+
+namespace test::mfdemu {
+TEST_SUITE("Performance Counters") {
+	TEST_CASE("single instruction") {
+		std::vector<u8> code = {OPCODE_DIV, 0x00, 0x00, 0x02};
+		code.resize(0x10000);
+
+		auto memory = std::make_shared<AioDevice>(false, code.size());
+		memory->setData(code);
+
+		CpuTest cpu;
+		cpu.m_regAR = 10;
+		cpu.connectAddressDevice(memory);
+		cpu.newState(CpuTest::CpuState::INST_FETCH);
+
+		while(cpu.perfCounters().retired == 0) {
+			cpu.iclck();
+		}
+
+		const PerfCounters &counters = cpu.perfCounters();
+		CHECK_EQ(cpu.m_regAR, 5);
+		CHECK_EQ(counters.retired, 1);
+		CHECK_EQ(counters.opcodes[OPCODE_DIV].retired, 1);
+		CHECK_EQ(counters.abus_reads, 2);
+		CHECK_EQ(counters.abus_writes, 0);
+		CHECK_EQ(
+			std::accumulate(counters.state_cycles.cbegin(), counters.state_cycles.cend(), 0ULL),
+			counters.cycles);
+		CHECK_EQ(
+			counters.opcodes[OPCODE_DIV].cycles +
+				counters.opcodes[PerfCounters::OPCODE_NONE].cycles,
+			counters.cycles);
+	}
+}
+}  // namespace test::mfdemu
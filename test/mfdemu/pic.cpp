@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <vector>
+
+#include <mfdemu/impl/bus/gio_bus.hpp>
+#include <mfdemu/impl/devices/pic.hpp>
+#include <mfdemu/impl/machine_config.hpp>
+#include <mfdemu/impl/system.hpp>
+#include <mfdemu/mri.hpp>
+
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>
+
+#include "test_cpu.hpp"
+
+namespace test::mfdemu {
+constexpr u16 PIC_BASE = 0x3100;
+constexpr u8 PIC_FIRST = 0x20;
+
+/* MRI of:
+ *
+ * 0x1100:         mov  0x0f00, sp
+ * 0x1105:         ld   dcl, 0
+ * 0x110a:         ld   acl, 0x40
+ * 0x110f:         out  acl, PIC_VECTOR     ; PIC_VECTOR = 0x3104
+ * 0x1114:         ld   acl, 1
+ * 0x1119:         out  acl, CH2_RELOAD     ; CH2_RELOAD = 0x3010
+ * 0x111e:         out  acl, CH0_RELOAD     ; CH0_RELOAD = 0x3000
+ * 0x1123:         out  acl, CH2_CONTROL    ; both expire before sti
+ * 0x1128:         out  acl, CH0_CONTROL
+ * 0x112d:         sti
+ * 0x112f: wait:   cmp  dcl, 2
+ * 0x1134:         jnz  wait
+ * 0x1138:         out  bcl, HALT           ; HALT = 0x1001
+ * 0x113d: spin:   jmp  spin
+ * 0x1141: isr:    mov  iid, ccl
+ * 0x1145:         cmp  dcl, 0
+ * 0x114a:         jnz  second
+ * 0x114e:         mov  ccl, bcl            ; IID of the first interrupt
+ * 0x1152: second: ld   acl, 4              ; acknowledge the channel
+ * 0x1157:         cmp  ccl, 0x40
+ * 0x115c:         jnz  ch2
+ * 0x1160:         out  acl, CH0_CONTROL
+ * 0x1165:         jmp  done
+ * 0x1169: ch2:    out  acl, CH2_CONTROL
+ * 0x116e: done:   ld   acl, 1
+ * 0x1173:         out  acl, PIC_COMMAND    ; end of interrupt
+ * 0x1178:         inc  dcl
+ * 0x117b:         iret */
+/* clang-format off */
+static const std::vector<u8> PIC_MRI = {
+	0x4d, 0x52, 0x49, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0xa5,
+	0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x24,
+	0x11, 0x00, 0x00, 0x7d, 0x00, 0x00, 0x00, 0xa1, 0xff, 0xfc, 0x00, 0x04,
+	0x1c, 0x08, 0x0f, 0x00, 0x0c, 0x1b, 0x80, 0x0b, 0x00, 0x00, 0x1b, 0x80,
+	0x02, 0x00, 0x40, 0x22, 0x80, 0x02, 0x31, 0x04, 0x1b, 0x80, 0x02, 0x00,
+	0x01, 0x22, 0x80, 0x02, 0x30, 0x10, 0x22, 0x80, 0x02, 0x30, 0x00, 0x22,
+	0x80, 0x02, 0x30, 0x14, 0x22, 0x80, 0x02, 0x30, 0x04, 0x3f, 0x00, 0x07,
+	0x80, 0x0b, 0x00, 0x02, 0x18, 0x00, 0x11, 0x2f, 0x22, 0x80, 0x05, 0x10,
+	0x01, 0x10, 0x00, 0x11, 0x3d, 0x1c, 0x88, 0x10, 0x08, 0x07, 0x80, 0x0b,
+	0x00, 0x00, 0x18, 0x00, 0x11, 0x52, 0x1c, 0x88, 0x08, 0x05, 0x1b, 0x80,
+	0x02, 0x00, 0x04, 0x07, 0x80, 0x08, 0x00, 0x40, 0x18, 0x00, 0x11, 0x69,
+	0x22, 0x80, 0x02, 0x30, 0x04, 0x10, 0x00, 0x11, 0x6e, 0x22, 0x80, 0x02,
+	0x30, 0x14, 0x1b, 0x80, 0x02, 0x00, 0x01, 0x22, 0x80, 0x02, 0x31, 0x06,
+	0x0d, 0x80, 0x0b, 0x0f, 0x00, 0x11, 0x41, 0x11, 0x00
+};
+/* clang-format on */
+
+static u8 acknowledge(GioBus &bus) {
+	bus.acknowledge();
+	return bus.io;
+}
+
+TEST_SUITE("Pic") {
+	TEST_CASE("priority, mask and end of interrupt") {
+		auto bus = std::make_shared<GioBus>();
+		auto pic = std::make_shared<PicDevice>(PIC_BASE, bus->interrupts(), PIC_FIRST);
+		bus->mapDevice(PIC_BASE, PIC_BASE + PicDevice::PORT_COUNT - 1, pic);
+		bus->setInterruptController(pic.get());
+
+		CpuTest cpu;
+		cpu.connectIoDevice(bus);
+
+		/* lines outside of the inputs are not seen */
+		bus->interrupts().raise(PIC_FIRST - 1);
+		bus->interrupts().raise(PIC_FIRST + PicDevice::INPUT_COUNT);
+		CHECK_FALSE(bus->interruptPending());
+
+		/* vectors which would wrap are ignored */
+		gioWrite(cpu, PIC_BASE + PicDevice::PORT_VECTOR, PicDevice::MAX_VECTOR + 1);
+		CHECK_EQ(gioRead(cpu, PIC_BASE + PicDevice::PORT_VECTOR), PIC_FIRST);
+		gioWrite(cpu, PIC_BASE + PicDevice::PORT_VECTOR, 0x80);
+		bus->interrupts().raise(PIC_FIRST + 5);
+		bus->interrupts().raise(PIC_FIRST + 9);
+		CHECK(bus->interruptPending());
+		CHECK_EQ(gioRead(cpu, PIC_BASE + PicDevice::PORT_REQUESTS), (1 << 5) | (1 << 9));
+
+		/* the in service input blocks itself and lower priorities */
+		CHECK_EQ(acknowledge(*bus), 0x85);
+		CHECK_EQ(gioRead(cpu, PIC_BASE + PicDevice::PORT_IN_SERVICE), 1 << 5);
+		CHECK_FALSE(bus->interruptPending());
+
+		/* a higher priority nests */
+		bus->interrupts().raise(PIC_FIRST + 2);
+		CHECK(bus->interruptPending());
+		CHECK_EQ(acknowledge(*bus), 0x82);
+		bus->interrupts().lower(PIC_FIRST + 2);
+		CHECK_EQ(gioRead(cpu, PIC_BASE + PicDevice::PORT_IN_SERVICE), (1 << 2) | (1 << 5));
+
+		/* end of interrupt retires the highest priority first */
+		gioWrite(cpu, PIC_BASE + PicDevice::PORT_COMMAND, PicDevice::COMMAND_EOI);
+		CHECK_EQ(gioRead(cpu, PIC_BASE + PicDevice::PORT_IN_SERVICE), 1 << 5);
+		CHECK_FALSE(bus->interruptPending());
+
+		bus->interrupts().lower(PIC_FIRST + 5);
+		gioWrite(cpu, PIC_BASE + PicDevice::PORT_COMMAND, PicDevice::COMMAND_EOI);
+		CHECK_EQ(gioRead(cpu, PIC_BASE + PicDevice::PORT_IN_SERVICE), 0);
+		CHECK(bus->interruptPending());
+
+		/* masked inputs are neither pending nor acknowledged */
+		gioWrite(cpu, PIC_BASE + PicDevice::PORT_MASK, 1 << 9);
+		CHECK_FALSE(bus->interruptPending());
+		CHECK_EQ(gioRead(cpu, PIC_BASE + PicDevice::PORT_REQUESTS), 0);
+		CHECK_EQ(gioRead(cpu, PIC_BASE + PicDevice::PORT_MASK), 1 << 9);
+
+		/* spurious, the lowest priority input is not put in service */
+		CHECK_EQ(acknowledge(*bus), 0x8f);
+		CHECK_EQ(gioRead(cpu, PIC_BASE + PicDevice::PORT_IN_SERVICE), 0);
+
+		/* without the controller the lowest raised line is taken again */
+		bus->setInterruptController(nullptr);
+		CHECK_EQ(acknowledge(*bus), PIC_FIRST - 1);
+	}
+
+	TEST_CASE("rotating priority") {
+		auto bus = std::make_shared<GioBus>();
+		auto pic = std::make_shared<PicDevice>(PIC_BASE, bus->interrupts(), PIC_FIRST);
+		bus->mapDevice(PIC_BASE, PIC_BASE + PicDevice::PORT_COUNT - 1, pic);
+		bus->setInterruptController(pic.get());
+
+		CpuTest cpu;
+		cpu.connectIoDevice(bus);
+
+		/* the vector defaults to the first line */
+		bus->interrupts().raise(PIC_FIRST + 1);
+		bus->interrupts().raise(PIC_FIRST + 6);
+		bus->interrupts().raise(PIC_FIRST + 12);
+		CHECK_EQ(acknowledge(*bus), PIC_FIRST + 1);
+		gioWrite(cpu, PIC_BASE + PicDevice::PORT_COMMAND, PicDevice::COMMAND_EOI);
+
+		/* 6 first, then 12, the lower inputs follow after 15 */
+		gioWrite(cpu, PIC_BASE + PicDevice::PORT_PRIORITY, 6);
+		CHECK_EQ(gioRead(cpu, PIC_BASE + PicDevice::PORT_PRIORITY), 6);
+		CHECK_EQ(acknowledge(*bus), PIC_FIRST + 6);
+		CHECK_FALSE(bus->interruptPending());
+		gioWrite(cpu, PIC_BASE + PicDevice::PORT_COMMAND, PicDevice::COMMAND_EOI);
+
+		bus->interrupts().lower(PIC_FIRST + 6);
+		CHECK_EQ(acknowledge(*bus), PIC_FIRST + 12);
+
+		/* input 1 has a lower priority than 12 now */
+		CHECK_FALSE(bus->interruptPending());
+		bus->interrupts().lower(PIC_FIRST + 12);
+		gioWrite(cpu, PIC_BASE + PicDevice::PORT_COMMAND, PicDevice::COMMAND_EOI);
+		CHECK_EQ(acknowledge(*bus), PIC_FIRST + 1);
+	}
+
+	TEST_CASE("timer interrupts through the machine file") {
+		std::istringstream stream(R"(
+[device halt]
+type = halt
+ports = 0x1001
+[device timer]
+type = timer
+ports = 0x3000
+irq = 0
+[device pic]
+type = pic
+ports = 0x3100
+)");
+		const std::optional<MachineConfig> config = MachineConfig::parse(stream, "pic.ini");
+		REQUIRE(config.has_value());
+
+		System system(0, UINT16_MAX);
+		system.setMainMemoryData(::mfdemu::parseMRIFromBytes(PIC_MRI));
+		REQUIRE(config->apply(system));
+		system.run();
+
+		/* channel 0 goes first although channel 2 expired first */
+		CHECK_EQ(system.stopReason(), System::StopReason::HALT);
+		CHECK_EQ(system.guestStatus(), 0x40);
+		CHECK_EQ(system.cpu().readRegister(REGISTER_CCL), 0x42);
+		CHECK_EQ(system.cpu().readRegister(REGISTER_DCL), 2);
+		CHECK_EQ(system.interrupts().raised(0, 4), 0);
+
+		/* taking interrupts leaves nothing behind on the state stack, only the
+		 * fetch below the OUT to the halt port remains once it finished */
+		Cpu &cpu = system.cpu();
+		while(cpu.saveContext().state.top() != Cpu::CpuState::INST_FETCH) {
+			cpu.iclck();
+		}
+		CHECK_EQ(cpu.saveContext().state.size(), 1);
+	}
+}
+}  // namespace test::mfdemu
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+#include <optional>
+
+#include <dlfcn.h>
+
+#include <mfdemu/impl/bus/gio_bus.hpp>
+#include <mfdemu/impl/bus/interrupts.hpp>
+#include <mfdemu/impl/devices/plugin.hpp>
+
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>
+
+#include "test_cpu.hpp"
+
+namespace test::mfdemu {
+
+/* run a whole GIO transaction, returns the word read */
+static u16 transfer(CpuTest &cpu, bool write, u16 port, u16 value = 0) {
+	cpu.newState(write ? CpuTest::CpuState::GIO_WRITE : CpuTest::CpuState::GIO_READ);
+	cpu.m_ioBusAddress = port;
+	cpu.m_ioBusOutput = value;
+	for(int cycle = 0; cycle < 5; cycle++) {
+		cpu.iclck();
+	}
+
+	return cpu.m_ioBusInput;
+}
+
+TEST_SUITE("Plugins") {
+	TEST_CASE("specs") {
+		std::optional<PluginSpec> spec = PluginSpec::parse("dev/a.so@0x2000:0x200f,1,2");
+		REQUIRE(spec.has_value());
+		CHECK_EQ(spec->path, "dev/a.so");
+		CHECK_EQ(spec->first, 0x2000);
+		CHECK_EQ(spec->last, 0x200f);
+		CHECK_EQ(spec->params, "1,2");
+
+		spec = PluginSpec::parse("a.so@16");
+		REQUIRE(spec.has_value());
+		CHECK_EQ(spec->first, 16);
+		CHECK_EQ(spec->last, 16);
+		CHECK_EQ(spec->params, "");
+
+		CHECK_FALSE(PluginSpec::parse("a.so").has_value());
+		CHECK_FALSE(PluginSpec::parse("a.so@").has_value());
+		CHECK_FALSE(PluginSpec::parse("a.so@5:4").has_value());
+		CHECK_FALSE(PluginSpec::parse("a.so@0x10000").has_value());
+		CHECK_FALSE(PluginSpec::parse("a.so@1:x").has_value());
+	}
+
+	TEST_CASE("loading") {
+		CHECK(loadPlugin({.path = "/nonexistent.so", .first = 0, .last = 0}) == nullptr);
+		CHECK(loadPlugin({.path = TEST_PLUGIN_PATH, .first = 0, .last = 0, .params = "x"}) ==
+			  nullptr);
+	}
+
+	TEST_CASE("transactions and read caching") {
+		std::shared_ptr<PluginDevice> device =
+			loadPlugin({.path = TEST_PLUGIN_PATH, .first = 0x2000, .last = 0x2003, .params = "7"});
+		REQUIRE(device != nullptr);
+
+		/* the plugin is loaded already, this only looks up its counters */
+		void *handle = dlopen(TEST_PLUGIN_PATH, RTLD_NOW | RTLD_NOLOAD);
+		REQUIRE(handle != nullptr);
+		const auto *reads = static_cast<const unsigned *>(dlsym(handle, "scratch_reads"));
+		const auto *writes = static_cast<const unsigned *>(dlsym(handle, "scratch_writes"));
+		REQUIRE(reads != nullptr);
+		REQUIRE(writes != nullptr);
+
+		auto bus = std::make_shared<GioBus>();
+		bus->mapDevice(0x2000, 0x2003, device);
+		CpuTest cpu;
+		cpu.connectIoDevice(bus);
+
+		CHECK_EQ(transfer(cpu, false, 0x2001), 7);
+		CHECK_EQ(*reads, 1);
+		CHECK_EQ(transfer(cpu, false, 0x2001), 7);
+		CHECK_EQ(*reads, 1);
+
+		transfer(cpu, true, 0x2002, 0xbeef);
+		CHECK_EQ(*writes, 1);
+		CHECK_EQ(transfer(cpu, false, 0x2002), 0xbeef);
+		CHECK_EQ(transfer(cpu, false, 0x2001), 7);
+		CHECK_EQ(*reads, 3);
+
+		/* cacheable reads do not count against idle loop detection */
+		CHECK_EQ(bus->volatileReads(), 0);
+
+		dlclose(handle);
+	}
+
+	TEST_CASE("block transfers") {
+		std::shared_ptr<PluginDevice> device =
+			loadPlugin({.path = TEST_PLUGIN_PATH, .first = 0x2000, .last = 0x2003, .params = "7"});
+		REQUIRE(device != nullptr);
+
+		void *handle = dlopen(TEST_PLUGIN_PATH, RTLD_NOW | RTLD_NOLOAD);
+		REQUIRE(handle != nullptr);
+		const auto *blocks = static_cast<const unsigned *>(dlsym(handle, "scratch_blocks"));
+		REQUIRE(blocks != nullptr);
+		const unsigned blocks_before = *blocks;
+
+		auto bus = std::make_shared<GioBus>();
+		bus->mapDevice(0x2000, 0x2003, device);
+		CpuTest cpu;
+		cpu.connectIoDevice(bus);
+
+		CHECK(bus->blockAccess(0x2000, 2));
+		CHECK(bus->blockAccess(0x2001, 2));
+		CHECK_FALSE(bus->blockAccess(0x2002, 2));
+
+		/* fill the read cache, a block write has to drop it */
+		CHECK_EQ(transfer(cpu, false, 0x2002), 7);
+
+		const u16 data[2] = {0x1234, 0x5678};
+		bus->writeBlock(0x2000, data, 2);
+		CHECK_EQ(transfer(cpu, false, 0x2002), 0x5678);
+
+		u16 out[2] = {};
+		bus->readBlock(0x2000, out, 2);
+		CHECK_EQ(out[0], 0x1234);
+		CHECK_EQ(out[1], 0x5678);
+		CHECK_EQ(*blocks - blocks_before, 2);
+
+		dlclose(handle);
+	}
+
+	TEST_CASE("interrupts") {
+		std::shared_ptr<PluginDevice> device =
+			loadPlugin({.path = TEST_PLUGIN_PATH, .first = 0x2000, .last = 0x2003, .params = "0"});
+		REQUIRE(device != nullptr);
+
+		InterruptSink sink;
+		device->setInterrupt(&sink, 5);
+
+		auto bus = std::make_shared<GioBus>();
+		bus->mapDevice(0x2000, 0x2003, device);
+		CpuTest cpu;
+		cpu.connectIoDevice(bus);
+
+		transfer(cpu, true, 0x2002, 1);
+		CHECK_FALSE(sink.pending());
+
+		transfer(cpu, true, 0x2003, 1);
+		CHECK_EQ(sink.raised(5, 1), 1);
+		CHECK_EQ(sink.acknowledge(), 5);
+
+		const u16 data[2] = {0, 2};
+		bus->writeBlock(0x2001, data, 2);
+		CHECK_FALSE(sink.pending());
+	}
+}
+}  // namespace test::mfdemu
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Device plugin used by plugin.cpp: a bank of word registers, one per port,
+ * all initialized to the value given as parameter. The interrupt line follows
+ * bit 0 of the register at the last port.
+ */
+
+#include <stdlib.h>
+
+#include <mfdemu/plugin.h>
+
+struct scratch {
+	uint16_t first;
+	uint16_t last;
+	uint16_t *words;
+	const mfdemu_plugin_host *host;
+};
+
+/* calls into the plugin, read by the tests through dlsym() */
+unsigned scratch_reads = 0;
+unsigned scratch_writes = 0;
+unsigned scratch_blocks = 0;
+
+static void *scratch_create(
+	uint16_t first, uint16_t last, const char *params, const mfdemu_plugin_host *host) {
+	char *end = NULL;
+	const unsigned long initial = strtoul(params, &end, 0);
+	if(*end != '\0' || initial > UINT16_MAX) {
+		return NULL;
+	}
+
+	struct scratch *scratch = malloc(sizeof(struct scratch));
+	scratch->first = first;
+	scratch->last = last;
+	scratch->host = host;
+	scratch->words = malloc(sizeof(uint16_t) * (last - first + 1));
+	for(unsigned ix = 0; ix <= (unsigned)(last - first); ix++) {
+		scratch->words[ix] = initial;
+	}
+
+	return scratch;
+}
+
+static void scratch_destroy(void *instance) {
+	struct scratch *scratch = instance;
+	free(scratch->words);
+	free(scratch);
+}
+
+static uint16_t scratch_read(void *instance, uint16_t port) {
+	struct scratch *scratch = instance;
+	scratch_reads++;
+	return scratch->words[port - scratch->first];
+}
+
+static void scratch_store(struct scratch *scratch, uint16_t port, uint16_t value) {
+	scratch->words[port - scratch->first] = value;
+	if(port == scratch->last) {
+		scratch->host->set_irq(scratch->host->context, (value & 1) != 0);
+	}
+}
+
+static void scratch_write(void *instance, uint16_t port, uint16_t value) {
+	scratch_writes++;
+	scratch_store(instance, port, value);
+}
+
+static bool scratch_block_access(void *instance, uint16_t port, size_t count) {
+	const struct scratch *scratch = instance;
+	return count > 0 && port >= scratch->first && port + (2 * (count - 1)) <= scratch->last;
+}
+
+static void scratch_read_block(void *instance, uint16_t port, uint16_t *out, size_t count) {
+	const struct scratch *scratch = instance;
+	scratch_blocks++;
+	for(size_t ix = 0; ix < count; ix++) {
+		out[ix] = scratch->words[port + (2 * ix) - scratch->first];
+	}
+}
+
+static void scratch_write_block(
+	void *instance, uint16_t port, const uint16_t *data, size_t count) {
+	scratch_blocks++;
+	for(size_t ix = 0; ix < count; ix++) {
+		scratch_store(instance, port + (2 * ix), data[ix]);
+	}
+}
+
+static const mfdemu_plugin_descriptor DESCRIPTOR = {
+	.abi_version = MFDEMU_PLUGIN_ABI_VERSION,
+	.flags = MFDEMU_PLUGIN_CACHEABLE_READS,
+	.name = "scratch",
+	.create = scratch_create,
+	.destroy = scratch_destroy,
+	.read = scratch_read,
+	.write = scratch_write,
+	.clck = NULL,
+	.block_access = scratch_block_access,
+	.read_block = scratch_read_block,
+	.write_block = scratch_write_block,
+};
+
+const mfdemu_plugin_descriptor *mfdemu_plugin_describe(void) {
+	return &DESCRIPTOR;
+}
@@ -0,0 +1,53 @@
+#include <memory>
+
+#include <mfdemu/impl/bus/gio_bus.hpp>
+#include <mfdemu/impl/devices/pmu.hpp>
+
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>
+
+#include "test_cpu.hpp"
+
+namespace test::mfdemu {
+constexpr u16 PMU_BASE = 0x2000;
+
+static u64 readCounter(CpuTest &cpu, u16 port) {
+	u64 value = 0;
+	for(u16 word = 0; word < 4; word++) {
+		value = (value << 16) | gioRead(cpu, PMU_BASE + port + (word * 2));
+	}
+	return value;
+}
+
+TEST_SUITE("PMU") {
+	TEST_CASE("counter read, freeze & reset") {
+		PerfCounters counters;
+		counters.cycles = 0x0123456789abcdef;
+		counters.retired = 42;
+
+		auto bus = std::make_shared<GioBus>();
+		bus->mapDevice(
+			PMU_BASE, PMU_BASE + PmuDevice::PORT_COUNT - 1,
+			std::make_shared<PmuDevice>(PMU_BASE, counters));
+
+		CpuTest cpu;
+		cpu.connectIoDevice(bus);
+
+		CHECK_EQ(readCounter(cpu, 0x00), 0x0123456789abcdef);
+		CHECK_EQ(readCounter(cpu, 0x08), 42);
+
+		gioWrite(cpu, PMU_BASE + PmuDevice::PORT_CONTROL, PmuDevice::CONTROL_FREEZE);
+		CHECK_EQ(gioRead(cpu, PMU_BASE + PmuDevice::PORT_CONTROL), PmuDevice::CONTROL_FREEZE);
+		counters.retired = 50;
+		CHECK_EQ(readCounter(cpu, 0x08), 42);
+
+		gioWrite(cpu, PMU_BASE + PmuDevice::PORT_CONTROL, 0);
+		counters.retired = 60;
+		CHECK_EQ(readCounter(cpu, 0x08), 52);
+
+		gioWrite(cpu, PMU_BASE + PmuDevice::PORT_CONTROL, PmuDevice::CONTROL_RESET);
+		counters.retired = 65;
+		CHECK_EQ(readCounter(cpu, 0x08), 5);
+	}
+}
+}  // namespace test::mfdemu
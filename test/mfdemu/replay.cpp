@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <mfdemu/impl/bus/aio_device.hpp>
+#include <mfdemu/impl/cpu.hpp>
+#include <mfdemu/impl/replay.hpp>
+
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>
+
+#include "test_cpu.hpp"
+
+namespace test::mfdemu {
+static void clockCycles(CpuTest &cpu, u64 count) {
+	for(u64 ix = 0; ix < count; ix++) {
+		cpu.iclck();
+	}
+}
+
+static std::shared_ptr<AioDevice> makeMemory() {
+	auto memory = std::make_shared<AioDevice>(false, 0x10000);
+	memory->setData(std::vector<u8>(0x10000));
+	return memory;
+}
+
+TEST_SUITE("Record & Replay") {
+	TEST_CASE("roundtrip") {
+		const std::string tmp_file = "/tmp/emu_replay_test." + std::to_string(getpid());
+
+		{
+			CpuTest cpu;
+			cpu.connectAddressDevice(makeMemory());
+			cpu.newState(CpuTest::CpuState::INST_FETCH);
+
+			InputRecorder recorder(cpu);
+			REQUIRE(recorder.open(tmp_file));
+			clockCycles(cpu, 3);
+			recorder.gioRead(0x41);
+			clockCycles(cpu, 200);
+			recorder.irq(true);
+			recorder.gioRead(0x42);
+			clockCycles(cpu, 5);
+			recorder.close();
+		}
+
+		CpuTest cpu;
+		cpu.connectAddressDevice(makeMemory());
+		cpu.newState(CpuTest::CpuState::INST_FETCH);
+
+		InputReplayer replayer(cpu);
+		REQUIRE(replayer.open(tmp_file));
+		std::remove(tmp_file.c_str());
+
+		clockCycles(cpu, 3);
+		CHECK_EQ(replayer.gioRead(), 0x41);
+		CHECK_FALSE(replayer.irq());
+
+		clockCycles(cpu, 199);
+		CHECK_FALSE(replayer.irq());
+		clockCycles(cpu, 1);
+		CHECK(replayer.irq());
+		CHECK_EQ(replayer.gioRead(), 0x42);
+
+		clockCycles(cpu, 4);
+		CHECK_FALSE(replayer.finished());
+		clockCycles(cpu, 1);
+		CHECK(replayer.finished());
+	}
+
+	TEST_CASE("divergence") {
+		const std::string tmp_file = "/tmp/emu_replay_test." + std::to_string(getpid());
+
+		{
+			CpuTest cpu;
+			cpu.connectAddressDevice(makeMemory());
+			cpu.newState(CpuTest::CpuState::INST_FETCH);
+
+			InputRecorder recorder(cpu);
+			REQUIRE(recorder.open(tmp_file));
+			clockCycles(cpu, 10);
+			recorder.gioRead(0x41);
+			clockCycles(cpu, 10);
+			recorder.close();
+		}
+
+		CpuTest cpu;
+		cpu.connectAddressDevice(makeMemory());
+		cpu.newState(CpuTest::CpuState::INST_FETCH);
+
+		InputReplayer replayer(cpu);
+		REQUIRE(replayer.open(tmp_file));
+		std::remove(tmp_file.c_str());
+
+		clockCycles(cpu, 9);
+		CHECK_FALSE(replayer.finished());
+		CHECK_EQ(replayer.gioRead(), 0);
+		CHECK(replayer.finished());
+	}
+}
+}  // namespace test::mfdemu
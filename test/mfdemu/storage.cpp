@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <mfdemu/impl/bus/aio_device.hpp>
+#include <mfdemu/impl/bus/gio_bus.hpp>
+#include <mfdemu/impl/devices/storage.hpp>
+#include <mfdemu/impl/scheduler.hpp>
+
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>
+
+#include "test_cpu.hpp"
+
+namespace test::mfdemu {
+constexpr u16 STORAGE_BASE = 0x3000;
+constexpr u8 STORAGE_IRQ = 4;
+
+static void transfer(CpuTest &cpu, u16 command, u16 sector, u16 count, u16 address) {
+	gioWrite(cpu, STORAGE_BASE + StorageDevice::PORT_SECTOR, sector);
+	gioWrite(cpu, STORAGE_BASE + StorageDevice::PORT_SECTOR_COUNT, count);
+	gioWrite(cpu, STORAGE_BASE + StorageDevice::PORT_ADDRESS, address);
+	gioWrite(cpu, STORAGE_BASE + StorageDevice::PORT_COMMAND, command);
+}
+
+TEST_SUITE("Storage") {
+	TEST_CASE("dma transfers and completion interrupt") {
+		const std::string path = "/tmp/emu_storage_test." + std::to_string(getpid());
+		{
+			/* two sectors and a partial one which is not part of the capacity */
+			std::vector<char> contents(StorageDevice::SECTOR_SIZE * 2 + 100);
+			for(usize ix = 0; ix < contents.size(); ix++) {
+				contents[ix] = static_cast<char>(ix / StorageDevice::SECTOR_SIZE + 1);
+			}
+			std::ofstream file(path, std::ios::binary);
+			file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+		}
+
+		PerfCounters counters;
+		EventScheduler scheduler;
+		AioDevice memory(false, 0x10000);
+		memory.setData(std::vector<u8>(0x10000));
+		memory.setAccess(0x80, 0x80, AioDevice::Access::READ_ONLY);
+
+		auto storage = std::make_shared<StorageDevice>(STORAGE_BASE, memory, scheduler, counters);
+		REQUIRE(storage->open(path));
+
+		auto bus = std::make_shared<GioBus>();
+		storage->setInterrupt(&bus->interrupts(), STORAGE_IRQ);
+		bus->mapDevice(STORAGE_BASE, STORAGE_BASE + StorageDevice::PORT_COUNT - 1, storage);
+
+		CpuTest cpu;
+		cpu.connectIoDevice(bus);
+
+		CHECK_EQ(gioRead(cpu, STORAGE_BASE + StorageDevice::PORT_CAPACITY), 2);
+
+		/* read sector 1 to 0x1000, nothing moves before the latency passed */
+		transfer(cpu, StorageDevice::COMMAND_READ, 1, 1, 0x1000);
+		CHECK_EQ(
+			gioRead(cpu, STORAGE_BASE + StorageDevice::PORT_COMMAND), StorageDevice::STATUS_BUSY);
+		CHECK_EQ(scheduler.nextCycle(), StorageDevice::CYCLES_PER_SECTOR);
+
+		counters.cycles = StorageDevice::CYCLES_PER_SECTOR - 1;
+		scheduler.runDue(counters.cycles);
+		CHECK_EQ(memory.readByte(0x1000), 0);
+		CHECK_FALSE(bus->interrupts().pending());
+
+		counters.cycles++;
+		scheduler.runDue(counters.cycles);
+		CHECK_EQ(
+			gioRead(cpu, STORAGE_BASE + StorageDevice::PORT_COMMAND), StorageDevice::STATUS_DONE);
+		CHECK_EQ(memory.readByte(0x1000), 2);
+		CHECK_EQ(memory.readByte(0x11ff), 2);
+		CHECK_EQ(memory.readByte(0x1200), 0);
+		CHECK(bus->interrupts().pending());
+		CHECK_EQ(bus->interrupts().acknowledge(), STORAGE_IRQ);
+
+		gioWrite(
+			cpu, STORAGE_BASE + StorageDevice::PORT_COMMAND, StorageDevice::COMMAND_ACKNOWLEDGE);
+		CHECK_EQ(gioRead(cpu, STORAGE_BASE + StorageDevice::PORT_COMMAND), 0);
+		CHECK_FALSE(bus->interrupts().pending());
+
+		/* write two sectors back, the read-only page reads normally */
+		memory.dmaWrite(0x8000, std::vector<u8>(0x200, 0xaa).data(), 0x200);
+		CHECK_EQ(memory.readByte(0x8000), 0);
+		CHECK_EQ(memory.readByte(0x8100), 0xaa);
+
+		transfer(cpu, StorageDevice::COMMAND_WRITE, 0, 2, 0x8000);
+		counters.cycles += 2 * StorageDevice::CYCLES_PER_SECTOR;
+		scheduler.runDue(counters.cycles);
+		CHECK_EQ(
+			gioRead(cpu, STORAGE_BASE + StorageDevice::PORT_COMMAND), StorageDevice::STATUS_DONE);
+		gioWrite(
+			cpu, STORAGE_BASE + StorageDevice::PORT_COMMAND, StorageDevice::COMMAND_ACKNOWLEDGE);
+
+		/* sectors past the capacity fail without touching memory */
+		transfer(cpu, StorageDevice::COMMAND_READ, 1, 2, 0x2000);
+		counters.cycles += 2 * StorageDevice::CYCLES_PER_SECTOR;
+		scheduler.runDue(counters.cycles);
+		CHECK_EQ(
+			gioRead(cpu, STORAGE_BASE + StorageDevice::PORT_COMMAND),
+			StorageDevice::STATUS_DONE | StorageDevice::STATUS_ERROR);
+		CHECK_EQ(memory.readByte(0x2000), 0);
+
+		storage.reset();
+		bus.reset();
+
+		std::ifstream file(path, std::ios::binary);
+		std::vector<char> contents(
+			(std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		std::remove(path.c_str());
+
+		REQUIRE_EQ(contents.size(), StorageDevice::SECTOR_SIZE * 2 + 100);
+		CHECK_EQ(contents[0x000], 0);
+		CHECK_EQ(contents[0x0ff], 0);
+		CHECK_EQ(contents[0x100], static_cast<char>(0xaa));
+		CHECK_EQ(contents[0x1ff], static_cast<char>(0xaa));
+		CHECK_EQ(contents[0x200], 0);
+		CHECK_EQ(contents[0x3ff], 0);
+		CHECK_EQ(contents[0x400], 3);
+	}
+
+	TEST_CASE("writes stop at the end of memory") {
+		const std::string path = "/tmp/emu_storage_end_test." + std::to_string(getpid());
+		{
+			std::vector<char> contents(StorageDevice::SECTOR_SIZE * 2, 0x11);
+			std::ofstream file(path, std::ios::binary);
+			file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+		}
+
+		PerfCounters counters;
+		EventScheduler scheduler;
+		AioDevice memory(false, 0x1100);
+		memory.setData(std::vector<u8>(0x1100, 0x55));
+
+		auto storage = std::make_shared<StorageDevice>(STORAGE_BASE, memory, scheduler, counters);
+		REQUIRE(storage->open(path));
+
+		auto bus = std::make_shared<GioBus>();
+		bus->mapDevice(STORAGE_BASE, STORAGE_BASE + StorageDevice::PORT_COUNT - 1, storage);
+
+		CpuTest cpu;
+		cpu.connectIoDevice(bus);
+
+		/* only 0x100 bytes of memory are left from 0x1000 */
+		transfer(cpu, StorageDevice::COMMAND_WRITE, 0, 2, 0x1000);
+		counters.cycles += 2 * StorageDevice::CYCLES_PER_SECTOR;
+		scheduler.runDue(counters.cycles);
+		CHECK_EQ(
+			gioRead(cpu, STORAGE_BASE + StorageDevice::PORT_COMMAND), StorageDevice::STATUS_DONE);
+
+		storage.reset();
+		bus.reset();
+
+		std::ifstream file(path, std::ios::binary);
+		std::vector<char> contents(
+			(std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		std::remove(path.c_str());
+
+		REQUIRE_EQ(contents.size(), StorageDevice::SECTOR_SIZE * 2);
+		CHECK_EQ(contents[0x000], 0x55);
+		CHECK_EQ(contents[0x0ff], 0x55);
+		CHECK_EQ(contents[0x100], 0x11);
+		CHECK_EQ(contents[0x3ff], 0x11);
+	}
+}
+}  // namespace test::mfdemu
@@ -24,4 +24,24 @@ class CpuTest : public Cpu {
 	u16 &m_ioBusOutput = Cpu::m_ioBusOutput;
 	u16 &m_ioBusAddress = Cpu::m_ioBusAddress;
 };
+
+/** run a whole GIO read transaction, returns the word read */
+inline u16 gioRead(CpuTest &cpu, u16 address) {
+	cpu.newState(CpuTest::CpuState::GIO_READ);
+	cpu.m_ioBusAddress = address;
+	for(int ix = 0; ix < 5; ix++) {
+		cpu.iclck();
+	}
+	return cpu.m_ioBusInput;
+}
+
+/** run a whole GIO write transaction */
+inline void gioWrite(CpuTest &cpu, u16 address, u16 value) {
+	cpu.newState(CpuTest::CpuState::GIO_WRITE);
+	cpu.m_ioBusAddress = address;
+	cpu.m_ioBusOutput = value;
+	for(int ix = 0; ix < 5; ix++) {
+		cpu.iclck();
+	}
+}
 }  // namespace test::mfdemu
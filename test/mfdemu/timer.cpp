@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+
+#include <mfdemu/impl/bus/gio_bus.hpp>
+#include <mfdemu/impl/devices/timer.hpp>
+#include <mfdemu/impl/scheduler.hpp>
+
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>
+
+#include "test_cpu.hpp"
+
+namespace test::mfdemu {
+constexpr u16 TIMER_BASE = 0x5000;
+constexpr u8 TIMER_IRQ = 8;
+
+static u16 channelPort(u16 channel, u16 port) {
+	return TIMER_BASE + (channel * TimerDevice::CHANNEL_PORTS) + port;
+}
+
+TEST_SUITE("Timer") {
+	TEST_CASE("periodic and one-shot channels") {
+		PerfCounters counters;
+		EventScheduler scheduler;
+		auto timer = std::make_shared<TimerDevice>(TIMER_BASE, scheduler, counters);
+		auto bus = std::make_shared<GioBus>();
+		timer->setInterrupt(&bus->interrupts(), TIMER_IRQ);
+		bus->mapDevice(TIMER_BASE, TIMER_BASE + TimerDevice::PORT_COUNT - 1, timer);
+
+		CpuTest cpu;
+		cpu.connectIoDevice(bus);
+
+		/* channel 1: 10 ticks of 4 cycles, periodic */
+		counters.cycles = 100;
+		gioWrite(cpu, channelPort(1, TimerDevice::PORT_RELOAD), 10);
+		gioWrite(cpu, channelPort(1, TimerDevice::PORT_PRESCALER), 4);
+		gioWrite(
+			cpu, channelPort(1, TimerDevice::PORT_CONTROL),
+			TimerDevice::CONTROL_ENABLE | TimerDevice::CONTROL_PERIODIC);
+		CHECK_EQ(scheduler.nextCycle(), 140);
+		CHECK_EQ(gioRead(cpu, channelPort(1, TimerDevice::PORT_COUNTER)), 10);
+
+		counters.cycles = 129;
+		CHECK_EQ(gioRead(cpu, channelPort(1, TimerDevice::PORT_COUNTER)), 3);
+
+		/* channel 3: 5 ticks without prescaler, one-shot */
+		gioWrite(cpu, channelPort(3, TimerDevice::PORT_RELOAD), 5);
+		gioWrite(cpu, channelPort(3, TimerDevice::PORT_CONTROL), TimerDevice::CONTROL_ENABLE);
+		CHECK_EQ(scheduler.nextCycle(), 134);
+
+		counters.cycles = 139;
+		scheduler.runDue(counters.cycles);
+		CHECK(bus->interrupts().pending());
+		CHECK_EQ(bus->interrupts().acknowledge(), TIMER_IRQ + 3);
+		CHECK_EQ(
+			gioRead(cpu, channelPort(3, TimerDevice::PORT_CONTROL)), TimerDevice::STATUS_EXPIRED);
+		CHECK_EQ(gioRead(cpu, channelPort(3, TimerDevice::PORT_COUNTER)), 0);
+
+		gioWrite(
+			cpu, channelPort(3, TimerDevice::PORT_CONTROL), TimerDevice::CONTROL_ACKNOWLEDGE);
+		CHECK_FALSE(bus->interrupts().pending());
+
+		/* the periodic channel keeps its phase */
+		counters.cycles = 140;
+		scheduler.runDue(counters.cycles);
+		CHECK_EQ(bus->interrupts().acknowledge(), TIMER_IRQ + 1);
+		CHECK_EQ(scheduler.nextCycle(), 180);
+		CHECK_EQ(
+			gioRead(cpu, channelPort(1, TimerDevice::PORT_CONTROL)),
+			TimerDevice::CONTROL_ENABLE | TimerDevice::CONTROL_PERIODIC |
+				TimerDevice::STATUS_EXPIRED);
+
+		/* acknowledging late does not move the next expiry */
+		counters.cycles = 150;
+		gioWrite(
+			cpu, channelPort(1, TimerDevice::PORT_CONTROL), TimerDevice::CONTROL_ACKNOWLEDGE);
+		CHECK_FALSE(bus->interrupts().pending());
+		CHECK_EQ(scheduler.nextCycle(), 180);
+
+		/* stopping cancels the pending expiry */
+		gioWrite(cpu, channelPort(1, TimerDevice::PORT_CONTROL), 0);
+		CHECK(scheduler.empty());
+		counters.cycles = 1000;
+		scheduler.runDue(counters.cycles);
+		CHECK_FALSE(bus->interrupts().pending());
+	}
+}
+}  // namespace test::mfdemu
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <unistd.h>
+
+#include <mfdemu/impl/vcd_writer.hpp>
+
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>
+
+namespace test::mfdemu {
+using namespace ::mfdemu::impl;
+
+TEST_SUITE("VCD Writer") {
+	TEST_CASE("trigger parsing") {
+		const std::optional<VcdTrigger> ip = VcdTrigger::parse("ip:0x1100");
+		REQUIRE(ip.has_value());
+		CHECK_EQ(ip->kind, VcdTrigger::IP);
+		CHECK_EQ(ip->value, 0x1100);
+
+		const std::optional<VcdTrigger> cycle = VcdTrigger::parse("cycle:1000");
+		REQUIRE(cycle.has_value());
+		CHECK_EQ(cycle->kind, VcdTrigger::CYCLE);
+		CHECK_EQ(cycle->value, 1000);
+
+		CHECK_FALSE(VcdTrigger::parse("ip:0x10000").has_value());
+		CHECK_FALSE(VcdTrigger::parse("cycle:").has_value());
+		CHECK_FALSE(VcdTrigger::parse("time:10").has_value());
+	}
+
+	TEST_CASE("capture window") {
+		const std::string tmp_file = "/tmp/emu_vcd_test." + std::to_string(getpid());
+
+		{
+			VcdWriter writer({.kind = VcdTrigger::CYCLE, .value = 2},
+							 {.kind = VcdTrigger::IP, .value = 0x0004});
+			REQUIRE(writer.open(tmp_file));
+
+			for(u64 cycle = 0; cycle < 8; cycle++) {
+				writer.sample({
+					.cycle = cycle,
+					.ip = static_cast<u16>(cycle & ~1ULL),
+					.aio = 0,
+					.gio = 0,
+					.clk = true,
+					.ams = cycle == 3,
+					.gms = false,
+					.ira = false,
+					.irq = false,
+					.reset = false,
+				});
+			}
+		}
+
+		std::ifstream stream(tmp_file);
+		std::stringstream contents;
+		contents << stream.rdbuf();
+		const std::string vcd = contents.str();
+		std::remove(tmp_file.c_str());
+
+		CHECK(vcd.find("$enddefinitions $end\n") != std::string::npos);
+		CHECK(vcd.find("\n#3\n") == std::string::npos);
+		CHECK(vcd.find("\n#4\n$dumpvars\n") != std::string::npos);
+		CHECK(vcd.find("\n#6\n1!\n1\"\n1#\n") != std::string::npos);
+		CHECK(vcd.find("\n#8\n1!\n1\"\n0#\n") != std::string::npos);
+		CHECK(vcd.find("\n#9\n") != std::string::npos);
+		CHECK(vcd.find("\n#10\n") == std::string::npos);
+	}
+}
+}  // namespace test::mfdemu
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2025  Marie Eckert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <memory>
+#include <vector>
+
+#include <mfdemu/impl/bus/aio_device.hpp>
+#include <mfdemu/impl/cpu.hpp>
+#include <mfdemu/impl/debug/watchpoints.hpp>
+#include <mfdemu/impl/instructions.hpp>
+
+#define DOCTEST_CONFIG_NO_EXCEPTIONS_BUT_WITH_ALL_ASSERTS
+#include <doctest/doctest.h>
+
+#include "test_cpu.hpp"
+
+namespace test::mfdemu {
+TEST_SUITE("Watchpoints") {
+	TEST_CASE("hits and stop") {
+		/* st 0x1234, 0x0100
+		 * st 0x1234, 0x0100
+		 * div [0x0100] */
+		std::vector<u8> code = {
+			OPCODE_ST, 0x00, 0x12, 0x34, 0x01, 0x00, OPCODE_ST,  0x00,
+			0x12,	   0x34, 0x01, 0x00, OPCODE_DIV, 0x10, 0x01, 0x00,
+		};
+		code.resize(0x10000);
+
+		auto memory = std::make_shared<AioDevice>(false, code.size());
+		memory->setData(code);
+
+		CpuTest cpu;
+		cpu.m_regAR = 0x2468;
+		cpu.connectAddressDevice(memory);
+		cpu.newState(CpuTest::CpuState::INST_FETCH);
+
+		Watchpoints watchpoints;
+		watchpoints.attach(cpu);
+		watchpoints.add(0x0101, 0x0101, Watchpoints::CHANGE, true);
+		watchpoints.add(0x0100, 0x0100, Watchpoints::READ, false);
+		memory->setWatchpoints(&watchpoints);
+
+		CHECK(watchpoints.watched(0x0100));
+		CHECK(watchpoints.watched(0x00ff));
+		CHECK_FALSE(watchpoints.watched(0x0200));
+
+		for(int ix = 0; ix < 1000 && !cpu.stopped(); ix++) {
+			cpu.iclck();
+		}
+
+		/* stops after the first store, the second one does not change the value */
+		REQUIRE(cpu.stopped());
+		CHECK_EQ(cpu.m_regIP, 0x0006);
+		REQUIRE_EQ(watchpoints.hitCount(), 1);
+		CHECK_EQ(watchpoints.history()[0].ip, 0x0000);
+		CHECK_EQ(watchpoints.history()[0].kind, Watchpoints::CHANGE);
+		CHECK_EQ(watchpoints.history()[0].old_value, 0x0000);
+		CHECK_EQ(watchpoints.history()[0].new_value, 0x1234);
+
+		cpu.resume();
+		while(cpu.perfCounters().retired < 3) {
+			cpu.iclck();
+		}
+
+		CHECK_FALSE(cpu.stopped());
+		CHECK_EQ(cpu.m_regAR, 2);
+		REQUIRE_EQ(watchpoints.hitCount(), 2);
+		CHECK_EQ(watchpoints.history()[1].ip, 0x000c);
+		CHECK_EQ(watchpoints.history()[1].kind, Watchpoints::READ);
+		CHECK_EQ(watchpoints.list()[0].hits, 1);
+		CHECK_EQ(watchpoints.list()[1].hits, 1);
+	}
+}
+}  // namespace test::mfdemu